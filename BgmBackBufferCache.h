@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+// =============================================================
+// BACK BUFFER CACHE
+// =============================================================
+// The render target view and size of the swap chain's back buffer, kept
+// across frames. They only change when the game resizes the swap chain (it
+// must call ResizeBuffers or ResizeBuffers1, which fail while we still hold a
+// view of the old buffer, so both hooks call Invalidate first) or presents a
+// different swap chain. The held view also keeps its swap chain alive, so a new swap chain
+// can never reuse the address of the one we cached.
+//
+// The graphics API sits behind a small Device policy so the invalidation
+// logic has no D3D dependency:
+//   using SwapChain = ...;  using RenderTarget = ...;
+//   RenderTarget* Create(SwapChain*, uint32_t* width, uint32_t* height); // null on failure
+//   void Release(RenderTarget*);
+// Not thread-safe: Present and the resize hooks run on the render thread.
+
+struct BgmBackBufferCacheStats {
+    uint64_t rebuilds = 0;       // Successful Create calls
+    uint64_t failures = 0;       // Failed Create calls (retried next frame)
+    uint64_t invalidations = 0;  // Invalidate calls that released a view
+};
+
+template <typename Device>
+class BgmBackBufferCache {
+public:
+    using SwapChain = typename Device::SwapChain;
+    using RenderTarget = typename Device::RenderTarget;
+
+    explicit BgmBackBufferCache(Device device = Device()) : m_device(device) {}
+    ~BgmBackBufferCache() { Invalidate(); }
+
+    BgmBackBufferCache(const BgmBackBufferCache&) = delete;
+    BgmBackBufferCache& operator=(const BgmBackBufferCache&) = delete;
+
+    // Returns the view for swapChain's back buffer, creating it if the cache
+    // is empty or holds another swap chain's. Null if creation failed.
+    RenderTarget* Acquire(SwapChain* swapChain)
+    {
+        if (m_renderTarget && m_swapChain == swapChain)
+            return m_renderTarget;
+
+        Invalidate();
+        uint32_t width = 0, height = 0;
+        m_renderTarget = m_device.Create(swapChain, &width, &height);
+        if (!m_renderTarget)
+        {
+            ++m_stats.failures;
+            return nullptr;
+        }
+        m_swapChain = swapChain;
+        m_width = width;
+        m_height = height;
+        ++m_stats.rebuilds;
+        return m_renderTarget;
+    }
+
+    // Drops the view (and with it our reference to the back buffer).
+    void Invalidate()
+    {
+        if (m_renderTarget)
+        {
+            m_device.Release(m_renderTarget);
+            ++m_stats.invalidations;
+        }
+        m_renderTarget = nullptr;
+        m_swapChain = nullptr;
+        m_width = 0;
+        m_height = 0;
+    }
+
+    // The cached view, if any; never creates one.
+    RenderTarget* GetRenderTarget() const { return m_renderTarget; }
+
+    // Size of the cached back buffer; 0 x 0 while nothing is cached.
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+    const BgmBackBufferCacheStats& GetStats() const { return m_stats; }
+
+private:
+    Device m_device;
+    SwapChain* m_swapChain = nullptr;
+    RenderTarget* m_renderTarget = nullptr;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    BgmBackBufferCacheStats m_stats;
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// =============================================================
+// BGM CAPTURE EVENT RING
+// =============================================================
+// Bounded multi-producer / single-consumer ring of fixed-size event slots.
+// Producers are the CreateFile detours running on arbitrary game threads: a
+// push is a handful of atomics, never blocks and never allocates. When the
+// ring is full the event is dropped and counted instead of stalling the game.
+// The single consumer (BgmWorkerThread) drains events in batches. The ring
+// itself never blocks; waking the consumer is left to the caller. The slot
+// type defaults to BgmCaptureEvent; BgmPathLogEvent rings carry deferred
+// diagnostics the same way.
+//
+// Each slot carries a sequence number (Vyukov's bounded queue): a slot is
+// writable for position `pos` when sequence == pos, and readable once the
+// producer publishes sequence == pos + 1.
+
+// Which detour captured the event; lets the consumer log on the producer's behalf.
+enum class BgmCaptureSource : uint8_t {
+    CreateFileW,
+    CreateFileA,
+};
+
+// 16 bytes: the detour resolves the path to a track ID before pushing, so no
+// strings cross threads. Track IDs are only meaningful within the map snapshot
+// they were resolved against, identified by the low byte of its generation.
+struct BgmCaptureEvent {
+    uint64_t timestamp = 0;   // steady_clock ticks at capture time
+    uint32_t threadId = 0;    // OS id of the thread that opened the file
+    uint16_t trackId = 0;     // Index into the map snapshot below
+    BgmCaptureSource source = BgmCaptureSource::CreateFileW;
+    uint8_t generation = 0;   // BgmMapSnapshot::generation, truncated
+};
+
+// An unresolved .ogg open that Detour_CreateFileA wants logged. The path is
+// copied (truncated) into the slot; voice and sound-effect opens go here, so
+// nothing else about them crosses threads.
+constexpr size_t BGM_LOGGED_PATH_CHARS = 260;
+
+struct BgmPathLogEvent {
+    uint32_t threadId = 0;
+    char path[BGM_LOGGED_PATH_CHARS] = {}; // NUL-terminated
+};
+
+struct BgmEventRingStats {
+    uint64_t pushed = 0;
+    uint64_t overflowed = 0;
+    uint64_t drained = 0;
+};
+
+template <size_t Capacity, typename Event = BgmCaptureEvent>
+class BgmEventRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    BgmEventRing()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BgmEventRing(const BgmEventRing&) = delete;
+    BgmEventRing& operator=(const BgmEventRing&) = delete;
+
+    // Producer side, safe from any number of threads. `fill` receives the
+    // reserved slot's event and writes it in place. Returns false (and counts
+    // an overflow) if the ring is full.
+    template <typename FillFn>
+    bool TryPush(FillFn&& fill)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = m_slots[pos & (Capacity - 1)];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    fill(slot.event);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    m_pushed.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                // CAS failure reloaded pos; try again
+            }
+            else if (diff < 0)
+            {
+                m_overflowed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side, single thread only. Copies up to maxCount published events
+    // into out[] in push order and returns how many were taken. Stops early at a
+    // slot whose producer has reserved it but not finished writing yet.
+    size_t PopBatch(Event* out, size_t maxCount)
+    {
+        size_t count = 0;
+        while (count < maxCount)
+        {
+            Slot& slot = m_slots[m_dequeuePos & (Capacity - 1)];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            if (seq != m_dequeuePos + 1)
+                break;
+
+            out[count++] = slot.event;
+            slot.sequence.store(m_dequeuePos + Capacity, std::memory_order_release);
+            ++m_dequeuePos;
+        }
+        m_drained += count;
+        return count;
+    }
+
+    // Consumer side, for draining under a time budget (inline trigger mode).
+    // Pops batches of up to BatchSize events and passes each to
+    // process(const Event*, size_t) until the ring is empty or `deadline`
+    // has passed; the clock is read between batches only, so one batch may
+    // overrun it. Returns true if published events were left behind.
+    template <size_t BatchSize, typename ProcessFn>
+    bool DrainUntil(std::chrono::steady_clock::time_point deadline, ProcessFn&& process)
+    {
+        Event batch[BatchSize];
+        while (size_t count = PopBatch(batch, BatchSize))
+        {
+            process(static_cast<const Event*>(batch), count);
+            if (std::chrono::steady_clock::now() >= deadline)
+                return !IsEmpty();
+        }
+        return false;
+    }
+
+    // Consumer side. True if the next event has not been published yet (a
+    // producer may still be writing it; it signals the consumer when done).
+    bool IsEmpty() const
+    {
+        const Slot& slot = m_slots[m_dequeuePos & (Capacity - 1)];
+        return slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+    // Consumer thread only (the drained count is consumer-owned). Producer
+    // counters are relaxed snapshots, which is fine for diagnostics.
+    BgmEventRingStats GetStats() const
+    {
+        BgmEventRingStats stats;
+        stats.pushed = m_pushed.load(std::memory_order_relaxed);
+        stats.overflowed = m_overflowed.load(std::memory_order_relaxed);
+        stats.drained = m_drained;
+        return stats;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Event event;
+    };
+
+    // Keep producer- and consumer-owned indices on separate cache lines.
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) size_t m_dequeuePos = 0;
+    uint64_t m_drained = 0;
+    alignas(64) std::atomic<uint64_t> m_pushed{0};
+    std::atomic<uint64_t> m_overflowed{0};
+    Slot m_slots[Capacity];
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "BgmIndex.h"
+
+// =============================================================
+// TOAST GLYPH CACHE
+// =============================================================
+// The toast font's baked glyphs (metrics plus an alpha8 bitmap each), saved
+// after the title codepoints were rasterized once, so later launches copy
+// them into the font atlas instead of running the rasterizer. The image is a
+// header, the glyph table and the packed bitmaps, in native byte order.
+//
+// The key covers everything the bitmaps depend on: the font file's bytes, the
+// baked pixel size, the codepoint set and the rasterizer version. Any mismatch
+// rejects the image, and so do a hash over the whole image (header included)
+// and bounds checks on every glyph, like the map cache's, so a truncated or
+// corrupted file makes the caller bake as if there were no cache. File I/O
+// and atlas access are the caller's job; this only builds and validates
+// bytes. The same images carry on-demand glyphs from the rasterizer thread
+// to the render thread.
+
+constexpr uint32_t BGM_GLYPH_CACHE_MAGIC = 0x474D4742u; // "BGMG"
+constexpr uint32_t BGM_GLYPH_CACHE_VERSION = 2;
+
+struct BgmGlyphCacheKey {
+    uint64_t fontHash;         // HashBgmGlyphCacheBytes of the font file(s)
+    uint64_t codepointHash;    // HashBgmGlyphSet of the requested codepoints
+    float pixelSize;
+    uint32_t rasterizerVersion; // Bumps whenever the rasterizer's output may change
+};
+
+// One baked glyph. Offsets are in pixels from the pen position, as the atlas
+// stores them; glyphs without pixels (a space) have a 0 x 0 bitmap.
+struct BgmCachedGlyph {
+    uint32_t codepoint;
+    uint16_t width;
+    uint16_t height;
+    uint32_t pixelOffset;      // Into the bitmap section
+    float advanceX;
+    float x0, y0, x1, y1;
+};
+
+struct BgmGlyphCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t glyphRecordSize;  // Guards against a layout change without a version bump
+    uint32_t glyphCount;
+    BgmGlyphCacheKey key;
+    uint64_t pixelBytes;
+    uint64_t payloadHash;      // FNV-1a over the whole image, reading this field as 0
+};
+
+// Points into a validated image, which must outlive it.
+struct BgmGlyphCacheView {
+    const BgmCachedGlyph* glyphs = nullptr;
+    size_t glyphCount = 0;
+    const uint8_t* pixels = nullptr;
+};
+
+// Pass a previous result as `seed` to hash several buffers as one.
+inline uint64_t HashBgmGlyphCacheBytes(const void* data, size_t size, uint64_t seed = BGM_HASH_OFFSET_BASIS)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * BGM_HASH_PRIME;
+    return hash;
+}
+
+inline uint64_t HashBgmGlyphSet(const uint32_t* codepoints, size_t count)
+{
+    return HashBgmGlyphCacheBytes(codepoints, count * sizeof(uint32_t));
+}
+
+namespace BgmGlyphCacheDetail {
+
+// The header is hashed too, so a damaged count or key cannot pass as long as
+// the bytes after it are intact.
+inline uint64_t HashImage(const BgmGlyphCacheHeader& header, const uint8_t* image, size_t size)
+{
+    BgmGlyphCacheHeader unsealed = header;
+    unsealed.payloadHash = 0;
+    uint64_t hash = HashBgmGlyphCacheBytes(&unsealed, sizeof(unsealed));
+    return HashBgmGlyphCacheBytes(image + sizeof(BgmGlyphCacheHeader), size - sizeof(BgmGlyphCacheHeader), hash);
+}
+
+} // namespace BgmGlyphCacheDetail
+
+// Serializes the glyph table and the bitmaps it points into.
+inline void BuildBgmGlyphCache(const BgmGlyphCacheKey& key, const std::vector<BgmCachedGlyph>& glyphs,
+    const std::vector<uint8_t>& pixels, std::vector<uint8_t>* outImage)
+{
+    BgmGlyphCacheHeader header = {};
+    header.magic = BGM_GLYPH_CACHE_MAGIC;
+    header.version = BGM_GLYPH_CACHE_VERSION;
+    header.glyphRecordSize = (uint32_t)sizeof(BgmCachedGlyph);
+    header.glyphCount = (uint32_t)glyphs.size();
+    header.key = key;
+    header.pixelBytes = pixels.size();
+
+    std::vector<uint8_t>& image = *outImage;
+    image.assign(sizeof(BgmGlyphCacheHeader), 0);
+    const uint8_t* table = (const uint8_t*)glyphs.data();
+    image.insert(image.end(), table, table + glyphs.size() * sizeof(BgmCachedGlyph));
+    image.insert(image.end(), pixels.begin(), pixels.end());
+
+    header.payloadHash = BgmGlyphCacheDetail::HashImage(header, image.data(), image.size());
+    memcpy(image.data(), &header, sizeof(header));
+}
+
+// Validates an image against the expected key and fills *outView. Returns
+// false if it is malformed, from another version, or was baked from another
+// font, size or codepoint set.
+inline bool OpenBgmGlyphCache(const void* image, size_t size, const BgmGlyphCacheKey& key, BgmGlyphCacheView* outView)
+{
+    const uint8_t* bytes = (const uint8_t*)image;
+    if (size < sizeof(BgmGlyphCacheHeader) || ((uintptr_t)bytes & (alignof(BgmGlyphCacheHeader) - 1)) != 0)
+        return false;
+
+    BgmGlyphCacheHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    if (header.magic != BGM_GLYPH_CACHE_MAGIC || header.version != BGM_GLYPH_CACHE_VERSION ||
+        header.glyphRecordSize != sizeof(BgmCachedGlyph) ||
+        header.key.fontHash != key.fontHash || header.key.codepointHash != key.codepointHash ||
+        header.key.pixelSize != key.pixelSize || header.key.rasterizerVersion != key.rasterizerVersion)
+        return false;
+
+    size_t payload = size - sizeof(BgmGlyphCacheHeader);
+    if (header.glyphCount > payload / sizeof(BgmCachedGlyph) ||
+        header.pixelBytes != payload - header.glyphCount * sizeof(BgmCachedGlyph))
+        return false;
+    if (BgmGlyphCacheDetail::HashImage(header, bytes, size) != header.payloadHash)
+        return false;
+
+    const BgmCachedGlyph* glyphs = (const BgmCachedGlyph*)(bytes + sizeof(BgmGlyphCacheHeader));
+    for (uint32_t i = 0; i < header.glyphCount; ++i)
+    {
+        const BgmCachedGlyph& glyph = glyphs[i];
+        if (glyph.pixelOffset > header.pixelBytes ||
+            (uint64_t)glyph.width * glyph.height > header.pixelBytes - glyph.pixelOffset)
+            return false;
+    }
+
+    outView->glyphs = glyphs;
+    outView->glyphCount = header.glyphCount;
+    outView->pixels = (const uint8_t*)(glyphs + header.glyphCount);
+    return true;
+}
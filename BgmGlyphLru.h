@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================
+// ON-DEMAND GLYPH LRU
+// =============================================================
+// Tracks which on-demand glyphs (CJK and other large scripts) are resident in
+// the font atlas and how much atlas surface they take, ordered from least to
+// most recently used. The owner inserts a glyph when it lands in the atlas,
+// touches it whenever a toast needs it, and evicts from the cold end while the
+// total surface exceeds the budget, so those glyphs never outgrow one page.
+//
+// Uses are stamped with a caller-supplied, non-decreasing tick. Eviction takes
+// a "pinned" tick: entries used at or after it (the toast on screen) are never
+// victims, even if that leaves the surface over budget for a while.
+// Not thread-safe; the render thread owns it.
+
+struct BgmGlyphLruStats {
+    uint64_t hits = 0;       // Touch on a resident glyph
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+};
+
+class BgmGlyphLru {
+public:
+    explicit BgmGlyphLru(uint64_t budget = 0) : m_budget(budget) {}
+
+    void SetBudget(uint64_t budget) { m_budget = budget; }
+
+    // Marks a resident glyph as used at `tick`. False if it is not tracked.
+    bool Touch(uint32_t codepoint, uint64_t tick)
+    {
+        auto it = m_lookup.find(codepoint);
+        if (it == m_lookup.end())
+            return false;
+        Node& node = m_nodes[it->second];
+        node.tick = tick;
+        MoveToBack(it->second);
+        ++m_stats.hits;
+        return true;
+    }
+
+    // Starts tracking a glyph that now occupies `area` pixels of the atlas
+    // (re-inserting one just refreshes it).
+    void Insert(uint32_t codepoint, uint32_t area, uint64_t tick)
+    {
+        auto it = m_lookup.find(codepoint);
+        if (it != m_lookup.end())
+        {
+            Node& node = m_nodes[it->second];
+            m_area += (uint64_t)area - node.area;
+            node.area = area;
+            node.tick = tick;
+            MoveToBack(it->second);
+            return;
+        }
+
+        uint32_t index;
+        if (m_freeHead != NO_NODE)
+        {
+            index = m_freeHead;
+            m_freeHead = m_nodes[index].next;
+        }
+        else
+        {
+            index = (uint32_t)m_nodes.size();
+            m_nodes.emplace_back();
+        }
+        Node& node = m_nodes[index];
+        node.codepoint = codepoint;
+        node.area = area;
+        node.tick = tick;
+        LinkBack(index);
+        m_lookup.emplace(codepoint, index);
+        m_area += area;
+        ++m_count;
+        ++m_stats.inserts;
+    }
+
+    // Stops tracking a glyph the atlas dropped by itself (e.g. a rebuild).
+    void Remove(uint32_t codepoint)
+    {
+        auto it = m_lookup.find(codepoint);
+        if (it == m_lookup.end())
+            return;
+        Release(it->second);
+        m_lookup.erase(it);
+    }
+
+    // While over budget, pops the least recently used glyph not used since
+    // `pinnedTick` into *outCodepoint; the caller discards it from the atlas.
+    bool PopVictim(uint64_t pinnedTick, uint32_t* outCodepoint)
+    {
+        if (m_area <= m_budget || m_head == NO_NODE || m_nodes[m_head].tick >= pinnedTick)
+            return false;
+        uint32_t index = m_head;
+        *outCodepoint = m_nodes[index].codepoint;
+        m_lookup.erase(m_nodes[index].codepoint);
+        Release(index);
+        ++m_stats.evictions;
+        return true;
+    }
+
+    void Clear()
+    {
+        m_nodes.clear();
+        m_lookup.clear();
+        m_head = m_tail = m_freeHead = NO_NODE;
+        m_area = 0;
+        m_count = 0;
+    }
+
+    size_t GetCount() const { return m_count; }
+    uint64_t GetArea() const { return m_area; }
+    uint64_t GetBudget() const { return m_budget; }
+    const BgmGlyphLruStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint32_t codepoint = 0;
+        uint32_t area = 0;
+        uint64_t tick = 0;
+        uint32_t prev = NO_NODE;
+        uint32_t next = NO_NODE; // Also links the free list
+    };
+
+    void LinkBack(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        node.prev = m_tail;
+        node.next = NO_NODE;
+        if (m_tail != NO_NODE)
+            m_nodes[m_tail].next = index;
+        else
+            m_head = index;
+        m_tail = index;
+    }
+
+    void Unlink(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        if (node.prev != NO_NODE) m_nodes[node.prev].next = node.next;
+        else m_head = node.next;
+        if (node.next != NO_NODE) m_nodes[node.next].prev = node.prev;
+        else m_tail = node.prev;
+    }
+
+    void MoveToBack(uint32_t index)
+    {
+        if (index == m_tail)
+            return;
+        Unlink(index);
+        LinkBack(index);
+    }
+
+    void Release(uint32_t index)
+    {
+        Unlink(index);
+        m_area -= m_nodes[index].area;
+        --m_count;
+        m_nodes[index].next = m_freeHead;
+        m_freeHead = index;
+    }
+
+    uint64_t m_budget;
+    std::vector<Node> m_nodes;
+    std::unordered_map<uint32_t, uint32_t> m_lookup; // Codepoint -> index into m_nodes
+    uint32_t m_head = NO_NODE;                       // Least recently used
+    uint32_t m_tail = NO_NODE;
+    uint32_t m_freeHead = NO_NODE;
+    uint64_t m_area = 0;
+    size_t m_count = 0;
+    BgmGlyphLruStats m_stats;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =============================================================
+// GLYPH DISTANCE FIELDS
+// =============================================================
+// Signed distance fields for the toast font: each texel stores how far its
+// center is from the glyph outline instead of how much of it is covered, so
+// one small bitmap stays sharp at any draw size once a shader thresholds it.
+//
+// Outlines come in as contours of lines and quadratic or cubic Bezier curves
+// (TrueType and CFF fonts alike), in pixels with y pointing down, and are
+// flattened to line segments. Every texel then takes the distance to the
+// nearest segment, negated outside the glyph (nonzero winding rule). Stored
+// values are `onEdge` on the outline and change by onEdge / spread per pixel,
+// saturating `spread` pixels inside and outside. No font parser dependency;
+// separate outlines may be rendered from any number of threads at once.
+
+struct BgmSdfSegment {
+    float x0, y0, x1, y1;
+};
+
+class BgmSdfOutline {
+public:
+    void MoveTo(float x, float y)
+    {
+        Close();
+        m_x = m_startX = x;
+        m_y = m_startY = y;
+    }
+
+    void LineTo(float x, float y)
+    {
+        if (x != m_x || y != m_y)
+            m_segments.push_back({ m_x, m_y, x, y });
+        m_x = x;
+        m_y = y;
+    }
+
+    void QuadTo(float cx, float cy, float x, float y)
+    {
+        int steps = GetCurveSteps(Length(m_x, m_y, cx, cy) + Length(cx, cy, x, y));
+        float x0 = m_x, y0 = m_y;
+        for (int i = 1; i < steps; ++i)
+        {
+            float t = (float)i / steps, s = 1.0f - t;
+            LineTo(s * s * x0 + 2.0f * s * t * cx + t * t * x, s * s * y0 + 2.0f * s * t * cy + t * t * y);
+        }
+        LineTo(x, y);
+    }
+
+    void CubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y)
+    {
+        int steps = GetCurveSteps(Length(m_x, m_y, c1x, c1y) + Length(c1x, c1y, c2x, c2y) + Length(c2x, c2y, x, y));
+        float x0 = m_x, y0 = m_y;
+        for (int i = 1; i < steps; ++i)
+        {
+            float t = (float)i / steps, s = 1.0f - t;
+            float a = s * s * s, b = 3.0f * s * s * t, c = 3.0f * s * t * t, d = t * t * t;
+            LineTo(a * x0 + b * c1x + c * c2x + d * x, a * y0 + b * c1y + c * c2y + d * y);
+        }
+        LineTo(x, y);
+    }
+
+    // Joins the current contour back to its start. MoveTo closes the previous
+    // one; call this after the last.
+    void Close() { LineTo(m_startX, m_startY); }
+
+    void Clear()
+    {
+        m_segments.clear();
+        m_x = m_y = m_startX = m_startY = 0.0f;
+    }
+
+    const std::vector<BgmSdfSegment>& GetSegments() const { return m_segments; }
+
+private:
+    static float Length(float x0, float y0, float x1, float y1) { return std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0)); }
+
+    // About one segment per 2 px of control polygon: well under a texel of
+    // error at glyph sizes
+    static int GetCurveSteps(float polygonLength) { return std::clamp((int)(polygonLength * 0.5f) + 1, 1, 32); }
+
+    std::vector<BgmSdfSegment> m_segments;
+    float m_x = 0.0f, m_y = 0.0f;
+    float m_startX = 0.0f, m_startY = 0.0f;
+};
+
+// Renders the field of `outline` into a width x height alpha8 bitmap whose
+// texel (i, j) is centered on (originX + i + 0.5, originY + j + 0.5).
+inline void RenderBgmSdf(const BgmSdfOutline& outline, int width, int height, float originX, float originY,
+    float spread, uint8_t onEdge, uint8_t* out, int pitch)
+{
+    struct Crossing {
+        float x;
+        int direction;
+    };
+
+    const std::vector<BgmSdfSegment>& segments = outline.GetSegments();
+    const float valuePerPixel = onEdge / spread;
+    std::vector<const BgmSdfSegment*> nearby;
+    std::vector<Crossing> crossings;
+    nearby.reserve(segments.size());
+
+    for (int j = 0; j < height; ++j)
+    {
+        // Only segments within `spread` of the row can set a distance, and
+        // only those crossing it (half-open in y, so shared endpoints count
+        // once) change the winding number along it
+        float py = originY + j + 0.5f;
+        nearby.clear();
+        crossings.clear();
+        for (const BgmSdfSegment& segment : segments)
+        {
+            if (py < std::min(segment.y0, segment.y1) - spread || py > std::max(segment.y0, segment.y1) + spread)
+                continue;
+            nearby.push_back(&segment);
+            if ((segment.y0 <= py) != (segment.y1 <= py)) {
+                float x = segment.x0 + (py - segment.y0) * (segment.x1 - segment.x0) / (segment.y1 - segment.y0);
+                crossings.push_back({ x, segment.y1 > segment.y0 ? 1 : -1 });
+            }
+        }
+        std::sort(crossings.begin(), crossings.end(), [](const Crossing& a, const Crossing& b) { return a.x < b.x; });
+
+        // Sweep left to right; the winding number is that of the ray towards +x
+        int winding = 0;
+        for (const Crossing& crossing : crossings)
+            winding += crossing.direction;
+        size_t nextCrossing = 0;
+
+        uint8_t* row = out + (size_t)j * pitch;
+        for (int i = 0; i < width; ++i)
+        {
+            float px = originX + i + 0.5f;
+            for (; nextCrossing < crossings.size() && crossings[nextCrossing].x <= px; ++nextCrossing)
+                winding -= crossings[nextCrossing].direction;
+
+            float best = spread * spread;
+            for (const BgmSdfSegment* segment : nearby)
+            {
+                if (px < std::min(segment->x0, segment->x1) - spread || px > std::max(segment->x0, segment->x1) + spread)
+                    continue;
+                float ex = segment->x1 - segment->x0, ey = segment->y1 - segment->y0;
+                float dx = px - segment->x0, dy = py - segment->y0;
+                float t = std::clamp((dx * ex + dy * ey) / (ex * ex + ey * ey), 0.0f, 1.0f);
+                float ox = dx - t * ex, oy = dy - t * ey;
+                best = std::min(best, ox * ox + oy * oy);
+            }
+
+            float distance = std::sqrt(best);
+            float value = onEdge + (winding != 0 ? distance : -distance) * valuePerPixel;
+            row[i] = (uint8_t)std::clamp((int)std::lround(value), 0, 255);
+        }
+    }
+}
@@ -0,0 +1,492 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================
+// BGM MAP INDEX
+// =============================================================
+// Lookup structures built once from the BGM map so the CreateFile detours can
+// reject or resolve a path without touching the map itself. Everything here is
+// flat arrays with no Windows dependencies, so the same tables can be built at
+// runtime or emitted as static data by tools/BgmMapGen at build time.
+//
+// Keys are matched on their basename (the part after the last '\' or '/'),
+// with ASCII letters folded to lower case and '/' treated as '\'. Keys are
+// UTF-8; callers convert UTF-16 or ANSI paths that contain non-ASCII units to
+// UTF-8 before looking them up.
+
+constexpr uint64_t BGM_HASH_OFFSET_BASIS = 14695981039346656037ull; // FNV-1a 64
+constexpr uint64_t BGM_HASH_PRIME = 1099511628211ull;
+
+// Track IDs are indices into the loaded map; one value is reserved for "none".
+constexpr uint16_t BGM_INVALID_TRACK_ID = 0xFFFF;
+constexpr size_t BGM_MAX_TRACKS = BGM_INVALID_TRACK_ID;
+
+// Folds one code unit for comparisons: ASCII upper case to lower, '/' to '\'.
+inline uint32_t FoldPathUnit(uint32_t c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c + ('a' - 'A');
+    if (c == '/')
+        return '\\';
+    return c;
+}
+
+// FNV-1a over folded code units. Returns false (leaving *outHash unspecified)
+// if any unit is outside ASCII, in which case the caller must convert the name
+// to UTF-8 and use HashUtf8Basename instead.
+template <typename CharT>
+inline bool HashAsciiBasename(const CharT* name, size_t length, uint64_t* outHash)
+{
+    uint64_t hash = BGM_HASH_OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint32_t c = (uint32_t)(typename std::make_unsigned<CharT>::type)name[i];
+        if (c >= 0x80)
+            return false;
+        hash = (hash ^ FoldPathUnit(c)) * BGM_HASH_PRIME;
+    }
+    *outHash = hash;
+    return true;
+}
+
+// Same hash over UTF-8 bytes; non-ASCII bytes are hashed as-is. Agrees with
+// HashAsciiBasename on ASCII input.
+inline uint64_t HashUtf8Basename(const char* name, size_t length)
+{
+    uint64_t hash = BGM_HASH_OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ FoldPathUnit((uint8_t)name[i])) * BGM_HASH_PRIME;
+    return hash;
+}
+
+// The same hash over a whole key. Identifies a key across map reloads, where
+// its track ID may change; keys that fold alike hash alike.
+inline uint64_t HashBgmKey(const char* key, size_t length)
+{
+    return HashUtf8Basename(key, length);
+}
+
+// Fingerprint of a BgmMap.yaml file's bytes, ignoring '\r' so a CRLF checkout
+// still matches the tables generated from it.
+inline uint64_t HashBgmMapSource(const char* data, size_t size)
+{
+    uint64_t hash = BGM_HASH_OFFSET_BASIS;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (data[i] != '\r')
+            hash = (hash ^ (uint8_t)data[i]) * BGM_HASH_PRIME;
+    }
+    return hash;
+}
+
+// -------------------------------------------------------------
+// Basename Bloom filter
+// -------------------------------------------------------------
+// A few hundred bytes that answer "is this basename possibly a BGM key?" so
+// voice and sound-effect .ogg opens are rejected before they touch the event
+// ring. Uses k probes derived from one 64-bit hash by double hashing; the word
+// count is a power of two.
+constexpr size_t BGM_FILTER_BITS_PER_KEY = 16;
+constexpr size_t BGM_FILTER_PROBE_COUNT = 4;
+constexpr size_t BGM_FILTER_MIN_BITS = 512;
+
+inline void BuildBasenameFilter(const std::vector<uint64_t>& hashes, std::vector<uint64_t>* outWords)
+{
+    size_t bitCount = BGM_FILTER_MIN_BITS;
+    while (bitCount < hashes.size() * BGM_FILTER_BITS_PER_KEY)
+        bitCount <<= 1;
+
+    outWords->assign(bitCount / 64, 0);
+    for (uint64_t hash : hashes)
+    {
+        uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+        for (size_t i = 0; i < BGM_FILTER_PROBE_COUNT; ++i)
+        {
+            uint64_t bit = (h1 + i * h2) & (bitCount - 1);
+            (*outWords)[bit >> 6] |= 1ull << (bit & 63);
+        }
+    }
+}
+
+inline bool BasenameFilterMayContain(const uint64_t* words, size_t wordCount, uint64_t hash)
+{
+    if (wordCount == 0)
+        return false;
+
+    uint64_t bitMask = wordCount * 64 - 1;
+    uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+    for (size_t i = 0; i < BGM_FILTER_PROBE_COUNT; ++i)
+    {
+        uint64_t bit = (h1 + i * h2) & bitMask;
+        if ((words[bit >> 6] & (1ull << (bit & 63))) == 0)
+            return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+// Minimal perfect hash over basenames
+// -------------------------------------------------------------
+// Hash-and-displace: keys are grouped into buckets of ~4 by the high half of
+// their hash, then each bucket (largest first) gets the smallest seed that
+// sends all of its keys to free slots in a table of exactly N entries. A
+// lookup is one hash, two array reads and a verifying compare.
+constexpr size_t BGM_HASH_KEYS_PER_BUCKET = 4;
+constexpr uint32_t BGM_HASH_MAX_SEED = 1u << 24;
+
+inline size_t PerfectHashBucket(uint64_t hash, size_t bucketCount)
+{
+    return (size_t)((hash >> 32) % bucketCount);
+}
+
+inline size_t PerfectHashSlot(uint64_t hash, uint32_t seed, size_t slotCount)
+{
+    // splitmix64 finalizer, so every seed gives an independent placement
+    uint64_t x = hash ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return (size_t)(x % slotCount);
+}
+
+// hashes must be distinct; values[i] is stored for hashes[i]. Returns false
+// if some bucket could not be placed (not expected for distinct hashes).
+inline bool BuildPerfectHash(const std::vector<uint64_t>& hashes, const std::vector<uint16_t>& values,
+    std::vector<uint32_t>* outSeeds, std::vector<uint16_t>* outSlots)
+{
+    size_t keyCount = hashes.size();
+    outSeeds->clear();
+    outSlots->clear();
+    if (keyCount == 0)
+        return true;
+
+    size_t bucketCount = (keyCount + BGM_HASH_KEYS_PER_BUCKET - 1) / BGM_HASH_KEYS_PER_BUCKET;
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    for (uint32_t i = 0; i < keyCount; ++i)
+        buckets[PerfectHashBucket(hashes[i], bucketCount)].push_back(i);
+
+    std::vector<uint32_t> order(bucketCount);
+    for (uint32_t b = 0; b < bucketCount; ++b)
+        order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    outSeeds->assign(bucketCount, 0);
+    outSlots->assign(keyCount, BGM_INVALID_TRACK_ID);
+    std::vector<bool> taken(keyCount, false);
+    std::vector<size_t> placed;
+
+    for (uint32_t b : order)
+    {
+        const std::vector<uint32_t>& bucket = buckets[b];
+        if (bucket.empty())
+            break;
+
+        uint32_t seed = 0;
+        for (; seed < BGM_HASH_MAX_SEED; ++seed)
+        {
+            placed.clear();
+            bool fits = true;
+            for (uint32_t key : bucket)
+            {
+                size_t slot = PerfectHashSlot(hashes[key], seed, keyCount);
+                if (taken[slot] || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+                    fits = false;
+                    break;
+                }
+                placed.push_back(slot);
+            }
+            if (fits)
+                break;
+        }
+        if (seed == BGM_HASH_MAX_SEED)
+            return false;
+
+        (*outSeeds)[b] = seed;
+        for (size_t i = 0; i < bucket.size(); ++i)
+        {
+            taken[placed[i]] = true;
+            (*outSlots)[placed[i]] = values[bucket[i]];
+        }
+    }
+    return true;
+}
+
+// Returns the stored value for a hash that was in the build set, or an
+// arbitrary stored value otherwise; callers must verify the key.
+inline uint16_t PerfectHashFind(const uint32_t* seeds, size_t seedCount, const uint16_t* slots, size_t slotCount, uint64_t hash)
+{
+    if (slotCount == 0)
+        return BGM_INVALID_TRACK_ID;
+    uint32_t seed = seeds[PerfectHashBucket(hash, seedCount)];
+    return slots[PerfectHashSlot(hash, seed, slotCount)];
+}
+
+// -------------------------------------------------------------
+// Track index
+// -------------------------------------------------------------
+// Resolves a captured path to the ID of the longest map key it ends with.
+// Track IDs are the positions of the keys passed to Build().
+//
+// Keys are grouped by folded basename. The perfect hash maps a basename to
+// its group, and each group owns a trie over its keys' directory parts,
+// stored reversed, so matching walks the path backwards from the basename
+// one code unit at a time: O(L), no allocation. Keys that share a basename
+// ("bgm\a.ogg", "bgm2\a.ogg", "a.ogg") are told apart by that walk, and the
+// deepest key on the path wins. Keys that fold to the same string (differ
+// only in case or separator style) are ambiguous: the first one wins and the
+// rest are reported by GetShadowedKeys().
+
+constexpr uint32_t BGM_TRIE_NO_NODE = 0xFFFFFFFFu;
+
+// First-child / next-sibling trie node; fan-out is tiny (a handful of folders).
+struct BgmTrieNode {
+    uint32_t firstChild;
+    uint32_t nextSibling;
+    uint16_t trackId;   // Set if a key ends here, else BGM_INVALID_TRACK_ID
+    uint8_t unit;       // Folded code unit on the edge into this node
+};
+
+// Every array the index reads. Points either at the index's own storage or
+// at static data (see BgmTrackIndex::Attach).
+struct BgmTrackIndexTables {
+    const uint64_t* filterWords = nullptr;
+    size_t filterWordCount = 0;
+    const uint32_t* hashSeeds = nullptr;
+    size_t hashSeedCount = 0;
+    const uint16_t* hashSlots = nullptr;    // Basename group per slot
+    size_t hashSlotCount = 0;
+    const char* namePool = nullptr;         // Folded group basenames, back to back
+    const uint32_t* nameOffsets = nullptr;  // groupCount + 1 entries
+    const uint32_t* groupRoots = nullptr;   // Trie node of each group's bare basename
+    size_t groupCount = 0;
+    const BgmTrieNode* nodes = nullptr;
+    size_t nodeCount = 0;
+};
+
+class BgmTrackIndex {
+public:
+    BgmTrackIndex() = default;
+    BgmTrackIndex(const BgmTrackIndex&) = delete;            // m_tables points into our own vectors
+    BgmTrackIndex& operator=(const BgmTrackIndex&) = delete;
+
+    // Returns false if the perfect hash could not be built (never expected
+    // for distinct 64-bit hashes). Keys beyond BGM_MAX_TRACKS are ignored.
+    // The keys are only read during the call.
+    bool Build(const std::vector<std::string>& keys)
+    {
+        std::vector<std::string_view> views(keys.begin(), keys.end());
+        return Build(views.data(), views.size());
+    }
+
+    bool Build(const std::string_view* keys, size_t keyCount)
+    {
+        size_t count = std::min(keyCount, BGM_MAX_TRACKS);
+        m_namePool.clear();
+        m_nameOffsets.assign(1, 0);
+        m_groupRoots.clear();
+        m_nodes.clear();
+        m_shadowedKeys.clear();
+
+        std::vector<uint64_t> hashes;
+        std::vector<uint16_t> groups;
+        std::unordered_map<uint64_t, uint16_t> groupByHash;
+
+        for (size_t id = 0; id < count; ++id)
+        {
+            std::string_view key = keys[id];
+            size_t sep = key.find_last_of("\\/");
+            size_t basename = sep == std::string_view::npos ? 0 : sep + 1;
+            uint64_t hash = HashUtf8Basename(key.data() + basename, key.size() - basename);
+
+            auto found = groupByHash.find(hash);
+            uint16_t group;
+            if (found == groupByHash.end())
+            {
+                group = (uint16_t)m_groupRoots.size();
+                groupByHash.emplace(hash, group);
+                hashes.push_back(hash);
+                groups.push_back(group);
+
+                for (size_t i = basename; i < key.size(); ++i)
+                    m_namePool.push_back((char)FoldPathUnit((uint8_t)key[i]));
+                m_nameOffsets.push_back((uint32_t)m_namePool.size());
+
+                m_groupRoots.push_back(AddNode(BGM_TRIE_NO_NODE, 0));
+            }
+            else
+            {
+                group = found->second;
+            }
+
+            // Walk/extend the group's trie with the directory part, last unit first
+            uint32_t node = m_groupRoots[group];
+            for (size_t i = basename; i-- > 0;)
+                node = FindOrAddChild(node, (uint8_t)FoldPathUnit((uint8_t)key[i]));
+
+            if (m_nodes[node].trackId != BGM_INVALID_TRACK_ID)
+                m_shadowedKeys.push_back((uint16_t)id);
+            else
+                m_nodes[node].trackId = (uint16_t)id;
+        }
+
+        BuildBasenameFilter(hashes, &m_filterWords);
+        bool built = BuildPerfectHash(hashes, groups, &m_hashSeeds, &m_hashSlots);
+
+        m_tables.filterWords = m_filterWords.data();
+        m_tables.filterWordCount = m_filterWords.size();
+        m_tables.hashSeeds = m_hashSeeds.data();
+        m_tables.hashSeedCount = m_hashSeeds.size();
+        m_tables.hashSlots = m_hashSlots.data();
+        m_tables.hashSlotCount = m_hashSlots.size();
+        m_tables.namePool = m_namePool.data();
+        m_tables.nameOffsets = m_nameOffsets.data();
+        m_tables.groupRoots = m_groupRoots.data();
+        m_tables.groupCount = m_groupRoots.size();
+        m_tables.nodes = m_nodes.data();
+        m_tables.nodeCount = m_nodes.size();
+        return built;
+    }
+
+    // Uses tables that live elsewhere (e.g. generated at build time) instead
+    // of building them. They must outlive the index.
+    void Attach(const BgmTrackIndexTables& tables)
+    {
+        m_filterWords.clear();
+        m_hashSeeds.clear();
+        m_hashSlots.clear();
+        m_namePool.clear();
+        m_nameOffsets.clear();
+        m_groupRoots.clear();
+        m_nodes.clear();
+        m_shadowedKeys.clear();
+        m_tables = tables;
+    }
+
+    const BgmTrackIndexTables& GetTables() const { return m_tables; }
+
+    bool MayContain(uint64_t basenameHash) const
+    {
+        return BasenameFilterMayContain(m_tables.filterWords, m_tables.filterWordCount, basenameHash);
+    }
+
+    // path[0..length) is a full captured path whose basename starts at
+    // basenameOffset and hashes to basenameHash. CharT units above ASCII must
+    // be UTF-8 bytes.
+    template <typename CharT>
+    uint16_t Find(uint64_t basenameHash, const CharT* path, size_t length, size_t basenameOffset) const
+    {
+        uint16_t group = PerfectHashFind(m_tables.hashSeeds, m_tables.hashSeedCount,
+            m_tables.hashSlots, m_tables.hashSlotCount, basenameHash);
+        if (group == BGM_INVALID_TRACK_ID)
+            return group;
+
+        // The perfect hash answers for any input; confirm the basename
+        size_t nameStart = m_tables.nameOffsets[group];
+        size_t nameLength = m_tables.nameOffsets[group + 1] - nameStart;
+        if (nameLength != length - basenameOffset)
+            return BGM_INVALID_TRACK_ID;
+        for (size_t i = 0; i < nameLength; ++i)
+        {
+            if (FoldUnit(path[basenameOffset + i]) != (uint8_t)m_tables.namePool[nameStart + i])
+                return BGM_INVALID_TRACK_ID;
+        }
+
+        // Longest key on the path: walk backwards and remember the deepest match
+        const BgmTrieNode* nodes = m_tables.nodes;
+        uint32_t node = m_tables.groupRoots[group];
+        uint16_t best = nodes[node].trackId;
+        for (size_t i = basenameOffset; i-- > 0;)
+        {
+            uint32_t c = FoldUnit(path[i]);
+            if (c > 0xFF)
+                break;
+            node = FindChild(node, (uint8_t)c);
+            if (node == BGM_TRIE_NO_NODE)
+                break;
+            if (nodes[node].trackId != BGM_INVALID_TRACK_ID)
+                best = nodes[node].trackId;
+        }
+        return best;
+    }
+
+    // IDs of keys that fold to the same string as an earlier key and never
+    // resolve. Only known for indexes built at runtime.
+    const std::vector<uint16_t>& GetShadowedKeys() const { return m_shadowedKeys; }
+
+    size_t GetSizeInBytes() const
+    {
+        const BgmTrackIndexTables& t = m_tables;
+        return t.filterWordCount * sizeof(uint64_t) + t.hashSeedCount * sizeof(uint32_t) +
+            t.hashSlotCount * sizeof(uint16_t) + (t.groupCount ? t.nameOffsets[t.groupCount] : 0) +
+            (t.groupCount * 2 + 1) * sizeof(uint32_t) + t.nodeCount * sizeof(BgmTrieNode);
+    }
+
+private:
+    template <typename CharT>
+    static uint32_t FoldUnit(CharT c)
+    {
+        return FoldPathUnit((uint32_t)(typename std::make_unsigned<CharT>::type)c);
+    }
+
+    uint32_t FindChild(uint32_t node, uint8_t unit) const
+    {
+        const BgmTrieNode* nodes = m_tables.nodes;
+        for (uint32_t child = nodes[node].firstChild; child != BGM_TRIE_NO_NODE; child = nodes[child].nextSibling)
+        {
+            if (nodes[child].unit == unit)
+                return child;
+        }
+        return BGM_TRIE_NO_NODE;
+    }
+
+    // Build-time only: m_nodes may reallocate, so this does not use m_tables.
+    uint32_t FindOrAddChild(uint32_t node, uint8_t unit)
+    {
+        for (uint32_t child = m_nodes[node].firstChild; child != BGM_TRIE_NO_NODE; child = m_nodes[child].nextSibling)
+        {
+            if (m_nodes[child].unit == unit)
+                return child;
+        }
+
+        uint32_t child = AddNode(m_nodes[node].firstChild, unit);
+        m_nodes[node].firstChild = child;
+        return child;
+    }
+
+    // Nodes are written to BgmMapCache images byte for byte, so the padding
+    // after `unit` is zeroed too; the image is then the same on every build.
+    uint32_t AddNode(uint32_t nextSibling, uint8_t unit)
+    {
+        m_nodes.emplace_back();
+        BgmTrieNode& node = m_nodes.back();
+        memset(&node, 0, sizeof(node));
+        node.firstChild = BGM_TRIE_NO_NODE;
+        node.nextSibling = nextSibling;
+        node.trackId = BGM_INVALID_TRACK_ID;
+        node.unit = unit;
+        return (uint32_t)(m_nodes.size() - 1);
+    }
+
+    BgmTrackIndexTables m_tables;
+
+    // Storage for indexes built at runtime
+    std::vector<uint64_t> m_filterWords;
+    std::vector<uint32_t> m_hashSeeds;
+    std::vector<uint16_t> m_hashSlots;
+    std::vector<char> m_namePool;
+    std::vector<uint32_t> m_nameOffsets;
+    std::vector<uint32_t> m_groupRoots;
+    std::vector<BgmTrieNode> m_nodes;
+    std::vector<uint16_t> m_shadowedKeys;
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "BgmIndex.h"
+#include "BgmTrackStore.h"
+
+// =============================================================
+// BGM MAP BINARY CACHE
+// =============================================================
+// A versioned image of a runtime-built BgmTrackStore and BgmTrackIndex, so an
+// edited BgmMap.yaml is parsed once and later launches map the image and use
+// its tables in place. The image is a header followed by 8-byte aligned
+// sections, one per table array, in native byte order.
+//
+// The header records the HashBgmMapSource fingerprint of the YAML it was
+// built from; a stale image (the YAML changed since) is rejected. A hash
+// over the whole image and bounds checks on every cross-table reference
+// reject truncated or corrupted files, so a bad cache falls back to parsing
+// instead of crashing. File I/O is the caller's job; this only builds and
+// validates bytes.
+
+constexpr uint32_t BGM_CACHE_MAGIC = 0x434D4742u; // "BGMC"
+constexpr uint32_t BGM_CACHE_VERSION = 3;
+
+enum BgmCacheSection : uint32_t {
+    BGM_CACHE_STRING_POOL,
+    BGM_CACHE_KEY_OFFSETS,
+    BGM_CACHE_TITLE_OFFSETS,
+    BGM_CACHE_DISCS,
+    BGM_CACHE_TRACK_NUMBERS,
+    BGM_CACHE_FILTER_WORDS,
+    BGM_CACHE_HASH_SEEDS,
+    BGM_CACHE_HASH_SLOTS,
+    BGM_CACHE_NAME_POOL,
+    BGM_CACHE_NAME_OFFSETS,
+    BGM_CACHE_GROUP_ROOTS,
+    BGM_CACHE_TRIE_NODES,
+    BGM_CACHE_SECTION_COUNT
+};
+
+struct BgmCacheSectionEntry {
+    uint64_t offset;  // From the start of the image
+    uint64_t count;   // Elements, not bytes
+};
+
+struct BgmCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t trieNodeSize;   // Guards against a layout change without a version bump
+    uint32_t sectionCount;
+    uint64_t sourceHash;     // HashBgmMapSource of the YAML
+    uint64_t payloadHash;    // FNV-1a over the whole image, reading this field as 0
+    BgmCacheSectionEntry sections[BGM_CACHE_SECTION_COUNT];
+};
+
+namespace BgmMapCacheDetail {
+
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+constexpr size_t ELEMENT_SIZES[BGM_CACHE_SECTION_COUNT] = {
+    sizeof(char), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint8_t), sizeof(uint8_t),
+    sizeof(uint64_t), sizeof(uint32_t), sizeof(uint16_t), sizeof(char), sizeof(uint32_t),
+    sizeof(uint32_t), sizeof(BgmTrieNode),
+};
+
+inline uint64_t HashBytes(const uint8_t* data, size_t size, uint64_t hash = BGM_HASH_OFFSET_BASIS)
+{
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * BGM_HASH_PRIME;
+    return hash;
+}
+
+// The section table is hashed too, so a damaged offset or count cannot point
+// the tables at other bytes that happen to pass the checks below.
+inline uint64_t HashImage(const BgmCacheHeader& header, const uint8_t* image, size_t size)
+{
+    BgmCacheHeader unsealed = header;
+    unsealed.payloadHash = 0;
+    uint64_t hash = HashBytes((const uint8_t*)&unsealed, sizeof(unsealed));
+    return HashBytes(image + sizeof(BgmCacheHeader), size - sizeof(BgmCacheHeader), hash);
+}
+
+// Every offset in `offsets` must start a NUL-terminated string inside the pool.
+inline bool StringsInPool(const uint32_t* offsets, size_t count, const char* pool, size_t poolSize)
+{
+    if (count == 0)
+        return true;
+    if (poolSize == 0 || pool[poolSize - 1] != '\0')
+        return false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (offsets[i] >= poolSize)
+            return false;
+    }
+    return true;
+}
+
+} // namespace BgmMapCacheDetail
+
+// Serializes both table sets into *outImage.
+inline void BuildBgmMapCache(const BgmTrackStoreTables& store, const BgmTrackIndexTables& index,
+    uint64_t sourceHash, std::vector<uint8_t>* outImage)
+{
+    using namespace BgmMapCacheDetail;
+
+    const void* data[BGM_CACHE_SECTION_COUNT] = {
+        store.stringPool, store.keyOffsets, store.titleOffsets, store.discs, store.trackNumbers,
+        index.filterWords, index.hashSeeds, index.hashSlots, index.namePool, index.nameOffsets,
+        index.groupRoots, index.nodes,
+    };
+    const size_t counts[BGM_CACHE_SECTION_COUNT] = {
+        store.stringPoolSize, store.trackCount, store.trackCount, store.trackCount, store.trackCount,
+        index.filterWordCount, index.hashSeedCount, index.hashSlotCount,
+        index.nameOffsets ? index.nameOffsets[index.groupCount] : 0, index.nameOffsets ? index.groupCount + 1 : 0,
+        index.groupCount, index.nodeCount,
+    };
+
+    BgmCacheHeader header = {};
+    header.magic = BGM_CACHE_MAGIC;
+    header.version = BGM_CACHE_VERSION;
+    header.trieNodeSize = (uint32_t)sizeof(BgmTrieNode);
+    header.sectionCount = BGM_CACHE_SECTION_COUNT;
+    header.sourceHash = sourceHash;
+
+    std::vector<uint8_t>& image = *outImage;
+    image.assign(sizeof(BgmCacheHeader), 0);
+    for (uint32_t s = 0; s < BGM_CACHE_SECTION_COUNT; ++s)
+    {
+        image.resize((image.size() + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1), 0);
+        header.sections[s].offset = image.size();
+        header.sections[s].count = counts[s];
+        const uint8_t* bytes = (const uint8_t*)data[s];
+        if (counts[s])
+            image.insert(image.end(), bytes, bytes + counts[s] * ELEMENT_SIZES[s]);
+    }
+
+    header.payloadHash = HashImage(header, image.data(), image.size());
+    memcpy(image.data(), &header, sizeof(header));
+}
+
+// Validates an image (which must stay alive and unmodified while the tables
+// are in use) and points *outStore / *outIndex into it. Returns false if the
+// image is malformed, from another version, or built from a different YAML.
+inline bool OpenBgmMapCache(const void* image, size_t size, uint64_t sourceHash,
+    BgmTrackStoreTables* outStore, BgmTrackIndexTables* outIndex)
+{
+    using namespace BgmMapCacheDetail;
+
+    const uint8_t* bytes = (const uint8_t*)image;
+    if (size < sizeof(BgmCacheHeader) || ((uintptr_t)bytes & (SECTION_ALIGNMENT - 1)) != 0)
+        return false;
+
+    BgmCacheHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    if (header.magic != BGM_CACHE_MAGIC || header.version != BGM_CACHE_VERSION ||
+        header.trieNodeSize != sizeof(BgmTrieNode) || header.sectionCount != BGM_CACHE_SECTION_COUNT ||
+        header.sourceHash != sourceHash)
+        return false;
+
+    const void* data[BGM_CACHE_SECTION_COUNT];
+    for (uint32_t s = 0; s < BGM_CACHE_SECTION_COUNT; ++s)
+    {
+        const BgmCacheSectionEntry& section = header.sections[s];
+        if (section.offset < sizeof(BgmCacheHeader) || section.offset > size ||
+            (section.offset & (SECTION_ALIGNMENT - 1)) != 0 ||
+            section.count > (size - section.offset) / ELEMENT_SIZES[s])
+            return false;
+        data[s] = bytes + section.offset;
+    }
+    if (HashImage(header, bytes, size) != header.payloadHash)
+        return false;
+
+    auto count = [&](BgmCacheSection s) { return (size_t)header.sections[s].count; };
+
+    BgmTrackStoreTables store;
+    store.stringPool = (const char*)data[BGM_CACHE_STRING_POOL];
+    store.stringPoolSize = count(BGM_CACHE_STRING_POOL);
+    store.keyOffsets = (const uint32_t*)data[BGM_CACHE_KEY_OFFSETS];
+    store.titleOffsets = (const uint32_t*)data[BGM_CACHE_TITLE_OFFSETS];
+    store.discs = (const uint8_t*)data[BGM_CACHE_DISCS];
+    store.trackNumbers = (const uint8_t*)data[BGM_CACHE_TRACK_NUMBERS];
+    store.trackCount = count(BGM_CACHE_KEY_OFFSETS);
+
+    BgmTrackIndexTables index;
+    index.filterWords = (const uint64_t*)data[BGM_CACHE_FILTER_WORDS];
+    index.filterWordCount = count(BGM_CACHE_FILTER_WORDS);
+    index.hashSeeds = (const uint32_t*)data[BGM_CACHE_HASH_SEEDS];
+    index.hashSeedCount = count(BGM_CACHE_HASH_SEEDS);
+    index.hashSlots = (const uint16_t*)data[BGM_CACHE_HASH_SLOTS];
+    index.hashSlotCount = count(BGM_CACHE_HASH_SLOTS);
+    index.namePool = (const char*)data[BGM_CACHE_NAME_POOL];
+    index.nameOffsets = (const uint32_t*)data[BGM_CACHE_NAME_OFFSETS];
+    index.groupRoots = (const uint32_t*)data[BGM_CACHE_GROUP_ROOTS];
+    index.groupCount = count(BGM_CACHE_GROUP_ROOTS);
+    index.nodes = (const BgmTrieNode*)data[BGM_CACHE_TRIE_NODES];
+    index.nodeCount = count(BGM_CACHE_TRIE_NODES);
+
+    // Cross-table consistency: every index the lookup code follows must be in range.
+    if (store.trackCount > BGM_MAX_TRACKS ||
+        count(BGM_CACHE_TITLE_OFFSETS) != store.trackCount ||
+        count(BGM_CACHE_DISCS) != store.trackCount ||
+        count(BGM_CACHE_TRACK_NUMBERS) != store.trackCount ||
+        !StringsInPool(store.keyOffsets, store.trackCount, store.stringPool, store.stringPoolSize) ||
+        !StringsInPool(store.titleOffsets, store.trackCount, store.stringPool, store.stringPoolSize))
+        return false;
+
+    if (count(BGM_CACHE_NAME_OFFSETS) != index.groupCount + 1 || index.groupCount > BGM_MAX_TRACKS ||
+        index.hashSlotCount != index.groupCount || (index.hashSeedCount == 0) != (index.hashSlotCount == 0) ||
+        (index.filterWordCount & (index.filterWordCount - 1)) != 0 ||
+        index.nameOffsets[index.groupCount] != count(BGM_CACHE_NAME_POOL))
+        return false;
+    for (size_t g = 0; g < index.groupCount; ++g)
+    {
+        if (index.nameOffsets[g] > index.nameOffsets[g + 1] || index.groupRoots[g] >= index.nodeCount)
+            return false;
+    }
+    for (size_t i = 0; i < index.hashSlotCount; ++i)
+    {
+        if (index.hashSlots[i] >= index.groupCount)
+            return false;
+    }
+    // BgmTrackIndex::Build only appends nodes, so a first child always comes
+    // after its parent and a next sibling before its node. Requiring that also
+    // rules out cycles, which would hang the lookup.
+    for (size_t n = 0; n < index.nodeCount; ++n)
+    {
+        const BgmTrieNode& node = index.nodes[n];
+        if ((node.firstChild != BGM_TRIE_NO_NODE && (node.firstChild >= index.nodeCount || node.firstChild <= n)) ||
+            (node.nextSibling != BGM_TRIE_NO_NODE && node.nextSibling >= n) ||
+            (node.trackId != BGM_INVALID_TRACK_ID && node.trackId >= store.trackCount))
+            return false;
+    }
+
+    *outStore = store;
+    *outIndex = index;
+    return true;
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BgmTrackStore.h"
+
+// =============================================================
+// BGM MAP PARSER
+// =============================================================
+// Single-pass parser for the subset of YAML that BgmMap.yaml uses: one
+// top-level `key: value` pair per line, where the key is a plain or quoted
+// path and the value a plain, 'single' or "double" quoted "title|disc|track"
+// string, plus blank lines and # comments. Keys and titles are views into the
+// input buffer (for example a mapped file); only quoted scalars that contain
+// escapes are decoded into parser-owned storage.
+//
+// Anything outside that subset (indentation, flow or block collections,
+// anchors, tags, multi-line scalars, document markers, text that is not
+// UTF-8) is reported as Unsupported, and the caller hands the file to
+// yaml-cpp instead. Input that is broken under any YAML reading (bad escapes,
+// a line with no ':' separator, an unterminated string) is an Error with a
+// line and column.
+
+enum class BgmMapParseStatus {
+    Ok,
+    Unsupported,
+    Error,
+};
+
+struct BgmMapParsedEntry {
+    std::string_view key;
+    std::string_view title;   // See ParseBgmValue for values that are not well formed
+    uint8_t disc = 0;
+    uint8_t track = 0;
+    bool wellFormed = false;  // Value was "title|disc|track"
+    uint32_t line = 0;
+};
+
+class BgmMapParser {
+public:
+    // The buffer must outlive the entries. Entries are in file order.
+    BgmMapParseStatus Parse(const char* data, size_t size)
+    {
+        m_entries.clear();
+        m_decoded.clear();
+        m_line = m_column = 0;
+        m_message = "";
+        m_end = data + size;
+
+        const char* p = data;
+        if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+            p += 3;
+
+        for (uint32_t line = 1; p < m_end; ++line)
+        {
+            const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(m_end - p));
+            if (!lineEnd)
+                lineEnd = m_end;
+            const char* contentEnd = (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+            m_onLastLine = lineEnd + 1 >= m_end;
+
+            BgmMapParseStatus status = ParseLine(p, contentEnd, line);
+            if (status != BgmMapParseStatus::Ok)
+                return status;
+            p = lineEnd < m_end ? lineEnd + 1 : m_end;
+        }
+        return BgmMapParseStatus::Ok;
+    }
+
+    const std::vector<BgmMapParsedEntry>& GetEntries() const { return m_entries; }
+
+    // Where and why Parse stopped (1-based; the column counts UTF-8 characters).
+    uint32_t GetLine() const { return m_line; }
+    uint32_t GetColumn() const { return m_column; }
+    const char* GetMessage() const { return m_message; }
+
+private:
+    static bool IsBlank(char c) { return c == ' ' || c == '\t'; }
+
+    // Characters that cannot start a plain scalar we handle
+    static bool IsIndicator(char c) { return c != '\0' && strchr("-?:,[]{}#&*!|>'\"%@`", c) != nullptr; }
+
+    BgmMapParseStatus Fail(BgmMapParseStatus status, uint32_t line, const char* lineStart, const char* at, const char* message)
+    {
+        m_line = line;
+        m_column = 1;
+        for (const char* c = lineStart; c < at; ++c)
+        {
+            if (((uint8_t)*c & 0xC0) != 0x80)
+                ++m_column;
+        }
+        m_message = message;
+        return status;
+    }
+
+    // Returns the first byte that is not part of a valid UTF-8 sequence, or null.
+    static const char* FindInvalidUtf8(const char* p, const char* end)
+    {
+        while (p < end)
+        {
+            uint8_t c = (uint8_t)*p;
+            if (c < 0x80) {
+                ++p;
+                continue;
+            }
+            size_t length;
+            uint32_t codePoint;
+            if ((c & 0xE0) == 0xC0) { length = 2; codePoint = c & 0x1F; }
+            else if ((c & 0xF0) == 0xE0) { length = 3; codePoint = c & 0x0F; }
+            else if ((c & 0xF8) == 0xF0) { length = 4; codePoint = c & 0x07; }
+            else return p;
+            if ((size_t)(end - p) < length)
+                return p;
+            for (size_t i = 1; i < length; ++i)
+            {
+                if (((uint8_t)p[i] & 0xC0) != 0x80)
+                    return p;
+                codePoint = (codePoint << 6) | ((uint8_t)p[i] & 0x3F);
+            }
+            static const uint32_t MIN_CODE_POINT[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+            if (codePoint < MIN_CODE_POINT[length] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                return p;
+            p += length;
+        }
+        return nullptr;
+    }
+
+    static void AppendUtf8(std::string* out, uint32_t codePoint)
+    {
+        if (codePoint < 0x80) {
+            out->push_back((char)codePoint);
+        } else if (codePoint < 0x800) {
+            out->push_back((char)(0xC0 | (codePoint >> 6)));
+            out->push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out->push_back((char)(0xE0 | (codePoint >> 12)));
+            out->push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else {
+            out->push_back((char)(0xF0 | (codePoint >> 18)));
+            out->push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+            out->push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    // *p is at the opening quote; on success it is left just past the closing one.
+    BgmMapParseStatus ParseQuoted(const char** p, const char* lineStart, const char* end, uint32_t line, std::string_view* out)
+    {
+        const char quote = **p;
+        const char* start = *p + 1;
+        const char* c = start;
+        bool escaped = false;
+
+        // Fast scan: find the closing quote and whether anything needs decoding
+        for (; c < end; ++c)
+        {
+            if (quote == '"' && *c == '\\') {
+                escaped = true;
+                if (++c == end) break;
+            } else if (*c == quote) {
+                if (quote == '\'' && c + 1 < end && c[1] == '\'') {
+                    escaped = true;
+                    ++c;
+                } else {
+                    break;
+                }
+            }
+        }
+        if (c >= end)
+        {
+            // A quoted scalar may legally continue on the next line (folded)
+            if (m_onLastLine)
+                return Fail(BgmMapParseStatus::Error, line, lineStart, *p, "unterminated quoted string");
+            return Fail(BgmMapParseStatus::Unsupported, line, lineStart, *p, "multi-line quoted string");
+        }
+
+        *p = c + 1;
+        if (!escaped) {
+            *out = std::string_view(start, (size_t)(c - start));
+            return BgmMapParseStatus::Ok;
+        }
+
+        std::string& decoded = m_decoded.emplace_back();
+        for (const char* s = start; s < c; ++s)
+        {
+            if (quote == '\'') {
+                decoded.push_back(*s);
+                if (*s == '\'') ++s; // '' -> '
+                continue;
+            }
+            if (*s != '\\') {
+                decoded.push_back(*s);
+                continue;
+            }
+
+            const char* escape = s++;
+            int hexDigits = 0;
+            switch (*s)
+            {
+            case '0': decoded.push_back('\0'); break;
+            case 'a': decoded.push_back('\a'); break;
+            case 'b': decoded.push_back('\b'); break;
+            case 't': case '\t': decoded.push_back('\t'); break;
+            case 'n': decoded.push_back('\n'); break;
+            case 'v': decoded.push_back('\v'); break;
+            case 'f': decoded.push_back('\f'); break;
+            case 'r': decoded.push_back('\r'); break;
+            case 'e': decoded.push_back('\x1B'); break;
+            case ' ': case '"': case '/': case '\\': decoded.push_back(*s); break;
+            case 'N': AppendUtf8(&decoded, 0x85); break;
+            case '_': AppendUtf8(&decoded, 0xA0); break;
+            case 'L': AppendUtf8(&decoded, 0x2028); break;
+            case 'P': AppendUtf8(&decoded, 0x2029); break;
+            case 'x': hexDigits = 2; break;
+            case 'u': hexDigits = 4; break;
+            case 'U': hexDigits = 8; break;
+            default:
+                return Fail(BgmMapParseStatus::Error, line, lineStart, escape, "unknown escape sequence");
+            }
+            if (hexDigits == 0)
+                continue;
+
+            uint32_t codePoint = 0;
+            for (int i = 0; i < hexDigits; ++i)
+            {
+                char h = (s + 1 < c) ? *++s : '\0';
+                uint32_t digit;
+                if (h >= '0' && h <= '9') digit = (uint32_t)(h - '0');
+                else if (h >= 'a' && h <= 'f') digit = (uint32_t)(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') digit = (uint32_t)(h - 'A' + 10);
+                else return Fail(BgmMapParseStatus::Error, line, lineStart, escape, "malformed hexadecimal escape");
+                codePoint = (codePoint << 4) | digit;
+            }
+            if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                return Fail(BgmMapParseStatus::Error, line, lineStart, escape, "escape is not a valid Unicode code point");
+            AppendUtf8(&decoded, codePoint);
+        }
+        *out = decoded;
+        return BgmMapParseStatus::Ok;
+    }
+
+    BgmMapParseStatus ParseLine(const char* begin, const char* end, uint32_t line)
+    {
+        if (const char* bad = FindInvalidUtf8(begin, end))
+            return Fail(BgmMapParseStatus::Unsupported, line, begin, bad, "not UTF-8 (saved in another encoding?)");
+
+        const char* p = begin;
+        while (p < end && IsBlank(*p)) ++p;
+        if (p == end || *p == '#')
+            return BgmMapParseStatus::Ok;
+        if (p != begin)
+            return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "indented line (nested or multi-line value)");
+        if (*p == '%' || ((end - p >= 3) && (memcmp(p, "---", 3) == 0 || memcmp(p, "...", 3) == 0) && (end - p == 3 || IsBlank(p[3]))))
+            return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "directive or document marker");
+
+        // Key
+        BgmMapParsedEntry entry;
+        entry.line = line;
+        if (*p == '"' || *p == '\'')
+        {
+            BgmMapParseStatus status = ParseQuoted(&p, begin, end, line, &entry.key);
+            if (status != BgmMapParseStatus::Ok)
+                return status;
+            while (p < end && IsBlank(*p)) ++p;
+            if (p == end || *p != ':')
+                return Fail(BgmMapParseStatus::Error, line, begin, p, "expected ':' after the key");
+        }
+        else
+        {
+            if (IsIndicator(*p))
+                return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "key starts with a YAML indicator");
+            const char* keyStart = p;
+            for (; p < end; ++p)
+            {
+                if (*p == ':' && (p + 1 == end || IsBlank(p[1])))
+                    break;
+                if (*p == '#' && IsBlank(p[-1]))
+                    return Fail(BgmMapParseStatus::Error, line, begin, p, "expected ':' after the key");
+            }
+            if (p == end)
+                return Fail(BgmMapParseStatus::Error, line, begin, p, "expected ':' after the key");
+            const char* keyEnd = p;
+            while (keyEnd > keyStart && IsBlank(keyEnd[-1])) --keyEnd;
+            entry.key = std::string_view(keyStart, (size_t)(keyEnd - keyStart));
+        }
+        ++p; // ':'
+        if (p < end && !IsBlank(*p)) // Only reachable after a quoted key ("key":value)
+            return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "no space after ':'");
+        while (p < end && IsBlank(*p)) ++p;
+
+        // Value
+        std::string_view value;
+        if (p == end || *p == '#')
+            return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "empty value");
+        if (*p == '"' || *p == '\'')
+        {
+            BgmMapParseStatus status = ParseQuoted(&p, begin, end, line, &value);
+            if (status != BgmMapParseStatus::Ok)
+                return status;
+            const char* afterValue = p;
+            while (p < end && IsBlank(*p)) ++p;
+            if (p < end && (*p != '#' || p == afterValue))
+                return Fail(BgmMapParseStatus::Error, line, begin, p, "unexpected text after the quoted value");
+        }
+        else
+        {
+            if (IsIndicator(*p))
+                return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "value starts with a YAML indicator");
+            const char* valueStart = p;
+            for (; p < end; ++p)
+            {
+                if (*p == '#' && IsBlank(p[-1]))
+                    break;
+                if (*p == ':' && (p + 1 == end || IsBlank(p[1])))
+                    return Fail(BgmMapParseStatus::Unsupported, line, begin, p, "value looks like a nested mapping");
+            }
+            const char* valueEnd = p;
+            while (valueEnd > valueStart && IsBlank(valueEnd[-1])) --valueEnd;
+            value = std::string_view(valueStart, (size_t)(valueEnd - valueStart));
+        }
+
+        entry.wellFormed = ParseBgmValue(value, &entry.title, &entry.disc, &entry.track);
+        m_entries.push_back(entry);
+        return BgmMapParseStatus::Ok;
+    }
+
+    std::vector<BgmMapParsedEntry> m_entries;
+    std::deque<std::string> m_decoded;  // Unescaped scalars; deque keeps views stable
+    const char* m_end = nullptr;
+    bool m_onLastLine = false;
+    uint32_t m_line = 0;
+    uint32_t m_column = 0;
+    const char* m_message = "";
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BGM_CLASSIFIER_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BGM_CLASSIFIER_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The aligned block loads below may read past the terminator (never past the
+// page), which AddressSanitizer would report.
+#if defined(_MSC_VER)
+#define BGM_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#elif defined(__clang__) || defined(__GNUC__)
+#define BGM_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define BGM_NO_SANITIZE_ADDRESS
+#endif
+
+// =============================================================
+// CREATEFILE PATH CLASSIFIER
+// =============================================================
+// Single pass over a NUL-terminated UTF-8 or UTF-16 path that finds the
+// terminator, the start of the basename (after the last '\' or '/') and
+// whether the path ends in ".ogg" (ASCII case-insensitive). The detours run
+// this on every file open in the game, so it scans 16 or 32 bytes at a time
+// with SSE2/AVX2 and falls back to a scalar loop elsewhere. The width is the
+// compiler's target: the DLL uses AVX2 only when built with BGMTOAST_DLL_AVX2.
+//
+// Vector loads are aligned down to the vector width so a block never crosses
+// a page boundary past the terminator; bytes before the start of the string
+// are masked out.
+
+#if defined(BGM_CLASSIFIER_AVX2)
+constexpr const char* BGM_CLASSIFIER_NAME = "AVX2"; // For the log
+#elif defined(BGM_CLASSIFIER_SSE2)
+constexpr const char* BGM_CLASSIFIER_NAME = "SSE2";
+#else
+constexpr const char* BGM_CLASSIFIER_NAME = "scalar";
+#endif
+
+struct BgmPathInfo {
+    size_t length = 0;          // Code units before the terminator
+    size_t basenameOffset = 0;  // Index of the first code unit of the basename
+    bool isOgg = false;         // Ends in ".ogg" and has a non-empty stem
+};
+
+namespace BgmPathClassifierDetail {
+
+inline unsigned CountTrailingZeros(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+inline unsigned HighestSetBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (unsigned)index;
+#else
+    return 31u - (unsigned)__builtin_clz(mask);
+#endif
+}
+
+template <typename CharT>
+inline bool EndsWithOgg(const CharT* path, size_t length)
+{
+    // |0x20 folds ASCII upper case only; no other code unit folds onto 'o'/'g'.
+    // The stem must not be empty: "bgm\.ogg" names no track.
+    return length > 4 &&
+        path[length - 5] != (CharT)'\\' && path[length - 5] != (CharT)'/' &&
+        path[length - 4] == (CharT)'.' &&
+        (path[length - 3] | 0x20) == (CharT)'o' &&
+        (path[length - 2] | 0x20) == (CharT)'g' &&
+        (path[length - 1] | 0x20) == (CharT)'g';
+}
+
+template <typename CharT>
+inline BgmPathInfo ClassifyScalar(const CharT* path)
+{
+    BgmPathInfo info;
+    size_t i = 0;
+    for (; path[i] != 0; ++i)
+    {
+        if (path[i] == (CharT)'\\' || path[i] == (CharT)'/')
+            info.basenameOffset = i + 1;
+    }
+    info.length = i;
+    info.isOgg = EndsWithOgg(path, i);
+    return info;
+}
+
+// Shared block loop. `scan(block, &zeroMask, &sepMask)` fills byte-position
+// masks for one aligned block of BlockBytes (see the Scan* functions below).
+// For 16-bit units only the bit of each unit's first byte is kept, so every
+// set bit marks the start of a unit.
+template <typename CharT, size_t BlockBytes>
+inline BgmPathInfo ClassifyBlocks(const CharT* path, void (*scan)(const uint8_t*, uint32_t*, uint32_t*))
+{
+    constexpr size_t UnitBytes = sizeof(CharT);
+    const uint8_t* start = (const uint8_t*)path;
+    const uint8_t* block = (const uint8_t*)((uintptr_t)start & ~(uintptr_t)(BlockBytes - 1));
+    unsigned lead = (unsigned)(start - block);
+
+    const uint8_t* lastSep = nullptr;
+    uint32_t validMask = ~0u << lead;
+
+    for (;; block += BlockBytes, validMask = ~0u)
+    {
+        uint32_t zeroMask, sepMask;
+        scan(block, &zeroMask, &sepMask);
+        zeroMask &= validMask;
+        sepMask &= validMask;
+
+        if (zeroMask)
+        {
+            unsigned term = CountTrailingZeros(zeroMask);
+            sepMask &= (term == 0) ? 0u : (~0u >> (32 - term));
+            if (sepMask)
+                lastSep = block + HighestSetBit(sepMask);
+
+            BgmPathInfo info;
+            info.length = (size_t)(block + term - start) / UnitBytes;
+            info.basenameOffset = lastSep ? (size_t)(lastSep - start) / UnitBytes + 1 : 0;
+            info.isOgg = EndsWithOgg(path, info.length);
+            return info;
+        }
+        if (sepMask)
+            lastSep = block + HighestSetBit(sepMask);
+    }
+}
+
+#if defined(BGM_CLASSIFIER_AVX2)
+BGM_NO_SANITIZE_ADDRESS inline void ScanBytes32(const uint8_t* block, uint32_t* zeroMask, uint32_t* sepMask)
+{
+    __m256i v = _mm256_load_si256((const __m256i*)block);
+    *zeroMask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    *sepMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))));
+}
+
+BGM_NO_SANITIZE_ADDRESS inline void ScanUnits32(const uint8_t* block, uint32_t* zeroMask, uint32_t* sepMask)
+{
+    __m256i v = _mm256_load_si256((const __m256i*)block);
+    *zeroMask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, _mm256_setzero_si256())) & 0x55555555u;
+    *sepMask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi16(v, _mm256_set1_epi16('\\')),
+        _mm256_cmpeq_epi16(v, _mm256_set1_epi16('/')))) & 0x55555555u;
+}
+#elif defined(BGM_CLASSIFIER_SSE2)
+BGM_NO_SANITIZE_ADDRESS inline void ScanBytes16(const uint8_t* block, uint32_t* zeroMask, uint32_t* sepMask)
+{
+    __m128i v = _mm_load_si128((const __m128i*)block);
+    *zeroMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    *sepMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('/'))));
+}
+
+BGM_NO_SANITIZE_ADDRESS inline void ScanUnits16(const uint8_t* block, uint32_t* zeroMask, uint32_t* sepMask)
+{
+    __m128i v = _mm_load_si128((const __m128i*)block);
+    *zeroMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128())) & 0x5555u;
+    *sepMask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi16(v, _mm_set1_epi16('\\')),
+        _mm_cmpeq_epi16(v, _mm_set1_epi16('/')))) & 0x5555u;
+}
+#endif
+
+} // namespace BgmPathClassifierDetail
+
+// UTF-8 / ANSI paths (Detour_CreateFileA)
+inline BgmPathInfo ClassifyPath(const char* path)
+{
+    using namespace BgmPathClassifierDetail;
+#if defined(BGM_CLASSIFIER_AVX2)
+    return ClassifyBlocks<char, 32>(path, ScanBytes32);
+#elif defined(BGM_CLASSIFIER_SSE2)
+    return ClassifyBlocks<char, 16>(path, ScanBytes16);
+#else
+    return ClassifyScalar(path);
+#endif
+}
+
+// UTF-16 paths (Detour_CreateFileW; WCHAR is 16-bit on Windows)
+inline BgmPathInfo ClassifyPath(const char16_t* path)
+{
+    using namespace BgmPathClassifierDetail;
+    // The block loop needs unit-aligned input; Win32 strings always are.
+    if ((uintptr_t)path & 1)
+        return ClassifyScalar(path);
+#if defined(BGM_CLASSIFIER_AVX2)
+    return ClassifyBlocks<char16_t, 32>(path, ScanUnits32);
+#elif defined(BGM_CLASSIFIER_SSE2)
+    return ClassifyBlocks<char16_t, 16>(path, ScanUnits16);
+#else
+    return ClassifyScalar(path);
+#endif
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BgmIndex.h"
+#include "BgmToastState.h"
+#include "BgmTrackStore.h"
+
+// =============================================================
+// BGM MAP SNAPSHOTS
+// =============================================================
+// The loaded map (records + index) is immutable once published. Reloading
+// BgmMap.yaml builds a complete new snapshot off to the side and swaps one
+// pointer, so the detours, the worker and the renderer never take a lock and
+// never see a half-built map.
+//
+// Reclamation is a minimal two-phase RCU: a reader bumps the counter of the
+// current phase, then loads the pointer; the single writer swaps the pointer,
+// flips the phase and waits for the old phase's counter to drain, twice, after
+// which no reader can still hold the old snapshot. Read sections are short
+// (one path lookup, one drained batch, one frame), so the writer's wait is too.
+
+struct BgmMapSnapshot {
+    BgmTrackStore store;
+    BgmTrackIndex index;
+    std::shared_ptr<const void> backing;  // Keeps attached tables alive (e.g. a mapped cache file)
+    uint64_t sourceHash = 0;              // HashBgmMapSource of the YAML, 0 if none
+    uint32_t generation = 0;              // Increases with every published snapshot
+    std::vector<uint32_t> codepoints;     // CollectBgmTitleCodepoints; prewarmed into the toast font
+};
+
+template <typename T>
+class BgmRcuPointer {
+public:
+    BgmRcuPointer() = default;
+    BgmRcuPointer(const BgmRcuPointer&) = delete;
+    BgmRcuPointer& operator=(const BgmRcuPointer&) = delete;
+
+    // Pins the current value for the guard's lifetime. Lock-free, any thread,
+    // and may nest. Get() is null until the first Exchange.
+    class ReadGuard {
+    public:
+        explicit ReadGuard(BgmRcuPointer& rcu)
+            : m_counter(&rcu.m_readers[rcu.m_phase.load(std::memory_order_seq_cst) & 1].count)
+        {
+            m_counter->fetch_add(1, std::memory_order_seq_cst);
+            m_value = rcu.m_current.load(std::memory_order_seq_cst);
+        }
+        ~ReadGuard() { m_counter->fetch_sub(1, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T* Get() const { return m_value; }
+        const T* operator->() const { return m_value; }
+        const T& operator*() const { return *m_value; }
+        explicit operator bool() const { return m_value != nullptr; }
+
+    private:
+        std::atomic<uint32_t>* m_counter;
+        const T* m_value;
+    };
+
+    // Writer side (one thread at a time). Publishes `next` and returns the
+    // previous value, which readers may still hold until Synchronize().
+    T* Exchange(T* next)
+    {
+        return m_current.exchange(next, std::memory_order_seq_cst);
+    }
+
+    // Writer side. Returns once every read section that could have seen a
+    // value replaced before this call has ended.
+    void Synchronize()
+    {
+        for (int flip = 0; flip < 2; ++flip)
+        {
+            uint32_t phase = m_phase.load(std::memory_order_relaxed);
+            m_phase.store(phase ^ 1, std::memory_order_seq_cst);
+            while (m_readers[phase & 1].count.load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+        }
+    }
+
+    // Exchange + Synchronize + delete the old value.
+    void Publish(T* next)
+    {
+        T* previous = Exchange(next);
+        Synchronize();
+        delete previous;
+    }
+
+private:
+    struct alignas(64) ReaderCount {
+        std::atomic<uint32_t> count{0};
+    };
+
+    std::atomic<T*> m_current{nullptr};
+    std::atomic<uint32_t> m_phase{0};
+    ReaderCount m_readers[2];
+};
+
+// -------------------------------------------------------------
+// Tracks across snapshots
+// -------------------------------------------------------------
+// Toasts name a track as (snapshot generation << 16) | track ID, so an ID is
+// never read against a snapshot it does not belong to.
+
+inline uint32_t MakeBgmSnapshotTrack(const BgmMapSnapshot& snapshot, uint16_t trackId)
+{
+    return ((snapshot.generation & 0xFFFF) << 16) | trackId;
+}
+
+// The track ID `track` names in `snapshot`, or BGM_INVALID_TRACK_ID if it
+// belongs to another snapshot (or none) or names no track.
+inline uint16_t GetBgmSnapshotTrackId(const BgmMapSnapshot* snapshot, uint32_t track)
+{
+    uint16_t trackId = (uint16_t)(track & 0xFFFF);
+    if (!snapshot || (track >> 16) != (snapshot->generation & 0xFFFF) || trackId >= snapshot->store.GetCount())
+        return BGM_INVALID_TRACK_ID;
+    return trackId;
+}
+
+// Points every state made against an older snapshot at the track with the
+// same key (by keyHash) in `snapshot`, or at BGM_INVALID_TRACK_ID in it if
+// the key is gone. States of `snapshot` itself are left alone. Scans the
+// store once, and only if some state is stale. Returns how many states now
+// name no track.
+inline size_t RemapBgmToastStates(const BgmMapSnapshot& snapshot, BgmToastState* const* states, size_t count)
+{
+    const uint32_t unresolved = MakeBgmSnapshotTrack(snapshot, BGM_INVALID_TRACK_ID);
+    size_t stale = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((states[i]->track >> 16) != (snapshot.generation & 0xFFFF)) {
+            states[i]->track = unresolved;
+            ++stale;
+        }
+    }
+    if (stale == 0)
+        return 0;
+
+    // Keys that fold alike resolve to the first, as in BgmTrackIndex
+    size_t remaining = stale;
+    for (size_t id = 0; id < snapshot.store.GetCount() && remaining; ++id)
+    {
+        const char* key = snapshot.store.GetKey((uint16_t)id);
+        uint64_t keyHash = HashBgmKey(key, strlen(key));
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (states[i]->track == unresolved && states[i]->keyHash == keyHash) {
+                states[i]->track = MakeBgmSnapshotTrack(snapshot, (uint16_t)id);
+                --remaining;
+            }
+        }
+    }
+
+    size_t invalid = 0;
+    for (size_t i = 0; i < count; ++i)
+        invalid += GetBgmSnapshotTrackId(&snapshot, states[i]->track) == BGM_INVALID_TRACK_ID;
+    return invalid;
+}
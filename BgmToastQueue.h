@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// =============================================================
+// TOAST QUEUE
+// =============================================================
+// Decides which toast is on screen when track changes arrive faster than a
+// toast can slide in, stay and slide out. One entry is "visible"; up to
+// CAPACITY more wait behind it in a fixed ring. The owner (the render thread)
+// pushes requests, calls ShowNext when nothing is visible and Hide once the
+// visible toast has fully slid out, so the queue advances at the pace of the
+// existing animation. Every operation is O(1) and nothing allocates.
+//
+// Policies for a request that arrives while a toast is visible or queued:
+//   Replace  - drop everything pending and cut the visible toast short.
+//   Enqueue  - wait in line; when full, the oldest pending entry is dropped.
+//   Coalesce - if the newest toast (pending, else visible) was requested less
+//              than the window ago, overwrite it in place (battle start then
+//              battle end shows only the latter); otherwise enqueue.
+//
+// Time is whatever monotonic seconds the caller passes in, so the queue is
+// deterministic and has no platform dependencies.
+
+enum class BgmToastPolicy : uint8_t {
+    Replace,
+    Enqueue,
+    Coalesce,
+};
+
+enum class BgmToastPushResult : uint8_t {
+    Queued,            // Waits for ShowNext
+    CoalescedPending,  // Overwrote a queued entry
+    CoalescedVisible,  // Overwrote the visible entry; the caller keeps animating it
+    PreemptVisible,    // Replace: the caller should start hiding the visible toast
+};
+
+struct BgmToastQueueStats {
+    uint64_t pushed = 0;
+    uint64_t coalesced = 0;
+    uint64_t dropped = 0;    // Enqueue on a full ring, cleared by Replace, or RemovePendingIf
+};
+
+template <typename T, size_t CAPACITY>
+class BgmToastQueue {
+    static_assert(CAPACITY > 0, "BgmToastQueue needs at least one pending slot");
+
+public:
+    explicit BgmToastQueue(BgmToastPolicy policy = BgmToastPolicy::Enqueue, double coalesceWindow = 0.0)
+        : m_policy(policy), m_coalesceWindow(coalesceWindow)
+    {
+    }
+
+    void Configure(BgmToastPolicy policy, double coalesceWindow)
+    {
+        m_policy = policy;
+        m_coalesceWindow = coalesceWindow;
+    }
+
+    BgmToastPushResult Push(const T& value, double now)
+    {
+        ++m_stats.pushed;
+
+        if (m_policy == BgmToastPolicy::Coalesce)
+        {
+            Entry* newest = m_pendingCount ? &m_pending[Slot(m_pendingCount - 1)] : (m_hasVisible ? &m_visible : nullptr);
+            if (newest && now - newest->requestedAt < m_coalesceWindow)
+            {
+                // requestedAt stays put, so a flapping track cannot extend the window forever
+                newest->value = value;
+                ++m_stats.coalesced;
+                return newest == &m_visible ? BgmToastPushResult::CoalescedVisible : BgmToastPushResult::CoalescedPending;
+            }
+        }
+
+        bool preempt = false;
+        if (m_policy == BgmToastPolicy::Replace)
+        {
+            m_stats.dropped += m_pendingCount;
+            m_head = 0;
+            m_pendingCount = 0;
+            preempt = m_hasVisible;
+        }
+        else if (m_pendingCount == CAPACITY)
+        {
+            m_head = Slot(1);
+            --m_pendingCount;
+            ++m_stats.dropped;
+        }
+
+        Entry& slot = m_pending[Slot(m_pendingCount)];
+        slot.value = value;
+        slot.requestedAt = now;
+        ++m_pendingCount;
+        return preempt ? BgmToastPushResult::PreemptVisible : BgmToastPushResult::Queued;
+    }
+
+    // Promotes the oldest pending entry if nothing is visible. Returns false
+    // if a toast is already visible or nothing is waiting.
+    bool ShowNext(double now)
+    {
+        if (m_hasVisible || m_pendingCount == 0)
+            return false;
+        m_visible = m_pending[m_head];
+        m_visible.requestedAt = now; // Coalescing into it counts from when it appeared
+        m_head = Slot(1);
+        --m_pendingCount;
+        m_hasVisible = true;
+        return true;
+    }
+
+    // The visible toast has finished its slide-out.
+    void Hide() { m_hasVisible = false; }
+
+    // Drops every pending entry for which remove(value) is true, keeping the
+    // order of the rest. Returns how many were dropped.
+    template <typename Remove>
+    size_t RemovePendingIf(Remove&& remove)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < m_pendingCount; ++i)
+        {
+            if (remove(static_cast<const T&>(m_pending[Slot(i)].value)))
+                continue;
+            if (kept != i)
+                m_pending[Slot(kept)] = m_pending[Slot(i)];
+            ++kept;
+        }
+        size_t removed = m_pendingCount - kept;
+        m_pendingCount = kept;
+        m_stats.dropped += removed;
+        return removed;
+    }
+
+    void Clear()
+    {
+        m_head = 0;
+        m_pendingCount = 0;
+        m_hasVisible = false;
+    }
+
+    bool HasVisible() const { return m_hasVisible; }
+    const T& GetVisible() const { return m_visible.value; }
+    T& GetVisible() { return m_visible.value; }
+    size_t GetPendingCount() const { return m_pendingCount; }
+    // Pending entry `i` in show order (0 is what ShowNext promotes); i < GetPendingCount().
+    const T& GetPending(size_t i) const { return m_pending[Slot(i)].value; }
+    T& GetPending(size_t i) { return m_pending[Slot(i)].value; }
+    const BgmToastQueueStats& GetStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        T value{};
+        double requestedAt = 0.0;
+    };
+
+    size_t Slot(size_t offset) const { return (m_head + offset) % CAPACITY; }
+
+    BgmToastPolicy m_policy;
+    double m_coalesceWindow;
+
+    Entry m_visible;
+    bool m_hasVisible = false;
+    Entry m_pending[CAPACITY];
+    size_t m_head = 0;
+    size_t m_pendingCount = 0;
+    BgmToastQueueStats m_stats;
+};
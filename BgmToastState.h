@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "BgmIndex.h"
+
+// =============================================================
+// TOAST STATE PUBLICATION
+// =============================================================
+// What the toast should show is decided where events are drained (the
+// worker, or Present in inline mode) and on map reloads, and read by the
+// render thread every frame. It travels through a seqlock: a writer makes the
+// sequence odd, stores the value, and makes it even again; a reader copies the
+// value between two loads of the sequence and retries if they differ or are
+// odd. Readers never block writers and never allocate.
+//
+// The value is stored as atomic words (copied in and out with memcpy), so
+// there is no data race for the compiler or TSan to object to: a reader that
+// sees any word of a write also sees the odd sequence that preceded it.
+// Acquire loads and release stores are plain moves on x86. Writers are rare
+// and serialize on the sequence itself.
+
+template <typename T>
+class BgmSeqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "BgmSeqlock values are copied bytewise");
+
+public:
+    BgmSeqlock() { Store(T()); }
+    explicit BgmSeqlock(const T& value) { Store(value); }
+    BgmSeqlock(const BgmSeqlock&) = delete;
+    BgmSeqlock& operator=(const BgmSeqlock&) = delete;
+
+    // Any thread, lock-free. Retries only while a write is in progress.
+    T Load() const
+    {
+        uint64_t words[WORD_COUNT];
+        for (;;)
+        {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < WORD_COUNT; ++i)
+                words[i] = m_words[i].load(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Read-modify-write under the writer lock; `modify` gets the current
+    // value and edits it in place. Keep it short, readers spin meanwhile.
+    template <typename Modify>
+    void Update(Modify&& modify)
+    {
+        uint32_t sequence = LockWriter();
+
+        uint64_t words[WORD_COUNT];
+        for (size_t i = 0; i < WORD_COUNT; ++i)
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        T value;
+        memcpy(&value, words, sizeof(T));
+
+        modify(value);
+
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORD_COUNT; ++i)
+            m_words[i].store(words[i], std::memory_order_release);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void Store(const T& value)
+    {
+        Update([&](T& current) { current = value; });
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Makes the sequence odd and returns its previous (even) value.
+    uint32_t LockWriter()
+    {
+        for (;;)
+        {
+            uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            if (!(sequence & 1) &&
+                m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire))
+                return sequence;
+            std::this_thread::yield();
+        }
+    }
+
+    std::atomic<uint32_t> m_sequence{0};
+    std::atomic<uint64_t> m_words[WORD_COUNT] = {};
+};
+
+// The published half of the toast. The render thread owns the animation
+// (timer and slide position) and restarts it whenever `serial` changes.
+struct BgmToastState {
+    uint32_t track = BGM_INVALID_TRACK_ID; // (snapshot generation << 16) | track ID
+    uint32_t serial = 0;                   // Bumped each time a toast should be shown
+    uint64_t keyHash = 0;                  // HashBgmKey of the track's key, to find it after a reload
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BgmIndex.h"
+
+// =============================================================
+// BGM TRACK STORE
+// =============================================================
+// The BGM map's records as one contiguous structure of arrays, indexed by
+// track ID (the same IDs BgmTrackIndex resolves to). Keys and titles live
+// back to back in a single NUL-terminated string pool and records refer to
+// them by offset; disc and track numbers are one byte each. Equal titles are
+// stored once, so within one store a title's offset also identifies the song.
+//
+// Nothing here owns per-record heap memory: the store is either built at
+// runtime into four vectors or attached to static tables emitted by
+// tools/BgmMapGen, and every accessor returns a view into those arrays.
+
+// Parses "title|disc|track". Returns false if the value is not exactly that
+// form with disc and track in 1-255 (tools/BgmMapGen rejects such values);
+// outputs are set either way. Like the original split, a value with two '|'
+// is cut at the first two, and a disc or track part that is not a number is
+// dropped (left 0). With fewer than two '|', or nothing before the first, the
+// whole value is the title. outTitle is a view into value.
+inline bool ParseBgmValue(std::string_view value, std::string_view* outTitle, uint8_t* outDisc, uint8_t* outTrack)
+{
+    *outTitle = value;
+    *outDisc = 0;
+    *outTrack = 0;
+
+    size_t pos1 = value.find('|');
+    size_t pos2 = pos1 == std::string_view::npos ? std::string_view::npos : value.find('|', pos1 + 1);
+    if (pos2 == std::string_view::npos || pos1 == 0)
+        return false;
+
+    // Blanks around a number are tolerated here, but make the value malformed
+    auto parseNumber = [](std::string_view text, uint8_t* out, bool* exact) {
+        size_t first = text.find_first_not_of(" \t");
+        size_t last = text.find_last_not_of(" \t");
+        if (first == std::string_view::npos) {
+            *exact = false;
+            return;
+        }
+        if (first != 0 || last != text.size() - 1)
+            *exact = false;
+        text = text.substr(first, last - first + 1);
+        unsigned number = 0;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9' || number > 255) {
+                *exact = false;
+                return;
+            }
+            number = number * 10 + (unsigned)(c - '0');
+        }
+        if (number == 0 || number > 255) {
+            *exact = false;
+            return;
+        }
+        *out = (uint8_t)number;
+    };
+
+    bool exact = true;
+    *outTitle = value.substr(0, pos1);
+    parseNumber(value.substr(pos1 + 1, pos2 - pos1 - 1), outDisc, &exact);
+    parseNumber(value.substr(pos2 + 1), outTrack, &exact);
+    return exact;
+}
+
+inline bool ParseBgmValue(const std::string& value, std::string* outTitle, uint8_t* outDisc, uint8_t* outTrack)
+{
+    std::string_view title;
+    bool parsed = ParseBgmValue(std::string_view(value), &title, outDisc, outTrack);
+    outTitle->assign(title.data(), title.size());
+    return parsed;
+}
+
+// Plain FNV-1a over a title's bytes. Stable across reloads, unlike offsets.
+inline uint64_t HashBgmTitle(const char* title, size_t length)
+{
+    uint64_t hash = BGM_HASH_OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ (uint8_t)title[i]) * BGM_HASH_PRIME;
+    return hash;
+}
+
+// Decodes one UTF-8 sequence at text (NUL-terminated) and returns its length.
+// Malformed, overlong or surrogate sequences decode as one byte of U+FFFD,
+// which is what ImGui draws for them.
+inline size_t DecodeBgmUtf8(const char* text, uint32_t* outCodepoint)
+{
+    const uint8_t* s = (const uint8_t*)text;
+    *outCodepoint = 0xFFFD;
+    if (s[0] < 0x80) { *outCodepoint = s[0]; return 1; }
+
+    size_t length = (s[0] & 0xE0) == 0xC0 ? 2 : (s[0] & 0xF0) == 0xE0 ? 3 : (s[0] & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 0)
+        return 1;
+    uint32_t codepoint = s[0] & (0x7F >> length);
+    for (size_t i = 1; i < length; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+            return 1;
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+    static const uint32_t MIN_FOR_LENGTH[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (codepoint < MIN_FOR_LENGTH[length] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        return 1;
+    *outCodepoint = codepoint;
+    return length;
+}
+
+// Every array the store reads. Points either at the store's own vectors or
+// at static data (see BgmTrackStore::Attach).
+struct BgmTrackStoreTables {
+    const char* stringPool = nullptr;       // NUL-terminated keys and titles
+    size_t stringPoolSize = 0;
+    const uint32_t* keyOffsets = nullptr;   // Per track
+    const uint32_t* titleOffsets = nullptr; // Per track; shared by equal titles
+    const uint8_t* discs = nullptr;         // Per track; 0 = none
+    const uint8_t* trackNumbers = nullptr;  // Per track; 0 = none
+    size_t trackCount = 0;
+};
+
+class BgmTrackStore {
+public:
+    BgmTrackStore() = default;
+    BgmTrackStore(const BgmTrackStore&) = delete;            // m_tables points into our own vectors
+    BgmTrackStore& operator=(const BgmTrackStore&) = delete;
+
+    void Clear()
+    {
+        m_stringPool.clear();
+        m_keyOffsets.clear();
+        m_titleOffsets.clear();
+        m_discs.clear();
+        m_trackNumbers.clear();
+        m_titleLookup.clear();
+        m_tables = BgmTrackStoreTables();
+    }
+
+    // Appends a record and returns its track ID, or BGM_INVALID_TRACK_ID if
+    // the store already holds BGM_MAX_TRACKS records. Detaches static tables.
+    // The strings are copied into the pool, so they may be views into a
+    // buffer that goes away afterwards (a parsed file).
+    uint16_t Add(std::string_view key, std::string_view title, uint8_t disc, uint8_t trackNumber)
+    {
+        if (m_tables.stringPool && m_tables.stringPool != m_stringPool.data())
+            Clear();
+        if (m_keyOffsets.size() >= BGM_MAX_TRACKS)
+            return BGM_INVALID_TRACK_ID;
+
+        m_keyOffsets.push_back(AppendString(key));
+
+        // Intern by hash; on the (unlikely) collision of two different titles
+        // the newer one simply gets its own copy.
+        uint64_t hash = HashBgmTitle(title.data(), title.size());
+        auto it = m_titleLookup.find(hash);
+        if (it == m_titleLookup.end() || title != std::string_view(&m_stringPool[it->second]))
+            it = m_titleLookup.insert_or_assign(hash, AppendString(title)).first;
+        m_titleOffsets.push_back(it->second);
+
+        m_discs.push_back(disc);
+        m_trackNumbers.push_back(trackNumber);
+        UpdateTables();
+        return (uint16_t)(m_keyOffsets.size() - 1);
+    }
+
+    // Uses static tables in place (e.g. from BgmMapBuiltin.h); nothing is copied.
+    void Attach(const BgmTrackStoreTables& tables)
+    {
+        Clear();
+        m_tables = tables;
+    }
+
+    const BgmTrackStoreTables& GetTables() const { return m_tables; }
+    size_t GetCount() const { return m_tables.trackCount; }
+
+    // Accessors take an ID below GetCount() and return views into the pool.
+    const char* GetKey(uint16_t id) const { return m_tables.stringPool + m_tables.keyOffsets[id]; }
+    const char* GetTitle(uint16_t id) const { return m_tables.stringPool + m_tables.titleOffsets[id]; }
+    uint32_t GetTitleOffset(uint16_t id) const { return m_tables.titleOffsets[id]; }
+    uint8_t GetDisc(uint16_t id) const { return m_tables.discs[id]; }
+    uint8_t GetTrackNumber(uint16_t id) const { return m_tables.trackNumbers[id]; }
+
+    size_t GetSizeInBytes() const
+    {
+        return m_tables.stringPoolSize + m_tables.trackCount * (sizeof(uint32_t) * 2 + sizeof(uint8_t) * 2);
+    }
+
+private:
+    uint32_t AppendString(std::string_view text)
+    {
+        uint32_t offset = (uint32_t)m_stringPool.size();
+        m_stringPool.insert(m_stringPool.end(), text.begin(), text.end());
+        m_stringPool.push_back('\0');
+        return offset;
+    }
+
+    void UpdateTables()
+    {
+        m_tables.stringPool = m_stringPool.data();
+        m_tables.stringPoolSize = m_stringPool.size();
+        m_tables.keyOffsets = m_keyOffsets.data();
+        m_tables.titleOffsets = m_titleOffsets.data();
+        m_tables.discs = m_discs.data();
+        m_tables.trackNumbers = m_trackNumbers.data();
+        m_tables.trackCount = m_keyOffsets.size();
+    }
+
+    BgmTrackStoreTables m_tables;
+
+    // Storage for stores built at runtime
+    std::vector<char> m_stringPool;
+    std::vector<uint32_t> m_keyOffsets;
+    std::vector<uint32_t> m_titleOffsets;
+    std::vector<uint8_t> m_discs;
+    std::vector<uint8_t> m_trackNumbers;
+    std::unordered_map<uint64_t, uint32_t> m_titleLookup; // Title hash -> offset, runtime builds only
+};
+
+// The distinct codepoints of every title plus extraText, sorted: the glyphs
+// the toast needs in order to draw any track of this store.
+inline std::vector<uint32_t> CollectBgmTitleCodepoints(const BgmTrackStore& store, const char* extraText)
+{
+    std::vector<uint32_t> codepoints;
+    auto collect = [&](const char* text) {
+        while (*text)
+        {
+            uint32_t codepoint;
+            text += DecodeBgmUtf8(text, &codepoint);
+            codepoints.push_back(codepoint);
+        }
+    };
+
+    collect(extraText);
+    uint32_t lastTitleOffset = UINT32_MAX;
+    for (size_t id = 0; id < store.GetCount(); ++id)
+    {
+        // Interned titles repeat their offset; skip the common back-to-back case
+        uint32_t titleOffset = store.GetTitleOffset((uint16_t)id);
+        if (titleOffset != lastTitleOffset)
+            collect(store.GetTitle((uint16_t)id));
+        lastTitleOffset = titleOffset;
+    }
+
+    std::sort(codepoints.begin(), codepoints.end());
+    codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
+    return codepoints;
+}
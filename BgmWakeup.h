@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+// =============================================================
+// CONSUMER WAKEUP
+// =============================================================
+// Lets the single consumer of a BgmEventRing block while the ring is empty
+// without putting a syscall on every push. The consumer announces that it is
+// about to sleep, fences, and re-checks the ring; a producer fences after its
+// push and only signals while the announcement is up. With both fences
+// seq_cst, either the consumer sees the new event or the producer sees the
+// flag, so no wakeup is lost and an awake consumer is never signalled.
+//
+// Event is an auto-reset event: Set() releases one Wait(), or the next one
+// if nobody is waiting. BgmAutoResetEvent is the portable one; the DLL uses a
+// Win32 event with the same two members.
+
+class BgmAutoResetEvent {
+public:
+    void Set()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_signaled = true;
+        }
+        m_condition.notify_one();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_signaled; });
+        m_signaled = false;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_signaled = false;
+};
+
+template <typename Event>
+class BgmWakeup {
+public:
+    Event& GetEvent() { return m_event; }
+
+    // Producers, after a successful push.
+    void Notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed))
+            m_event.Set();
+    }
+
+    // Consumer, once it has drained everything. Blocks unless isIdle() turns
+    // false after the sleep is announced (a push raced with the drain, or the
+    // consumer is being stopped). Returns true if it blocked.
+    template <typename IsIdle>
+    bool Wait(IsIdle&& isIdle)
+    {
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool blocked = isIdle();
+        if (blocked)
+            m_event.Wait();
+        m_sleeping.store(false, std::memory_order_relaxed);
+        return blocked;
+    }
+
+private:
+    Event m_event;
+    std::atomic<bool> m_sleeping{false};
+};
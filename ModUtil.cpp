@@ -0,0 +1,71 @@
+#define NOMINMAX
+#include <windows.h>
+#include <shlwapi.h>
+#pragma comment(lib, "shlwapi.lib")
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+#include "ModUtil.h"
+
+// =============================================================
+// LOGGING HELPER
+// =============================================================
+void Log(const std::string& message) {
+    std::ofstream log_file("mod_log.txt", std::ios_base::app | std::ios_base::out);
+    auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    char time_str[26];
+    ctime_s(time_str, sizeof(time_str), &time);
+    time_str[24] = '\0';
+    log_file << "[" << time_str << "] " << message << std::endl;
+}
+
+// =============================================================
+// MOD FILES
+// =============================================================
+std::string GetModDirectory()
+{
+    char path[MAX_PATH];
+    HMODULE hModule = NULL;
+    GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+        GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        (LPCSTR)&GetModDirectory, &hModule);
+
+    GetModuleFileNameA(hModule, path, MAX_PATH);
+    PathRemoveFileSpecA(path);
+    return std::string(path);
+}
+
+std::string GetModAssetPath(const char* name)
+{
+    return GetModDirectory() + "\\assets/" + name;
+}
+
+bool ReadModFile(const std::string& path, std::vector<uint8_t>* out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    out->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !out->empty();
+}
+
+bool WriteCacheFile(const std::string& path, const std::vector<uint8_t>& image, const char* caller)
+{
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write((const char*)image.data(), (std::streamsize)image.size());
+        if (!out.good()) {
+            Log(std::string(caller) + ": Could not write " + tempPath);
+            return false;
+        }
+    }
+    if (!MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        Log(std::string(caller) + ": Could not replace " + path + ", error " + std::to_string(GetLastError()));
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================
+// MOD FILES AND LOGGING
+// =============================================================
+// The DLL's log and the files beside it. ModUtil.cpp has the Win32 versions;
+// tests link tests/ModUtilHost.cpp instead, which keeps the log in memory and
+// roots the mod directory wherever the test says.
+
+// Appends a timestamped line to mod_log.txt.
+void Log(const std::string& message);
+
+// The directory the DLL was loaded from.
+std::string GetModDirectory();
+
+// A file in the mod's assets directory ("<mod directory>\assets/<name>").
+std::string GetModAssetPath(const char* name);
+
+// Reads a whole file. False if it is missing or empty.
+bool ReadModFile(const std::string& path, std::vector<uint8_t>* out);
+
+// Writes beside `path` and renames, so readers never see a partial file.
+// Failures are logged under `caller`.
+bool WriteCacheFile(const std::string& path, const std::vector<uint8_t>& image, const char* caller);
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <string>
+
+#include <imgui_internal.h>
+
+#include "BgmGlyphCache.h"
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGlyphLoader.h"
+
+ImFont* g_pToastFont = nullptr;
+std::vector<uint8_t> g_toastFontData;
+std::vector<uint8_t> g_toastFallbackFontData;
+uint64_t g_toastFontHash = 0;
+bool g_bToastSdf = true;
+float g_toastFontSize = TOAST_FONT_SIZE;
+float g_toastBakedSize = 0.0f;
+
+// Read ourselves rather than by ImGui: their bytes key the glyph caches, and
+// the glyph rasterizer thread bakes from the same buffers.
+bool LoadToastFontFiles()
+{
+    if (!ReadModFile(GetModAssetPath("mod_font.otf"), &g_toastFontData))
+        return false;
+    g_toastFontHash = HashBgmGlyphCacheBytes(g_toastFontData.data(), g_toastFontData.size());
+    if (ReadModFile(GetModAssetPath("mod_font_cjk.otf"), &g_toastFallbackFontData)) {
+        g_toastFontHash = HashBgmGlyphCacheBytes(g_toastFallbackFontData.data(), g_toastFallbackFontData.size(), g_toastFontHash);
+        Log("mod_font_cjk.otf found; merged into the toast font.");
+    }
+    return InitToastGlyphFaces();
+}
+
+ImFont* AddToastFonts(ImFontAtlas* atlas)
+{
+    ImFontConfig config;
+    config.FontDataOwnedByAtlas = false; // The buffers outlive every atlas
+    config.FontLoader = GetToastFontLoader();
+    ImFont* font = atlas->AddFontFromMemoryTTF(g_toastFontData.data(), (int)g_toastFontData.size(), TOAST_FONT_SIZE, &config);
+    if (font && !g_toastFallbackFontData.empty()) {
+        config.MergeMode = true;
+        atlas->AddFontFromMemoryTTF(g_toastFallbackFontData.data(), (int)g_toastFallbackFontData.size(), TOAST_FONT_SIZE, &config);
+    }
+    // One bake at a time serves every draw size, scaled (see UpdateToastScale);
+    // other sizes are only ever baked on the rasterizer thread
+    if (font)
+        font->Flags |= ImFontFlags_LockBakedSizes;
+    return font;
+}
+
+// Distance fields serve any size up to TOAST_SDF_MAX_MAGNIFICATION times
+// theirs, so they are baked at TOAST_FONT_SIZE, doubled as often as it takes;
+// bitmaps are baked at the draw size, snapped to TOAST_BITMAP_SIZE_STEP.
+float GetToastBakeSize(float fontSize)
+{
+    if (g_bToastSdf) {
+        float size = TOAST_FONT_SIZE;
+        while (fontSize > size * TOAST_SDF_MAX_MAGNIFICATION)
+            size *= 2.0f;
+        return size;
+    }
+    return std::max(TOAST_BITMAP_SIZE_STEP, IM_ROUND(fontSize / TOAST_BITMAP_SIZE_STEP) * TOAST_BITMAP_SIZE_STEP);
+}
+
+// ImFontFlags_LockBakedSizes hands the one bake out for every other size too.
+ImFontBaked* GetToastBaked()
+{
+    return g_pToastFont->GetFontBaked(g_toastBakedSize);
+}
+
+void PushToastFont()
+{
+    GetToastBaked();
+    ImGui::PushFont(g_pToastFont, g_toastFontSize);
+}
+
+// The font's fallback and ellipsis glyphs must stay resident, so they never are.
+bool IsToastGlyphOnDemand(uint32_t codepoint)
+{
+    return codepoint >= TOAST_ON_DEMAND_CODEPOINT_MIN && codepoint <= IM_UNICODE_CODEPOINT_MAX &&
+        !(g_pToastFont && (codepoint == g_pToastFont->FallbackChar || codepoint == g_pToastFont->EllipsisChar));
+}
+
+uint32_t GetToastRasterizerVersion()
+{
+    return g_bToastSdf ? (TOAST_SDF_VERSION << 24) | IMGUI_VERSION_NUM : IMGUI_VERSION_NUM;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <imgui.h>
+
+// =============================================================
+// TOAST FONT
+// =============================================================
+// mod_font.otf (plus mod_font_cjk.otf, merged in if present) as the toast
+// draws it: one bake at a time, scaled by ImGui to the draw size. Everything
+// here belongs to the render thread, except that the font files' bytes are
+// read-only once loaded and the rasterizer thread bakes from them too.
+
+constexpr float TOAST_FONT_SIZE = 28.0f;
+constexpr uint32_t TOAST_ON_DEMAND_CODEPOINT_MIN = 0x2E80; // CJK radicals and everything above
+constexpr float TOAST_SDF_MAX_MAGNIFICATION = 2.0f;       // Draw size a field still serves, per baked pixel
+constexpr float TOAST_BITMAP_SIZE_STEP = 4.0f;            // Bitmap bakes snap to multiples of this many pixels
+constexpr uint32_t TOAST_SDF_VERSION = 1;                 // Bump with any change to how the fields are rendered
+
+extern ImFont* g_pToastFont;
+extern std::vector<uint8_t> g_toastFontData;         // mod_font.otf, shared by every font atlas
+extern std::vector<uint8_t> g_toastFallbackFontData; // mod_font_cjk.otf (optional), merged in
+extern uint64_t g_toastFontHash;                     // Of both files' bytes; keys the glyph caches
+extern bool g_bToastSdf;                             // [Font] Sdf; cleared if the shader fails to build
+extern float g_toastFontSize;                        // Draw size: TOAST_FONT_SIZE * g_toastScale, rounded
+extern float g_toastBakedSize;                       // Pixel size of the font's bake; 0 until the first frame
+
+// Reads the font files from the assets directory, hashes them and parses
+// them for the rasterizer thread. False if mod_font.otf is missing or unreadable.
+bool LoadToastFontFiles();
+
+// Adds mod_font.otf (plus the fallback, merged) to `atlas`, with the toast
+// font's loader (ToastGlyphLoader.h), as distance fields while g_bToastSdf.
+ImFont* AddToastFonts(ImFontAtlas* atlas);
+
+// The pixel size to bake the toast font at for drawing it at `fontSize`.
+float GetToastBakeSize(float fontSize);
+
+// The toast font's one bake, created at g_toastBakedSize the first time.
+ImFontBaked* GetToastBaked();
+
+// Pushes the toast font at the current draw size (its bake, scaled).
+void PushToastFont();
+
+// Whether a codepoint is rasterized on demand rather than prewarmed.
+bool IsToastGlyphOnDemand(uint32_t codepoint);
+
+// Glyph images (cached or from the rasterizer thread) only fit a font baked
+// the same way: same ImGui, and distance fields or not.
+uint32_t GetToastRasterizerVersion();
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include <imgui_internal.h> // ImDrawList internals, for appending retained geometry
+
+#include "ToastFont.h"
+#include "ToastGeometry.h"
+#include "ToastSdfShader.h"
+
+// Draws the toast with its left edge at x = 0. Only used to (re)build the
+// retained geometry below.
+static void EmitToastGeometry(ImDrawList* draw_list, const ToastLayout& layout, float top_y)
+{
+    ImVec2 pos_note_start(0.0f, top_y);
+    ImVec2 pos_note_end(layout.noteIconWidth, top_y + layout.totalHeight);
+    ImVec2 pos_box_start(pos_note_end.x, top_y);
+    ImVec2 pos_box_end(pos_box_start.x + layout.boxWidth, top_y + layout.totalHeight);
+
+    // Vertically center the text block
+    float text_start_y = top_y + layout.textStartOffsetY;
+
+    // The icon comes from the font atlas, like the box's white pixel and the
+    // glyphs, so all three land in one draw command
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFontAtlasRect icon;
+    if (GetToastIconRect(atlas, layout.icon, &icon)) {
+        draw_list->AddImage(
+            atlas->TexRef,
+            pos_note_start,
+            pos_note_end,
+            icon.uv0,
+            icon.uv1
+        );
+    }
+
+    draw_list->AddRectFilled(
+        pos_box_start,
+        pos_box_end,
+        IM_COL32(0, 0, 0, 100),
+        TOAST_ROUNDING * layout.scale
+    );
+
+    if (g_pToastFont) PushToastFont();
+    if (g_bToastSdf) draw_list->AddCallback(SetToastSdfShader, nullptr);
+
+    // Line 1: Song Name
+    float text_x = pos_box_start.x + TOAST_TEXT_PADDING_X * layout.scale;
+    ImVec2 pos_line1(text_x, text_start_y);
+    draw_list->AddText(pos_line1, IM_COL32_WHITE, layout.title);
+
+    // Line 2: Disc/Track
+    if (layout.line2[0] != '\0') {
+        ImVec2 pos_line2(text_x, text_start_y + layout.lineHeight);
+        draw_list->AddText(pos_line2, IM_COL32(180, 180, 180, 255), layout.line2);
+    }
+
+    if (g_bToastSdf) draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    if (g_pToastFont) ImGui::PopFont();
+}
+
+static ToastGeometry g_toastGeometry;
+
+const ToastGeometry& GetToastGeometry(const ToastLayout& layout, float top_y)
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ToastGeometry& geometry = g_toastGeometry;
+    if (geometry.track == layout.track && geometry.screenWidth == layout.screenWidth &&
+        geometry.scale == layout.scale && geometry.bakedSize == layout.bakedSize &&
+        geometry.atlasTextureId == (atlas->TexData ? atlas->TexData->UniqueID : -1))
+        return geometry;
+
+    // Tessellate into a scratch list without clipping (ImGui culls glyphs
+    // outside the clip rect, and the toast may start offscreen)
+    ImDrawList scratch(ImGui::GetDrawListSharedData());
+    scratch._ResetForNewFrame();
+    scratch.PushTexture(atlas->TexRef);
+    scratch.PushClipRect(ImVec2(-FLT_MAX, -FLT_MAX), ImVec2(FLT_MAX, FLT_MAX));
+    EmitToastGeometry(&scratch, layout, top_y);
+
+    geometry.vertices.resize(0);
+    geometry.indices.resize(0);
+    geometry.batches.resize(0);
+    bool sdf = false;
+    for (const ImDrawCmd& cmd : scratch.CmdBuffer)
+    {
+        if (cmd.UserCallback)
+            sdf = cmd.UserCallback == SetToastSdfShader;
+        if (cmd.ElemCount == 0 || cmd.UserCallback)
+            continue;
+
+        const ImDrawIdx* idx = scratch.IdxBuffer.Data + cmd.IdxOffset;
+        unsigned int first = ~0u, last = 0;
+        for (unsigned int i = 0; i < cmd.ElemCount; ++i)
+        {
+            first = std::min(first, (unsigned int)idx[i]);
+            last = std::max(last, (unsigned int)idx[i]);
+        }
+
+        ToastGeometryBatch batch;
+        batch.texture = cmd.TexRef;
+        batch.sdf = sdf;
+        batch.vtxBegin = geometry.vertices.Size;
+        batch.vtxCount = (int)(last - first + 1);
+        batch.idxBegin = geometry.indices.Size;
+        batch.idxCount = (int)cmd.ElemCount;
+        const ImDrawVert* vtx = scratch.VtxBuffer.Data + cmd.VtxOffset + first;
+        geometry.vertices.resize(batch.vtxBegin + batch.vtxCount);
+        memcpy(geometry.vertices.Data + batch.vtxBegin, vtx, batch.vtxCount * sizeof(ImDrawVert));
+        for (unsigned int i = 0; i < cmd.ElemCount; ++i)
+            geometry.indices.push_back((ImDrawIdx)(idx[i] - first));
+        geometry.batches.push_back(batch);
+    }
+
+    // Keyed after tessellating: drawing may have baked glyphs and grown the atlas
+    geometry.track = layout.track;
+    geometry.screenWidth = layout.screenWidth;
+    geometry.scale = layout.scale;
+    geometry.bakedSize = layout.bakedSize;
+    geometry.atlasTextureId = atlas->TexData ? atlas->TexData->UniqueID : -1;
+    return geometry;
+}
+
+void DrawToastGeometry(ImDrawList* draw_list, const ToastGeometry& geometry, float x)
+{
+    for (const ToastGeometryBatch& batch : geometry.batches)
+    {
+        if (batch.sdf) draw_list->AddCallback(SetToastSdfShader, nullptr);
+        draw_list->PushTexture(batch.texture);
+        draw_list->PrimReserve(batch.idxCount, batch.vtxCount);
+
+        ImDrawIdx base = (ImDrawIdx)draw_list->_VtxCurrentIdx;
+        const ImDrawIdx* idx = geometry.indices.Data + batch.idxBegin;
+        ImDrawIdx* idxOut = draw_list->_IdxWritePtr;
+        for (int i = 0; i < batch.idxCount; ++i)
+            idxOut[i] = (ImDrawIdx)(base + idx[i]);
+
+        ImDrawVert* vtxOut = draw_list->_VtxWritePtr;
+        memcpy(vtxOut, geometry.vertices.Data + batch.vtxBegin, batch.vtxCount * sizeof(ImDrawVert));
+        for (int i = 0; i < batch.vtxCount; ++i)
+            vtxOut[i].pos.x += x;
+
+        draw_list->_IdxWritePtr += batch.idxCount;
+        draw_list->_VtxWritePtr += batch.vtxCount;
+        draw_list->_VtxCurrentIdx += batch.vtxCount;
+        draw_list->PopTexture();
+        if (batch.sdf) draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#include <imgui.h>
+
+#include "BgmIndex.h"
+#include "ToastIcons.h"
+
+// =============================================================
+// TOAST GEOMETRY
+// =============================================================
+// The toast's draw commands: tessellated once per layout into retained
+// vertices, then appended each frame shifted along X. The icon, the box's
+// white pixel and the glyphs all come from the font atlas, so bitmap text
+// draws the whole toast in one command; distance-field text adds one more,
+// between the SDF shader callbacks. Render thread only.
+
+// UI Configuration, in pixels at TOAST_REFERENCE_HEIGHT (times g_toastScale)
+constexpr float TOAST_UI_SCALE = 0.65f;
+constexpr float TOAST_SCREEN_PADDING = 10.0f;
+constexpr float TOAST_TEXT_PADDING_X = 20.0f * TOAST_UI_SCALE;
+constexpr float TOAST_TEXT_PADDING_Y = 15.0f * TOAST_UI_SCALE;
+constexpr float TOAST_ROUNDING = 8.0f * TOAST_UI_SCALE;
+
+// Everything about the toast that only changes with the track shown or the
+// display: its strings, text extents, box size and slide targets, in screen
+// pixels. Render thread only.
+struct ToastLayout {
+    uint32_t track = BGM_INVALID_TRACK_ID; // Key: packed track (generation << 16 | ID) ...
+    float screenWidth = -1.0f;             // ... the display width it was laid out for ...
+    float scale = 0.0f;                    // ... at this g_toastScale ...
+    float bakedSize = 0.0f;                // ... measuring the font bake of this size
+
+    const char* title = "";     // View into the snapshot of the keyed generation
+    char line2[32] = "";        // "Disc N, Track M", or empty
+    float lineHeight = 28.0f;
+    float textStartOffsetY = 0.0f; // From the top of the box, vertically centered
+    float totalHeight = 0.0f;
+    float noteIconWidth = 0.0f;
+    float boxWidth = 0.0f;
+    bool isTitleScreen = false;
+    ToastIcon icon = ToastIcon::Note;
+    float targetOnscreenX = 0.0f;
+    float targetOffscreenX = 0.0f;
+};
+
+// One texture's (and pixel shader's) worth of retained toast geometry.
+// Indices are relative to the batch's first vertex.
+struct ToastGeometryBatch {
+    ImTextureRef texture;
+    bool sdf = false; // Drawn between SetToastSdfShader and a render state reset
+    int vtxBegin = 0;
+    int vtxCount = 0;
+    int idxBegin = 0;
+    int idxCount = 0;
+};
+
+// The toast's vertices and indices at x = 0. Valid for the layout it was
+// built from and for the font atlas texture its glyph UVs point into (1.92
+// atlases can grow, which moves glyphs). Render thread only.
+struct ToastGeometry {
+    uint32_t track = BGM_INVALID_TRACK_ID;
+    float screenWidth = -1.0f;
+    float scale = 0.0f;
+    float bakedSize = 0.0f;
+    int atlasTextureId = -1;
+    ImVector<ImDrawVert> vertices;
+    ImVector<ImDrawIdx> indices;
+    ImVector<ToastGeometryBatch> batches;
+};
+
+// The retained geometry for `layout` with the toast's top at `top_y`,
+// rebuilt only if the layout or the atlas texture changed.
+const ToastGeometry& GetToastGeometry(const ToastLayout& layout, float top_y);
+
+// Appends the retained geometry shifted to x; no tessellation.
+void DrawToastGeometry(ImDrawList* draw_list, const ToastGeometry& geometry, float x);
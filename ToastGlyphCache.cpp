@@ -0,0 +1,134 @@
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGlyphCache.h"
+
+std::string GetToastGlyphCachePath()
+{
+    return GetModAssetPath("ToastGlyphs.cache");
+}
+
+BgmGlyphCacheKey MakeToastGlyphCacheKey(const std::vector<uint32_t>& codepoints, float pixelSize)
+{
+    BgmGlyphCacheKey key = {};
+    key.fontHash = g_toastFontHash;
+    key.codepointHash = HashBgmGlyphSet(codepoints.data(), codepoints.size());
+    key.pixelSize = pixelSize;
+    key.rasterizerVersion = GetToastRasterizerVersion();
+    return key;
+}
+
+int AddToastGlyphs(ImFontAtlas* atlas, ImFontBaked* baked, const BgmGlyphCacheView& view)
+{
+    int added = 0;
+    for (size_t i = 0; i < view.glyphCount; ++i)
+    {
+        const BgmCachedGlyph& cached = view.glyphs[i];
+        if (cached.codepoint > IM_UNICODE_CODEPOINT_MAX || baked->IsGlyphLoaded((ImWchar)cached.codepoint))
+            continue;
+
+        ImFontGlyph glyph;
+        glyph.Codepoint = cached.codepoint;
+        glyph.AdvanceX = cached.advanceX;
+        glyph.X0 = cached.x0;
+        glyph.Y0 = cached.y0;
+        glyph.X1 = cached.x1;
+        glyph.Y1 = cached.y1;
+        glyph.Visible = cached.width != 0 && cached.height != 0;
+        if (glyph.Visible) {
+            glyph.PackId = ImFontAtlasPackAddRect(atlas, cached.width, cached.height);
+            if (glyph.PackId == ImFontAtlasRectId_Invalid)
+                break; // Atlas full; FindGlyph rasterizes the rest
+        }
+
+        // No font source: the advance was already clamped and snapped when it was baked
+        ImFontAtlasBakedAddFontGlyph(atlas, baked, nullptr, &glyph);
+        if (glyph.Visible) {
+            // The stored bitmap was read back after post-processing, so it is copied as is
+            ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph.PackId);
+            ImTextureData* texture = atlas->TexData;
+            ImFontAtlasTextureBlockConvert(view.pixels + cached.pixelOffset, ImTextureFormat_Alpha8, cached.width,
+                (unsigned char*)texture->GetPixelsAt(r->x, r->y), texture->Format, texture->GetPitch(), r->w, r->h);
+            ImFontAtlasTextureBlockQueueUpload(atlas, texture, r->x, r->y, r->w, r->h);
+        }
+        ++added;
+    }
+    return added;
+}
+
+int LoadToastGlyphCache(const BgmGlyphCacheKey& key, ImFontBaked* baked)
+{
+    size_t size = 0;
+    void* image = ImFileLoadToMemory(GetToastGlyphCachePath().c_str(), "rb", &size);
+    if (!image) return -1;
+
+    BgmGlyphCacheView view;
+    int added = -1;
+    if (OpenBgmGlyphCache(image, size, key, &view))
+        added = AddToastGlyphs(ImGui::GetIO().Fonts, baked, view);
+    IM_FREE(image);
+    return added;
+}
+
+void ReadToastGlyphs(ImFontAtlas* atlas, ImFontBaked* baked, const std::vector<uint32_t>& codepoints,
+    std::vector<BgmCachedGlyph>* outGlyphs, std::vector<uint8_t>* outPixels)
+{
+    std::vector<BgmCachedGlyph>& glyphs = *outGlyphs;
+    std::vector<uint8_t>& pixels = *outPixels;
+    glyphs.reserve(glyphs.size() + codepoints.size());
+
+    for (uint32_t codepoint : codepoints)
+    {
+        if (codepoint > IM_UNICODE_CODEPOINT_MAX)
+            continue;
+        const ImFontGlyph* glyph = baked->FindGlyphNoFallback((ImWchar)codepoint);
+        if (!glyph || glyph->Colored)
+            continue; // Not in the font (nothing to save), or not an alpha8 bitmap
+
+        BgmCachedGlyph cached = {};
+        cached.codepoint = codepoint;
+        cached.advanceX = glyph->AdvanceX;
+        cached.x0 = glyph->X0;
+        cached.y0 = glyph->Y0;
+        cached.x1 = glyph->X1;
+        cached.y1 = glyph->Y1;
+        cached.pixelOffset = (uint32_t)pixels.size();
+        if (glyph->Visible && glyph->PackId != ImFontAtlasRectId_Invalid)
+        {
+            // Looked up after FindGlyphNoFallback, which may have grown the texture
+            ImTextureData* texture = atlas->TexData;
+            const ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph->PackId);
+            cached.width = r->w;
+            cached.height = r->h;
+            for (int y = 0; y < r->h; ++y)
+            {
+                const uint8_t* row = (const uint8_t*)texture->GetPixelsAt(r->x, r->y + y);
+                if (texture->Format == ImTextureFormat_Alpha8) {
+                    pixels.insert(pixels.end(), row, row + r->w);
+                } else {
+                    for (int x = 0; x < r->w; ++x)
+                        pixels.push_back(row[x * 4 + 3]); // RGBA32 glyphs are white, coverage in alpha
+                }
+            }
+        }
+        glyphs.push_back(cached);
+    }
+}
+
+// Runs once per map generation that missed the cache.
+void WriteToastGlyphCache(const BgmGlyphCacheKey& key, const std::vector<uint32_t>& codepoints, ImFontBaked* baked)
+{
+    std::vector<uint32_t> resident;
+    for (uint32_t codepoint : codepoints) {
+        if (!IsToastGlyphOnDemand(codepoint))
+            resident.push_back(codepoint);
+    }
+
+    std::vector<BgmCachedGlyph> glyphs;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> image;
+    ReadToastGlyphs(ImGui::GetIO().Fonts, baked, resident, &glyphs, &pixels);
+    BuildBgmGlyphCache(key, glyphs, pixels, &image);
+    if (WriteCacheFile(GetToastGlyphCachePath(), image, "PrewarmToastGlyphs"))
+        Log("PrewarmToastGlyphs: Wrote ToastGlyphs.cache (" + std::to_string(glyphs.size()) + " glyph(s), " +
+            std::to_string(image.size()) + " bytes).");
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+#include <imgui_internal.h> // ImFontAtlasRectId and the atlas builder API
+
+#include "BgmGlyphCache.h"
+
+// =============================================================
+// TOAST GLYPH CACHE
+// =============================================================
+// Moves the toast font's glyphs between font atlases and BgmGlyphCache images:
+// the prewarm set saved to assets/ToastGlyphs.cache and loaded back on the
+// next launch, and the batches the rasterizer thread bakes. Render thread
+// only.
+
+// assets/ToastGlyphs.cache, beside the map cache. It is keyed by the codepoint
+// set, so a map reload that changes titles bakes and rewrites it, and one that
+// does not reuses it.
+std::string GetToastGlyphCachePath();
+
+// The key of the toast font's glyphs for `codepoints` baked at `pixelSize`.
+BgmGlyphCacheKey MakeToastGlyphCacheKey(const std::vector<uint32_t>& codepoints, float pixelSize);
+
+// Copies the glyphs of a BgmGlyphCache image that `baked` still lacks into
+// `atlas`, packing and uploading them as the rasterizer would. Returns how
+// many were added.
+int AddToastGlyphs(ImFontAtlas* atlas, ImFontBaked* baked, const BgmGlyphCacheView& view);
+
+// Adds the cached glyphs `baked` still lacks to the ImGui atlas. Returns how
+// many were added, or -1 if the cache is missing or stale.
+int LoadToastGlyphCache(const BgmGlyphCacheKey& key, ImFontBaked* baked);
+
+// Reads the glyphs of `codepoints` back out of `atlas` (rasterizing any
+// `baked` still lacks), appending them to a glyph table and its bitmaps.
+// Codepoints the font does not have are left out.
+void ReadToastGlyphs(ImFontAtlas* atlas, ImFontBaked* baked, const std::vector<uint32_t>& codepoints,
+    std::vector<BgmCachedGlyph>* outGlyphs, std::vector<uint8_t>* outPixels);
+
+// Saves the prewarmed glyphs of `codepoints` (a map's title codepoints) from
+// the ImGui atlas. On-demand glyphs come and go with the LRU, so they are
+// left to the rasterizer thread on every launch.
+void WriteToastGlyphCache(const BgmGlyphCacheKey& key, const std::vector<uint32_t>& codepoints, ImFontBaked* baked);
@@ -0,0 +1,311 @@
+#include <string>
+
+#include <imgui_internal.h> // Font atlas builder API
+
+// A private stb_truetype, with ImGui's math so coverage comes out bit for bit
+// as its loader renders it, but the C allocator: ImGui's allocation hooks
+// belong to the render thread. imgui_draw.cpp compiles its own, with
+// stb_rect_pack first as here; all the copies are static, so they never clash.
+#define STB_RECT_PACK_IMPLEMENTATION
+#define STBRP_STATIC
+#include <imstb_rectpack.h>
+#define STBTT_assert(x)     do { IM_ASSERT(x); } while (0)
+#define STBTT_fmod(x, y)    ImFmod(x, y)
+#define STBTT_sqrt(x)       ImSqrt(x)
+#define STBTT_pow(x, y)     ImPow(x, y)
+#define STBTT_fabs(x)       ImFabs(x)
+#define STBTT_ifloor(x)     ((int)ImFloor(x))
+#define STBTT_iceil(x)      ((int)ImCeil(x))
+#define STBTT_strlen(x)     ImStrlen(x)
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#include <imstb_truetype.h>
+
+#include "BgmGlyphSdf.h"
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGlyphLoader.h"
+
+struct ToastGlyphFace {
+    stbtt_fontinfo info = {};
+    float scaleFactor = 0.0f; // Font units to pixels, per pixel of font size
+};
+
+// FontLoaderData of each toast font source in an ImFontAtlas
+struct ToastFontSource {
+    ToastGlyphFace face;
+    bool sdf = false;
+    std::vector<uint8_t> bitmap;
+};
+
+// mod_font.otf, then mod_font_cjk.otf; read-only once parsed
+static std::vector<ToastGlyphFace> g_toastGlyphFaces;
+
+static bool InitToastGlyphFace(ToastGlyphFace* face, const void* data, int fontNo)
+{
+    int offset = stbtt_GetFontOffsetForIndex((const unsigned char*)data, fontNo);
+    return offset >= 0 && stbtt_InitFont(&face->info, (const unsigned char*)data, offset);
+}
+
+// Coverage, as ImGui's stb_truetype loader renders it: oversampled and
+// prefiltered, offset by the subpixel shift the filter leaves.
+static void RasterizeToastCoverage(const ToastGlyphFace& face, int glyphIndex, float size, float density, float ascent,
+    int oversampleH, int oversampleV, float offsetX, float offsetY, BgmCachedGlyph* out, std::vector<uint8_t>* bitmap)
+{
+    const float scaleX = face.scaleFactor * size * density * oversampleH;
+    const float scaleY = face.scaleFactor * size * density * oversampleV;
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBoxSubpixel(&face.info, glyphIndex, scaleX, scaleY, 0, 0, &x0, &y0, &x1, &y1);
+    if (x0 == x1 || y0 == y1)
+        return; // Nothing to draw (a space)
+
+    const int w = x1 - x0 + oversampleH - 1;
+    const int h = y1 - y0 + oversampleV - 1;
+    bitmap->assign((size_t)w * h, 0);
+    float subX, subY;
+    stbtt_MakeGlyphBitmapSubpixelPrefilter(&face.info, bitmap->data(), w, h, w, scaleX, scaleY, 0, 0, oversampleH,
+        oversampleV, &subX, &subY, glyphIndex);
+
+    offsetX += subX;
+    offsetY += subY + IM_ROUND(ascent);
+    float recipH = 1.0f / (oversampleH * density);
+    float recipV = 1.0f / (oversampleV * density);
+    out->width = (uint16_t)w;
+    out->height = (uint16_t)h;
+    out->x0 = x0 * recipH + offsetX;
+    out->y0 = y0 * recipV + offsetY;
+    out->x1 = (x0 + w) * recipH + offsetX;
+    out->y1 = (y0 + h) * recipV + offsetY;
+}
+
+// A distance field with RenderBgmSdf, on the same pixel grid as coverage
+// without oversampling, padded by the field's spread.
+static void RasterizeToastSdf(const ToastGlyphFace& face, int glyphIndex, float size, float density, float ascent,
+    float offsetX, float offsetY, BgmCachedGlyph* out, std::vector<uint8_t>* bitmap)
+{
+    const float rasterScale = face.scaleFactor * size * density;
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBox(&face.info, glyphIndex, rasterScale, rasterScale, &x0, &y0, &x1, &y1);
+    if (x0 == x1 || y0 == y1)
+        return;
+
+    // Outline in raster pixels, y down
+    BgmSdfOutline outline;
+    stbtt_vertex* vertices = nullptr;
+    int vertexCount = stbtt_GetGlyphShape(&face.info, glyphIndex, &vertices);
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        const stbtt_vertex& v = vertices[i];
+        switch (v.type) {
+        case STBTT_vmove:  outline.MoveTo(v.x * rasterScale, -v.y * rasterScale); break;
+        case STBTT_vline:  outline.LineTo(v.x * rasterScale, -v.y * rasterScale); break;
+        case STBTT_vcurve: outline.QuadTo(v.cx * rasterScale, -v.cy * rasterScale, v.x * rasterScale, -v.y * rasterScale); break;
+        case STBTT_vcubic: outline.CubicTo(v.cx * rasterScale, -v.cy * rasterScale, v.cx1 * rasterScale, -v.cy1 * rasterScale,
+                               v.x * rasterScale, -v.y * rasterScale); break;
+        }
+    }
+    outline.Close();
+    stbtt_FreeShape(&face.info, vertices);
+
+    const int padding = (int)TOAST_SDF_SPREAD;
+    const int w = x1 - x0 + padding * 2;
+    const int h = y1 - y0 + padding * 2;
+    bitmap->resize((size_t)w * h);
+    RenderBgmSdf(outline, w, h, (float)(x0 - padding), (float)(y0 - padding), TOAST_SDF_SPREAD, TOAST_SDF_ON_EDGE,
+        bitmap->data(), w);
+
+    offsetY += IM_ROUND(ascent);
+    out->width = (uint16_t)w;
+    out->height = (uint16_t)h;
+    out->x0 = (x0 - padding) / density + offsetX;
+    out->y0 = (y0 - padding) / density + offsetY;
+    out->x1 = (x0 - padding + w) / density + offsetX;
+    out->y1 = (y0 - padding + h) / density + offsetY;
+}
+
+// Fills in `out`'s advance and, if the glyph has a bitmap, its size and quad
+// (relative to the pen, `offsetX/Y` being the source's scaled GlyphOffset);
+// the bitmap itself goes to `bitmap`, width x height.
+static void RasterizeToastGlyph(const ToastGlyphFace& face, int glyphIndex, float size, float density, float ascent,
+    int oversampleH, int oversampleV, float offsetX, float offsetY, bool sdf, BgmCachedGlyph* out, std::vector<uint8_t>* bitmap)
+{
+    int advance, leftBearing;
+    stbtt_GetGlyphHMetrics(&face.info, glyphIndex, &advance, &leftBearing);
+    out->advanceX = advance * (face.scaleFactor * size);
+    out->width = out->height = 0;
+    out->x0 = out->y0 = out->x1 = out->y1 = 0.0f;
+    bitmap->clear();
+    if (sdf)
+        RasterizeToastSdf(face, glyphIndex, size, density, ascent, offsetX, offsetY, out, bitmap);
+    else
+        RasterizeToastCoverage(face, glyphIndex, size, density, ascent, oversampleH, oversampleV, offsetX, offsetY, out, bitmap);
+}
+
+// =============================================================
+// FONT LOADER (render thread)
+// =============================================================
+// ImGui's stb_truetype loader, source for source, but rasterizing through
+// RasterizeToastGlyph.
+
+static bool ToastFontSourceInit(ImFontAtlas*, ImFontConfig* src)
+{
+    ToastFontSource* source = IM_NEW(ToastFontSource)();
+    if (!InitToastGlyphFace(&source->face, src->FontData, src->FontNo)) {
+        IM_DELETE(source);
+        return false;
+    }
+    source->sdf = g_bToastSdf;
+
+    float refSize = src->DstFont->Sources[0]->SizePixels;
+    if (src->MergeMode && src->SizePixels == 0.0f)
+        src->SizePixels = refSize;
+    source->face.scaleFactor = src->SizePixels >= 0.0f ? stbtt_ScaleForPixelHeight(&source->face.info, 1.0f)
+                                                       : stbtt_ScaleForMappingEmToPixels(&source->face.info, 1.0f);
+    if (src->MergeMode && src->SizePixels != 0.0f && refSize != 0.0f)
+        source->face.scaleFactor *= src->SizePixels / refSize;
+    src->FontLoaderData = source;
+    return true;
+}
+
+static void ToastFontSourceDestroy(ImFontAtlas*, ImFontConfig* src)
+{
+    IM_DELETE((ToastFontSource*)src->FontLoaderData);
+    src->FontLoaderData = nullptr;
+}
+
+static bool ToastFontSourceContainsGlyph(ImFontAtlas*, ImFontConfig* src, ImWchar codepoint)
+{
+    return stbtt_FindGlyphIndex(&((ToastFontSource*)src->FontLoaderData)->face.info, codepoint) != 0;
+}
+
+static bool ToastFontBakedInit(ImFontAtlas*, ImFontConfig* src, ImFontBaked* baked, void*)
+{
+    if (src->MergeMode)
+        return true;
+    const ToastGlyphFace& face = ((const ToastFontSource*)src->FontLoaderData)->face;
+    float layoutScale = face.scaleFactor * baked->Size;
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&face.info, &ascent, &descent, &lineGap);
+    baked->Ascent = ImCeil(ascent * layoutScale);
+    baked->Descent = ImFloor(descent * layoutScale);
+    return true;
+}
+
+static bool ToastFontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*, ImWchar codepoint,
+    ImFontGlyph* outGlyph, float* outAdvanceX)
+{
+    ToastFontSource* source = (ToastFontSource*)src->FontLoaderData;
+    int glyphIndex = stbtt_FindGlyphIndex(&source->face.info, codepoint);
+    if (glyphIndex == 0)
+        return false;
+    if (outAdvanceX) {
+        int advance, leftBearing;
+        stbtt_GetGlyphHMetrics(&source->face.info, glyphIndex, &advance, &leftBearing);
+        *outAdvanceX = advance * (source->face.scaleFactor * baked->Size); // Metrics only
+        return true;
+    }
+
+    int oversampleH, oversampleV;
+    ImFontAtlasBuildGetOversampleFactors(src, baked, &oversampleH, &oversampleV);
+    float refSize = baked->ContainerFont->Sources[0]->SizePixels;
+    float offsetScale = refSize != 0.0f ? baked->Size / refSize : 1.0f;
+    float offsetX = src->GlyphOffset.x * offsetScale;
+    float offsetY = src->GlyphOffset.y * offsetScale;
+    if (src->PixelSnapH) offsetX = IM_ROUND(offsetX);
+    if (src->PixelSnapV) offsetY = IM_ROUND(offsetY);
+
+    BgmCachedGlyph glyph = {};
+    RasterizeToastGlyph(source->face, glyphIndex, baked->Size, src->RasterizerDensity * baked->RasterizerDensity,
+        baked->Ascent, oversampleH, oversampleV, offsetX, offsetY, source->sdf, &glyph, &source->bitmap);
+    outGlyph->Codepoint = codepoint;
+    outGlyph->AdvanceX = glyph.advanceX;
+    if (glyph.width == 0)
+        return true;
+
+    ImFontAtlasRectId packId = ImFontAtlasPackAddRect(atlas, glyph.width, glyph.height);
+    if (packId == ImFontAtlasRectId_Invalid)
+        return false;
+    outGlyph->X0 = glyph.x0;
+    outGlyph->Y0 = glyph.y0;
+    outGlyph->X1 = glyph.x1;
+    outGlyph->Y1 = glyph.y1;
+    outGlyph->Visible = true;
+    outGlyph->PackId = packId;
+    ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, outGlyph, ImFontAtlasPackGetRect(atlas, packId),
+        source->bitmap.data(), ImTextureFormat_Alpha8, glyph.width);
+    return true;
+}
+
+const ImFontLoader* GetToastFontLoader()
+{
+    static ImFontLoader loader;
+    loader.Name = "ToastGlyphLoader";
+    loader.FontSrcInit = ToastFontSourceInit;
+    loader.FontSrcDestroy = ToastFontSourceDestroy;
+    loader.FontSrcContainsGlyph = ToastFontSourceContainsGlyph;
+    loader.FontBakedInit = ToastFontBakedInit;
+    loader.FontBakedLoadGlyph = ToastFontBakedLoadGlyph;
+    return &loader;
+}
+
+// =============================================================
+// BAKING WITHOUT AN ATLAS (any thread)
+// =============================================================
+
+bool InitToastGlyphFaces()
+{
+    g_toastGlyphFaces.clear();
+    for (const std::vector<uint8_t>* data : { &g_toastFontData, &g_toastFallbackFontData })
+    {
+        ToastGlyphFace face;
+        if (data->empty())
+            continue;
+        if (!InitToastGlyphFace(&face, data->data(), 0)) {
+            Log(std::string(data == &g_toastFontData ? "mod_font.otf" : "mod_font_cjk.otf") + " is not a font stb_truetype can read.");
+            if (data == &g_toastFontData)
+                return false;
+            continue;
+        }
+        // AddToastFonts merges the fallback at the same size: no extra scale
+        face.scaleFactor = stbtt_ScaleForPixelHeight(&face.info, 1.0f);
+        g_toastGlyphFaces.push_back(face);
+    }
+    return true;
+}
+
+size_t BakeToastGlyphs(const std::vector<uint32_t>& codepoints, float pixelSize, bool sdf,
+    std::vector<BgmCachedGlyph>* outGlyphs, std::vector<uint8_t>* outPixels)
+{
+    if (g_toastGlyphFaces.empty())
+        return 0;
+
+    // The bake's ascent (the main file's) and ImFontAtlasBuildGetOversampleFactors, for AddToastFonts' config
+    const ToastGlyphFace& main = g_toastGlyphFaces[0];
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&main.info, &ascent, &descent, &lineGap);
+    const float bakedAscent = ImCeil(ascent * (main.scaleFactor * pixelSize));
+    const int oversampleH = pixelSize > 36.0f ? 1 : 2;
+    std::vector<uint8_t> bitmap;
+    size_t baked = 0;
+    outGlyphs->reserve(outGlyphs->size() + codepoints.size());
+    for (uint32_t codepoint : codepoints)
+    {
+        if (codepoint > IM_UNICODE_CODEPOINT_MAX)
+            continue;
+        for (const ToastGlyphFace& face : g_toastGlyphFaces)
+        {
+            int glyphIndex = stbtt_FindGlyphIndex(&face.info, (int)codepoint);
+            if (glyphIndex == 0)
+                continue;
+            BgmCachedGlyph glyph = {};
+            glyph.codepoint = codepoint;
+            RasterizeToastGlyph(face, glyphIndex, pixelSize, 1.0f, bakedAscent, oversampleH, 1, 0.0f, 0.0f, sdf, &glyph, &bitmap);
+            glyph.pixelOffset = (uint32_t)outPixels->size();
+            outPixels->insert(outPixels->end(), bitmap.begin(), bitmap.end());
+            outGlyphs->push_back(glyph);
+            ++baked;
+            break;
+        }
+    }
+    return baked;
+}
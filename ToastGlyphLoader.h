@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <imgui.h>
+
+#include "BgmGlyphCache.h"
+
+// =============================================================
+// TOAST GLYPH LOADER
+// =============================================================
+// Rasterizes the toast font with a private stb_truetype: as coverage laid
+// out and rendered exactly like ImGui's own loader, or as signed distance
+// fields (BgmGlyphSdf.h) padded by their spread. The font's ImFontLoader on
+// the render thread and BakeToastGlyphs on the rasterizer thread share one
+// rasterizer, so their glyphs always agree; only the loader touches an
+// ImFontAtlas.
+
+constexpr float TOAST_SDF_SPREAD = 4.0f;   // Field range either side of the outline, in baked pixels
+constexpr uint8_t TOAST_SDF_ON_EDGE = 128; // Field value on the outline (the shader's threshold)
+
+// The loader AddToastFonts adds every toast font file with. Each file draws
+// as distance fields or not as g_bToastSdf was when it was added.
+const ImFontLoader* GetToastFontLoader();
+
+// Parses g_toastFontData and g_toastFallbackFontData for BakeToastGlyphs.
+// Render thread, once the files are loaded and before the rasterizer thread
+// starts. False if mod_font.otf does not parse.
+bool InitToastGlyphFaces();
+
+// Bakes `codepoints` at `pixelSize` (RasterizerDensity 1) as the toast font's
+// loader would, appending them to a glyph table and its bitmaps; codepoints
+// neither file has are left out. Uses no ImGui state, so any number of
+// threads may bake at once. Returns the number of glyphs appended.
+size_t BakeToastGlyphs(const std::vector<uint32_t>& codepoints, float pixelSize, bool sdf,
+    std::vector<BgmCachedGlyph>* outGlyphs, std::vector<uint8_t>* outPixels);
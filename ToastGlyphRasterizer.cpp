@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+
+#include <imgui_internal.h> // Font atlas builder API
+
+#include "BgmTrackStore.h"
+#include "BgmWakeup.h"
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGlyphCache.h"
+#include "ToastGlyphLoader.h"
+#include "ToastGlyphRasterizer.h"
+
+// Render thread only
+static uint32_t g_glyphPageSize = TOAST_GLYPH_PAGE_SIZE;   // For a TOAST_FONT_SIZE bake
+static BgmGlyphLru g_glyphLru(TOAST_GLYPH_PAGE_SIZE * TOAST_GLYPH_PAGE_SIZE);
+static uint64_t g_glyphTick = 0;
+static uint64_t g_glyphPinnedTick = 0;                     // Glyphs used since belong to the toast on screen
+static std::unordered_set<uint32_t> g_glyphsInFlight;      // Requested, not yet copied in
+static size_t g_glyphBatchesInFlight = 0;                  // Sent, not yet ingested
+
+// Batches; the rasterizer thread starts with the first request
+constexpr size_t TOAST_GLYPH_SLICE_MIN = 32;  // Glyphs per helper thread when a batch is split
+constexpr size_t TOAST_GLYPH_MAX_SLICES = 8;
+static std::mutex g_glyphBatchMutex;
+static std::vector<ToastGlyphBatch> g_glyphRequests; // Render thread -> rasterizer
+static std::vector<ToastGlyphBatch> g_glyphResults;  // Rasterizer -> render thread
+static BgmAutoResetEvent g_glyphRequestSignal;       // Wakes the rasterizer
+static std::thread g_glyphRasterizerThread;
+static std::atomic<bool> g_bGlyphRasterizerActive = false;
+
+// Helper threads, started with the rasterizer, one per further spare core: a
+// large batch is split into slices that the rasterizer thread and the helpers
+// take in turn. The job is only written while no slice of the last one is
+// still being baked.
+static std::vector<std::thread> g_glyphHelperThreads;
+static std::mutex g_glyphHelperMutex;
+static std::condition_variable g_glyphHelperWork;     // A new job, or stop
+static std::condition_variable g_glyphHelperFinished; // The job's last slice is done
+static const std::function<void(size_t)>* g_pGlyphHelperSlice = nullptr;
+static uint64_t g_glyphHelperJob = 0;                  // Bumped per job
+static size_t g_glyphHelperSlices = 0;
+static size_t g_glyphHelperNext = 0;                   // Next slice to take
+static size_t g_glyphHelperDone = 0;                   // Slices finished
+static bool g_bGlyphHelpersStopping = false;
+
+// Takes and bakes slices of the current job until none is left. Called with
+// the helper mutex held; returns with it held.
+static void BakeToastGlyphSlices(std::unique_lock<std::mutex>& lock)
+{
+    while (g_glyphHelperNext < g_glyphHelperSlices)
+    {
+        size_t slice = g_glyphHelperNext++;
+        const std::function<void(size_t)>& bakeSlice = *g_pGlyphHelperSlice;
+        lock.unlock();
+        bakeSlice(slice);
+        lock.lock();
+        if (++g_glyphHelperDone == g_glyphHelperSlices)
+            g_glyphHelperFinished.notify_one();
+    }
+}
+
+static void ToastGlyphHelperThread()
+{
+    uint64_t job = 0;
+    std::unique_lock<std::mutex> lock(g_glyphHelperMutex);
+    while (true)
+    {
+        g_glyphHelperWork.wait(lock, [&] { return g_bGlyphHelpersStopping || g_glyphHelperJob != job; });
+        if (g_bGlyphHelpersStopping)
+            return;
+        job = g_glyphHelperJob;
+        BakeToastGlyphSlices(lock);
+    }
+}
+
+// Runs bakeSlice(0 .. sliceCount - 1) on the rasterizer thread and whichever
+// helpers are free, and returns once all are done.
+static void RunToastGlyphSlices(size_t sliceCount, const std::function<void(size_t)>& bakeSlice)
+{
+    std::unique_lock<std::mutex> lock(g_glyphHelperMutex);
+    g_pGlyphHelperSlice = &bakeSlice;
+    g_glyphHelperSlices = sliceCount;
+    g_glyphHelperNext = 0;
+    g_glyphHelperDone = 0;
+    ++g_glyphHelperJob;
+    if (sliceCount > 1)
+        g_glyphHelperWork.notify_all();
+    BakeToastGlyphSlices(lock);
+    g_glyphHelperFinished.wait(lock, [] { return g_glyphHelperDone == g_glyphHelperSlices; });
+    g_pGlyphHelperSlice = nullptr;
+}
+
+// Starts up to `count` helpers; as many as the system gives, which may be none.
+static void StartToastGlyphHelpers(size_t count)
+{
+    g_bGlyphHelpersStopping = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        try {
+            g_glyphHelperThreads.emplace_back(ToastGlyphHelperThread);
+        } catch (const std::system_error& error) {
+            Log(std::string("Could not start a glyph helper thread (") + error.what() + "); " +
+                std::to_string(g_glyphHelperThreads.size()) + " helper(s) running.");
+            break;
+        }
+    }
+}
+
+static void StopToastGlyphHelpers()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_glyphHelperMutex);
+        g_bGlyphHelpersStopping = true;
+    }
+    g_glyphHelperWork.notify_all();
+    for (std::thread& helper : g_glyphHelperThreads)
+        helper.join();
+    g_glyphHelperThreads.clear();
+}
+
+void SetToastGlyphPageSize(uint32_t pageSize)
+{
+    g_glyphPageSize = pageSize;
+    g_glyphLru.SetBudget((uint64_t)g_glyphPageSize * g_glyphPageSize);
+}
+
+void SetToastGlyphBudget(float bakedSize)
+{
+    float ratio = bakedSize / TOAST_FONT_SIZE;
+    g_glyphLru.SetBudget((uint64_t)((double)g_glyphPageSize * g_glyphPageSize * ratio * ratio));
+}
+
+// Bakes a batch into its BgmGlyphCache image with BakeToastGlyphs, no font
+// atlas involved. A large batch (a map's prewarm set, a rebake) is split into
+// slices baked by the rasterizer thread and its helpers, each taking every Nth
+// codepoint, and their glyphs are stitched into one image: distance fields
+// cost several times what coverage does, so this is what keeps a cold start
+// short. Returns the number of glyphs stored.
+static size_t BakeToastGlyphBatch(ToastGlyphBatch& batch, size_t sliceCount)
+{
+    std::vector<std::vector<BgmCachedGlyph>> glyphs(sliceCount);
+    std::vector<std::vector<uint8_t>> pixels(sliceCount);
+    RunToastGlyphSlices(sliceCount, [&](size_t slice) {
+        std::vector<uint32_t> codepoints;
+        for (size_t i = slice; i < batch.codepoints.size(); i += sliceCount)
+            codepoints.push_back(batch.codepoints[i]);
+        BakeToastGlyphs(codepoints, batch.key.pixelSize, batch.sdf, &glyphs[slice], &pixels[slice]);
+    });
+
+    for (size_t slice = 1; slice < sliceCount; ++slice) {
+        uint32_t pixelBase = (uint32_t)pixels[0].size();
+        for (BgmCachedGlyph& glyph : glyphs[slice])
+            glyph.pixelOffset += pixelBase;
+        glyphs[0].insert(glyphs[0].end(), glyphs[slice].begin(), glyphs[slice].end());
+        pixels[0].insert(pixels[0].end(), pixels[slice].begin(), pixels[slice].end());
+    }
+    BuildBgmGlyphCache(batch.key, glyphs[0], pixels[0], &batch.image);
+    return glyphs[0].size();
+}
+
+// Bakes requested glyphs and hands them back as BgmGlyphCache images. Large
+// batches are split between it and the helper threads.
+static void ToastGlyphRasterizerThread()
+{
+    Log("Glyph rasterizer thread started, " + std::to_string(g_glyphHelperThreads.size()) + " helper(s).");
+
+    uint64_t glyphCount = 0;
+    size_t maxSlices = g_glyphHelperThreads.size() + 1;
+
+    while (g_bGlyphRasterizerActive)
+    {
+        std::vector<ToastGlyphBatch> batches;
+        {
+            std::lock_guard<std::mutex> lock(g_glyphBatchMutex);
+            batches.swap(g_glyphRequests);
+        }
+        if (batches.empty()) {
+            g_glyphRequestSignal.Wait();
+            continue;
+        }
+
+        for (ToastGlyphBatch& batch : batches)
+        {
+            size_t sliceCount = std::clamp<size_t>(batch.codepoints.size() / TOAST_GLYPH_SLICE_MIN, 1, maxSlices);
+            auto start = std::chrono::steady_clock::now();
+            size_t baked = BakeToastGlyphBatch(batch, sliceCount);
+            glyphCount += baked;
+            if (sliceCount > 1)
+                Log("Glyph rasterizer: " + std::to_string(baked) + " glyph(s) on " + std::to_string(sliceCount) + " threads in " +
+                    std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) + " us.");
+        }
+
+        std::lock_guard<std::mutex> lock(g_glyphBatchMutex);
+        for (ToastGlyphBatch& batch : batches)
+            g_glyphResults.push_back(std::move(batch));
+    }
+
+    Log("Glyph rasterizer thread shutting down, " + std::to_string(glyphCount) + " glyph(s) baked.");
+}
+
+static bool StartToastGlyphRasterizer()
+{
+    static bool s_failed = false;
+    if (g_glyphRasterizerThread.joinable()) return true;
+    if (s_failed) return false;
+
+    // One slice per spare core: the render thread keeps one, the rasterizer
+    // thread takes another
+    unsigned int cores = std::thread::hardware_concurrency();
+    StartToastGlyphHelpers(std::clamp<size_t>(cores > 2 ? cores - 2 : 0, 0, TOAST_GLYPH_MAX_SLICES - 1));
+
+    g_bGlyphRasterizerActive = true;
+    try {
+        g_glyphRasterizerThread = std::thread(ToastGlyphRasterizerThread);
+    } catch (const std::system_error& error) {
+        Log(std::string("Could not start the glyph rasterizer thread (") + error.what() +
+            "); on-demand glyphs will be rasterized in Present.");
+        g_bGlyphRasterizerActive = false;
+        StopToastGlyphHelpers();
+        s_failed = true;
+        return false;
+    }
+    return true;
+}
+
+void StopToastGlyphRasterizer()
+{
+    g_bGlyphRasterizerActive = false;
+    g_glyphRequestSignal.Set();
+    if (g_glyphRasterizerThread.joinable())
+        g_glyphRasterizerThread.join();
+    StopToastGlyphHelpers();
+}
+
+bool SendToastGlyphBatch(float pixelSize, std::vector<uint32_t> codepoints, ToastGlyphBatchKind kind)
+{
+    if (!StartToastGlyphRasterizer())
+        return false;
+
+    ToastGlyphBatch batch;
+    batch.key = MakeToastGlyphCacheKey(codepoints, pixelSize);
+    batch.codepoints = std::move(codepoints);
+    batch.kind = kind;
+    batch.sdf = g_bToastSdf;
+    if (kind != ToastGlyphBatchKind::Rebake)
+        g_glyphsInFlight.insert(batch.codepoints.begin(), batch.codepoints.end());
+    ++g_glyphBatchesInFlight;
+    {
+        std::lock_guard<std::mutex> lock(g_glyphBatchMutex);
+        g_glyphRequests.push_back(std::move(batch));
+    }
+    g_glyphRequestSignal.Set();
+    return true;
+}
+
+bool RequestToastGlyphs(ImFontBaked* baked, const char* text)
+{
+    if (!text) return false;
+
+    std::vector<uint32_t> codepoints;
+    bool inFlight = false;
+    for (const char* p = text; *p; )
+    {
+        uint32_t codepoint;
+        p += DecodeBgmUtf8(p, &codepoint);
+        if (!IsToastGlyphOnDemand(codepoint) || baked->IsGlyphLoaded((ImWchar)codepoint))
+            continue;
+        if (g_glyphsInFlight.count(codepoint)) {
+            inFlight = true;
+            continue;
+        }
+        if (!g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+            continue; // Only ever drawn as the fallback glyph
+        if (std::find(codepoints.begin(), codepoints.end(), codepoint) == codepoints.end())
+            codepoints.push_back(codepoint);
+    }
+    if (codepoints.empty())
+        return inFlight;
+    return SendToastGlyphBatch(baked->Size, std::move(codepoints), ToastGlyphBatchKind::OnDemand);
+}
+
+void IngestToastGlyphs(ToastRebakeHandler onRebake)
+{
+    if (!g_pToastFont || g_glyphBatchesInFlight == 0)
+        return;
+
+    std::vector<ToastGlyphBatch> results;
+    {
+        std::unique_lock<std::mutex> lock(g_glyphBatchMutex, std::try_to_lock);
+        if (!lock.owns_lock() || g_glyphResults.empty())
+            return;
+        results.swap(g_glyphResults);
+    }
+    g_glyphBatchesInFlight -= results.size();
+
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFontBaked* baked = GetToastBaked();
+    for (const ToastGlyphBatch& batch : results)
+    {
+        BgmGlyphCacheView view;
+        bool valid = OpenBgmGlyphCache(batch.image.data(), batch.image.size(), batch.key, &view);
+        if (batch.kind == ToastGlyphBatchKind::Rebake) {
+            baked = onRebake(atlas, baked, batch, valid, view);
+            continue;
+        }
+
+        for (uint32_t codepoint : batch.codepoints)
+            g_glyphsInFlight.erase(codepoint);
+
+        // Baked for another size: drop it, the next toast that needs them asks again
+        if (batch.key.pixelSize != baked->Size || !valid)
+            continue;
+
+        AddToastGlyphs(atlas, baked, view);
+        if (batch.kind == ToastGlyphBatchKind::Resident)
+            continue;
+        for (size_t i = 0; i < view.glyphCount; ++i) {
+            const BgmCachedGlyph& glyph = view.glyphs[i];
+            if (baked->IsGlyphLoaded((ImWchar)glyph.codepoint))
+                g_glyphLru.Insert(glyph.codepoint, (uint32_t)glyph.width * glyph.height, ++g_glyphTick);
+        }
+    }
+}
+
+void TouchToastGlyphs(ImFontBaked* baked, const char* text)
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    g_glyphPinnedTick = ++g_glyphTick;
+    for (const char* p = text; *p; )
+    {
+        uint32_t codepoint;
+        p += DecodeBgmUtf8(p, &codepoint);
+        if (!IsToastGlyphOnDemand(codepoint) || g_glyphLru.Touch(codepoint, g_glyphPinnedTick))
+            continue;
+
+        // Rasterized in Present after all (the rasterizer was late): track it too
+        ImFontGlyph* glyph = baked->IsGlyphLoaded((ImWchar)codepoint) ? baked->FindGlyphNoFallback((ImWchar)codepoint) : nullptr;
+        if (glyph && glyph->PackId != ImFontAtlasRectId_Invalid) {
+            const ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph->PackId);
+            g_glyphLru.Insert(codepoint, (uint32_t)r->w * r->h, g_glyphPinnedTick);
+        }
+    }
+
+    // The atlas reclaims discarded space by repacking once enough accumulates
+    uint32_t victim;
+    while (g_glyphLru.PopVictim(g_glyphPinnedTick, &victim)) {
+        if (baked->IsGlyphLoaded((ImWchar)victim))
+            ImFontAtlasBakedDiscardFontGlyph(atlas, g_pToastFont, baked, baked->FindGlyphNoFallback((ImWchar)victim));
+    }
+}
+
+void ResetToastGlyphLru(ImFontBaked* baked, const BgmGlyphCacheView& view)
+{
+    g_glyphLru.Clear();
+    SetToastGlyphBudget(baked->Size);
+    for (size_t i = 0; i < view.glyphCount; ++i) {
+        const BgmCachedGlyph& glyph = view.glyphs[i];
+        if (IsToastGlyphOnDemand(glyph.codepoint) && baked->IsGlyphLoaded((ImWchar)glyph.codepoint))
+            g_glyphLru.Insert(glyph.codepoint, (uint32_t)glyph.width * glyph.height, ++g_glyphTick);
+    }
+}
+
+bool IsToastGlyphInFlight(uint32_t codepoint)
+{
+    return g_glyphsInFlight.count(codepoint) != 0;
+}
+
+void GetToastGlyphsInFlight(std::vector<uint32_t>* outCodepoints)
+{
+    outCodepoints->insert(outCodepoints->end(), g_glyphsInFlight.begin(), g_glyphsInFlight.end());
+}
+
+const BgmGlyphLru& GetToastGlyphLru()
+{
+    return g_glyphLru;
+}
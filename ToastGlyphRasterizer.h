@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <imgui.h>
+
+#include "BgmGlyphCache.h"
+#include "BgmGlyphLru.h"
+
+// =============================================================
+// TOAST GLYPH RASTERIZER
+// =============================================================
+// On-demand glyphs: CJK and other large-script codepoints are left out of the
+// prewarm. A rasterizer thread bakes them the first time a queued toast needs
+// them, the render thread copies them into the atlas, and the least recently
+// used ones are evicted beyond one page. The same thread bakes a map's
+// prewarm set on a cache miss, and the whole font when the toast's scale needs
+// a new bake. Everything below is for the render thread; the rasterizer
+// thread only sees the batches.
+
+constexpr uint32_t TOAST_GLYPH_PAGE_SIZE = 512; // Default page side, in pixels
+
+enum class ToastGlyphBatchKind {
+    OnDemand,  // A toast's CJK glyphs: tracked by the LRU
+    Resident,  // A map's prewarm set: kept for good, not tracked by the LRU
+    Rebake,    // Every glyph of the font's bake, at a new pixel size (UpdateToastScale)
+};
+
+struct ToastGlyphBatch {
+    BgmGlyphCacheKey key;              // codepointHash covers `codepoints`
+    std::vector<uint32_t> codepoints;
+    std::vector<uint8_t> image;        // BgmGlyphCache image, filled in by the rasterizer
+    ToastGlyphBatchKind kind = ToastGlyphBatchKind::OnDemand;
+    bool sdf = false;                  // g_bToastSdf, as the render thread had it
+};
+
+// Called by IngestToastGlyphs for a finished rebake (`valid` if its image
+// opened as `view`). Returns the bake the batches after it go to.
+using ToastRebakeHandler = ImFontBaked* (*)(ImFontAtlas* atlas, ImFontBaked* baked, const ToastGlyphBatch& batch,
+    bool valid, const BgmGlyphCacheView& view);
+
+// [Font] GlyphPageSize: the side of the page on-demand glyphs may fill at
+// TOAST_FONT_SIZE. Set before the first frame.
+void SetToastGlyphPageSize(uint32_t pageSize);
+
+// On-demand glyphs may take one page at TOAST_FONT_SIZE; a larger bake gets
+// as many glyphs in proportionally more surface.
+void SetToastGlyphBudget(float bakedSize);
+
+// Joins the rasterizer thread, if it ever started. At shutdown.
+void StopToastGlyphRasterizer();
+
+// Hands `codepoints` to the rasterizer thread, to be baked at `pixelSize`.
+// Except for a rebake (whose glyphs are loaded already), they must be neither
+// loaded nor in flight yet, and are marked in flight. False if the thread
+// could not be started.
+bool SendToastGlyphBatch(float pixelSize, std::vector<uint32_t> codepoints, ToastGlyphBatchKind kind);
+
+// Sends the on-demand codepoints of `text` that the toast font has but
+// `baked` lacks to the rasterizer thread. Returns true if any of the text's
+// glyphs are in flight (from this request or an earlier one).
+bool RequestToastGlyphs(ImFontBaked* baked, const char* text);
+
+// Copies the batches the rasterizer finished into the atlas and starts
+// tracking their on-demand glyphs in the LRU; hands rebakes to `onRebake`.
+// Never waits for the rasterizer. Call before NewFrame, so nothing in the
+// frame holds on to a replaced bake.
+void IngestToastGlyphs(ToastRebakeHandler onRebake);
+
+// Pins the on-screen title's on-demand glyphs and evicts the least recently
+// used others while they take more than a page. Call with the toast font
+// pushed, after the title was measured (which rasterizes anything missing).
+void TouchToastGlyphs(ImFontBaked* baked, const char* text);
+
+// Restarts the LRU for a new bake of the font, tracking the on-demand glyphs
+// of `view` it holds.
+void ResetToastGlyphLru(ImFontBaked* baked, const BgmGlyphCacheView& view);
+
+// Whether a codepoint was sent to the rasterizer and is not copied in yet.
+bool IsToastGlyphInFlight(uint32_t codepoint);
+
+// Appends every codepoint in flight.
+void GetToastGlyphsInFlight(std::vector<uint32_t>* outCodepoints);
+
+const BgmGlyphLru& GetToastGlyphLru();
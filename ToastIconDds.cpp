@@ -0,0 +1,40 @@
+#define NOMINMAX
+#include <windows.h>
+
+#include <cstring>
+
+#include <DirectXTex.h>
+
+#include "ModUtil.h"
+#include "ToastIcons.h"
+
+// bgm_info.dds is BC7, which DirectXTK cannot decode; DirectXTex can, on the CPU.
+bool LoadToastIconImage(const std::string& path, ToastIconImage* out)
+{
+    std::wstring pathW(path.begin(), path.end());
+    DirectX::TexMetadata metadata;
+    DirectX::ScratchImage file;
+    HRESULT hr = DirectX::LoadFromDDSFile(pathW.c_str(), DirectX::DDS_FLAGS_NONE, &metadata, file);
+    if (FAILED(hr))
+        return false;
+
+    const DirectX::Image* image = file.GetImage(0, 0, 0);
+    DirectX::ScratchImage rgba;
+    if (image->format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+        if (DirectX::IsCompressed(image->format))
+            hr = DirectX::Decompress(*image, DXGI_FORMAT_R8G8B8A8_UNORM, rgba);
+        else
+            hr = DirectX::Convert(*image, DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, rgba);
+        if (FAILED(hr)) {
+            Log("Failed to decode " + path + " to RGBA! HR: " + std::to_string(hr));
+            return false;
+        }
+        image = rgba.GetImage(0, 0, 0);
+    }
+
+    out->width = (int)image->width;
+    out->height = (int)image->height;
+    out->pitch = image->rowPitch;
+    out->pixels.assign(image->pixels, image->pixels + image->rowPitch * image->height);
+    return true;
+}
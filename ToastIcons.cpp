@@ -0,0 +1,71 @@
+#include <cstring>
+#include <string>
+
+#include "ModUtil.h"
+#include "ToastIcons.h"
+
+const char* const TOAST_ICON_FILES[(size_t)ToastIcon::Count] = {
+    "bgm_info.dds", "bgm_info_battle.dds", "bgm_info_dungeon.dds", "bgm_info_field.dds", "bgm_info_event.dds", "bgm_info_town.dds",
+};
+static ImFontAtlasRectId g_toastIconRects[(size_t)ToastIcon::Count] = {
+    ImFontAtlasRectId_Invalid, ImFontAtlasRectId_Invalid, ImFontAtlasRectId_Invalid,
+    ImFontAtlasRectId_Invalid, ImFontAtlasRectId_Invalid, ImFontAtlasRectId_Invalid,
+};
+
+ImFontAtlasRectId AddToastIconRect(ImFontAtlas* atlas, const ToastIconImage& image)
+{
+    ImFontAtlasRect rect;
+    ImFontAtlasRectId id = atlas->AddCustomRect(image.width, image.height, &rect);
+    if (id == ImFontAtlasRectId_Invalid)
+        return ImFontAtlasRectId_Invalid;
+    ImTextureData* texture = atlas->TexData;
+    for (int y = 0; y < rect.h; ++y)
+        memcpy(texture->GetPixelsAt(rect.x, rect.y + y), image.pixels.data() + y * image.pitch, (size_t)rect.w * 4);
+    ImFontAtlasTextureBlockQueueUpload(atlas, texture, rect.x, rect.y, rect.w, rect.h);
+    return id;
+}
+
+void AddToastIcons(ImFontAtlas* atlas)
+{
+    IM_ASSERT(atlas->TexDesiredFormat == ImTextureFormat_RGBA32);
+    int categoryIcons = 0;
+    for (size_t i = 0; i < (size_t)ToastIcon::Count; ++i)
+    {
+        ToastIconImage image;
+        g_toastIconRects[i] = LoadToastIconImage(GetModAssetPath(TOAST_ICON_FILES[i]), &image) ?
+            AddToastIconRect(atlas, image) : ImFontAtlasRectId_Invalid;
+        if (i == (size_t)ToastIcon::Note) {
+            if (g_toastIconRects[i] == ImFontAtlasRectId_Invalid)
+                Log("Failed to load bgm_info.dds from file!");
+        } else if (g_toastIconRects[i] != ImFontAtlasRectId_Invalid) {
+            ++categoryIcons;
+        } else {
+            g_toastIconRects[i] = g_toastIconRects[(size_t)ToastIcon::Note];
+        }
+    }
+
+    ImFontAtlasRect rect;
+    if (atlas->GetCustomRect(g_toastIconRects[(size_t)ToastIcon::Note], &rect))
+        Log("Toast icons packed into the font atlas: note " + std::to_string(rect.w) + "x" + std::to_string(rect.h) +
+            ", " + std::to_string(categoryIcons) + " category icon(s).");
+}
+
+ToastIcon GetToastIcon(const char* key)
+{
+    const char* stem = strstr(key, "y8_");
+    if (!stem || stem[3] == '\0' || stem[4] < '0' || stem[4] > '9')
+        return ToastIcon::Note;
+    switch (stem[3]) {
+    case 'b': return ToastIcon::Battle;
+    case 'd': return ToastIcon::Dungeon;
+    case 'f': return ToastIcon::Field;
+    case 'e': return ToastIcon::Event;
+    case 't': return ToastIcon::Town;
+    default: return ToastIcon::Note;
+    }
+}
+
+bool GetToastIconRect(ImFontAtlas* atlas, ToastIcon icon, ImFontAtlasRect* out)
+{
+    return atlas->GetCustomRect(g_toastIconRects[(size_t)icon], out);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+#include <imgui_internal.h> // ImFontAtlasRectId
+
+// =============================================================
+// TOAST ICONS
+// =============================================================
+// Toast icons, packed into the font atlas beside the glyphs so the whole toast
+// draws from one texture: the note icon, and optionally one per track category
+// (the letter after "y8_" in the file name). Categories without their own icon
+// share the note's rect. Render thread only.
+
+enum class ToastIcon : uint8_t { Note, Battle, Dungeon, Field, Event, Town, Count };
+
+extern const char* const TOAST_ICON_FILES[(size_t)ToastIcon::Count]; // In the assets directory
+
+// An icon's top mip as RGBA8, rows `pitch` bytes apart.
+struct ToastIconImage {
+    int width = 0;
+    int height = 0;
+    size_t pitch = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Decodes a DDS file's top mip (block-compressed ones included) to RGBA.
+// False if it is missing; a file that does not decode is also logged.
+// ToastIconDds.cpp has the DirectXTex version; host tests define their own.
+bool LoadToastIconImage(const std::string& path, ToastIconImage* out);
+
+// Copies `image` into a new custom rect of `atlas` (RGBA32) and queues its
+// upload. ImGui carries custom rects' pixels across atlas growth and repacks;
+// only their UVs move. ImFontAtlasRectId_Invalid if it does not fit.
+ImFontAtlasRectId AddToastIconRect(ImFontAtlas* atlas, const ToastIconImage& image);
+
+// Packs the note icon and whichever category icons exist into the atlas. The
+// atlas stays RGBA32, so the icons keep their color.
+void AddToastIcons(ImFontAtlas* atlas);
+
+// Category of a track from its file name: "bgm\y8_b006.ogg" is a battle theme.
+// Anything else ("y8_title", "y8_op", keys from other games) gets the note.
+ToastIcon GetToastIcon(const char* key);
+
+// The rect (with its current UVs) `icon` draws from. False if not even the
+// note icon loaded.
+bool GetToastIconRect(ImFontAtlas* atlas, ToastIcon icon, ImFontAtlasRect* out);
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <imgui_internal.h> // Font atlas builder API
+
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGlyphCache.h"
+#include "ToastScale.h"
+
+float g_toastScale = 1.0f;
+static float g_toastRebakeSize = 0.0f; // Pixel size on the rasterizer thread, 0 if none
+
+// Replaces the toast font's bake with a finished rebake. Glyphs the old bake
+// got after the rebake was sent go with it; toasts ask for them again.
+static ImFontBaked* SwapToastBake(ImFontAtlas* atlas, ImFontBaked* oldBaked, float pixelSize, const BgmGlyphCacheView& view)
+{
+    // Repacked without the old glyphs (cheap: little else is left) and straight
+    // to a size with room for the new ones, which growing glyph by glyph would
+    // copy the whole texture for several times over
+    ImFontAtlasBakedDiscard(atlas, g_pToastFont, oldBaked);
+    ImFontAtlasBuilder* builder = atlas->Builder;
+    int padding = atlas->TexGlyphPadding;
+    int surface = builder->RectsPackedSurface - builder->RectsDiscardedSurface;
+    for (size_t i = 0; i < view.glyphCount; ++i)
+        surface += (view.glyphs[i].width + padding) * (view.glyphs[i].height + padding);
+    surface += surface / 4; // Packing slack
+    int width = std::clamp(ImUpperPowerOfTwo((int)sqrtf((float)surface)), atlas->TexMinWidth, atlas->TexMaxWidth);
+    int height = std::clamp(ImUpperPowerOfTwo((surface + width - 1) / width), atlas->TexMinHeight, atlas->TexMaxHeight);
+    ImFontAtlasTextureRepack(atlas, width, height);
+    g_toastBakedSize = pixelSize;
+    ImFontBaked* baked = GetToastBaked(); // Nothing left to match: creates it
+    int added = AddToastGlyphs(atlas, baked, view);
+    ResetToastGlyphLru(baked, view);
+
+    ImTextureData* texture = atlas->TexData;
+    Log("Toast font rebaked at " + std::to_string((int)pixelSize) + " px for " + std::to_string((int)g_toastFontSize) +
+        " px text: " + std::to_string(added) + " glyph(s), atlas " +
+        (texture ? std::to_string(texture->Width) + "x" + std::to_string(texture->Height) : std::string("n/a")) + ".");
+    return baked;
+}
+
+ImFontBaked* ApplyToastRebake(ImFontAtlas* atlas, ImFontBaked* baked, const ToastGlyphBatch& batch, bool valid,
+    const BgmGlyphCacheView& view)
+{
+    g_toastRebakeSize = 0.0f;
+    if (valid && batch.key.pixelSize == GetToastBakeSize(g_toastFontSize))
+        return SwapToastBake(atlas, baked, batch.key.pixelSize, view);
+    return baked;
+}
+
+void UpdateToastScale(float displayHeight)
+{
+    if (displayHeight > 0.0f)
+        g_toastScale = std::clamp(displayHeight / TOAST_REFERENCE_HEIGHT, TOAST_SCALE_MIN, TOAST_SCALE_MAX);
+    g_toastFontSize = IM_ROUND(TOAST_FONT_SIZE * g_toastScale);
+    if (!g_pToastFont)
+        return;
+
+    float bakeSize = GetToastBakeSize(g_toastFontSize);
+    if (g_toastBakedSize == 0.0f) {
+        // Before NewFrame asks for the font at its nominal size and bakes that
+        g_toastBakedSize = bakeSize;
+        GetToastBaked();
+        SetToastGlyphBudget(bakeSize);
+        Log("Toast scale " + std::to_string(g_toastScale) + ": " + std::to_string((int)g_toastFontSize) + " px text, font baked at " +
+            std::to_string((int)bakeSize) + " px.");
+        return;
+    }
+    if (bakeSize == g_toastBakedSize || g_toastRebakeSize != 0.0f)
+        return;
+
+    // Everything the bake has or is about to get
+    ImFontBaked* baked = GetToastBaked();
+    std::vector<uint32_t> codepoints;
+    GetToastGlyphsInFlight(&codepoints);
+    for (const ImFontGlyph& glyph : baked->Glyphs)
+        codepoints.push_back(glyph.Codepoint);
+    std::sort(codepoints.begin(), codepoints.end());
+    codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
+
+    static bool s_warned = false;
+    if (SendToastGlyphBatch(bakeSize, std::move(codepoints), ToastGlyphBatchKind::Rebake)) {
+        g_toastRebakeSize = bakeSize;
+    } else if (!s_warned) {
+        Log("UpdateToastScale: no rasterizer thread; the toast font stays baked at " + std::to_string((int)g_toastBakedSize) + " px.");
+        s_warned = true;
+    }
+}
+
+bool IsToastRebakeInFlight()
+{
+    return g_toastRebakeSize != 0.0f;
+}
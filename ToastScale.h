@@ -0,0 +1,38 @@
+#pragma once
+
+#include <imgui.h>
+
+#include "BgmGlyphCache.h"
+#include "ToastGlyphRasterizer.h"
+
+// =============================================================
+// TOAST SCALE
+// =============================================================
+// Resolution-aware scaling: the toast is laid out for a TOAST_REFERENCE_HEIGHT
+// back buffer and scaled with its height. The font keeps a single bake, which
+// ImGui scales to the draw size; when the draw size moves past what that bake
+// serves (GetToastBakeSize), the rasterizer thread rebakes every glyph at the
+// new size and the render thread swaps it in before a NewFrame. Render thread
+// only.
+
+constexpr float TOAST_REFERENCE_HEIGHT = 1080.0f;
+constexpr float TOAST_SCALE_MIN = 0.5f;
+constexpr float TOAST_SCALE_MAX = 4.0f;
+
+extern float g_toastScale; // Back buffer height / TOAST_REFERENCE_HEIGHT, clamped
+
+// Per active frame, before IngestToastGlyphs and NewFrame: scales the toast
+// with the back buffer's height. The first call picks the size the font is
+// baked at. After that, a draw size the bake no longer serves sends a rebake
+// of all its glyphs to the rasterizer thread (one at a time); until it lands
+// ImGui keeps scaling the old bake, so Present never waits for it.
+void UpdateToastScale(float displayHeight);
+
+// IngestToastGlyphs' handler for a finished rebake: swaps it in if it still
+// matches the draw size. Outdated if the display changed again meanwhile; the
+// next UpdateToastScale sends another.
+ImFontBaked* ApplyToastRebake(ImFontAtlas* atlas, ImFontBaked* baked, const ToastGlyphBatch& batch, bool valid,
+    const BgmGlyphCacheView& view);
+
+// Whether a rebake is on the rasterizer thread and not swapped in or dropped yet.
+bool IsToastRebakeInFlight();
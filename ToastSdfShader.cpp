@@ -0,0 +1,77 @@
+#include <cstring>
+#include <string>
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#pragma comment(lib, "d3dcompiler.lib")
+
+#include <imgui_impl_dx11.h>
+
+#include "ModUtil.h"
+#include "ToastGlyphLoader.h"
+#include "ToastSdfShader.h"
+
+static ID3D11PixelShader* g_pSdfPixelShader = nullptr;
+
+// Draws distance-field glyphs: the field (in alpha, see BgmGlyphSdf.h) is cut
+// at the outline and antialiased over about one screen pixel at any scale.
+// Same inputs as the ImGui backend's pixel shader; TOAST_SDF_ON_EDGE is
+// defined when it is compiled.
+static const char* TOAST_SDF_PIXEL_SHADER =
+    "struct PS_INPUT\n"
+    "{\n"
+    "    float4 pos : SV_POSITION;\n"
+    "    float4 col : COLOR0;\n"
+    "    float2 uv  : TEXCOORD0;\n"
+    "};\n"
+    "sampler sampler0;\n"
+    "Texture2D texture0;\n"
+    "\n"
+    "float4 main(PS_INPUT input) : SV_Target\n"
+    "{\n"
+    "    float field = texture0.Sample(sampler0, input.uv).a;\n"
+    "    float edge = TOAST_SDF_ON_EDGE / 255.0;\n"
+    "    float width = max(fwidth(field) * 0.5, 1.0 / 255.0);\n"
+    "    float coverage = smoothstep(edge - width, edge + width, field);\n"
+    "    return float4(input.col.rgb, input.col.a * coverage);\n"
+    "}\n";
+
+bool CreateToastSdfShader(ID3D11Device* device)
+{
+    std::string onEdge = std::to_string(TOAST_SDF_ON_EDGE) + ".0";
+    const D3D_SHADER_MACRO defines[] = { { "TOAST_SDF_ON_EDGE", onEdge.c_str() }, { nullptr, nullptr } };
+    ID3DBlob* blob = nullptr;
+    ID3DBlob* errors = nullptr;
+    HRESULT hr = D3DCompile(TOAST_SDF_PIXEL_SHADER, strlen(TOAST_SDF_PIXEL_SHADER), "ToastSdf", defines, nullptr,
+        "main", "ps_4_0", 0, 0, &blob, &errors);
+    if (FAILED(hr)) {
+        Log("SDF shader failed to compile, HR: " + std::to_string(hr) +
+            (errors ? ": " + std::string((const char*)errors->GetBufferPointer(), errors->GetBufferSize()) : std::string()));
+        if (errors) errors->Release();
+        return false;
+    }
+    if (errors) errors->Release();
+
+    hr = device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, &g_pSdfPixelShader);
+    blob->Release();
+    if (FAILED(hr)) {
+        Log("CreatePixelShader failed for the SDF shader, HR: " + std::to_string(hr));
+        return false;
+    }
+    return true;
+}
+
+void ReleaseToastSdfShader()
+{
+    if (g_pSdfPixelShader) {
+        g_pSdfPixelShader->Release();
+        g_pSdfPixelShader = nullptr;
+    }
+}
+
+void SetToastSdfShader(const ImDrawList*, const ImDrawCmd*)
+{
+    // Only ever called from within ImGui_ImplDX11_RenderDrawData
+    ImGui_ImplDX11_RenderState* state = (ImGui_ImplDX11_RenderState*)ImGui::GetPlatformIO().Renderer_RenderState;
+    state->DeviceContext->PSSetShader(g_pSdfPixelShader, nullptr, 0);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <imgui.h>
+
+struct ID3D11Device;
+
+// =============================================================
+// TOAST SDF SHADER
+// =============================================================
+// The pixel shader distance-field glyphs (ToastGlyphLoader.h) draw with,
+// swapped in for the ImGui backend's around the toast's text. Render thread.
+// Only names the device type, so ToastGeometry.cpp builds off Windows too
+// (host tests define the callback themselves).
+
+// Compiles the shader on `device`. False (and logged) if it does not build;
+// the toast font is then baked as plain bitmaps.
+bool CreateToastSdfShader(ID3D11Device* device);
+
+void ReleaseToastSdfShader();
+
+// ImDrawList callback: the commands after it draw with the SDF shader, until
+// an ImDrawCallback_ResetRenderState puts the backend's back.
+void SetToastSdfShader(const ImDrawList* drawList, const ImDrawCmd* cmd);
@@ -1,17 +1,15 @@
 #define NOMINMAX
 #include <windows.h>
-#include <shlwapi.h>
-#pragma comment(lib, "shlwapi.lib")
 
 #include <d3d11.h>
+#include <dxgi1_4.h> // IDXGISwapChain3::ResizeBuffers1
 #pragma comment(lib, "d3d11.lib")
-#include <DDSTextureLoader.h>
-#include <DirectXTex.h>
 #pragma comment(lib, "dxguid.lib")
 
 #include <MinHook.h>
 
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <fstream>
 #include <chrono>
@@ -20,139 +18,531 @@
 #include <thread>
 #include <algorithm>
 #include <queue>
-#include <mutex>
+#include <deque>
+#include <string_view>
 #include <atomic>
 
 #include <yaml-cpp/yaml.h>
 
 #include <imgui.h>
+#include <imgui_internal.h> // Font atlas builder API, for the glyph cache
 #include <imgui_impl_win32.h>
 #include <imgui_impl_dx11.h>
 
-// =============================================================
-// LOGGING HELPER
-// =============================================================
-void Log(const std::string& message) {
-    std::ofstream log_file("mod_log.txt", std::ios_base::app | std::ios_base::out);
-    auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    char time_str[26];
-    ctime_s(time_str, sizeof(time_str), &time);
-    time_str[24] = '\0';
-    log_file << "[" << time_str << "] " << message << std::endl;
-}
+#include "BgmBackBufferCache.h"
+#include "BgmEventRing.h"
+#include "BgmGlyphCache.h"
+#include "BgmGlyphLru.h"
+#include "BgmIndex.h"
+#include "BgmMapBuiltin.h"
+#include "BgmMapCache.h"
+#include "BgmMapParser.h"
+#include "BgmPathClassifier.h"
+#include "BgmSnapshot.h"
+#include "BgmToastQueue.h"
+#include "BgmToastState.h"
+#include "BgmTrackStore.h"
+#include "BgmWakeup.h"
+#include "ModUtil.h"
+#include "ToastFont.h"
+#include "ToastGeometry.h"
+#include "ToastGlyphCache.h"
+#include "ToastGlyphRasterizer.h"
+#include "ToastIcons.h"
+#include "ToastScale.h"
+#include "ToastSdfShader.h"
 
 void WCharToString(const WCHAR* wstr, char* buffer, size_t bufferSize) {
     if (!wstr || !buffer) return;
-    WideCharToMultiByte(CP_UTF8, 0, wstr, -1, buffer, (int)bufferSize, NULL, NULL);
+    if (WideCharToMultiByte(CP_UTF8, 0, wstr, -1, buffer, (int)bufferSize, NULL, NULL) == 0)
+        buffer[0] = '\0'; // Conversion failed or path too long
 }
 
 // =============================================================
 // GLOBAL VARIABLES
 // =============================================================
-struct BgmInfo {
-    std::string songName;
-    std::string disc;
-    std::string track;
-    std::string rawFileName; // Added to track filename for position logic
-};
+// Current map snapshot; read through BgmRcuPointer::ReadGuard, replaced by LoadBgmMap
+static BgmRcuPointer<BgmMapSnapshot> g_bgmSnapshot;
+static uint32_t g_bgmSnapshotGeneration = 0; // LoadBgmMap only
 
-static std::map<std::string, BgmInfo> g_bgmMap;
-static BgmInfo g_currentBgmInfo;
-static std::map<std::string, std::chrono::steady_clock::time_point> g_songLastShown;
-static std::string g_lastTriggeredFile = "";
+// Latest triggered track and a serial bumped per toast request; written by
+// ProcessBgmTrigger and LoadBgmMap, read once per frame by My_Present
+static BgmSeqlock<BgmToastState> g_toastState;
+static std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> g_songLastShown; // By title hash
+static uint16_t g_lastTriggeredTrack = BGM_INVALID_TRACK_ID;
+static uint32_t g_lastTriggeredGeneration = 0;
 
 // MODIFIED: Switched to float timer for seconds
+// Animation state below is owned by the render thread
 static float g_toastTimer = 0.0f;
 constexpr float TOAST_DURATION_SECONDS = 5.0f; // 8 seconds, independent of FPS
 constexpr int COOLDOWN_HOURS = 5;
 
 // MODIFIED: Changed reset value to be far offscreen for logic
 static float g_toastCurrentX = -10000.0f;
+static uint32_t g_toastShownSerial = 0; // Last BgmToastState::serial queued
+
+// Toast requests waiting for the visible one to slide out (render thread only)
+constexpr size_t TOAST_QUEUE_CAPACITY = 4;
+static BgmToastQueue<BgmToastState, TOAST_QUEUE_CAPACITY> g_toastQueue(BgmToastPolicy::Coalesce, 2.0);
+
+// Toast font glyph prewarming: LoadBgmMap publishes the generation whose
+// title codepoints should be baked; the render thread catches up a few glyphs
+// per frame (see PrewarmToastGlyphs)
+constexpr char TOAST_FIXED_GLYPHS[] = "Disc, Track 0123456789"; // The second toast line
+constexpr size_t TOAST_GLYPH_PREWARM_PER_FRAME = 16;           // Newly rasterized glyphs per Present
+static std::atomic<uint32_t> g_glyphGeneration = 0;
+static uint32_t g_prewarmedGeneration = 0;                      // Render thread only
+
+// Present frames that skipped ImGui (nothing to show) vs. ran it (render thread only)
+static uint64_t g_idleFrames = 0;
+static uint64_t g_activeFrames = 0;
+static std::atomic<bool> g_bImGuiFrameSkipped = false; // Last Present took the idle path
+constexpr float MAX_RESUME_DELTA_SECONDS = 1.0f / 30.0f;
 
 // Graphics / ImGui Globals
 static bool g_imguiInitialized = false;
 static HWND g_hWindow = nullptr;
 static ID3D11Device* g_pd3dDevice = nullptr;
 static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
-static ID3D11RenderTargetView* g_pd3dRenderTargetView = nullptr;
-static ImFont* g_pToastFont = nullptr;
-static ID3D11ShaderResourceView* g_pToastTexture = nullptr;
-static ID3D11Resource* g_pToastResource = nullptr;
-static float g_TextureWidth = 0.0f;
-static float g_TextureHeight = 0.0f;
 
 // Threading Globals (Producer-Consumer)
+constexpr size_t BGM_EVENT_RING_CAPACITY = 64;
+constexpr size_t BGM_EVENT_BATCH_SIZE = 16;
 static std::thread g_workerThread;
-static std::mutex g_bufferMutex;
-static char g_bgmFilenameBuffer[MAX_PATH];
-static std::atomic<bool> g_bNewBgmAvailable = false;
+static BgmEventRing<BGM_EVENT_RING_CAPACITY> g_bgmEventRing;
 static std::atomic<bool> g_bWorkerThreadActive = true;
 
+// Win32 auto-reset event for BgmWakeup. Without a handle the worker polls.
+struct BgmWorkerSignal {
+    HANDLE handle = nullptr;
+    void Set() { if (handle) SetEvent(handle); }
+    void Wait()
+    {
+        if (handle) WaitForSingleObject(handle, INFINITE);
+        else std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+};
+static BgmWakeup<BgmWorkerSignal> g_bgmWorkerWakeup; // Detours wake the worker through this
+static std::thread g_mapWatcherThread;
+static std::atomic<bool> g_bMapWatcherActive = false;
+
+// .ogg paths Detour_CreateFileA could not resolve (voice lines, sound effects,
+// tracks missing from the map). Logged by the map watcher thread on its next
+// poll, so they neither touch the log file on the game's I/O thread nor wake
+// the BGM worker.
+constexpr size_t BGM_PATH_LOG_RING_CAPACITY = 32;
+static BgmEventRing<BGM_PATH_LOG_RING_CAPACITY, BgmPathLogEvent> g_pathLogRing;
+
+// Inline mode: the keys ProcessBgmEventBatch and ProcessBgmTrigger log, which
+// would otherwise open the log file inside My_Present. Logged by the map
+// watcher thread with the paths above.
+enum class BgmTriggerLogKind : uint8_t { Caught, Match };
+
+struct BgmTriggerLogEvent {
+    BgmTriggerLogKind kind = BgmTriggerLogKind::Match;
+    char key[BGM_LOGGED_PATH_CHARS] = {}; // NUL-terminated
+};
+
+static BgmEventRing<BGM_PATH_LOG_RING_CAPACITY, BgmTriggerLogEvent> g_triggerLogRing;
+
+// Where captured events are matched, chosen once at startup (see LoadModConfig)
+enum class BgmTriggerMode { Worker, Inline };
+static BgmTriggerMode g_triggerMode = BgmTriggerMode::Worker;
+static std::chrono::microseconds g_inlineTriggerBudget{200}; // Per Present, inline mode only
+constexpr size_t BGM_INLINE_BATCH_SIZE = 4;                   // Budget is checked between batches
+
+// Basename prefilter counters (hits = passed the Bloom filter, misses =
+// rejected by it, false positives = passed but resolved to no map key)
+static std::atomic<uint64_t> g_filterHits = 0;
+static std::atomic<uint64_t> g_filterMisses = 0;
+static std::atomic<uint64_t> g_filterFalsePositives = 0;
+
 // =============================================================
 // HELPER FUNCTIONS
 // =============================================================
-std::string GetModDirectory()
+// Reads assets/BgmToast.ini once at startup. A missing file keeps the defaults:
+//   [Trigger]
+//   Mode=worker         ; or "inline": match events inside Present, no worker thread
+//   InlineBudgetUs=200  ; inline mode: max time per frame, the rest waits a frame
+//   [Toast]
+//   Policy=coalesce     ; or "replace" / "enqueue" (see BgmToastQueue.h)
+//   CoalesceWindowMs=2000
+//   [Font]
+//   GlyphPageSize=512   ; on-demand (CJK) glyphs beyond a page this size are evicted
+//   Sdf=1               ; 0: plain coverage bitmaps instead of distance fields
+void LoadModConfig()
 {
-    char path[MAX_PATH];
-    HMODULE hModule = NULL;
-    GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
-        GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-        (LPCSTR)&GetModDirectory, &hModule);
+    std::string iniPath = GetModDirectory() + "\\assets\\BgmToast.ini";
+
+    char mode[16];
+    GetPrivateProfileStringA("Trigger", "Mode", "worker", mode, sizeof(mode), iniPath.c_str());
+    g_triggerMode = _stricmp(mode, "inline") == 0 ? BgmTriggerMode::Inline : BgmTriggerMode::Worker;
+
+    UINT budget = GetPrivateProfileIntA("Trigger", "InlineBudgetUs", 200, iniPath.c_str());
+    g_inlineTriggerBudget = std::chrono::microseconds(std::clamp(budget, 20u, 5000u));
+
+    if (g_triggerMode == BgmTriggerMode::Inline)
+        Log("Trigger mode: inline, " + std::to_string(g_inlineTriggerBudget.count()) + " us per frame.");
+    else
+        Log("Trigger mode: worker thread.");
+
+    char policy[16];
+    GetPrivateProfileStringA("Toast", "Policy", "coalesce", policy, sizeof(policy), iniPath.c_str());
+    BgmToastPolicy toastPolicy = BgmToastPolicy::Coalesce;
+    if (_stricmp(policy, "replace") == 0) toastPolicy = BgmToastPolicy::Replace;
+    else if (_stricmp(policy, "enqueue") == 0) toastPolicy = BgmToastPolicy::Enqueue;
 
-    GetModuleFileNameA(hModule, path, MAX_PATH);
-    PathRemoveFileSpecA(path);
-    return std::string(path);
+    UINT windowMs = GetPrivateProfileIntA("Toast", "CoalesceWindowMs", 2000, iniPath.c_str());
+    g_toastQueue.Configure(toastPolicy, std::min(windowMs, 60000u) / 1000.0);
+    const char* POLICY_NAMES[] = { "replace", "enqueue", "coalesce" };
+    Log("Toast policy: " + std::string(POLICY_NAMES[(int)toastPolicy]) + ", coalesce window " + std::to_string(windowMs) + " ms.");
+
+    UINT pageSize = GetPrivateProfileIntA("Font", "GlyphPageSize", TOAST_GLYPH_PAGE_SIZE, iniPath.c_str());
+    SetToastGlyphPageSize(std::clamp(pageSize, 128u, 2048u));
+
+    g_bToastSdf = GetPrivateProfileIntA("Font", "Sdf", 1, iniPath.c_str()) != 0;
 }
 
-void LoadBgmMap()
+static void UseBuiltinBgmMap(BgmMapSnapshot* snapshot)
 {
-    std::string modDir = GetModDirectory();
-    std::string yamlPath = modDir + "\\assets/BgmMap.yaml";
+    snapshot->store.Attach(GetBuiltinBgmTrackTables());
+    snapshot->index.Attach(GetBuiltinBgmIndexTables());
+    snapshot->sourceHash = BGM_BUILTIN_SOURCE_HASH;
+}
+
+// Maps assets/BgmMap.cache and uses its tables in place if it was built from
+// the same YAML bytes. The snapshot keeps the view mapped until it is reclaimed.
+static bool TryLoadBgmMapCache(const std::string& cachePath, uint64_t sourceHash, BgmMapSnapshot* snapshot)
+{
+    HANDLE hFile = CreateFileA(cachePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
 
-    try
+    LARGE_INTEGER fileSize = {};
+    const void* view = nullptr;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0)
     {
-        std::ifstream file(yamlPath);
-        if (!file.is_open())
+        HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hMapping)
         {
-            Log("LoadBgmMap: BgmMap.yaml not found.");
-            return;
+            view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(hMapping); // The view keeps the mapping alive
         }
+    }
+    CloseHandle(hFile);
+    if (!view) return false;
+
+    BgmTrackStoreTables store;
+    BgmTrackIndexTables index;
+    if (!OpenBgmMapCache(view, (size_t)fileSize.QuadPart, sourceHash, &store, &index))
+    {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    snapshot->store.Attach(store);
+    snapshot->index.Attach(index);
+    snapshot->backing = std::shared_ptr<const void>(view, [](const void* p) { UnmapViewOfFile(p); });
+    snapshot->sourceHash = sourceHash;
+    return true;
+}
+
+static void WriteBgmMapCache(const std::string& cachePath, const BgmMapSnapshot& snapshot)
+{
+    std::vector<uint8_t> image;
+    BuildBgmMapCache(snapshot.store.GetTables(), snapshot.index.GetTables(), snapshot.sourceHash, &image);
+
+    if (WriteCacheFile(cachePath, image, "LoadBgmMap"))
+        Log("LoadBgmMap: Wrote BgmMap.cache (" + std::to_string(image.size()) + " bytes).");
+}
 
-        YAML::Node config = YAML::Load(file);
-        for (const auto& node : config)
+// Builds a snapshot for assets/BgmMap.yaml, or returns null if the file's
+// bytes match the published snapshot (or it cannot be parsed and a snapshot
+// is already published). Sets *outWriteCache if the result was parsed.
+static std::unique_ptr<BgmMapSnapshot> BuildBgmMapSnapshot(const std::string& yamlPath, const std::string& cachePath,
+    uint64_t publishedHash, bool* outWriteCache)
+{
+    *outWriteCache = false;
+    auto snapshot = std::make_unique<BgmMapSnapshot>();
+
+    // One read into a buffer that the parser borrows: keys and titles stay
+    // views into it until BgmTrackStore::Add copies them into its pool.
+    std::vector<char> source;
+    {
+        std::ifstream file(yamlPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
         {
-            std::string filepath = node.first.as<std::string>();
-            std::string value = node.second.as<std::string>();
+            if (publishedHash == BGM_BUILTIN_SOURCE_HASH) return nullptr;
+            UseBuiltinBgmMap(snapshot.get());
+            Log("LoadBgmMap: BgmMap.yaml not found, using the built-in map (" + std::to_string(snapshot->store.GetCount()) + " entries).");
+            return snapshot;
+        }
+        source.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(source.data(), (std::streamsize)source.size());
+    }
+
+    uint64_t sourceHash = HashBgmMapSource(source.data(), source.size());
+    if (sourceHash == publishedHash) return nullptr;
+
+    // An unmodified copy of the shipped map needs no parsing at all.
+    if (sourceHash == BGM_BUILTIN_SOURCE_HASH)
+    {
+        UseBuiltinBgmMap(snapshot.get());
+        Log("LoadBgmMap: BgmMap.yaml matches the built-in map (" + std::to_string(snapshot->store.GetCount()) + " entries).");
+        return snapshot;
+    }
 
-            // MODIFIED: Parse "Song Name|Disc|Track"
-            BgmInfo info;
-            info.rawFileName = filepath; // Store the key
+    // Edited map that was already compiled by an earlier launch
+    if (TryLoadBgmMapCache(cachePath, sourceHash, snapshot.get()))
+    {
+        Log("LoadBgmMap: Using BgmMap.cache (" + std::to_string(snapshot->store.GetCount()) + " entries).");
+        return snapshot;
+    }
 
-            size_t pos1 = value.find('|');
-            size_t pos2 = value.find('|', pos1 + 1);
+    // Edited map: start from the built-in entries and let the file override
+    // or extend them. Entries are views into the built-in tables, `source`,
+    // the parser, or (yaml-cpp only) `yamlStrings`.
+    struct MapEntry {
+        std::string_view key;
+        std::string_view songName;
+        uint8_t disc = 0;
+        uint8_t track = 0;
+    };
+    std::vector<MapEntry> entries;
+    std::unordered_map<std::string_view, size_t> entryByKey;
+    std::deque<std::string> yamlStrings;
+
+    BgmTrackStore builtin;
+    builtin.Attach(GetBuiltinBgmTrackTables());
+    for (uint16_t id = 0; id < builtin.GetCount(); ++id)
+    {
+        entryByKey[builtin.GetKey(id)] = entries.size();
+        entries.push_back({ builtin.GetKey(id), builtin.GetTitle(id), builtin.GetDisc(id), builtin.GetTrackNumber(id) });
+    }
 
-            if (pos1 != std::string::npos && pos2 != std::string::npos)
-            {
-                info.songName = value.substr(0, pos1);
-                info.disc = value.substr(pos1 + 1, pos2 - pos1 - 1);
-                info.track = value.substr(pos2 + 1);
-            }
-            else
+    auto addEntry = [&](const MapEntry& entry) {
+        auto it = entryByKey.find(entry.key);
+        if (it != entryByKey.end()) {
+            entries[it->second] = entry;
+        } else {
+            entryByKey[entry.key] = entries.size();
+            entries.push_back(entry);
+        }
+    };
+
+    // A typo while editing keeps the map that is already running
+    auto rejectSource = [&](const std::string& reason) -> std::unique_ptr<BgmMapSnapshot> {
+        if (publishedHash != 0) {
+            Log("LoadBgmMap: " + reason + "; keeping the current map.");
+            return nullptr;
+        }
+        Log("LoadBgmMap: " + reason + "; using the built-in map.");
+        UseBuiltinBgmMap(snapshot.get());
+        return std::move(snapshot);
+    };
+
+    // Plain "path: title|disc|track" lines are read in place; yaml-cpp only
+    // sees files that use other YAML features.
+    BgmMapParser parser;
+    BgmMapParseStatus status = parser.Parse(source.data(), source.size());
+    if (status == BgmMapParseStatus::Error)
+    {
+        return rejectSource("BgmMap.yaml:" + std::to_string(parser.GetLine()) + ":" + std::to_string(parser.GetColumn()) +
+            ": " + parser.GetMessage());
+    }
+    if (status == BgmMapParseStatus::Ok)
+    {
+        for (const BgmMapParsedEntry& parsed : parser.GetEntries())
+        {
+            if (!parsed.wellFormed)
+                Log("LoadBgmMap: BgmMap.yaml:" + std::to_string(parsed.line) + ": Value for '" + std::string(parsed.key) +
+                    "' is not \"title|disc|track\"; showing the parts that parse.");
+            addEntry({ parsed.key, parsed.title, parsed.disc, parsed.track });
+        }
+    }
+    else
+    {
+        Log("LoadBgmMap: BgmMap.yaml:" + std::to_string(parser.GetLine()) + ": " + parser.GetMessage() +
+            "; parsing the file with yaml-cpp.");
+        try
+        {
+            YAML::Node config = YAML::Load(std::string(source.data(), source.size()));
+            for (const auto& node : config)
             {
-                // Fallback if format is wrong
-                info.songName = value;
-                info.disc = "";
-                info.track = "";
+                MapEntry entry;
+                entry.key = yamlStrings.emplace_back(node.first.as<std::string>());
+                const std::string& value = yamlStrings.emplace_back(node.second.as<std::string>());
+
+                if (!ParseBgmValue(value, &entry.songName, &entry.disc, &entry.track))
+                    Log("LoadBgmMap: Value for '" + std::string(entry.key) + "' is not \"title|disc|track\"; showing the parts that parse.");
+
+                addEntry(entry);
             }
+        }
+        catch (const YAML::Exception& e)
+        {
+            return rejectSource("YAML parsing error: " + std::string(e.what()));
+        }
+    }
+    Log("LoadBgmMap: Map loaded successfully with " + std::to_string(entries.size()) + " entries.");
 
-            g_bgmMap[filepath] = info;
+    for (const MapEntry& entry : entries)
+    {
+        if (snapshot->store.Add(entry.key, entry.songName, entry.disc, entry.track) == BGM_INVALID_TRACK_ID) {
+            Log("LoadBgmMap: Too many entries, ignoring the rest.");
+            break;
         }
-        Log("LoadBgmMap: Map loaded successfully with " + std::to_string(g_bgmMap.size()) + " entries.");
     }
-    catch (const YAML::Exception& e)
+    snapshot->sourceHash = sourceHash;
+
+    // The index reads the keys from the finished pool
+    std::vector<std::string_view> keys;
+    for (uint16_t id = 0; id < snapshot->store.GetCount(); ++id)
+        keys.emplace_back(snapshot->store.GetKey(id));
+    bool indexBuilt = snapshot->index.Build(keys.data(), keys.size());
+    if (!indexBuilt)
+        Log("LoadBgmMap: Failed to build the track index!");
+
+    for (uint16_t id : snapshot->index.GetShadowedKeys())
+        Log("LoadBgmMap: Key '" + std::string(keys[id]) + "' duplicates another entry (case or separator only) and will never match.");
+
+    Log("LoadBgmMap: Track index built (" + std::to_string(snapshot->index.GetSizeInBytes()) + " bytes, records " +
+        std::to_string(snapshot->store.GetSizeInBytes()) + " bytes).");
+
+    *outWriteCache = indexBuilt;
+    return snapshot;
+}
+
+// Exact key lookup, used to carry a track across snapshots.
+static uint16_t FindTrackByKey(const BgmMapSnapshot& snapshot, const char* key)
+{
+    BgmPathInfo info = ClassifyPath(key);
+    uint64_t hash = HashUtf8Basename(key + info.basenameOffset, info.length - info.basenameOffset);
+    uint16_t trackId = snapshot.index.Find(hash, key, info.length, info.basenameOffset);
+    if (trackId == BGM_INVALID_TRACK_ID || strcmp(snapshot.store.GetKey(trackId), key) != 0)
+        return BGM_INVALID_TRACK_ID;
+    return trackId;
+}
+
+// Loads assets/BgmMap.yaml and publishes it as the current snapshot. Runs
+// once from InitializeHooks and again from the watcher whenever the file
+// changes; a reload with unchanged bytes does nothing.
+void LoadBgmMap()
+{
+    std::string modDir = GetModDirectory();
+    std::string yamlPath = modDir + "\\assets/BgmMap.yaml";
+    std::string cachePath = modDir + "\\assets/BgmMap.cache";
+
+    uint64_t publishedHash;
     {
-        Log("LoadBgmMap: YAML parsing error: " + std::string(e.what()));
+        BgmRcuPointer<BgmMapSnapshot>::ReadGuard published(g_bgmSnapshot);
+        publishedHash = published ? published->sourceHash : 0;
     }
+
+    bool writeCache;
+    std::unique_ptr<BgmMapSnapshot> next = BuildBgmMapSnapshot(yamlPath, cachePath, publishedHash, &writeCache);
+    if (!next) return;
+    next->generation = ++g_bgmSnapshotGeneration;
+    next->codepoints = CollectBgmTitleCodepoints(next->store, TOAST_FIXED_GLYPHS);
+
+    BgmMapSnapshot* published = next.get();
+    std::unique_ptr<BgmMapSnapshot> previous(g_bgmSnapshot.Exchange(next.release()));
+    if (previous)
+    {
+        // Keep the latest toast on the same key; its old ID means nothing in
+        // the new snapshot. My_Present does the same for the queued ones.
+        g_toastState.Update([&](BgmToastState& toast) {
+            uint16_t trackId = GetBgmSnapshotTrackId(previous.get(), toast.track);
+            if (trackId != BGM_INVALID_TRACK_ID)
+                toast.track = MakeBgmSnapshotTrack(*published, FindTrackByKey(*published, previous->store.GetKey(trackId)));
+        });
+
+        g_bgmSnapshot.Synchronize();
+        previous.reset(); // Unmaps a previous BgmMap.cache, so it can be replaced below
+        Log("LoadBgmMap: Reloaded (generation " + std::to_string(published->generation) + ").");
+    }
+
+    g_glyphGeneration.store(published->generation, std::memory_order_release);
+
+    if (writeCache)
+        WriteBgmMapCache(cachePath, *published);
+}
+
+static void LogBgmTriggerKey(BgmTriggerLogKind kind, const char* key)
+{
+    if (kind == BgmTriggerLogKind::Caught)
+        Log("Detour_CreateFileA caught: " + std::string(key));
+    else
+        Log("MATCH FOUND for: " + std::string(key));
+}
+
+// Logs the unresolved .ogg paths Detour_CreateFileA deferred and the inline
+// mode's trigger keys, and how many of each were dropped while their ring
+// was full. Map watcher thread only.
+static void LogDeferredPaths()
+{
+    static uint64_t s_reportedOverflow = 0;
+    static uint64_t s_reportedTriggerOverflow = 0;
+
+    BgmPathLogEvent batch[8];
+    while (size_t count = g_pathLogRing.PopBatch(batch, 8))
+    {
+        for (size_t i = 0; i < count; ++i)
+            Log("Detour_CreateFileA caught: " + std::string(batch[i].path) + " (not in the map)");
+    }
+
+    BgmTriggerLogEvent triggers[8];
+    while (size_t count = g_triggerLogRing.PopBatch(triggers, 8))
+    {
+        for (size_t i = 0; i < count; ++i)
+            LogBgmTriggerKey(triggers[i].kind, triggers[i].key);
+    }
+
+    BgmEventRingStats stats = g_pathLogRing.GetStats();
+    if (stats.overflowed != s_reportedOverflow) {
+        Log("Detour_CreateFileA: " + std::to_string(stats.overflowed - s_reportedOverflow) + " unresolved .ogg path(s) not logged.");
+        s_reportedOverflow = stats.overflowed;
+    }
+    stats = g_triggerLogRing.GetStats();
+    if (stats.overflowed != s_reportedTriggerOverflow) {
+        Log("Inline triggers: " + std::to_string(stats.overflowed - s_reportedTriggerOverflow) + " key(s) not logged.");
+        s_reportedTriggerOverflow = stats.overflowed;
+    }
+}
+
+// Watches the assets folder and reloads BgmMap.yaml when it changes, so
+// titles can be fixed while the game is running. Also logs the paths the
+// detours deferred, every poll.
+void BgmMapWatcherThread()
+{
+    std::string assetsDir = GetModDirectory() + "\\assets";
+    HANDLE hChange = FindFirstChangeNotificationA(assetsDir.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (hChange == INVALID_HANDLE_VALUE)
+        Log("BgmMap watcher: Cannot watch " + assetsDir + ", error " + std::to_string(GetLastError()));
+
+    while (g_bMapWatcherActive)
+    {
+        LogDeferredPaths();
+        if (hChange == INVALID_HANDLE_VALUE) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            continue;
+        }
+        if (WaitForSingleObject(hChange, 250) != WAIT_OBJECT_0)
+            continue;
+
+        // Editors save in several steps; let the file settle. Re-arm before
+        // reading so a save during the reload triggers another pass. Changes
+        // to other files (including our own cache write) hash the same and
+        // are ignored by LoadBgmMap.
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        FindNextChangeNotification(hChange);
+        LoadBgmMap();
+    }
+    LogDeferredPaths();
+    if (hChange != INVALID_HANDLE_VALUE)
+        FindCloseChangeNotification(hChange);
 }
 
 // =============================================================
@@ -160,6 +550,40 @@ void LoadBgmMap()
 // =============================================================
 typedef HRESULT(WINAPI* PFN_PRESENT)(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags);
 static PFN_PRESENT g_pfnOriginalPresent = nullptr;
+typedef HRESULT(WINAPI* PFN_RESIZEBUFFERS)(IDXGISwapChain* pSwapChain, UINT BufferCount, UINT Width, UINT Height,
+    DXGI_FORMAT NewFormat, UINT SwapChainFlags);
+static PFN_RESIZEBUFFERS g_pfnOriginalResizeBuffers = nullptr;
+typedef HRESULT(WINAPI* PFN_RESIZEBUFFERS1)(IDXGISwapChain3* pSwapChain, UINT BufferCount, UINT Width, UINT Height,
+    DXGI_FORMAT Format, UINT SwapChainFlags, const UINT* pCreationNodeMask, IUnknown* const* ppPresentQueue);
+static PFN_RESIZEBUFFERS1 g_pfnOriginalResizeBuffers1 = nullptr;
+
+// BgmBackBufferCache device policy for D3D11
+struct D3D11BackBufferDevice {
+    using SwapChain = IDXGISwapChain;
+    using RenderTarget = ID3D11RenderTargetView;
+
+    RenderTarget* Create(SwapChain* pSwapChain, uint32_t* width, uint32_t* height)
+    {
+        ID3D11Texture2D* pBackBuffer = nullptr;
+        if (!g_pd3dDevice || FAILED(pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&pBackBuffer)))
+            return nullptr;
+
+        D3D11_TEXTURE2D_DESC desc;
+        pBackBuffer->GetDesc(&desc);
+        *width = desc.Width;
+        *height = desc.Height;
+
+        ID3D11RenderTargetView* pRenderTargetView = nullptr;
+        g_pd3dDevice->CreateRenderTargetView(pBackBuffer, NULL, &pRenderTargetView);
+        pBackBuffer->Release();
+        return pRenderTargetView;
+    }
+
+    void Release(RenderTarget* pRenderTargetView) { pRenderTargetView->Release(); }
+};
+
+// Render thread only (Present and ResizeBuffers)
+static BgmBackBufferCache<D3D11BackBufferDevice> g_backBufferCache;
 
 LRESULT WINAPI WndProc(const HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 static WNDPROC g_pfnOriginalWndProc = NULL;
@@ -167,7 +591,10 @@ static WNDPROC g_pfnOriginalWndProc = NULL;
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT WINAPI WndProc(const HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
-    if (ImGui_ImplWin32_WndProcHandler(hWnd, uMsg, wParam, lParam))
+    // While Present skips ImGui nothing drains its input queue, and the toast
+    // takes no input anyway
+    if (!g_bImGuiFrameSkipped.load(std::memory_order_relaxed) &&
+        ImGui_ImplWin32_WndProcHandler(hWnd, uMsg, wParam, lParam))
         return TRUE;
 
     return CallWindowProc(g_pfnOriginalWndProc, hWnd, uMsg, wParam, lParam);
@@ -191,8 +618,14 @@ void InitImGui(IDXGISwapChain* pSwapChain)
         ImGuiIO& io = ImGui::GetIO();
         io.IniFilename = NULL;
 
-        std::string fontPathStr = GetModDirectory() + "\\assets/mod_font.otf";
-        g_pToastFont = io.Fonts->AddFontFromFileTTF(fontPathStr.c_str(), 28.0f);
+        // Distance-field text needs its pixel shader; without it the toast
+        // font is baked as plain bitmaps
+        if (g_bToastSdf && !CreateToastSdfShader(g_pd3dDevice))
+            g_bToastSdf = false;
+        Log(g_bToastSdf ? "Toast text: distance fields." : "Toast text: bitmaps.");
+
+        if (LoadToastFontFiles())
+            g_pToastFont = AddToastFonts(io.Fonts);
 
         if (g_pToastFont == nullptr) {
             Log("Failed to load mod_font.otf from file!");
@@ -200,35 +633,7 @@ void InitImGui(IDXGISwapChain* pSwapChain)
             Log("mod_font.otf loaded successfully from file.");
         }
 
-        std::string texturePathStr = GetModDirectory() + "\\assets/bgm_info.dds";
-        std::wstring texturePathW(texturePathStr.begin(), texturePathStr.end());
-
-        HRESULT hr = DirectX::CreateDDSTextureFromFile(
-            g_pd3dDevice,
-            texturePathW.c_str(),
-            &g_pToastResource,
-            &g_pToastTexture
-        );
-
-        if (SUCCEEDED(hr) && g_pToastResource)
-        {
-            Log("bgm_info.dds loaded successfully from file.");
-
-            ID3D11Texture2D* pTexture = nullptr;
-            if (SUCCEEDED(g_pToastResource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&pTexture)))
-            {
-                D3D11_TEXTURE2D_DESC desc;
-                pTexture->GetDesc(&desc);
-                g_TextureWidth = (float)desc.Width;
-                g_TextureHeight = (float)desc.Height;
-                pTexture->Release();
-                Log("Texture size found: " + std::to_string(g_TextureWidth) + "x" + std::to_string(g_TextureHeight));
-            }
-        }
-        else
-        {
-            Log("Failed to load bgm_info.dds from file! HR: " + std::to_string(hr));
-        }
+        AddToastIcons(io.Fonts);
 
         ImGui_ImplWin32_Init(g_hWindow);
         ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
@@ -242,6 +647,225 @@ void InitImGui(IDXGISwapChain* pSwapChain)
     }
 }
 
+constexpr float TOAST_ANIMATION_SPEED = 1500.0f; // Pixels per second, at TOAST_REFERENCE_HEIGHT
+
+// Title of a queued or visible toast, or null if its track is not in `snapshot`.
+static const char* GetToastTitle(const BgmMapSnapshot* snapshot, uint32_t track)
+{
+    uint16_t trackId = GetBgmSnapshotTrackId(snapshot, track);
+    return trackId == BGM_INVALID_TRACK_ID ? nullptr : snapshot->store.GetTitle(trackId);
+}
+
+// Per active frame, before ShowNext: requests the on-demand glyphs of every
+// queued toast, so they are usually resident before it shows (IngestToastGlyphs
+// copies them in). Returns true if the next toast to show still has glyphs in
+// flight.
+static bool UpdateToastGlyphs(const BgmMapSnapshot* snapshot)
+{
+    if (!g_pToastFont)
+        return false;
+
+    PushToastFont();
+    ImFontBaked* baked = ImGui::GetFontBaked();
+    bool nextInFlight = false;
+    for (size_t i = 0; i < g_toastQueue.GetPendingCount(); ++i) {
+        bool inFlight = RequestToastGlyphs(baked, GetToastTitle(snapshot, g_toastQueue.GetPending(i).track));
+        if (i == 0)
+            nextInFlight = inFlight;
+    }
+    ImGui::PopFont();
+    return nextInFlight;
+}
+
+static ToastLayout g_toastLayout;
+
+// Returns the layout for `track`, recomputing it only if the track (which
+// includes the snapshot generation), the display or the font bake changed.
+static const ToastLayout& GetToastLayout(const BgmMapSnapshot* snapshot, uint32_t track, float screenWidth)
+{
+    ToastLayout& layout = g_toastLayout;
+    if (layout.track == track && layout.screenWidth == screenWidth && layout.scale == g_toastScale &&
+        layout.bakedSize == g_toastBakedSize)
+        return layout;
+
+    layout = ToastLayout();
+    layout.track = track;
+    layout.screenWidth = screenWidth;
+    layout.scale = g_toastScale;
+    layout.bakedSize = g_toastBakedSize;
+
+    uint16_t trackId = GetBgmSnapshotTrackId(snapshot, track);
+    bool hasTrack = trackId != BGM_INVALID_TRACK_ID;
+    float text_width = 0.0f;
+    float text_height = 0.0f;
+
+    if (hasTrack) {
+        layout.title = snapshot->store.GetTitle(trackId);
+
+        // Prepare disc/track string
+        uint8_t disc = snapshot->store.GetDisc(trackId);
+        uint8_t trackNumber = snapshot->store.GetTrackNumber(trackId);
+        if (disc && trackNumber)
+            snprintf(layout.line2, sizeof(layout.line2), "Disc %u, Track %u", (unsigned)disc, (unsigned)trackNumber);
+        else if (disc)
+            snprintf(layout.line2, sizeof(layout.line2), "Disc %u", (unsigned)disc);
+        else if (trackNumber)
+            snprintf(layout.line2, sizeof(layout.line2), "Track %u", (unsigned)trackNumber);
+
+        if (g_pToastFont) PushToastFont();
+
+        ImVec2 size_line1 = ImGui::CalcTextSize(layout.title);
+        ImVec2 size_line2 = ImGui::CalcTextSize(layout.line2);
+
+        text_width = std::max(size_line1.x, size_line2.x);
+        layout.lineHeight = size_line1.y;
+        TouchToastGlyphs(ImGui::GetFontBaked(), layout.title);
+
+        // Use 2 lines of height, plus a bit of padding
+        text_height = layout.lineHeight * 2.2f;
+
+        if (g_pToastFont) ImGui::PopFont();
+
+        // Check if filename contains "y8_title"
+        layout.isTitleScreen = strstr(snapshot->store.GetKey(trackId), "y8_title") != nullptr;
+        layout.icon = GetToastIcon(snapshot->store.GetKey(trackId));
+    }
+
+    // UI layout calculations
+    layout.totalHeight = text_height + (TOAST_TEXT_PADDING_Y * layout.scale * 2.0f);
+    layout.noteIconWidth = layout.totalHeight; // Make icon square
+    layout.boxWidth = text_width + (TOAST_TEXT_PADDING_X * layout.scale * 2.0f);
+    float total_width = layout.noteIconWidth + layout.boxWidth;
+
+    float text_block_height = layout.lineHeight * (layout.line2[0] == '\0' ? 1.0f : 2.0f);
+    layout.textStartOffsetY = (layout.totalHeight - text_block_height) * 0.5f;
+
+    float screen_padding = TOAST_SCREEN_PADDING * layout.scale;
+    if (layout.isTitleScreen) {
+        // LEFT SIDE
+        layout.targetOnscreenX = screen_padding;
+        layout.targetOffscreenX = -total_width - screen_padding; // Hide to the left
+    } else {
+        // RIGHT SIDE (Default)
+        layout.targetOnscreenX = screenWidth - total_width - screen_padding;
+        layout.targetOffscreenX = screenWidth + screen_padding; // Hide to the right
+    }
+    return layout;
+}
+
+// Bakes the snapshot's title codepoints into the toast font, so showing a
+// toast never rasterizes glyphs mid-slide. A glyph cache that matches the font
+// and codepoint set replaces the rasterizer altogether; otherwise whatever the
+// atlas lacks goes to the rasterizer thread as one batch. Without that thread
+// the render thread bakes TOAST_GLYPH_PREWARM_PER_FRAME new glyphs per frame.
+// Call between NewFrame and Render.
+static void PrewarmToastGlyphs(const BgmMapSnapshot& snapshot)
+{
+    static uint32_t s_generation = 0;
+    static size_t s_next = 0;
+    static size_t s_baked = 0;
+    static int s_fromCache = -1; // Glyphs copied from the cache; -1 if it missed
+    static size_t s_sent = 0;    // Glyphs handed to the rasterizer thread
+    static BgmGlyphCacheKey s_cacheKey = {};
+    static std::chrono::steady_clock::duration s_elapsed{};
+
+    if (g_prewarmedGeneration == snapshot.generation)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    if (g_pToastFont) PushToastFont();
+    ImFontBaked* baked = ImGui::GetFontBaked();
+
+    bool useCache = g_pToastFont && g_toastFontHash;
+    if (s_generation != snapshot.generation) {
+        s_generation = snapshot.generation;
+        s_next = 0;
+        s_baked = 0;
+        s_elapsed = {};
+        s_fromCache = -1;
+        s_sent = 0;
+        if (useCache) {
+            s_cacheKey = MakeToastGlyphCacheKey(snapshot.codepoints, baked->Size);
+            s_fromCache = LoadToastGlyphCache(s_cacheKey, baked);
+        }
+
+        // Whatever the cache did not cover is baked off the render thread
+        std::vector<uint32_t> missing;
+        for (uint32_t codepoint : snapshot.codepoints) {
+            if (g_pToastFont && codepoint <= IM_UNICODE_CODEPOINT_MAX && !IsToastGlyphOnDemand(codepoint) &&
+                !baked->IsGlyphLoaded((ImWchar)codepoint) && !IsToastGlyphInFlight(codepoint) &&
+                g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+                missing.push_back(codepoint);
+        }
+        size_t missingCount = missing.size();
+        if (missingCount && SendToastGlyphBatch(baked->Size, std::move(missing), ToastGlyphBatchKind::Resident))
+            s_sent = missingCount;
+    }
+
+    size_t bakedThisFrame = 0;
+    for (; s_next < snapshot.codepoints.size() && bakedThisFrame < TOAST_GLYPH_PREWARM_PER_FRAME; ++s_next)
+    {
+        uint32_t codepoint = snapshot.codepoints[s_next];
+        if (codepoint > IM_UNICODE_CODEPOINT_MAX || IsToastGlyphOnDemand(codepoint) || baked->IsGlyphLoaded((ImWchar)codepoint))
+            continue;
+        if (IsToastGlyphInFlight(codepoint))
+            break; // Still on the rasterizer thread; IngestToastGlyphs copies it in
+        baked->FindGlyph((ImWchar)codepoint);
+        ++bakedThisFrame;
+    }
+
+    bool done = s_next == snapshot.codepoints.size();
+    if (done && useCache && s_fromCache < 0)
+        WriteToastGlyphCache(s_cacheKey, snapshot.codepoints, baked);
+
+    if (g_pToastFont) ImGui::PopFont();
+    s_baked += bakedThisFrame;
+    s_elapsed += std::chrono::steady_clock::now() - start;
+
+    if (done) {
+        g_prewarmedGeneration = snapshot.generation;
+        ImTextureData* texture = ImGui::GetIO().Fonts->TexData;
+        Log("Toast glyphs ready: " + std::to_string(snapshot.codepoints.size()) + " codepoint(s), " +
+            (s_fromCache >= 0 ? std::to_string(s_fromCache) + " from cache, " : std::string()) +
+            (s_sent ? std::to_string(s_sent) + " from the rasterizer thread, " : std::string()) +
+            std::to_string(s_baked) + " newly baked in " +
+            std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(s_elapsed).count()) + " us, atlas " +
+            (texture ? std::to_string(texture->Width) + "x" + std::to_string(texture->Height) : std::string("n/a")) + ".");
+    }
+}
+
+// Moves the latest, visible and queued toasts made against an older map (a
+// reload, or a trigger that raced one) to the same keys in `snapshot`. A
+// queued toast whose key is gone is dropped; the visible one shows the latest
+// track instead, or leaves at once, so a toast is never drawn without a title.
+static void RemapToastQueue(const BgmMapSnapshot& snapshot, BgmToastState* latest)
+{
+    BgmToastState* states[2 + TOAST_QUEUE_CAPACITY];
+    size_t count = 0;
+    states[count++] = latest;
+    if (g_toastQueue.HasVisible())
+        states[count++] = &g_toastQueue.GetVisible();
+    for (size_t i = 0; i < g_toastQueue.GetPendingCount(); ++i)
+        states[count++] = &g_toastQueue.GetPending(i);
+    if (RemapBgmToastStates(snapshot, states, count) == 0)
+        return;
+
+    auto hasNoTitle = [&](const BgmToastState& toast) { return !GetToastTitle(&snapshot, toast.track); };
+    g_toastQueue.RemovePendingIf(hasNoTitle);
+    if (g_toastQueue.HasVisible() && hasNoTitle(g_toastQueue.GetVisible())) {
+        if (!hasNoTitle(*latest)) {
+            g_toastQueue.GetVisible().track = latest->track;
+            g_toastQueue.GetVisible().keyHash = latest->keyHash;
+        } else {
+            g_toastQueue.Hide();
+            g_toastTimer = 0.0f;
+            g_toastCurrentX = -10000.0f;
+        }
+    }
+}
+
+void ProcessBgmEventsInline(); // See BgmWorkerThread
+
 HRESULT WINAPI My_Present(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags)
 {
     // ... (Init/Get Target Dimensions logic remains unchanged) ...
@@ -253,116 +877,109 @@ HRESULT WINAPI My_Present(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Fl
 
     InitImGui(pSwapChain);
 
-    // Get render target dimensions
-    ID3D11Texture2D* pBackBuffer = nullptr;
-    float actual_width = 0.0f;
-    float actual_height = 0.0f;
+    if (g_triggerMode == BgmTriggerMode::Inline)
+        ProcessBgmEventsInline();
 
-    if (SUCCEEDED(pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&pBackBuffer)))
+    // Idle fast path: with no toast on screen, queued or newly requested there
+    // is nothing to draw, so skip ImGui (and the back buffer) altogether.
+    BgmToastState latest = g_toastState.Load();
+    if (latest.serial == g_toastShownSerial && !g_toastQueue.HasVisible() &&
+        g_toastQueue.GetPendingCount() == 0 && g_toastCurrentX == -10000.0f && g_toastTimer <= 0.0f &&
+        g_glyphGeneration.load(std::memory_order_relaxed) == g_prewarmedGeneration)
     {
-        D3D11_TEXTURE2D_DESC desc;
-        pBackBuffer->GetDesc(&desc);
-        actual_width = (float)desc.Width;
-        actual_height = (float)desc.Height;
-        pBackBuffer->Release();
+        ++g_idleFrames;
+        g_bImGuiFrameSkipped.store(true, std::memory_order_relaxed);
+        return g_pfnOriginalPresent(pSwapChain, SyncInterval, Flags);
     }
+    ++g_activeFrames;
+
+    // Cached render target and its dimensions; rebuilt after ResizeBuffers
+    ID3D11RenderTargetView* pRenderTargetView = g_backBufferCache.Acquire(pSwapChain);
+    float actual_width = (float)g_backBufferCache.GetWidth();
+    float actual_height = (float)g_backBufferCache.GetHeight();
 
     ImGui_ImplWin32_NewFrame();
 
     // Override DisplaySize with actual render target size
     ImGuiIO& io = ImGui::GetIO();
+
+    // The backend measures DeltaTime since its last NewFrame, which spans the
+    // whole idle stretch; don't let that eat the new toast's timer.
+    if (g_bImGuiFrameSkipped.load(std::memory_order_relaxed)) {
+        io.DeltaTime = std::min(io.DeltaTime, MAX_RESUME_DELTA_SECONDS);
+        g_bImGuiFrameSkipped.store(false, std::memory_order_relaxed);
+    }
     if (actual_width > 0.0f && actual_height > 0.0f) {
         io.DisplaySize.x = actual_width;
         io.DisplaySize.y = actual_height;
     }
 
+    // Between frames: the toast's size follows the back buffer, and a finished
+    // rebake of its font replaces the old bake before anything uses it
+    UpdateToastScale(io.DisplaySize.y);
+    IngestToastGlyphs(ApplyToastRebake);
+
     ImGui_ImplDX11_NewFrame();
     ImGui::NewFrame();
 
-    // UI Configuration
-    const float UI_SCALE = 0.65f;
-    const float SCREEN_PADDING = 10.0f;
-    const float TEXT_PADDING_X = 20.0f * UI_SCALE;
-    const float TEXT_PADDING_Y = 15.0f * UI_SCALE;
-    const float ROUNDING = 8.0f * UI_SCALE;
-
-    // MODIFIED: Cleaned up text logic
-    float text_width = 0.0f;
-    float text_height = 0.0f;
-    float line_height = 28.0f;
-
-    // Prepare disc/track string
-    std::string line2 = "";
-    if (!g_currentBgmInfo.disc.empty() || !g_currentBgmInfo.track.empty()) {
-        line2 = "Disc " + g_currentBgmInfo.disc + ", Track " + g_currentBgmInfo.track;
+    // Views into the current map snapshot; nothing is copied per frame. The
+    // guard is held for the rest of the frame, so a reload waits one Present.
+    BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(g_bgmSnapshot);
+    double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (snapshot)
+        RemapToastQueue(*snapshot, &latest);
+    if (latest.serial != g_toastShownSerial) {
+        g_toastShownSerial = latest.serial;
+        if (GetToastTitle(snapshot.Get(), latest.track) &&
+            g_toastQueue.Push(latest, now) == BgmToastPushResult::PreemptVisible)
+            g_toastTimer = 0.0f; // Slide the visible toast out; the new one follows
     }
-
-    if (g_toastTimer > 0.0f || g_toastCurrentX != -10000.0f)
-    {
-        if (g_pToastFont) ImGui::PushFont(g_pToastFont);
-
-        ImVec2 size_line1 = ImGui::CalcTextSize(g_currentBgmInfo.songName.c_str());
-        ImVec2 size_line2 = ImGui::CalcTextSize(line2.c_str());
-
-        text_width = std::max(size_line1.x, size_line2.x);
-        line_height = size_line1.y;
-
-        // Use 2 lines of height, plus a bit of padding
-        text_height = line_height * 2.2f;
-
-        if (g_pToastFont) ImGui::PopFont();
+    // Hold the next toast back one frame (no more) if the rasterizer thread
+    // still has glyphs of its title; ImGui rasterizes whatever is left
+    static uint32_t s_heldSerial = 0;
+    bool holdNext = false;
+    if (UpdateToastGlyphs(snapshot.Get()) && !g_toastQueue.HasVisible()) {
+        uint32_t nextSerial = g_toastQueue.GetPending(0).serial;
+        holdNext = s_heldSerial != nextSerial;
+        s_heldSerial = nextSerial;
+    }
+    if (!holdNext && g_toastQueue.ShowNext(now)) {
+        g_toastTimer = TOAST_DURATION_SECONDS;
+        g_toastCurrentX = -10000.0f; // Reset animation state
     }
 
-    // UI layout calculations
-    float total_height = text_height + (TEXT_PADDING_Y * 2.0f);
-    float note_icon_width = total_height; // Make icon square
-    float box_width = text_width + (TEXT_PADDING_X * 2.0f);
-    float total_width = note_icon_width + box_width;
-
-    float screen_width = io.DisplaySize.x;
-    float top_y = SCREEN_PADDING;
+    BgmToastState toast = g_toastQueue.HasVisible() ? g_toastQueue.GetVisible() : BgmToastState();
 
-    // MODIFIED: Logic for Top-Left vs Top-Right
-    float target_onscreen_x = 0.0f;
-    float target_offscreen_x = 0.0f;
+    if (snapshot)
+        PrewarmToastGlyphs(*snapshot);
 
-    // Check if filename contains "y8_title"
-    bool isTitleScreen = (!g_currentBgmInfo.rawFileName.empty() &&
-                          g_currentBgmInfo.rawFileName.find("y8_title") != std::string::npos);
-
-    if (isTitleScreen) {
-        // LEFT SIDE
-        target_onscreen_x = SCREEN_PADDING;
-        target_offscreen_x = -total_width - SCREEN_PADDING; // Hide to the left
-    } else {
-        // RIGHT SIDE (Default)
-        target_onscreen_x = screen_width - total_width - SCREEN_PADDING;
-        target_offscreen_x = screen_width + SCREEN_PADDING; // Hide to the right
-    }
+    // Text and box geometry only change with the track or the display width
+    const ToastLayout& layout = GetToastLayout(snapshot.Get(), toast.track, io.DisplaySize.x);
+    float top_y = TOAST_SCREEN_PADDING * layout.scale;
 
     // Initialize position if reset
     if (g_toastCurrentX == -10000.0f) {
-        g_toastCurrentX = target_offscreen_x;
+        g_toastCurrentX = layout.targetOffscreenX;
     }
 
     // MODIFIED: Animation logic
-    const float ANIMATION_SPEED = 1500.0f; // Pixels per second
+    const float ANIMATION_SPEED = TOAST_ANIMATION_SPEED * layout.scale;
     float delta_time = io.DeltaTime; // Seconds since last frame
 
     if (g_toastTimer > 0.0f)
     {
         // Sliding ON
-        if (isTitleScreen) {
+        if (layout.isTitleScreen) {
             // Move RIGHT to slide in
-            if (g_toastCurrentX < target_onscreen_x) {
+            if (g_toastCurrentX < layout.targetOnscreenX) {
                 g_toastCurrentX += ANIMATION_SPEED * delta_time;
-                if (g_toastCurrentX > target_onscreen_x) g_toastCurrentX = target_onscreen_x;
+                if (g_toastCurrentX > layout.targetOnscreenX) g_toastCurrentX = layout.targetOnscreenX;
             }
         } else {
             // Move LEFT to slide in
-            if (g_toastCurrentX > target_onscreen_x) {
+            if (g_toastCurrentX > layout.targetOnscreenX) {
                 g_toastCurrentX -= ANIMATION_SPEED * delta_time;
-                if (g_toastCurrentX < target_onscreen_x) g_toastCurrentX = target_onscreen_x;
+                if (g_toastCurrentX < layout.targetOnscreenX) g_toastCurrentX = layout.targetOnscreenX;
             }
         }
         g_toastTimer -= delta_time; // FPS-independent timer
@@ -370,103 +987,158 @@ HRESULT WINAPI My_Present(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Fl
     else
     {
         // Sliding OFF
-        if (isTitleScreen) {
+        if (layout.isTitleScreen) {
             // Move LEFT to slide out
-            if (g_toastCurrentX > target_offscreen_x) {
+            if (g_toastCurrentX > layout.targetOffscreenX) {
                 g_toastCurrentX -= ANIMATION_SPEED * delta_time;
-                if (g_toastCurrentX < target_offscreen_x) g_toastCurrentX = target_offscreen_x;
+                if (g_toastCurrentX < layout.targetOffscreenX) g_toastCurrentX = layout.targetOffscreenX;
             }
         } else {
             // Move RIGHT to slide out
-            if (g_toastCurrentX < target_offscreen_x) {
+            if (g_toastCurrentX < layout.targetOffscreenX) {
                 g_toastCurrentX += ANIMATION_SPEED * delta_time;
-                if (g_toastCurrentX > target_offscreen_x) g_toastCurrentX = target_offscreen_x;
+                if (g_toastCurrentX > layout.targetOffscreenX) g_toastCurrentX = layout.targetOffscreenX;
             }
         }
 
         // Check if fully offscreen to reset
         bool offscreen = false;
-        if (isTitleScreen && g_toastCurrentX <= target_offscreen_x) offscreen = true;
-        if (!isTitleScreen && g_toastCurrentX >= target_offscreen_x) offscreen = true;
+        if (layout.isTitleScreen && g_toastCurrentX <= layout.targetOffscreenX) offscreen = true;
+        if (!layout.isTitleScreen && g_toastCurrentX >= layout.targetOffscreenX) offscreen = true;
 
         if (offscreen) {
             g_toastCurrentX = -10000.0f; // Reset state
+            g_toastQueue.Hide();         // Next queued toast (if any) starts next frame
         }
     }
 
     // Draw UI
     if (g_toastCurrentX != -10000.0f)
     {
-        ImDrawList* draw_list = ImGui::GetBackgroundDrawList();
+        // Tessellated once per layout; each frame only shifts it along X
+        const ToastGeometry& geometry = GetToastGeometry(layout, top_y);
+        DrawToastGeometry(ImGui::GetBackgroundDrawList(), geometry, g_toastCurrentX);
+    }
 
-        ImVec2 pos_note_start(g_toastCurrentX, top_y);
-        ImVec2 pos_note_end(g_toastCurrentX + note_icon_width, top_y + total_height);
-        ImVec2 pos_box_start(pos_note_end.x, top_y);
-        ImVec2 pos_box_end(pos_box_start.x + box_width, top_y + total_height);
+    ImGui::Render();
 
-        // Vertically center the text block
-        float text_block_height = line_height * (line2.empty() ? 1.0f : 2.0f);
-        float text_start_y = top_y + (total_height - text_block_height) * 0.5f;
+    if (pRenderTargetView)
+    {
+        g_pd3dDeviceContext->OMSetRenderTargets(1, &pRenderTargetView, NULL);
+        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    }
 
-        if (g_pToastTexture) {
-            draw_list->AddImage(
-                (void*)g_pToastTexture,
-                pos_note_start,
-                pos_note_end,
-                ImVec2(0.0f, 0.0f),
-                ImVec2(1.0f, 1.0f)
-            );
-        }
+    return g_pfnOriginalPresent(pSwapChain, SyncInterval, Flags);
+}
 
-        draw_list->AddRectFilled(
-            pos_box_start,
-            pos_box_end,
-            IM_COL32(0, 0, 0, 100),
-            ROUNDING
-        );
+// ResizeBuffers fails while any view of the old back buffer is alive, so
+// drop ours (and unbind it, in case the game hasn't) before forwarding.
+static void ReleaseBackBufferForResize()
+{
+    if (g_backBufferCache.GetRenderTarget() && g_pd3dDeviceContext)
+    {
+        ID3D11RenderTargetView* pBound = nullptr;
+        g_pd3dDeviceContext->OMGetRenderTargets(1, &pBound, NULL);
+        if (pBound && pBound == g_backBufferCache.GetRenderTarget())
+            g_pd3dDeviceContext->OMSetRenderTargets(0, NULL, NULL);
+        if (pBound) pBound->Release();
+    }
+    g_backBufferCache.Invalidate();
+}
 
-        if (g_pToastFont) ImGui::PushFont(g_pToastFont);
+HRESULT WINAPI My_ResizeBuffers(IDXGISwapChain* pSwapChain, UINT BufferCount, UINT Width, UINT Height,
+    DXGI_FORMAT NewFormat, UINT SwapChainFlags)
+{
+    ReleaseBackBufferForResize();
 
-        // Line 1: Song Name
-        ImVec2 pos_line1(pos_box_start.x + TEXT_PADDING_X, text_start_y);
-        draw_list->AddText(pos_line1, IM_COL32_WHITE, g_currentBgmInfo.songName.c_str());
+    HRESULT hr = g_pfnOriginalResizeBuffers(pSwapChain, BufferCount, Width, Height, NewFormat, SwapChainFlags);
+    if (FAILED(hr)) {
+        std::stringstream ss;
+        ss << "ResizeBuffers failed! HRESULT: 0x" << std::hex << hr;
+        Log(ss.str());
+    }
+    return hr;
+}
 
-        // Line 2: Disc/Track
-        if (!line2.empty()) {
-            ImVec2 pos_line2(pos_box_start.x + TEXT_PADDING_X, text_start_y + line_height);
-            draw_list->AddText(pos_line2, IM_COL32(180, 180, 180, 255), line2.c_str());
-        }
+// Same rule for IDXGISwapChain3::ResizeBuffers1, which some games and
+// overlays call instead of ResizeBuffers.
+HRESULT WINAPI My_ResizeBuffers1(IDXGISwapChain3* pSwapChain, UINT BufferCount, UINT Width, UINT Height,
+    DXGI_FORMAT Format, UINT SwapChainFlags, const UINT* pCreationNodeMask, IUnknown* const* ppPresentQueue)
+{
+    ReleaseBackBufferForResize();
 
-        if (g_pToastFont) ImGui::PopFont();
+    HRESULT hr = g_pfnOriginalResizeBuffers1(pSwapChain, BufferCount, Width, Height, Format, SwapChainFlags,
+        pCreationNodeMask, ppPresentQueue);
+    if (FAILED(hr)) {
+        std::stringstream ss;
+        ss << "ResizeBuffers1 failed! HRESULT: 0x" << std::hex << hr;
+        Log(ss.str());
     }
+    return hr;
+}
 
-    ImGui::Render();
+// =============================================================
+// FILE SYSTEM HOOK LOGIC (Kernel32::CreateFile A & W)
+// =============================================================
 
-    // ... (Render Target logic remains unchanged) ...
-    if (!g_pd3dRenderTargetView)
+// Converts a captured path to UTF-8 for the rare paths with non-ASCII units.
+static bool PathToUtf8(const char16_t* path, char* buffer, int bufferSize)
+{
+    return WideCharToMultiByte(CP_UTF8, 0, (LPCWSTR)path, -1, buffer, bufferSize, NULL, NULL) != 0;
+}
+
+static bool PathToUtf8(const char* path, char* buffer, int bufferSize)
+{
+    WCHAR wide[MAX_PATH];
+    if (MultiByteToWideChar(CP_ACP, 0, path, -1, wide, MAX_PATH) == 0)
+        return false;
+    return WideCharToMultiByte(CP_UTF8, 0, wide, -1, buffer, bufferSize, NULL, NULL) != 0;
+}
+
+// Resolves a captured .ogg path to a track ID, or BGM_INVALID_TRACK_ID.
+// Voice and sound-effect opens are rejected by the Bloom filter in a few
+// instructions; survivors go through the perfect hash. No allocation.
+template <typename CharT>
+static uint16_t ResolveCapturedTrack(const BgmTrackIndex& index, const CharT* path, const BgmPathInfo& pathInfo)
+{
+    uint64_t hash;
+    uint16_t trackId;
+
+    if (HashAsciiBasename(path + pathInfo.basenameOffset, pathInfo.length - pathInfo.basenameOffset, &hash))
     {
-        ID3D11Texture2D* pBackBuffer;
-        if (SUCCEEDED(pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&pBackBuffer)))
-        {
-            g_pd3dDevice->CreateRenderTargetView(pBackBuffer, NULL, &g_pd3dRenderTargetView);
-            pBackBuffer->Release();
+        if (!index.MayContain(hash)) {
+            g_filterMisses.fetch_add(1, std::memory_order_relaxed);
+            return BGM_INVALID_TRACK_ID;
         }
+        g_filterHits.fetch_add(1, std::memory_order_relaxed);
+        trackId = index.Find(hash, path, pathInfo.length, pathInfo.basenameOffset);
     }
-
-    if (g_pd3dRenderTargetView)
+    else
     {
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_pd3dRenderTargetView, NULL);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-        g_pd3dRenderTargetView->Release();
-        g_pd3dRenderTargetView = nullptr;
+        char utf8[MAX_PATH * 3];
+        if (!PathToUtf8(path, utf8, sizeof(utf8)))
+            return BGM_INVALID_TRACK_ID;
+
+        BgmPathInfo utf8Info = ClassifyPath(utf8);
+        hash = HashUtf8Basename(utf8 + utf8Info.basenameOffset, utf8Info.length - utf8Info.basenameOffset);
+        if (!index.MayContain(hash)) {
+            g_filterMisses.fetch_add(1, std::memory_order_relaxed);
+            return BGM_INVALID_TRACK_ID;
+        }
+        g_filterHits.fetch_add(1, std::memory_order_relaxed);
+        trackId = index.Find(hash, utf8, utf8Info.length, utf8Info.basenameOffset);
     }
 
-    return g_pfnOriginalPresent(pSwapChain, SyncInterval, Flags);
+    if (trackId == BGM_INVALID_TRACK_ID)
+        g_filterFalsePositives.fetch_add(1, std::memory_order_relaxed);
+    return trackId;
 }
 
-// =============================================================
-// FILE SYSTEM HOOK LOGIC (Kernel32::CreateFile A & W)
-// =============================================================
+// Called after a successful push. SetEvent is skipped while the worker is awake.
+static void WakeBgmWorker()
+{
+    g_bgmWorkerWakeup.Notify();
+}
 
 // --- Hook for CreateFileW (Unicode) ---
   
@@ -475,20 +1147,21 @@ static PFN_CREATEFILEW g_pfnOriginalCreateFileW = nullptr;
 
 HANDLE WINAPI Detour_CreateFileW(LPCWSTR lpFileName, DWORD dwAccess, DWORD dwShare, LPSECURITY_ATTRIBUTES lpSec, DWORD dwDisp, DWORD dwFlags, HANDLE hTemplate) {
     if (lpFileName) {
-        size_t len = wcslen(lpFileName);
-        if (len > 4) {
-            if (towlower(lpFileName[len - 1]) == 'g' &&
-                towlower(lpFileName[len - 2]) == 'g' &&
-                towlower(lpFileName[len - 3]) == 'o' &&
-                lpFileName[len - 4] == L'.')
-            {
-                if (g_bufferMutex.try_lock()) {
-                    if (!g_bNewBgmAvailable) {
-                        WCharToString(lpFileName, g_bgmFilenameBuffer, MAX_PATH);
-                        g_bNewBgmAvailable = true;
-                    }
-                    g_bufferMutex.unlock();
-                }
+        const char16_t* path = reinterpret_cast<const char16_t*>(lpFileName);
+        BgmPathInfo pathInfo = ClassifyPath(path);
+        if (pathInfo.isOgg) {
+            BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(g_bgmSnapshot);
+            uint16_t trackId = snapshot ? ResolveCapturedTrack(snapshot->index, path, pathInfo) : BGM_INVALID_TRACK_ID;
+            if (trackId != BGM_INVALID_TRACK_ID) {
+                uint8_t generation = (uint8_t)snapshot->generation;
+                if (g_bgmEventRing.TryPush([trackId, generation](BgmCaptureEvent& ev) {
+                    ev.timestamp = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+                    ev.threadId = GetCurrentThreadId();
+                    ev.trackId = trackId;
+                    ev.source = BgmCaptureSource::CreateFileW;
+                    ev.generation = generation;
+                }))
+                    WakeBgmWorker();
             }
         }
     }
@@ -501,104 +1174,223 @@ typedef HANDLE(WINAPI* PFN_CREATEFILEA)(LPCSTR, DWORD, DWORD, LPSECURITY_ATTRIBU
 static PFN_CREATEFILEA g_pfnOriginalCreateFileA = nullptr;
 
 HANDLE WINAPI Detour_CreateFileA(LPCSTR lpFileName, DWORD dwAccess, DWORD dwShare, LPSECURITY_ATTRIBUTES lpSec, DWORD dwDisp, DWORD dwFlags, HANDLE hTemplate) {
+    // Runs on the game's I/O threads: classify in place, no allocation and no
+    // file I/O. Logging is deferred: hits to BgmWorkerThread, other .ogg
+    // paths to the map watcher (see LogDeferredPaths).
     if (lpFileName) {
-        std::string fname = lpFileName;
-        if (fname.length() > 4) {
-            std::string ext = fname.substr(fname.length() - 4);
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-
-            if (ext == ".ogg") {
-                Log("Detour_CreateFileA caught: " + fname);
-
-                if (g_bufferMutex.try_lock()) {
-                    if (!g_bNewBgmAvailable) {
-                        strcpy_s(g_bgmFilenameBuffer, MAX_PATH, lpFileName);
-                        g_bNewBgmAvailable = true;
-                    }
-                    g_bufferMutex.unlock();
-                }
+        BgmPathInfo pathInfo = ClassifyPath(lpFileName);
+        if (pathInfo.isOgg) {
+            BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(g_bgmSnapshot);
+            uint16_t trackId = snapshot ? ResolveCapturedTrack(snapshot->index, lpFileName, pathInfo) : BGM_INVALID_TRACK_ID;
+            if (trackId == BGM_INVALID_TRACK_ID) {
+                size_t length = std::min(pathInfo.length, BGM_LOGGED_PATH_CHARS - 1);
+                g_pathLogRing.TryPush([&](BgmPathLogEvent& ev) {
+                    ev.threadId = GetCurrentThreadId();
+                    memcpy(ev.path, lpFileName, length);
+                    ev.path[length] = '\0';
+                });
+            } else {
+                uint8_t generation = (uint8_t)snapshot->generation;
+                if (g_bgmEventRing.TryPush([trackId, generation](BgmCaptureEvent& ev) {
+                    ev.timestamp = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+                    ev.threadId = GetCurrentThreadId();
+                    ev.trackId = trackId;
+                    ev.source = BgmCaptureSource::CreateFileA;
+                    ev.generation = generation;
+                }))
+                    WakeBgmWorker();
             }
         }
     }
     return g_pfnOriginalCreateFileA(lpFileName, dwAccess, dwShare, lpSec, dwDisp, dwFlags, hTemplate);
 }
 
-void ProcessBgmTrigger(const std::string& s_filename)
+// Logs a triggered key: right away on the worker, through g_triggerLogRing
+// in inline mode, where this runs inside Present.
+static void LogBgmTrigger(BgmTriggerLogKind kind, const char* key)
 {
-    if (s_filename == g_lastTriggeredFile) return;
-    g_lastTriggeredFile = s_filename;
+    if (g_triggerMode == BgmTriggerMode::Worker) {
+        LogBgmTriggerKey(kind, key);
+        return;
+    }
+    size_t length = std::min(strlen(key), BGM_LOGGED_PATH_CHARS - 1);
+    g_triggerLogRing.TryPush([&](BgmTriggerLogEvent& ev) {
+        ev.kind = kind;
+        memcpy(ev.key, key, length);
+        ev.key[length] = '\0';
+    });
+}
 
-    Log("Processing Audio File: " + s_filename);
+void ProcessBgmTrigger(const BgmMapSnapshot& snapshot, uint16_t trackId)
+{
+    if (trackId >= snapshot.store.GetCount()) return;
+    if (trackId == g_lastTriggeredTrack && snapshot.generation == g_lastTriggeredGeneration) return;
+    g_lastTriggeredTrack = trackId;
+    g_lastTriggeredGeneration = snapshot.generation;
 
-    std::string normalizedInput = s_filename;
-    std::replace(normalizedInput.begin(), normalizedInput.end(), '/', '\\');
+    LogBgmTrigger(BgmTriggerLogKind::Match, snapshot.store.GetKey(trackId));
 
-    for (auto& entry : g_bgmMap)
-    {
-        std::string key = entry.first;
-        std::replace(key.begin(), key.end(), '/', '\\');
+    const char* title = snapshot.store.GetTitle(trackId);
+    uint64_t songKey = HashBgmTitle(title, strlen(title));
+    bool shouldShow = false;
+    auto it = g_songLastShown.find(songKey);
 
-        if (normalizedInput.length() >= key.length()) {
-            if (normalizedInput.compare(normalizedInput.length() - key.length(), key.length(), key) == 0) {
+    if (it == g_songLastShown.end()) {
+        shouldShow = true;
+    } else {
+        auto now = std::chrono::steady_clock::now();
+        auto hours = std::chrono::duration_cast<std::chrono::hours>(now - it->second).count();
+        if (hours >= COOLDOWN_HOURS) shouldShow = true;
+    }
 
-                Log("MATCH FOUND for: " + key);
+    if (shouldShow) {
+        g_songLastShown[songKey] = std::chrono::steady_clock::now();
+    }
 
-                // MODIFIED: Store the matched key (filename) for position logic
-                g_currentBgmInfo = entry.second;
-                g_currentBgmInfo.rawFileName = entry.first;
+    // My_Present restarts the animation when it sees the serial change
+    const char* key = snapshot.store.GetKey(trackId);
+    uint64_t keyHash = HashBgmKey(key, strlen(key));
+    g_toastState.Update([&](BgmToastState& toast) {
+        toast.track = MakeBgmSnapshotTrack(snapshot, trackId);
+        toast.keyHash = keyHash;
+        if (shouldShow) ++toast.serial;
+    });
+}
 
-                std::string songKey = g_currentBgmInfo.songName;
-                bool shouldShow = false;
-                auto it = g_songLastShown.find(songKey);
+// Drain bookkeeping shared by the worker and the inline mode. Only touched by
+// whichever thread drains the ring.
+struct BgmTriggerStats {
+    uint64_t lastReportedOverflow = 0;
 
-                if (it == g_songLastShown.end()) {
-                    shouldShow = true;
-                } else {
-                    auto now = std::chrono::steady_clock::now();
-                    auto hours = std::chrono::duration_cast<std::chrono::hours>(now - it->second).count();
-                    if (hours >= COOLDOWN_HOURS) shouldShow = true;
-                }
+    // Push-to-trigger latency, reported at shutdown
+    uint64_t latencyCount = 0;
+    std::chrono::steady_clock::duration latencyTotal{}, latencyMax{};
 
-                if (shouldShow) {
-                    // MODIFIED: Use new timer variables
-                    g_toastTimer = TOAST_DURATION_SECONDS;
-                    g_songLastShown[songKey] = std::chrono::steady_clock::now();
-                    g_toastCurrentX = -10000.0f; // Reset animation state
-                }
-                break;
-            }
-        }
+    // Inline mode: time spent draining inside Present
+    uint64_t inlineFrames = 0;
+    uint64_t inlineCarriedOver = 0;  // Frames that hit the budget with events left
+    std::chrono::steady_clock::duration inlineTotal{}, inlineMax{};
+};
+
+static BgmTriggerStats g_inlineTriggerStats; // Render thread only
+
+// Triggers a batch of popped events against the current snapshot.
+static void ProcessBgmEventBatch(const BgmCaptureEvent* batch, size_t count, BgmTriggerStats* stats)
+{
+    BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(g_bgmSnapshot);
+    if (!snapshot) return;
+
+    // Events arrive in push order, so the last match in a burst wins
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Resolved against a snapshot that has since been replaced
+        if (batch[i].generation != (uint8_t)snapshot->generation)
+            continue;
+
+        if (batch[i].source == BgmCaptureSource::CreateFileA && batch[i].trackId < snapshot->store.GetCount())
+            LogBgmTrigger(BgmTriggerLogKind::Caught, snapshot->store.GetKey(batch[i].trackId));
+
+        auto latency = std::chrono::steady_clock::now().time_since_epoch() -
+                       std::chrono::steady_clock::duration(batch[i].timestamp);
+        stats->latencyTotal += latency;
+        stats->latencyMax = std::max(stats->latencyMax, latency);
+        ++stats->latencyCount;
+
+        ProcessBgmTrigger(*snapshot, batch[i].trackId);
     }
 }
 
+static void ReportBgmEventOverflow(BgmTriggerStats* stats)
+{
+    BgmEventRingStats ringStats = g_bgmEventRing.GetStats();
+    if (ringStats.overflowed != stats->lastReportedOverflow)
+    {
+        Log("BGM event ring overflow: " + std::to_string(ringStats.overflowed - stats->lastReportedOverflow) +
+            " event(s) dropped (" + std::to_string(ringStats.overflowed) + " total).");
+        stats->lastReportedOverflow = ringStats.overflowed;
+    }
+}
+
+static void LogBgmTriggerStats(const BgmTriggerStats& stats)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    BgmEventRingStats ringStats = g_bgmEventRing.GetStats();
+    Log("BGM events pushed: " + std::to_string(ringStats.pushed) +
+        ", drained: " + std::to_string(ringStats.drained) + ", dropped: " + std::to_string(ringStats.overflowed));
+    Log("Basename filter: hits: " + std::to_string(g_filterHits.load()) +
+        ", misses: " + std::to_string(g_filterMisses.load()) +
+        ", false positives: " + std::to_string(g_filterFalsePositives.load()));
+    if (stats.latencyCount > 0)
+    {
+        Log("Trigger latency (push to ProcessBgmTrigger): avg " +
+            std::to_string(duration_cast<microseconds>(stats.latencyTotal).count() / stats.latencyCount) + " us, max " +
+            std::to_string(duration_cast<microseconds>(stats.latencyMax).count()) + " us over " +
+            std::to_string(stats.latencyCount) + " event(s).");
+    }
+    if (stats.inlineFrames > 0)
+    {
+        Log("Inline triggers: " + std::to_string(stats.inlineFrames) + " frame(s) with events, avg " +
+            std::to_string(duration_cast<microseconds>(stats.inlineTotal).count() / stats.inlineFrames) + " us, max " +
+            std::to_string(duration_cast<microseconds>(stats.inlineMax).count()) + " us, " +
+            std::to_string(stats.inlineCarriedOver) + " carried over to the next frame.");
+    }
+}
+
+// Inline mode: called at the top of every Present. Drains small batches
+// until the ring is empty or the frame budget is spent; whatever is left
+// stays queued for the next frame. The common case (nothing queued) costs
+// one IsEmpty check.
+void ProcessBgmEventsInline()
+{
+    if (g_bgmEventRing.IsEmpty()) return;
+
+    BgmTriggerStats& stats = g_inlineTriggerStats;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + g_inlineTriggerBudget;
+
+    bool carriedOver = g_bgmEventRing.DrainUntil<BGM_INLINE_BATCH_SIZE>(deadline,
+        [&stats](const BgmCaptureEvent* batch, size_t count) { ProcessBgmEventBatch(batch, count, &stats); });
+    if (carriedOver) ++stats.inlineCarriedOver;
+    ReportBgmEventOverflow(&stats);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stats.inlineTotal += elapsed;
+    stats.inlineMax = std::max(stats.inlineMax, elapsed);
+    ++stats.inlineFrames;
+}
+
 void BgmWorkerThread()
 {
       
     Log("BGM Worker Thread started.");
-    while (g_bWorkerThreadActive)
-    {
-        if (g_bNewBgmAvailable == true)
-        {
-            std::string filename_to_process;
-
-            {
-                std::lock_guard<std::mutex> lock(g_bufferMutex);
-                filename_to_process = g_bgmFilenameBuffer;
-                g_bNewBgmAvailable = false;
-            }
 
-            ProcessBgmTrigger(filename_to_process);
-        }
+    BgmTriggerStats stats;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    while (g_bWorkerThreadActive)
+    {
+        BgmCaptureEvent batch[BGM_EVENT_BATCH_SIZE];
+        while (size_t count = g_bgmEventRing.PopBatch(batch, BGM_EVENT_BATCH_SIZE))
+            ProcessBgmEventBatch(batch, count, &stats);
+        ReportBgmEventOverflow(&stats);
+
+        // Block until a detour pushes (or shutdown). A push that raced with
+        // the drain above is seen here or signals (see BgmWakeup).
+        g_bgmWorkerWakeup.Wait([] { return g_bgmEventRing.IsEmpty() && g_bWorkerThreadActive; });
     }
+
     Log("BGM Worker Thread shutting down.");
+    LogBgmTriggerStats(stats);
 }
 
 // =============================================================
 // HOOK INITIALIZATION
 // =============================================================
-uintptr_t FindPresentAddress(HWND hWnd)
+// Returns IDXGISwapChain::Present; *pResizeBuffersAddr gets ResizeBuffers from
+// the same vtable and *pResizeBuffers1Addr IDXGISwapChain3::ResizeBuffers1
+// (left 0 where DXGI 1.4 is unavailable).
+uintptr_t FindPresentAddress(HWND hWnd, uintptr_t* pResizeBuffersAddr, uintptr_t* pResizeBuffers1Addr)
 {
       
     DXGI_SWAP_CHAIN_DESC sd;
@@ -621,6 +1413,15 @@ uintptr_t FindPresentAddress(HWND hWnd)
     {
         void** pVTable = *(void***)pSwapChain;
         pPresentAddr = (uintptr_t)pVTable[8];
+        *pResizeBuffersAddr = (uintptr_t)pVTable[13];
+
+        IDXGISwapChain3* pSwapChain3 = nullptr;
+        if (SUCCEEDED(pSwapChain->QueryInterface(__uuidof(IDXGISwapChain3), (void**)&pSwapChain3)))
+        {
+            void** pVTable3 = *(void***)pSwapChain3;
+            *pResizeBuffers1Addr = (uintptr_t)pVTable3[39];
+            pSwapChain3->Release();
+        }
 
         pSwapChain->Release();
         pDevice->Release();
@@ -673,10 +1474,22 @@ void InitializeHooks()
     }
     Log("MH_Initialize successful.");
 
+    LoadModConfig();
     LoadBgmMap();
 
-    g_bWorkerThreadActive = true;
-    g_workerThread = std::thread(BgmWorkerThread);
+    // Inline mode drains the ring from My_Present; no thread, no wake event
+    if (g_triggerMode == BgmTriggerMode::Worker)
+    {
+        g_bgmWorkerWakeup.GetEvent().handle = CreateEventA(NULL, FALSE, FALSE, NULL);
+        if (!g_bgmWorkerWakeup.GetEvent().handle)
+            Log("CreateEvent failed; the worker will poll instead. Error: " + std::to_string(GetLastError()));
+
+        g_bWorkerThreadActive = true;
+        g_workerThread = std::thread(BgmWorkerThread);
+    }
+
+    g_bMapWatcherActive = true;
+    g_mapWatcherThread = std::thread(BgmMapWatcherThread);
 
     // 2. HOOK FILE SYSTEM (CreateFileW)
     HMODULE hKernel32 = GetModuleHandleA("kernel32.dll");
@@ -694,12 +1507,14 @@ void InitializeHooks()
             if (MH_CreateHook(pCreateFileA, &Detour_CreateFileA, (LPVOID*)&g_pfnOriginalCreateFileA) != MH_OK) {
                 Log("Failed to hook CreateFileA!");
             } else {
-                Log("Hooked CreateFileA successfully.");
+                Log(std::string("Hooked CreateFileA successfully (") + BGM_CLASSIFIER_NAME + " path classifier).");
             }
         }
     }
     // 3. HOOK GRAPHICS (IDXGISwapChain::Present)
-    uintptr_t pPresentAddr = FindPresentAddress(g_hWindow);
+    uintptr_t pResizeBuffersAddr = 0;
+    uintptr_t pResizeBuffers1Addr = 0;
+    uintptr_t pPresentAddr = FindPresentAddress(g_hWindow, &pResizeBuffersAddr, &pResizeBuffers1Addr);
     if (pPresentAddr)
     {
         std::string logMsg = "FindPresentAddress successful. Found at: 0x" + std::to_string(pPresentAddr);
@@ -712,6 +1527,29 @@ void InitializeHooks()
         {
             Log("MH_CreateHook for Present successful.");
         }
+
+        // Without this hook the cached back buffer view would block resizes
+        if (MH_CreateHook((LPVOID)pResizeBuffersAddr, &My_ResizeBuffers, (LPVOID*)&g_pfnOriginalResizeBuffers) != MH_OK)
+        {
+            Log("MH_CreateHook for ResizeBuffers failed!");
+        }
+        else
+        {
+            Log("MH_CreateHook for ResizeBuffers successful.");
+        }
+
+        if (!pResizeBuffers1Addr)
+        {
+            Log("IDXGISwapChain3 unavailable; ResizeBuffers1 not hooked.");
+        }
+        else if (MH_CreateHook((LPVOID)pResizeBuffers1Addr, &My_ResizeBuffers1, (LPVOID*)&g_pfnOriginalResizeBuffers1) != MH_OK)
+        {
+            Log("MH_CreateHook for ResizeBuffers1 failed!");
+        }
+        else
+        {
+            Log("MH_CreateHook for ResizeBuffers1 successful.");
+        }
     }
     else
     {
@@ -740,11 +1578,32 @@ BOOL WINAPI DllMain(HMODULE hModule, DWORD fdwReason, LPVOID lpReserved)
         Log("--- DLL_PROCESS_DETACH ---");
 
         g_bWorkerThreadActive = false;
+        g_bgmWorkerWakeup.GetEvent().Set();
         if (g_workerThread.joinable())
         {
             g_workerThread.join();
             Log("BGM Worker Thread joined.");
         }
+        if (g_triggerMode == BgmTriggerMode::Inline)
+            LogBgmTriggerStats(g_inlineTriggerStats);
+        Log("Present frames: " + std::to_string(g_idleFrames) + " idle, " + std::to_string(g_activeFrames) + " active.");
+        const BgmToastQueueStats& toastStats = g_toastQueue.GetStats();
+        Log("Toast queue: " + std::to_string(toastStats.pushed) + " request(s), " +
+            std::to_string(toastStats.coalesced) + " coalesced, " + std::to_string(toastStats.dropped) + " dropped.");
+
+        StopToastGlyphRasterizer();
+        const BgmGlyphLru& glyphLru = GetToastGlyphLru();
+        const BgmGlyphLruStats& glyphStats = glyphLru.GetStats();
+        Log("On-demand glyphs: " + std::to_string(glyphLru.GetCount()) + " resident (" +
+            std::to_string(glyphLru.GetArea()) + " px), " + std::to_string(glyphStats.inserts) + " loaded, " +
+            std::to_string(glyphStats.hits) + " hit(s), " + std::to_string(glyphStats.evictions) + " evicted.");
+
+        g_bMapWatcherActive = false;
+        if (g_mapWatcherThread.joinable())
+        {
+            g_mapWatcherThread.join();
+            Log("BgmMap watcher thread joined.");
+        }
 
         if (g_imguiInitialized)
         {
@@ -754,14 +1613,10 @@ BOOL WINAPI DllMain(HMODULE hModule, DWORD fdwReason, LPVOID lpReserved)
             ImGui::DestroyContext();
         }
 
-        if (g_pToastTexture) {
-            g_pToastTexture->Release();
-            g_pToastTexture = nullptr;
-        }
-        if (g_pToastResource) {
-            g_pToastResource->Release();
-            g_pToastResource = nullptr;
-        }
+        g_backBufferCache.Invalidate();
+        Log("Back buffer view rebuilt " + std::to_string(g_backBufferCache.GetStats().rebuilds) + " time(s).");
+
+        ReleaseToastSdfShader();
 
         MH_Uninitialize();
     }
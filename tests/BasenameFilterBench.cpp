@@ -0,0 +1,116 @@
+// Replays a voice-heavy .ogg trace (one BGM track per 50 opens; the rest are
+// voice lines and sound effects) through three ways of resolving a captured
+// path, in ns per path:
+//
+// - map scan: what ProcessBgmTrigger did for every .ogg before the index, a
+//   std::string copy and std::replace of the path and of every std::map key,
+//   then a suffix compare per key;
+// - index: the perfect hash and trie alone (BgmTrackIndex::Find);
+// - filter + index: the Bloom filter first, as ResolveCapturedTrack does.
+//
+// Also prints the filter's hit, miss and false-positive counts for the trace.
+
+#include <algorithm>
+#include <map>
+
+#include "BgmIndex.h"
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+struct FilterCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t falsePositives = 0;
+};
+
+uint16_t ScanMap(const std::map<std::string, uint16_t>& map, const std::string& filename)
+{
+    std::string normalizedInput = filename;
+    std::replace(normalizedInput.begin(), normalizedInput.end(), '/', '\\');
+    for (auto& entry : map)
+    {
+        std::string key = entry.first;
+        std::replace(key.begin(), key.end(), '/', '\\');
+        if (normalizedInput.length() >= key.length() &&
+            normalizedInput.compare(normalizedInput.length() - key.length(), key.length(), key) == 0)
+            return entry.second;
+    }
+    return BGM_INVALID_TRACK_ID;
+}
+
+uint16_t FindInIndex(const BgmTrackIndex& index, const std::string& path, bool useFilter, FilterCounters* counters)
+{
+    BgmPathInfo info = ClassifyPath(path.c_str());
+    uint64_t hash;
+    if (!HashAsciiBasename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset, &hash))
+        return BGM_INVALID_TRACK_ID;
+    if (useFilter) {
+        if (!index.MayContain(hash)) {
+            ++counters->misses;
+            return BGM_INVALID_TRACK_ID;
+        }
+        ++counters->hits;
+    }
+    uint16_t trackId = index.Find(hash, path.c_str(), info.length, info.basenameOffset);
+    if (useFilter && trackId == BGM_INVALID_TRACK_ID)
+        ++counters->falsePositives;
+    return trackId;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::vector<std::string> keys = GetBgmTestKeys(LoadShippedBgmMap());
+    BgmTrackIndex index;
+    if (keys.empty() || !index.Build(keys))
+        return 1;
+
+    std::map<std::string, uint16_t> map;
+    for (size_t id = 0; id < keys.size(); ++id)
+        map.emplace(keys[id], (uint16_t)id);
+
+    BgmTestTrace trace = MakeBgmTestTrace(keys, 20000, 0);
+    std::vector<std::string> replay;
+    for (size_t i = 0; i < trace.oggMisses.size(); ++i)
+    {
+        replay.push_back(trace.oggMisses[i]);
+        if (i % 49 == 48)
+            replay.push_back(trace.bgmHits[i / 49 % trace.bgmHits.size()]);
+    }
+
+    // Counters for exactly one pass over the trace
+    FilterCounters counters;
+    size_t resolved = 0;
+    for (const std::string& path : replay)
+        resolved += FindInIndex(index, path, true, &counters) != BGM_INVALID_TRACK_ID;
+
+    // Sums every result so the optimizer cannot drop the lookups
+    uint64_t sum = 0;
+    size_t calls = std::max<size_t>(1, bench.Iterations(20)) * replay.size();
+    FilterCounters ignored;
+    double scan = bench.NsPerCall(calls / 10, [&](size_t i) {
+        sum += ScanMap(map, replay[i % replay.size()]);
+    });
+    double indexOnly = bench.NsPerCall(calls, [&](size_t i) {
+        sum += FindInIndex(index, replay[i % replay.size()], false, &ignored);
+    });
+    double filtered = bench.NsPerCall(calls, [&](size_t i) {
+        sum += FindInIndex(index, replay[i % replay.size()], true, &ignored);
+    });
+    BgmBenchKeep(sum);
+
+    std::printf("Voice-heavy trace: %zu .ogg opens, %zu BGM (%zu map entries, filter %zu bytes)\n",
+        replay.size(), resolved, keys.size(), index.GetTables().filterWordCount * sizeof(uint64_t));
+    std::printf("Filter: %llu hits, %llu misses, %llu false positives\n",
+        (unsigned long long)counters.hits, (unsigned long long)counters.misses, (unsigned long long)counters.falsePositives);
+    std::printf("%-16s %10s\n", "", "ns/path");
+    std::printf("%-16s %10.1f\n", "map scan", scan);
+    std::printf("%-16s %10.1f\n", "index", indexOnly);
+    std::printf("%-16s %10.1f\n", "filter + index", filtered);
+    return 0;
+}
@@ -0,0 +1,193 @@
+// BgmBackBufferCache.h against a mock swap chain: views are reused across
+// frames, rebuilt for a new swap chain or after a resize, creation failures
+// are retried, and every view created is released exactly once. The mock's
+// resize fails while a view of its buffers is alive, as DXGI's ResizeBuffers
+// and ResizeBuffers1 do, so the tests also check the hooks' ordering.
+
+#include <vector>
+
+#include "BgmBackBufferCache.h"
+#include "BgmTest.h"
+
+namespace {
+
+struct MockSwapChain {
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    int liveViews = 0; // Views of this swap chain's back buffer still held
+
+    // ResizeBuffers(1): fails while any view of the old buffers is alive
+    bool Resize(uint32_t newWidth, uint32_t newHeight)
+    {
+        if (liveViews > 0)
+            return false;
+        width = newWidth;
+        height = newHeight;
+        return true;
+    }
+};
+
+struct MockView {
+    MockSwapChain* swapChain;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Shared by the cache's copy of the device and the test
+struct MockLog {
+    int creates = 0;
+    int releases = 0;
+    int failNext = 0; // Create calls left to fail
+    std::vector<MockView*> live;
+};
+
+struct MockDevice {
+    using SwapChain = MockSwapChain;
+    using RenderTarget = MockView;
+
+    MockLog* log;
+
+    RenderTarget* Create(SwapChain* swapChain, uint32_t* width, uint32_t* height)
+    {
+        if (log->failNext > 0)
+        {
+            --log->failNext;
+            return nullptr;
+        }
+        ++log->creates;
+        ++swapChain->liveViews;
+        *width = swapChain->width;
+        *height = swapChain->height;
+        MockView* view = new MockView{ swapChain, swapChain->width, swapChain->height };
+        log->live.push_back(view);
+        return view;
+    }
+
+    void Release(RenderTarget* view)
+    {
+        ++log->releases;
+        --view->swapChain->liveViews;
+        for (size_t i = 0; i < log->live.size(); ++i)
+            if (log->live[i] == view)
+                log->live.erase(log->live.begin() + (long)i);
+        delete view;
+    }
+};
+
+using Cache = BgmBackBufferCache<MockDevice>;
+
+// My_ResizeBuffers / My_ResizeBuffers1: drop the view, then forward
+bool HookedResize(Cache& cache, MockSwapChain& swapChain, uint32_t width, uint32_t height)
+{
+    cache.Invalidate();
+    return swapChain.Resize(width, height);
+}
+
+} // namespace
+
+BGM_TEST(ReusesTheViewAcrossFrames)
+{
+    MockLog log;
+    MockSwapChain swapChain;
+    {
+        Cache cache(MockDevice{ &log });
+        BGM_CHECK(cache.GetRenderTarget() == nullptr && cache.GetWidth() == 0 && cache.GetHeight() == 0);
+
+        MockView* first = cache.Acquire(&swapChain);
+        BGM_REQUIRE(first != nullptr);
+        BGM_CHECK(cache.GetWidth() == 1920 && cache.GetHeight() == 1080);
+        for (int frame = 0; frame < 1000; ++frame)
+            BGM_CHECK(cache.Acquire(&swapChain) == first);
+        BGM_CHECK(log.creates == 1 && log.releases == 0);
+        BGM_CHECK(cache.GetStats().rebuilds == 1 && cache.GetStats().failures == 0);
+    }
+    BGM_CHECK(log.releases == 1 && log.live.empty() && swapChain.liveViews == 0);
+}
+
+BGM_TEST(RebuildsForAnotherSwapChain)
+{
+    MockLog log;
+    MockSwapChain a, b;
+    b.width = 1280;
+    b.height = 720;
+    Cache cache(MockDevice{ &log });
+
+    MockView* viewA = cache.Acquire(&a);
+    MockView* viewB = cache.Acquire(&b);
+    BGM_REQUIRE(viewA != nullptr && viewB != nullptr);
+    BGM_CHECK(viewB->swapChain == &b);
+    BGM_CHECK(cache.GetWidth() == 1280 && cache.GetHeight() == 720);
+    BGM_CHECK(a.liveViews == 0 && b.liveViews == 1);
+    BGM_CHECK(log.creates == 2 && log.releases == 1);
+    BGM_CHECK(cache.GetStats().rebuilds == 2 && cache.GetStats().invalidations == 1);
+}
+
+// Without the hook the resize fails and the old size sticks; with it the
+// next Present picks up the new buffers.
+BGM_TEST(ResizeNeedsTheViewDropped)
+{
+    MockLog log;
+    MockSwapChain swapChain;
+    Cache cache(MockDevice{ &log });
+
+    BGM_REQUIRE(cache.Acquire(&swapChain) != nullptr);
+    BGM_CHECK(!swapChain.Resize(2560, 1440));
+    BGM_CHECK(swapChain.width == 1920);
+
+    BGM_CHECK(HookedResize(cache, swapChain, 2560, 1440));
+    BGM_CHECK(cache.GetRenderTarget() == nullptr && cache.GetWidth() == 0);
+    BGM_REQUIRE(cache.Acquire(&swapChain) != nullptr);
+    BGM_CHECK(cache.GetWidth() == 2560 && cache.GetHeight() == 1440);
+
+    // Repeated resizes (a window drag), with frames in between or not
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        BGM_CHECK(HookedResize(cache, swapChain, 800 + i, 600 + i));
+        if (i % 3 == 0)
+            BGM_CHECK(HookedResize(cache, swapChain, 800 + i, 600 + i)); // No frame: nothing to release
+        BGM_REQUIRE(cache.Acquire(&swapChain) != nullptr);
+        BGM_CHECK(cache.GetWidth() == 800 + i && cache.GetHeight() == 600 + i);
+    }
+    BGM_CHECK(log.creates == 52 && log.releases == 51);
+    BGM_CHECK(cache.GetStats().invalidations == 51);
+}
+
+BGM_TEST(RetriesAFailedCreateNextFrame)
+{
+    MockLog log;
+    MockSwapChain swapChain;
+    Cache cache(MockDevice{ &log });
+
+    log.failNext = 2;
+    BGM_CHECK(cache.Acquire(&swapChain) == nullptr);
+    BGM_CHECK(cache.Acquire(&swapChain) == nullptr);
+    BGM_CHECK(cache.GetWidth() == 0 && cache.GetHeight() == 0);
+    BGM_CHECK(cache.GetStats().failures == 2 && cache.GetStats().rebuilds == 0);
+
+    BGM_CHECK(cache.Acquire(&swapChain) != nullptr);
+    BGM_CHECK(cache.GetStats().rebuilds == 1 && cache.GetWidth() == 1920);
+
+    // A failure after a resize leaves nothing cached (and nothing leaked)
+    BGM_CHECK(HookedResize(cache, swapChain, 1600, 900));
+    log.failNext = 1;
+    BGM_CHECK(cache.Acquire(&swapChain) == nullptr);
+    BGM_CHECK(cache.GetRenderTarget() == nullptr && swapChain.liveViews == 0);
+    BGM_CHECK(cache.Acquire(&swapChain) != nullptr && cache.GetWidth() == 1600);
+}
+
+BGM_TEST(InvalidateIsIdempotent)
+{
+    MockLog log;
+    MockSwapChain swapChain;
+    Cache cache(MockDevice{ &log });
+
+    cache.Invalidate();
+    BGM_CHECK(cache.GetStats().invalidations == 0 && log.releases == 0);
+    BGM_REQUIRE(cache.Acquire(&swapChain) != nullptr);
+    cache.Invalidate();
+    cache.Invalidate();
+    BGM_CHECK(cache.GetStats().invalidations == 1 && log.releases == 1);
+    BGM_CHECK(log.live.empty() && swapChain.liveViews == 0);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,278 @@
+#include "BgmEventRing.h"
+#include "BgmTest.h"
+#include "BgmWakeup.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Events are stamped with their producer (threadId) and its push count
+// (timestamp), so the consumer can tell a lost, duplicated or reordered event.
+static void FillEvent(BgmCaptureEvent& ev, uint32_t producer, uint64_t count)
+{
+    ev.threadId = producer;
+    ev.timestamp = count;
+    ev.trackId = (uint16_t)(count * 31 + producer);
+    ev.generation = (uint8_t)producer;
+}
+
+static bool IsIntact(const BgmCaptureEvent& ev)
+{
+    return ev.trackId == (uint16_t)(ev.timestamp * 31 + ev.threadId) && ev.generation == (uint8_t)ev.threadId;
+}
+
+BGM_TEST(PopsInPushOrder)
+{
+    BgmEventRing<8> ring;
+    BgmCaptureEvent out[8];
+    BGM_CHECK(ring.IsEmpty());
+    BGM_CHECK(ring.PopBatch(out, 8) == 0);
+
+    for (uint64_t i = 0; i < 5; ++i)
+        BGM_CHECK(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, i); }));
+    BGM_CHECK(!ring.IsEmpty());
+
+    BGM_REQUIRE(ring.PopBatch(out, 3) == 3);
+    BGM_REQUIRE(ring.PopBatch(out + 3, 8) == 2);
+    for (uint64_t i = 0; i < 5; ++i)
+        BGM_CHECK(out[i].timestamp == i && IsIntact(out[i]));
+    BGM_CHECK(ring.IsEmpty());
+}
+
+BGM_TEST(CountsOverflowWhenFull)
+{
+    BgmEventRing<4> ring;
+    for (uint64_t i = 0; i < 4; ++i)
+        BGM_CHECK(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, i); }));
+    BGM_CHECK(!ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, 4); }));
+    BGM_CHECK(!ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, 5); }));
+
+    BgmEventRingStats stats = ring.GetStats();
+    BGM_CHECK(stats.pushed == 4);
+    BGM_CHECK(stats.overflowed == 2);
+    BGM_CHECK(stats.drained == 0);
+
+    // Dropped events never show up; the ring takes new ones once drained
+    BgmCaptureEvent out[4];
+    BGM_REQUIRE(ring.PopBatch(out, 4) == 4);
+    BGM_CHECK(out[3].timestamp == 3);
+    BGM_CHECK(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, 6); }));
+    BGM_CHECK(ring.GetStats().drained == 4);
+}
+
+BGM_TEST(WrapsAroundManyTimes)
+{
+    BgmEventRing<4> ring;
+    BgmCaptureEvent out[4];
+    uint64_t next = 0;
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        BGM_REQUIRE(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 1, i); }));
+        if (i % 3 == 2) {
+            size_t count = ring.PopBatch(out, 4);
+            for (size_t j = 0; j < count; ++j)
+                BGM_CHECK(out[j].timestamp == next++);
+        }
+    }
+    while (size_t count = ring.PopBatch(out, 4))
+        for (size_t j = 0; j < count; ++j)
+            BGM_CHECK(out[j].timestamp == next++);
+    BGM_CHECK(next == 1000);
+}
+
+// N producers retry until every event is in; the consumer must see each one
+// exactly once, intact, and in each producer's push order.
+static void HammerRing(uint32_t producerCount, uint64_t eventsPerProducer)
+{
+    static BgmEventRing<64> ring;
+    std::atomic<uint32_t> finished{0};
+    uint64_t attemptsBefore = ring.GetStats().pushed + ring.GetStats().overflowed;
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < producerCount; ++p)
+        producers.emplace_back([&, p] {
+            for (uint64_t i = 0; i < eventsPerProducer; ++i)
+                while (!ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, p, i); }))
+                    std::this_thread::yield();
+            finished.fetch_add(1);
+        });
+
+    std::vector<uint64_t> nextCount(producerCount, 0);
+    uint64_t received = 0;
+    bool ordered = true;
+    bool intact = true;
+    BgmCaptureEvent batch[16];
+    for (;;)
+    {
+        size_t count = ring.PopBatch(batch, 16);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BgmCaptureEvent& ev = batch[i];
+            intact = intact && ev.threadId < producerCount && IsIntact(ev);
+            if (!intact) break;
+            ordered = ordered && ev.timestamp == nextCount[ev.threadId];
+            nextCount[ev.threadId] = ev.timestamp + 1;
+        }
+        received += count;
+        if (count == 0) {
+            if (finished.load() == producerCount && ring.IsEmpty())
+                break;
+            std::this_thread::yield(); // Let producers run on a single core
+        }
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    BGM_CHECK(intact);
+    BGM_CHECK(ordered);
+    BGM_CHECK(received == producerCount * eventsPerProducer);
+    BgmEventRingStats stats = ring.GetStats();
+    BGM_CHECK(stats.pushed + stats.overflowed - attemptsBefore >= received);
+    BGM_CHECK(stats.drained == stats.pushed);
+}
+
+BGM_TEST(ManyProducersLoseNothing)
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+    HammerRing(cores > 2 ? cores : 4, 50000);
+}
+
+BGM_TEST(OversubscribedProducersLoseNothing)
+{
+    HammerRing(32, 5000);
+}
+
+// Producers that give up when the ring is full (as the detours do): every
+// attempt is either pushed or counted as an overflow, and nothing is drained twice.
+BGM_TEST(OverflowAccountingUnderContention)
+{
+    static BgmEventRing<16> ring;
+    constexpr uint32_t PRODUCERS = 8;
+    constexpr uint64_t ATTEMPTS = 50000;
+    std::atomic<uint32_t> finished{0};
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p)
+        producers.emplace_back([&, p] {
+            for (uint64_t i = 0; i < ATTEMPTS; ++i)
+                ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, p, i); });
+            finished.fetch_add(1);
+        });
+
+    uint64_t received = 0;
+    std::vector<uint64_t> nextCount(PRODUCERS, 0);
+    bool ordered = true;
+    BgmCaptureEvent batch[4];
+    for (;;)
+    {
+        size_t count = ring.PopBatch(batch, 4);
+        for (size_t i = 0; i < count; ++i) {
+            // Gaps are dropped events; going backwards would be a duplicate
+            ordered = ordered && IsIntact(batch[i]) && batch[i].timestamp >= nextCount[batch[i].threadId];
+            nextCount[batch[i].threadId] = batch[i].timestamp + 1;
+        }
+        received += count;
+        if (count == 0) {
+            if (finished.load() == PRODUCERS && ring.IsEmpty())
+                break;
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    BgmEventRingStats stats = ring.GetStats();
+    BGM_CHECK(ordered);
+    BGM_CHECK(stats.pushed + stats.overflowed == PRODUCERS * ATTEMPTS);
+    BGM_CHECK(stats.drained == stats.pushed);
+    BGM_CHECK(received == stats.pushed);
+}
+
+// Inline mode's budgeted drain: one batch at least, the rest only while the
+// deadline holds, and leftovers reported.
+BGM_TEST(DrainUntilStopsAtTheDeadline)
+{
+    BgmEventRing<64> ring;
+    for (uint64_t i = 0; i < 10; ++i)
+        BGM_REQUIRE(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, i); }));
+
+    std::vector<uint64_t> seen;
+    auto collect = [&](const BgmCaptureEvent* batch, size_t count) {
+        BGM_CHECK(count >= 1 && count <= 4);
+        for (size_t i = 0; i < count; ++i)
+            seen.push_back(batch[i].timestamp);
+    };
+
+    // Already late: a single batch, then stop with events left
+    auto past = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    BGM_CHECK(ring.DrainUntil<4>(past, collect));
+    BGM_CHECK(seen.size() == 4);
+
+    auto future = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    BGM_CHECK(!ring.DrainUntil<4>(future, collect));
+    BGM_CHECK(seen.size() == 10);
+    for (uint64_t i = 0; i < seen.size(); ++i)
+        BGM_CHECK(seen[i] == i);
+
+    // Nothing queued: nothing processed, nothing left
+    BGM_CHECK(!ring.DrainUntil<4>(past, collect));
+    BGM_CHECK(seen.size() == 10);
+
+    // Exactly one batch left when the deadline passes: not carried over
+    for (uint64_t i = 0; i < 4; ++i)
+        BGM_REQUIRE(ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, 0, 10 + i); }));
+    BGM_CHECK(!ring.DrainUntil<4>(past, collect));
+    BGM_CHECK(seen.size() == 14 && ring.IsEmpty());
+}
+
+// A consumer that blocks whenever the ring is empty, as BgmWorkerThread does.
+// Producers pause now and then so it really sleeps between bursts. A lost
+// wakeup leaves events in the ring with the consumer asleep; the test then
+// fails after a timeout instead of hanging.
+BGM_TEST(BlockingConsumerMissesNoWakeup)
+{
+    static BgmEventRing<64> ring;
+    BgmWakeup<BgmAutoResetEvent> wakeup;
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint64_t EVENTS = 20000;
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> active{true};
+    uint64_t blocked = 0;
+
+    std::thread consumer([&] {
+        BgmCaptureEvent batch[16];
+        while (active.load())
+        {
+            while (size_t count = ring.PopBatch(batch, 16))
+                received.fetch_add(count);
+            blocked += wakeup.Wait([&] { return ring.IsEmpty() && active.load(); });
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p)
+        producers.emplace_back([&, p] {
+            for (uint64_t i = 0; i < EVENTS; ++i)
+            {
+                while (!ring.TryPush([&](BgmCaptureEvent& ev) { FillEvent(ev, p, i); }))
+                    std::this_thread::yield();
+                wakeup.Notify();
+                if (i % 1000 == 999)
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+    for (std::thread& producer : producers)
+        producer.join();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (received.load() < PRODUCERS * EVENTS && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BGM_CHECK(received.load() == PRODUCERS * EVENTS);
+
+    active = false;
+    wakeup.GetEvent().Set();
+    consumer.join();
+    BGM_CHECK(blocked > 0);
+}
+
+BGM_TEST_MAIN()
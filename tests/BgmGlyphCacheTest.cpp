@@ -0,0 +1,223 @@
+// BgmGlyphCache.h: images round-trip the glyph table and bitmaps, and any
+// truncated, stale, misaligned or corrupted image is rejected, including
+// ones whose hash was recomputed to match.
+
+#include <cstring>
+#include <vector>
+
+#include "BgmGlyphCache.h"
+#include "BgmTest.h"
+
+namespace {
+
+const BgmGlyphCacheKey KEY = { 0x1111, 0x2222, 28.0f, 19240 };
+
+// A glyph table shaped like a baked title: varied sizes, a space, and
+// bitmaps packed back to back.
+struct GlyphFixture {
+    std::vector<BgmCachedGlyph> glyphs;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> image;
+
+    explicit GlyphFixture(uint32_t count, const BgmGlyphCacheKey& key = KEY)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            BgmCachedGlyph glyph = {};
+            glyph.codepoint = 0x20 + i;
+            glyph.width = glyph.codepoint == 0x20 ? 0 : (uint16_t)(4 + i % 13);
+            glyph.height = glyph.codepoint == 0x20 ? 0 : (uint16_t)(6 + i % 17);
+            glyph.pixelOffset = (uint32_t)pixels.size();
+            glyph.advanceX = 7.0f + (float)(i % 5);
+            glyph.x0 = -1.0f;
+            glyph.y0 = 3.0f;
+            glyph.x1 = glyph.x0 + glyph.width;
+            glyph.y1 = glyph.y0 + glyph.height;
+            for (uint32_t p = 0; p < (uint32_t)glyph.width * glyph.height; ++p)
+                pixels.push_back((uint8_t)(p * 31 + i));
+            glyphs.push_back(glyph);
+        }
+        BuildBgmGlyphCache(key, glyphs, pixels, &image);
+    }
+};
+
+// OpenBgmGlyphCache wants images aligned as its header, as a loaded file is
+bool Open(const std::vector<uint8_t>& image, BgmGlyphCacheView* outView = nullptr, const BgmGlyphCacheKey& key = KEY)
+{
+    static std::vector<uint64_t> aligned;
+    aligned.assign((image.size() + 7) / 8, 0);
+    if (!image.empty())
+        memcpy(aligned.data(), image.data(), image.size());
+    BgmGlyphCacheView view;
+    bool opened = OpenBgmGlyphCache(aligned.data(), image.size(), key, &view);
+    if (opened && outView)
+        *outView = view; // Valid until the next Open
+    return opened;
+}
+
+BgmGlyphCacheHeader GetHeader(const std::vector<uint8_t>& image)
+{
+    BgmGlyphCacheHeader header;
+    memcpy(&header, image.data(), sizeof(header));
+    return header;
+}
+
+void SetHeader(std::vector<uint8_t>* image, const BgmGlyphCacheHeader& header)
+{
+    memcpy(image->data(), &header, sizeof(header));
+}
+
+// Recomputes the image hash, so only the structural checks can reject it.
+void Reseal(std::vector<uint8_t>* image)
+{
+    BgmGlyphCacheHeader header = GetHeader(*image);
+    header.payloadHash = BgmGlyphCacheDetail::HashImage(header, image->data(), image->size());
+    SetHeader(image, header);
+}
+
+BgmCachedGlyph* GetGlyphs(std::vector<uint8_t>* image)
+{
+    return (BgmCachedGlyph*)(image->data() + sizeof(BgmGlyphCacheHeader));
+}
+
+} // namespace
+
+BGM_TEST(RoundTripsGlyphsAndBitmaps)
+{
+    GlyphFixture fixture(200);
+    BgmGlyphCacheView view;
+    BGM_REQUIRE(Open(fixture.image, &view));
+    BGM_REQUIRE(view.glyphCount == fixture.glyphs.size());
+    BGM_CHECK(memcmp(view.glyphs, fixture.glyphs.data(), fixture.glyphs.size() * sizeof(BgmCachedGlyph)) == 0);
+    BGM_CHECK(memcmp(view.pixels, fixture.pixels.data(), fixture.pixels.size()) == 0);
+
+    GlyphFixture empty(0);
+    BGM_CHECK(Open(empty.image, &view) && view.glyphCount == 0);
+}
+
+BGM_TEST(RejectsOtherKeys)
+{
+    GlyphFixture fixture(50);
+    BGM_REQUIRE(Open(fixture.image));
+
+    BgmGlyphCacheKey keys[4] = { KEY, KEY, KEY, KEY };
+    keys[0].fontHash ^= 1;
+    keys[1].codepointHash ^= 1;
+    keys[2].pixelSize = 56.0f;
+    keys[3].rasterizerVersion += 1;
+    for (const BgmGlyphCacheKey& key : keys)
+        BGM_CHECK(!Open(fixture.image, nullptr, key));
+}
+
+BGM_TEST(RejectsStaleAndMisalignedImages)
+{
+    GlyphFixture fixture(50);
+    std::vector<uint64_t> aligned(fixture.image.size() / 8 + 2);
+    uint8_t* misaligned = (uint8_t*)aligned.data() + 4;
+    memcpy(misaligned, fixture.image.data(), fixture.image.size());
+    BgmGlyphCacheView view;
+    BGM_CHECK(!OpenBgmGlyphCache(misaligned, fixture.image.size(), KEY, &view));
+    BGM_CHECK(!OpenBgmGlyphCache(aligned.data(), 0, KEY, &view));
+
+    // Version 1 images hashed only what follows the header
+    for (uint32_t version : { BGM_GLYPH_CACHE_VERSION - 1, BGM_GLYPH_CACHE_VERSION + 1 })
+    {
+        std::vector<uint8_t> image = fixture.image;
+        BgmGlyphCacheHeader header = GetHeader(image);
+        header.version = version;
+        SetHeader(&image, header);
+        Reseal(&image);
+        BGM_CHECK(!Open(image));
+    }
+}
+
+BGM_TEST(RejectsEveryTruncation)
+{
+    GlyphFixture fixture(60);
+    size_t accepted = 0;
+    for (size_t size = 0; size < fixture.image.size(); ++size)
+        accepted += Open(std::vector<uint8_t>(fixture.image.begin(), fixture.image.begin() + size));
+    BGM_CHECK(accepted == 0);
+
+    // Growing the file is no better
+    std::vector<uint8_t> longer = fixture.image;
+    longer.push_back(0);
+    BGM_CHECK(!Open(longer));
+}
+
+// Header bytes included: a hash over the payload alone let a damaged glyph
+// count or key through
+BGM_TEST(RejectsEverySingleByteCorruption)
+{
+    GlyphFixture fixture(60);
+    size_t accepted = 0;
+    std::vector<uint8_t> image = fixture.image;
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        image[i] ^= 0x40;
+        accepted += Open(image);
+        image[i] ^= 0x40;
+    }
+    BGM_CHECK(accepted == 0);
+    BGM_CHECK(Open(image));
+}
+
+BGM_TEST(RejectsResealedStructuralDamage)
+{
+    GlyphFixture fixture(60);
+
+    // A glyph whose bitmap runs past the pixel section
+    std::vector<uint8_t> image = fixture.image;
+    GetGlyphs(&image)[59].pixelOffset = (uint32_t)fixture.pixels.size() - 1;
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    image = fixture.image;
+    GetGlyphs(&image)[10].width = 0xFFFF;
+    GetGlyphs(&image)[10].height = 0xFFFF;
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    image = fixture.image;
+    GetGlyphs(&image)[0].pixelOffset = 0xFFFFFFFFu;
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    // Counts that disagree with the file's size
+    image = fixture.image;
+    BgmGlyphCacheHeader header = GetHeader(image);
+    header.glyphCount += 1;
+    SetHeader(&image, header);
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    image = fixture.image;
+    header = GetHeader(image);
+    header.glyphCount = 0xFFFFFFFFu;
+    SetHeader(&image, header);
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    image = fixture.image;
+    header = GetHeader(image);
+    header.pixelBytes -= 1;
+    SetHeader(&image, header);
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    image = fixture.image;
+    header = GetHeader(image);
+    header.glyphRecordSize += 4;
+    SetHeader(&image, header);
+    Reseal(&image);
+    BGM_CHECK(!Open(image));
+
+    // A resealed, consistent edit still opens: only the hash stops tampering
+    image = fixture.image;
+    GetGlyphs(&image)[5].advanceX = 99.0f;
+    Reseal(&image);
+    BgmGlyphCacheView view;
+    BGM_CHECK(Open(image, &view) && view.glyphs[5].advanceX == 99.0f);
+}
+
+BGM_TEST_MAIN()
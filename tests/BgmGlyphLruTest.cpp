@@ -0,0 +1,176 @@
+// BgmGlyphLru.h: eviction order, the surface budget, and pins. Glyphs used
+// at or after the pinned tick (the toast on screen) are never victims, even
+// when that leaves the surface over budget.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "BgmGlyphLru.h"
+#include "BgmTest.h"
+
+namespace {
+
+std::vector<uint32_t> PopAll(BgmGlyphLru& lru, uint64_t pinnedTick)
+{
+    std::vector<uint32_t> victims;
+    uint32_t victim;
+    while (lru.PopVictim(pinnedTick, &victim))
+        victims.push_back(victim);
+    return victims;
+}
+
+} // namespace
+
+BGM_TEST(EvictsLeastRecentlyUsedFirst)
+{
+    BgmGlyphLru lru(300);
+    uint64_t tick = 0;
+    for (uint32_t cp = 1; cp <= 5; ++cp)
+        lru.Insert(cp, 100, ++tick);
+    BGM_CHECK(lru.GetCount() == 5 && lru.GetArea() == 500);
+
+    BGM_CHECK(lru.Touch(1, ++tick)); // 2 is now the coldest
+    BGM_CHECK(!lru.Touch(42, ++tick));
+
+    std::vector<uint32_t> victims = PopAll(lru, ++tick);
+    BGM_CHECK((victims == std::vector<uint32_t>{ 2, 3 }));
+    BGM_CHECK(lru.GetCount() == 3 && lru.GetArea() == 300);
+    BGM_CHECK(lru.GetStats().evictions == 2 && lru.GetStats().hits == 1 && lru.GetStats().inserts == 5);
+}
+
+BGM_TEST(StaysWithinBudgetWithoutVictims)
+{
+    BgmGlyphLru lru(1000);
+    for (uint32_t cp = 0; cp < 10; ++cp)
+        lru.Insert(cp, 100, cp + 1);
+    uint32_t victim;
+    BGM_CHECK(!lru.PopVictim(100, &victim));
+    lru.SetBudget(999);
+    BGM_CHECK(lru.PopVictim(100, &victim) && victim == 0);
+    BGM_CHECK(!lru.PopVictim(100, &victim));
+}
+
+BGM_TEST(NeverEvictsPinnedGlyphs)
+{
+    BgmGlyphLru lru(200);
+    uint64_t tick = 0;
+    for (uint32_t cp = 1; cp <= 4; ++cp)
+        lru.Insert(cp, 100, ++tick);
+
+    // The toast on screen uses 1 and 2: pinned from here on
+    uint64_t pinned = ++tick;
+    BGM_CHECK(lru.Touch(1, pinned));
+    BGM_CHECK(lru.Touch(2, pinned));
+    BGM_CHECK((PopAll(lru, pinned) == std::vector<uint32_t>{ 3, 4 }));
+    BGM_CHECK(lru.GetArea() == 200);
+
+    // A long title: more pinned surface than the budget, nothing evictable
+    pinned = ++tick;
+    for (uint32_t cp = 10; cp < 15; ++cp)
+        lru.Insert(cp, 100, pinned);
+    BGM_CHECK((PopAll(lru, pinned) == std::vector<uint32_t>{ 1, 2 }));
+    BGM_CHECK(lru.GetCount() == 5 && lru.GetArea() == 500); // Over budget, all pinned
+
+    // Once the toast is gone they go, coldest first
+    lru.Insert(20, 100, ++tick);
+    pinned = ++tick;
+    BGM_CHECK(lru.Touch(20, pinned));
+    BGM_CHECK((PopAll(lru, pinned) == std::vector<uint32_t>{ 10, 11, 12, 13 }));
+    BGM_CHECK(lru.GetArea() == 200);
+}
+
+BGM_TEST(ReinsertRefreshesAreaAndRecency)
+{
+    BgmGlyphLru lru(250);
+    lru.Insert(1, 100, 1);
+    lru.Insert(2, 100, 2);
+    lru.Insert(1, 150, 3); // Rebaked bigger, and just used
+    BGM_CHECK(lru.GetCount() == 2 && lru.GetArea() == 250 && lru.GetStats().inserts == 2);
+    lru.Insert(3, 10, 4);
+    BGM_CHECK((PopAll(lru, 5) == std::vector<uint32_t>{ 2 }));
+}
+
+BGM_TEST(RemoveAndClearReleaseSurface)
+{
+    BgmGlyphLru lru(0);
+    lru.Insert(1, 100, 1);
+    lru.Insert(2, 50, 2);
+    lru.Remove(1);
+    lru.Remove(7);
+    BGM_CHECK(lru.GetCount() == 1 && lru.GetArea() == 50);
+    uint32_t victim;
+    BGM_CHECK(lru.PopVictim(3, &victim) && victim == 2);
+
+    // Freed nodes are reused
+    for (uint32_t cp = 0; cp < 4; ++cp)
+        lru.Insert(cp, 10, 10 + cp);
+    lru.Clear();
+    BGM_CHECK(lru.GetCount() == 0 && lru.GetArea() == 0);
+    BGM_CHECK(!lru.PopVictim(100, &victim));
+    lru.Insert(9, 10, 20);
+    BGM_CHECK(lru.PopVictim(100, &victim) && victim == 9);
+}
+
+// Random traffic against a plain list model: same victims, same totals, and
+// pinned entries never evicted.
+BGM_TEST(MatchesAReferenceModel)
+{
+    struct Entry {
+        uint32_t codepoint;
+        uint32_t area;
+        uint64_t tick;
+    };
+    std::mt19937 rng(22);
+    BgmGlyphLru lru(5000);
+    std::vector<Entry> model; // Least recently used first
+    uint64_t tick = 0;
+
+    for (int step = 0; step < 20000; ++step)
+    {
+        uint32_t codepoint = rng() % 200;
+        auto it = std::find_if(model.begin(), model.end(), [&](const Entry& e) { return e.codepoint == codepoint; });
+        uint32_t roll = rng() % 10;
+        if (roll < 4) {
+            bool tracked = it != model.end();
+            BGM_CHECK(lru.Touch(codepoint, ++tick) == tracked);
+            if (tracked) {
+                Entry entry = *it;
+                entry.tick = tick;
+                model.erase(it);
+                model.push_back(entry);
+            }
+        } else if (roll < 8) {
+            uint32_t area = 20 + rng() % 200;
+            lru.Insert(codepoint, area, ++tick);
+            if (it != model.end())
+                model.erase(it);
+            model.push_back({ codepoint, area, tick });
+        } else if (roll < 9) {
+            lru.Remove(codepoint);
+            if (it != model.end())
+                model.erase(it);
+        } else {
+            uint64_t pinned = tick > 5 ? tick - rng() % 5 : 0;
+            uint64_t area = 0;
+            for (const Entry& e : model)
+                area += e.area;
+            uint32_t victim;
+            while (area > lru.GetBudget() && !model.empty() && model.front().tick < pinned)
+            {
+                BGM_REQUIRE(lru.PopVictim(pinned, &victim));
+                BGM_CHECK(victim == model.front().codepoint);
+                area -= model.front().area;
+                model.erase(model.begin());
+            }
+            BGM_CHECK(!lru.PopVictim(pinned, &victim));
+        }
+
+        uint64_t area = 0;
+        for (const Entry& e : model)
+            area += e.area;
+        BGM_REQUIRE(lru.GetCount() == model.size() && lru.GetArea() == area);
+    }
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,211 @@
+// BgmGlyphSdf.h: the field's sign (nonzero winding, either contour direction,
+// holes), its value on and around the outline, saturation, flattened curves,
+// and that separate outlines render from several threads at once.
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "BgmGlyphSdf.h"
+#include "BgmTest.h"
+
+namespace {
+
+constexpr float SPREAD = 4.0f;
+constexpr uint8_t ON_EDGE = 128;
+
+void AddRect(BgmSdfOutline* outline, float x0, float y0, float x1, float y1, bool clockwise)
+{
+    outline->MoveTo(x0, y0);
+    if (clockwise) {
+        outline->LineTo(x1, y0);
+        outline->LineTo(x1, y1);
+        outline->LineTo(x0, y1);
+    } else {
+        outline->LineTo(x0, y1);
+        outline->LineTo(x1, y1);
+        outline->LineTo(x1, y0);
+    }
+    outline->Close();
+}
+
+// A w x h field whose texel (i, j) is centered on (i + 0.5, j + 0.5).
+std::vector<uint8_t> Render(const BgmSdfOutline& outline, int w, int h)
+{
+    std::vector<uint8_t> field((size_t)w * h);
+    RenderBgmSdf(outline, w, h, 0.0f, 0.0f, SPREAD, ON_EDGE, field.data(), w);
+    return field;
+}
+
+// What the field holds `distance` px inside (> 0) or outside (< 0) the outline.
+int Expected(float distance)
+{
+    float value = ON_EDGE + distance * (ON_EDGE / SPREAD);
+    return std::clamp((int)std::lround(value), 0, 255);
+}
+
+} // namespace
+
+BGM_TEST(SignFollowsTheOutline)
+{
+    BgmSdfOutline outline;
+    AddRect(&outline, 8.0f, 8.0f, 24.0f, 24.0f, true);
+    std::vector<uint8_t> field = Render(outline, 32, 32);
+    for (int j = 0; j < 32; ++j)
+    {
+        for (int i = 0; i < 32; ++i)
+        {
+            bool inside = i >= 8 && i < 24 && j >= 8 && j < 24;
+            BGM_CHECK((field[j * 32 + i] > ON_EDGE) == inside);
+        }
+    }
+}
+
+BGM_TEST(ValuesAroundTheEdge)
+{
+    BgmSdfOutline outline;
+    AddRect(&outline, 8.0f, 8.0f, 24.0f, 24.0f, true);
+    std::vector<uint8_t> field = Render(outline, 32, 32);
+
+    // Along row 16, away from the corners: texel centers 0.5, 1.5, ... px from x = 8
+    const uint8_t* row = &field[16 * 32];
+    for (int k = 0; k < 4; ++k) {
+        BGM_CHECK(row[8 + k] == Expected(k + 0.5f));
+        BGM_CHECK(row[7 - k] == Expected(-(k + 0.5f)));
+        BGM_CHECK(row[8 + k] + row[7 - k] == 2 * ON_EDGE); // Symmetric about the edge
+    }
+
+    // Saturated past the spread either side
+    BGM_CHECK(row[16] == 255);
+    BGM_CHECK(row[0] == 0 && row[31] == 0);
+    BGM_CHECK(field[0] == 0);
+
+    // A texel centered on the outline holds ON_EDGE exactly
+    BgmSdfOutline onCenters;
+    AddRect(&onCenters, 8.5f, 8.5f, 24.5f, 24.5f, true);
+    BGM_CHECK(Render(onCenters, 32, 32)[16 * 32 + 8] == ON_EDGE);
+}
+
+BGM_TEST(EitherDirectionGivesTheSameField)
+{
+    BgmSdfOutline clockwise, counterClockwise;
+    AddRect(&clockwise, 5.0f, 6.0f, 27.0f, 20.0f, true);
+    AddRect(&counterClockwise, 5.0f, 6.0f, 27.0f, 20.0f, false);
+    BGM_CHECK(Render(clockwise, 32, 32) == Render(counterClockwise, 32, 32));
+}
+
+BGM_TEST(NonzeroWindingForHolesAndOverlaps)
+{
+    // A counter-wound inner contour is a hole (an "O")...
+    BgmSdfOutline ring;
+    AddRect(&ring, 4.0f, 4.0f, 28.0f, 28.0f, true);
+    AddRect(&ring, 12.0f, 12.0f, 20.0f, 20.0f, false);
+    std::vector<uint8_t> field = Render(ring, 32, 32);
+    BGM_CHECK(field[16 * 32 + 16] < ON_EDGE);  // In the hole
+    BGM_CHECK(field[16 * 32 + 16] == Expected(-3.5f));
+    BGM_CHECK(field[16 * 32 + 6] > ON_EDGE);   // In the ring
+    BGM_CHECK(field[0] < ON_EDGE);
+
+    // ...an equally wound one overlaps, and is filled
+    BgmSdfOutline overlap;
+    AddRect(&overlap, 4.0f, 4.0f, 28.0f, 28.0f, true);
+    AddRect(&overlap, 12.0f, 12.0f, 20.0f, 20.0f, true);
+    BGM_CHECK(Render(overlap, 32, 32)[16 * 32 + 16] > ON_EDGE);
+}
+
+BGM_TEST(CurvesAreFlattenedClosely)
+{
+    // A circle of radius 10 as four cubics (and the same as quadratics)
+    const float cx = 16.0f, cy = 16.0f, r = 10.0f, k = 0.5523f * r;
+    BgmSdfOutline cubic;
+    cubic.MoveTo(cx + r, cy);
+    cubic.CubicTo(cx + r, cy + k, cx + k, cy + r, cx, cy + r);
+    cubic.CubicTo(cx - k, cy + r, cx - r, cy + k, cx - r, cy);
+    cubic.CubicTo(cx - r, cy - k, cx - k, cy - r, cx, cy - r);
+    cubic.CubicTo(cx + k, cy - r, cx + r, cy - k, cx + r, cy);
+    cubic.Close();
+
+    BgmSdfOutline quad;
+    quad.MoveTo(cx + r, cy);
+    for (int i = 1; i <= 8; ++i)
+    {
+        float a = i * 3.14159265f / 4.0f, mid = a - 3.14159265f / 8.0f;
+        float reach = r / std::cos(3.14159265f / 8.0f);
+        quad.QuadTo(cx + reach * std::cos(mid), cy + reach * std::sin(mid), cx + r * std::cos(a), cy + r * std::sin(a));
+    }
+    quad.Close();
+
+    for (const BgmSdfOutline* outline : { &cubic, &quad })
+    {
+        std::vector<uint8_t> field = Render(*outline, 32, 32);
+        for (int j = 0; j < 32; ++j)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                float d = r - std::hypot(i + 0.5f - cx, j + 0.5f - cy);
+                // Within a tenth of a pixel of the true circle (a quadratic
+                // conic is within 0.03 px of it at this radius)
+                BGM_CHECK(std::abs(field[j * 32 + i] - Expected(d)) <= (int)std::ceil(0.1f * ON_EDGE / SPREAD));
+            }
+        }
+    }
+}
+
+BGM_TEST(OriginAndPitch)
+{
+    BgmSdfOutline outline;
+    AddRect(&outline, 100.0f, 200.0f, 110.0f, 210.0f, true);
+
+    // The same field, shifted to the outline and written with a row pitch
+    const int w = 18, h = 18, pitch = 32;
+    std::vector<uint8_t> rows((size_t)pitch * h, 0x5A);
+    RenderBgmSdf(outline, w, h, 96.0f, 196.0f, SPREAD, ON_EDGE, rows.data(), pitch);
+
+    BgmSdfOutline atOrigin;
+    AddRect(&atOrigin, 4.0f, 4.0f, 14.0f, 14.0f, true);
+    std::vector<uint8_t> field = Render(atOrigin, w, h);
+    for (int j = 0; j < h; ++j)
+    {
+        for (int i = 0; i < pitch; ++i)
+            BGM_CHECK(rows[j * pitch + i] == (i < w ? field[j * w + i] : 0x5A));
+    }
+}
+
+BGM_TEST(EmptyOutlineIsAllOutside)
+{
+    BgmSdfOutline outline;
+    outline.Close();
+    std::vector<uint8_t> field = Render(outline, 8, 8);
+    for (uint8_t value : field)
+        BGM_CHECK(value == 0);
+
+    AddRect(&outline, 1.0f, 1.0f, 7.0f, 7.0f, true);
+    outline.Clear();
+    BGM_CHECK(outline.GetSegments().empty());
+}
+
+// The rasterizer thread renders its slices' outlines on several threads.
+BGM_TEST(SeparateOutlinesRenderConcurrently)
+{
+    std::vector<BgmSdfOutline> outlines(4);
+    for (size_t n = 0; n < outlines.size(); ++n)
+        AddRect(&outlines[n], 2.0f + n, 3.0f, 20.0f, 18.0f + n, n % 2 == 0);
+
+    std::vector<std::vector<uint8_t>> expected;
+    for (const BgmSdfOutline& outline : outlines)
+        expected.push_back(Render(outline, 24, 24));
+
+    std::vector<std::vector<uint8_t>> fields(outlines.size());
+    std::vector<std::thread> threads;
+    for (size_t n = 0; n < outlines.size(); ++n)
+        threads.emplace_back([&, n] {
+            for (int repeat = 0; repeat < 20; ++repeat)
+                fields[n] = Render(outlines[n], 24, 24);
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    BGM_CHECK(fields == expected);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,306 @@
+// BgmIndex.h: the basename Bloom filter, the perfect hash and the reversed
+// path trie, each against a plain std::unordered_map or brute-force reference.
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "BgmIndex.h"
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+static std::vector<uint64_t> HashBasenames(const std::vector<std::string>& paths)
+{
+    std::vector<uint64_t> hashes;
+    for (const std::string& path : paths)
+    {
+        BgmPathInfo info = ClassifyPath(path.c_str());
+        hashes.push_back(HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset));
+    }
+    return hashes;
+}
+
+// -------------------------------------------------------------
+// Basename Bloom filter
+// -------------------------------------------------------------
+
+BGM_TEST(FilterHasNoFalseNegatives)
+{
+    for (size_t count : { (size_t)0, (size_t)1, (size_t)57, (size_t)50000 })
+    {
+        std::vector<uint64_t> hashes = HashBasenames(MakeSyntheticBgmKeys(count));
+        std::vector<uint64_t> words;
+        BuildBasenameFilter(hashes, &words);
+        BGM_CHECK(words.size() * 64 >= BGM_FILTER_MIN_BITS);
+        BGM_CHECK((words.size() & (words.size() - 1)) == 0);
+        BGM_CHECK(words.size() * 64 >= count * BGM_FILTER_BITS_PER_KEY);
+        for (uint64_t hash : hashes)
+            BGM_CHECK(BasenameFilterMayContain(words.data(), words.size(), hash));
+    }
+}
+
+BGM_TEST(EmptyFilterRejectsEverything)
+{
+    BGM_CHECK(!BasenameFilterMayContain(nullptr, 0, HashUtf8Basename("y8_b001.ogg", 11)));
+
+    BgmTrackIndex index;
+    BGM_REQUIRE(index.Build({}));
+    BGM_CHECK(!index.MayContain(HashUtf8Basename("y8_b001.ogg", 11)));
+}
+
+// 16 bits and 4 probes per key give ~0.24% false positives at full load;
+// allow twice that on the shipped map and on a 50k-key one.
+BGM_TEST(FalsePositiveRateOnVoiceTrace)
+{
+    std::vector<std::vector<std::string>> keySets = { GetBgmTestKeys(LoadShippedBgmMap()), MakeSyntheticBgmKeys(50000) };
+    BgmTestTrace trace = MakeBgmTestTrace({}, 100000, 0);
+    std::vector<uint64_t> misses = HashBasenames(trace.oggMisses);
+
+    for (const std::vector<std::string>& keys : keySets)
+    {
+        BGM_REQUIRE(!keys.empty());
+        std::vector<uint64_t> hashes = HashBasenames(keys);
+        std::unordered_set<uint64_t> known(hashes.begin(), hashes.end());
+        std::vector<uint64_t> words;
+        BuildBasenameFilter(hashes, &words);
+
+        size_t falsePositives = 0;
+        for (uint64_t hash : misses)
+        {
+            BGM_CHECK(known.count(hash) == 0);
+            falsePositives += BasenameFilterMayContain(words.data(), words.size(), hash);
+        }
+        double rate = (double)falsePositives / (double)misses.size();
+        std::printf("  %zu keys, %zu bytes: %zu/%zu false positives (%.3f%%)\n",
+            keys.size(), words.size() * sizeof(uint64_t), falsePositives, misses.size(), rate * 100.0);
+        BGM_CHECK(rate < 0.005);
+    }
+}
+
+BGM_TEST(IndexFilterAgreesWithKeys)
+{
+    std::vector<BgmTestEntry> entries = LoadShippedBgmMap();
+    BGM_REQUIRE(!entries.empty());
+    BgmTrackIndex index;
+    BGM_REQUIRE(index.Build(GetBgmTestKeys(entries)));
+
+    // Case and separator style do not matter to the basename hash
+    uint64_t hash;
+    const char upper[] = "Y8_B001.OGG";
+    BGM_REQUIRE(HashAsciiBasename(upper, sizeof(upper) - 1, &hash));
+    BGM_CHECK(hash == HashUtf8Basename("y8_b001.ogg", 11));
+
+    for (const std::string& path : MakeBgmTestTrace(GetBgmTestKeys(entries), 0, 0).bgmHits)
+    {
+        BgmPathInfo info = ClassifyPath(path.c_str());
+        BGM_REQUIRE(HashAsciiBasename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset, &hash));
+        BGM_CHECK(index.MayContain(hash));
+    }
+}
+
+// -------------------------------------------------------------
+// Minimal perfect hash
+// -------------------------------------------------------------
+
+// Every built key finds its own value, every slot is used exactly once, and
+// the table agrees with std::unordered_map on the same keys.
+static void CheckPerfectHash(const std::vector<uint64_t>& hashes)
+{
+    std::vector<uint16_t> values;
+    std::unordered_map<uint64_t, uint16_t> reference;
+    for (size_t i = 0; i < hashes.size(); ++i)
+    {
+        values.push_back((uint16_t)i);
+        reference.emplace(hashes[i], (uint16_t)i);
+    }
+    BGM_REQUIRE(reference.size() == hashes.size());
+
+    std::vector<uint32_t> seeds;
+    std::vector<uint16_t> slots;
+    BGM_REQUIRE(BuildPerfectHash(hashes, values, &seeds, &slots));
+    BGM_CHECK(slots.size() == hashes.size());
+    BGM_CHECK(seeds.size() == (hashes.size() + BGM_HASH_KEYS_PER_BUCKET - 1) / BGM_HASH_KEYS_PER_BUCKET);
+
+    std::vector<bool> used(hashes.size(), false);
+    size_t mismatches = 0;
+    for (const auto& entry : reference)
+    {
+        uint16_t found = PerfectHashFind(seeds.data(), seeds.size(), slots.data(), slots.size(), entry.first);
+        if (found != entry.second || used[found])
+            ++mismatches;
+        else
+            used[found] = true;
+    }
+    BGM_CHECK(mismatches == 0);
+}
+
+BGM_TEST(PerfectHashMatchesUnorderedMap)
+{
+    CheckPerfectHash(HashBasenames(GetBgmTestKeys(LoadShippedBgmMap())));
+    for (size_t count : { (size_t)1, (size_t)2, (size_t)5, (size_t)57, (size_t)1000, (size_t)50000 })
+        CheckPerfectHash(HashBasenames(MakeSyntheticBgmKeys(count)));
+}
+
+BGM_TEST(EmptyPerfectHashFindsNothing)
+{
+    std::vector<uint32_t> seeds;
+    std::vector<uint16_t> slots;
+    BGM_REQUIRE(BuildPerfectHash({}, {}, &seeds, &slots));
+    BGM_CHECK(seeds.empty() && slots.empty());
+    BGM_CHECK(PerfectHashFind(seeds.data(), 0, slots.data(), 0, 1234) == BGM_INVALID_TRACK_ID);
+}
+
+// The index confirms the basename after the hash, so a path that is not a key
+// resolves to nothing even though the perfect hash answers for any input.
+BGM_TEST(IndexMatchesUnorderedMap)
+{
+    for (size_t count : { (size_t)57, (size_t)50000 })
+    {
+        std::vector<std::string> keys = MakeSyntheticBgmKeys(count);
+        BgmTrackIndex index;
+        BGM_REQUIRE(index.Build(keys));
+        BGM_CHECK(index.GetShadowedKeys().empty());
+
+        std::unordered_map<std::string, uint16_t> reference;
+        for (size_t id = 0; id < keys.size(); ++id)
+            reference.emplace(keys[id], (uint16_t)id);
+
+        BgmTestTrace trace = MakeBgmTestTrace(keys, 2000, 0);
+        trace.oggMisses.push_back(std::string(BGM_TEST_GAME_DIR) + "bgm\\y8_z99999.ogg");
+        trace.oggMisses.push_back(std::string(BGM_TEST_GAME_DIR) + "voice\\" + keys[0].substr(4));
+        size_t mismatches = 0;
+        for (const std::vector<std::string>* paths : { &trace.bgmHits, &trace.oggMisses })
+        {
+            for (const std::string& path : *paths)
+            {
+                BgmPathInfo info = ClassifyPath(path.c_str());
+                uint64_t hash = HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset);
+                auto expected = reference.find(path.substr(sizeof(BGM_TEST_GAME_DIR) - 1));
+                uint16_t wanted = expected == reference.end() ? BGM_INVALID_TRACK_ID : expected->second;
+                if (index.Find(hash, path.c_str(), info.length, info.basenameOffset) != wanted)
+                    ++mismatches;
+            }
+        }
+        BGM_CHECK(mismatches == 0);
+    }
+}
+
+// -------------------------------------------------------------
+// Reversed path trie
+// -------------------------------------------------------------
+
+static std::string FoldKey(const std::string& text)
+{
+    std::string folded;
+    for (char c : text)
+        folded.push_back((char)FoldPathUnit((uint8_t)c));
+    return folded;
+}
+
+// Brute force: the longest key that is a folded suffix of the path and has
+// the path's basename; equal folded keys resolve to the first one.
+static uint16_t FindLongestKey(const std::vector<std::string>& keys, const std::string& path)
+{
+    std::string folded = FoldKey(path);
+    std::string basename = folded.substr(folded.find_last_of('\\') + 1);
+    uint16_t best = BGM_INVALID_TRACK_ID;
+    size_t bestLength = 0;
+    for (size_t id = 0; id < keys.size(); ++id)
+    {
+        std::string key = FoldKey(keys[id]);
+        if (key.size() > folded.size() || folded.compare(folded.size() - key.size(), key.size(), key) != 0)
+            continue;
+        if (key.substr(key.find_last_of('\\') + 1) != basename)
+            continue;
+        if (best == BGM_INVALID_TRACK_ID || key.size() > bestLength) {
+            best = (uint16_t)id;
+            bestLength = key.size();
+        }
+    }
+    return best;
+}
+
+static uint16_t FindInIndex(const BgmTrackIndex& index, const std::string& path)
+{
+    BgmPathInfo info = ClassifyPath(path.c_str());
+    uint64_t hash = HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset);
+    return index.Find(hash, path.c_str(), info.length, info.basenameOffset);
+}
+
+BGM_TEST(OverlappingKeysResolveToTheLongest)
+{
+    const std::vector<std::string> keys = {
+        "a.ogg",            // 0
+        "bgm\\a.ogg",       // 1
+        "bgm2\\a.ogg",      // 2
+        "data\\bgm\\a.ogg", // 3
+        "BGM/A.OGG",        // 4: folds onto 1, shadowed
+        "gm\\b.ogg",        // 5
+    };
+    BgmTrackIndex index;
+    BGM_REQUIRE(index.Build(keys));
+    BGM_CHECK(index.GetShadowedKeys() == std::vector<uint16_t>{ 4 });
+
+    struct Case {
+        const char* path;
+        uint16_t trackId;
+    };
+    const Case cases[] = {
+        { "a.ogg", 0 },
+        { "C:\\game\\a.ogg", 0 },
+        { "C:\\game\\bgm\\a.ogg", 1 },
+        { "C:/game/BGM/a.OGG", 1 },
+        { "C:\\game\\bgm2\\a.ogg", 2 },
+        { "C:\\game\\data\\bgm\\a.ogg", 3 },
+        { "C:\\game\\xdata\\bgm\\a.ogg", 3 }, // Suffix match, as before the trie
+        { "C:\\game\\bgm\\b.ogg", 5 },
+        { "C:\\game\\b.ogg", BGM_INVALID_TRACK_ID },
+        { "C:\\game\\bgm\\ba.ogg", BGM_INVALID_TRACK_ID }, // Basenames match whole
+        { "C:\\game\\bgm\\c.ogg", BGM_INVALID_TRACK_ID },
+    };
+    for (const Case& c : cases)
+    {
+        BGM_CHECK(FindInIndex(index, c.path) == c.trackId);
+        BGM_CHECK(FindLongestKey(keys, c.path) == c.trackId);
+    }
+}
+
+// Random keys and paths over a tiny alphabet, so they share basenames and
+// folders and overlap in every way, against the brute-force scan.
+BGM_TEST(RandomKeysMatchBruteForce)
+{
+    static const char* const FOLDERS[] = { "bgm", "BGM", "bgm2", "gm", "data", "a", "" };
+    static const char* const NAMES[] = { "a.ogg", "A.ogg", "b.ogg", "ab.ogg", "y8_b001.ogg" };
+    std::mt19937 rng(6);
+    auto randomPath = [&](size_t maxDepth) {
+        std::string path;
+        for (size_t depth = rng() % (maxDepth + 1); depth > 0; --depth)
+        {
+            path += FOLDERS[rng() % 7];
+            path += rng() % 4 ? '\\' : '/';
+        }
+        return path + NAMES[rng() % 5];
+    };
+
+    size_t mismatches = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<std::string> keys;
+        for (size_t i = rng() % 24; i > 0; --i)
+            keys.push_back(randomPath(3));
+        BgmTrackIndex index;
+        BGM_REQUIRE(index.Build(keys));
+        for (int probe = 0; probe < 200; ++probe)
+        {
+            std::string path = randomPath(5);
+            if (FindInIndex(index, path) != FindLongestKey(keys, path))
+                ++mismatches;
+        }
+    }
+    BGM_CHECK(mismatches == 0);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,262 @@
+// BgmMapCache.h: images round-trip the store and index tables, are the same
+// bytes on every build, and any truncated, stale or corrupted image is
+// rejected, including ones whose hash was recomputed to match.
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "BgmMapCache.h"
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+constexpr uint64_t SOURCE_HASH = 0x1234;
+
+struct CacheFixture {
+    BgmTrackStore store;
+    BgmTrackIndex index;
+    std::vector<uint8_t> image;
+
+    explicit CacheFixture(const std::vector<BgmTestEntry>& entries)
+    {
+        std::vector<std::string> keys;
+        for (const BgmTestEntry& entry : entries)
+        {
+            store.Add(entry.key, entry.title, entry.disc, entry.track);
+            keys.push_back(entry.key);
+        }
+        index.Build(keys);
+        BuildBgmMapCache(store.GetTables(), index.GetTables(), SOURCE_HASH, &image);
+    }
+};
+
+// OpenBgmMapCache wants 8-byte aligned images, as a mapped file is
+bool Open(const std::vector<uint8_t>& image, BgmTrackStoreTables* store, BgmTrackIndexTables* index, uint64_t sourceHash = SOURCE_HASH)
+{
+    std::vector<uint64_t> aligned((image.size() + 7) / 8);
+    if (!image.empty())
+        memcpy(aligned.data(), image.data(), image.size());
+    BgmTrackStoreTables s;
+    BgmTrackIndexTables i;
+    bool opened = OpenBgmMapCache(aligned.data(), image.size(), sourceHash, &s, &i);
+    if (opened && store && index) {
+        // Only used for checks that finish before `aligned` goes away
+        *store = s;
+        *index = i;
+    }
+    return opened;
+}
+
+bool Open(const std::vector<uint8_t>& image, uint64_t sourceHash = SOURCE_HASH)
+{
+    return Open(image, nullptr, nullptr, sourceHash);
+}
+
+BgmCacheHeader GetHeader(const std::vector<uint8_t>& image)
+{
+    BgmCacheHeader header;
+    memcpy(&header, image.data(), sizeof(header));
+    return header;
+}
+
+// Recomputes the image hash, so only the structural checks can reject it.
+void Reseal(std::vector<uint8_t>* image)
+{
+    BgmCacheHeader header = GetHeader(*image);
+    header.payloadHash = BgmMapCacheDetail::HashImage(header, image->data(), image->size());
+    memcpy(image->data(), &header, sizeof(header));
+}
+
+template <typename T>
+T* GetSection(std::vector<uint8_t>* image, BgmCacheSection section)
+{
+    return (T*)(image->data() + GetHeader(*image).sections[section].offset);
+}
+
+} // namespace
+
+BGM_TEST(RoundTripsTheShippedMap)
+{
+    std::vector<BgmTestEntry> entries = LoadShippedBgmMap();
+    BGM_REQUIRE(!entries.empty());
+    CacheFixture fixture(entries);
+
+    std::vector<uint64_t> aligned((fixture.image.size() + 7) / 8);
+    memcpy(aligned.data(), fixture.image.data(), fixture.image.size());
+    BgmTrackStoreTables storeTables;
+    BgmTrackIndexTables indexTables;
+    BGM_REQUIRE(OpenBgmMapCache(aligned.data(), fixture.image.size(), SOURCE_HASH, &storeTables, &indexTables));
+
+    BgmTrackStore store;
+    store.Attach(storeTables);
+    BgmTrackIndex index;
+    index.Attach(indexTables);
+    BGM_REQUIRE(store.GetCount() == entries.size());
+    BGM_CHECK(index.GetSizeInBytes() == fixture.index.GetSizeInBytes());
+
+    for (size_t id = 0; id < entries.size(); ++id)
+    {
+        BGM_CHECK(entries[id].key == store.GetKey((uint16_t)id));
+        BGM_CHECK(entries[id].title == store.GetTitle((uint16_t)id));
+        BGM_CHECK(store.GetDisc((uint16_t)id) == entries[id].disc);
+        BGM_CHECK(store.GetTrackNumber((uint16_t)id) == entries[id].track);
+
+        std::string path = BGM_TEST_GAME_DIR + entries[id].key;
+        BgmPathInfo info = ClassifyPath(path.c_str());
+        uint64_t hash = HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset);
+        BGM_CHECK(index.MayContain(hash));
+        BGM_CHECK(index.Find(hash, path.c_str(), info.length, info.basenameOffset) ==
+                  fixture.index.Find(hash, path.c_str(), info.length, info.basenameOffset));
+    }
+}
+
+BGM_TEST(RoundTripsAnEmptyMap)
+{
+    CacheFixture fixture({});
+    BgmTrackStoreTables store;
+    BgmTrackIndexTables index;
+    BGM_CHECK(Open(fixture.image, &store, &index));
+    BGM_CHECK(store.trackCount == 0 && index.groupCount == 0 && index.nodeCount == 0);
+}
+
+// Trie node padding is zeroed, so the same map always gives the same image.
+BGM_TEST(ImagesAreTheSameBytesOnEveryBuild)
+{
+    static_assert(sizeof(BgmTrieNode) > offsetof(BgmTrieNode, unit) + 1, "BgmTrieNode has no padding to check");
+    std::vector<BgmTestEntry> entries = LoadShippedBgmMap();
+    BGM_REQUIRE(!entries.empty());
+
+    std::vector<uint8_t> first;
+    for (int build = 0; build < 4; ++build)
+    {
+        // Leave garbage where the next build's nodes are likely to be allocated
+        {
+            std::vector<uint8_t> dirty(1 << 16, 0xA5);
+            BgmBenchKeep(dirty[build]);
+        }
+        CacheFixture fixture(entries);
+        const BgmTrackIndexTables& tables = fixture.index.GetTables();
+        for (size_t n = 0; n < tables.nodeCount; ++n)
+        {
+            const uint8_t* bytes = (const uint8_t*)&tables.nodes[n];
+            for (size_t b = offsetof(BgmTrieNode, unit) + 1; b < sizeof(BgmTrieNode); ++b)
+                BGM_CHECK(bytes[b] == 0);
+        }
+        if (build == 0)
+            first = fixture.image;
+        BGM_CHECK(fixture.image == first);
+    }
+}
+
+BGM_TEST(RejectsStaleAndMisalignedImages)
+{
+    CacheFixture fixture(LoadShippedBgmMap());
+    BGM_REQUIRE(Open(fixture.image));
+    BGM_CHECK(!Open(fixture.image, SOURCE_HASH + 1));
+
+    std::vector<uint64_t> aligned(fixture.image.size() / 8 + 2);
+    uint8_t* misaligned = (uint8_t*)aligned.data() + 4;
+    memcpy(misaligned, fixture.image.data(), fixture.image.size());
+    BgmTrackStoreTables store;
+    BgmTrackIndexTables index;
+    BGM_CHECK(!OpenBgmMapCache(misaligned, fixture.image.size(), SOURCE_HASH, &store, &index));
+    BGM_CHECK(!OpenBgmMapCache(aligned.data(), 0, SOURCE_HASH, &store, &index));
+
+    for (uint32_t version : { BGM_CACHE_VERSION - 1, BGM_CACHE_VERSION + 1 })
+    {
+        std::vector<uint8_t> image = fixture.image;
+        BgmCacheHeader header = GetHeader(image);
+        header.version = version;
+        memcpy(image.data(), &header, sizeof(header));
+        BGM_CHECK(!Open(image));
+    }
+}
+
+BGM_TEST(RejectsEveryTruncation)
+{
+    CacheFixture fixture(LoadShippedBgmMap());
+    size_t accepted = 0;
+    for (size_t size = 0; size < fixture.image.size(); ++size)
+        accepted += Open(std::vector<uint8_t>(fixture.image.begin(), fixture.image.begin() + size));
+    BGM_CHECK(accepted == 0);
+}
+
+BGM_TEST(RejectsEverySingleByteCorruption)
+{
+    CacheFixture fixture(LoadShippedBgmMap());
+    size_t accepted = 0;
+    std::vector<uint8_t> image = fixture.image;
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        image[i] ^= 0x40;
+        accepted += Open(image);
+        image[i] ^= 0x40;
+    }
+    BGM_CHECK(accepted == 0);
+}
+
+// Corruption that comes with a matching hash (a buggy writer rather
+// than a bad disk) must still never reach the lookup code.
+BGM_TEST(RejectsResealedStructuralDamage)
+{
+    CacheFixture fixture(LoadShippedBgmMap());
+    const BgmTrackIndexTables& tables = fixture.index.GetTables();
+    BGM_REQUIRE(tables.nodeCount > 2 && tables.groupCount > 1);
+
+    struct Damage {
+        const char* name;
+        void (*apply)(std::vector<uint8_t>* image, const BgmTrackIndexTables& tables);
+    };
+    const Damage damages[] = {
+        { "key offset past the pool", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            GetSection<uint32_t>(image, BGM_CACHE_KEY_OFFSETS)[0] = 0x7FFFFFFF; } },
+        { "unterminated pool", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            GetSection<char>(image, BGM_CACHE_STRING_POOL)[GetHeader(*image).sections[BGM_CACHE_STRING_POOL].count - 1] = 'x'; } },
+        { "slot names no group", [](std::vector<uint8_t>* image, const BgmTrackIndexTables& t) {
+            GetSection<uint16_t>(image, BGM_CACHE_HASH_SLOTS)[0] = (uint16_t)t.groupCount; } },
+        { "root past the nodes", [](std::vector<uint8_t>* image, const BgmTrackIndexTables& t) {
+            GetSection<uint32_t>(image, BGM_CACHE_GROUP_ROOTS)[0] = (uint32_t)t.nodeCount; } },
+        { "name offsets out of order", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            GetSection<uint32_t>(image, BGM_CACHE_NAME_OFFSETS)[1] = 0xFFFF; } },
+        { "child past the nodes", [](std::vector<uint8_t>* image, const BgmTrackIndexTables& t) {
+            GetSection<BgmTrieNode>(image, BGM_CACHE_TRIE_NODES)[0].firstChild = (uint32_t)t.nodeCount; } },
+        { "node is its own child", [](std::vector<uint8_t>* image, const BgmTrackIndexTables& t) {
+            GetSection<BgmTrieNode>(image, BGM_CACHE_TRIE_NODES)[t.nodeCount - 1].firstChild = (uint32_t)t.nodeCount - 1; } },
+        { "node is its own sibling", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            GetSection<BgmTrieNode>(image, BGM_CACHE_TRIE_NODES)[1].nextSibling = 1; } },
+        { "sibling loop", [](std::vector<uint8_t>* image, const BgmTrackIndexTables& t) {
+            GetSection<BgmTrieNode>(image, BGM_CACHE_TRIE_NODES)[0].nextSibling = (uint32_t)t.nodeCount - 1; } },
+        { "track ID past the store", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            GetSection<BgmTrieNode>(image, BGM_CACHE_TRIE_NODES)[0].trackId = BGM_MAX_TRACKS - 1; } },
+        { "filter size not a power of two", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            BgmCacheHeader header = GetHeader(*image);
+            header.sections[BGM_CACHE_FILTER_WORDS].count -= 1;
+            memcpy(image->data(), &header, sizeof(header)); } },
+        { "section past the end", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            BgmCacheHeader header = GetHeader(*image);
+            header.sections[BGM_CACHE_TRIE_NODES].count += 1;
+            memcpy(image->data(), &header, sizeof(header)); } },
+        { "misaligned section", [](std::vector<uint8_t>* image, const BgmTrackIndexTables&) {
+            BgmCacheHeader header = GetHeader(*image);
+            header.sections[BGM_CACHE_HASH_SEEDS].offset += 4;
+            memcpy(image->data(), &header, sizeof(header)); } },
+    };
+    for (const Damage& damage : damages)
+    {
+        std::vector<uint8_t> image = fixture.image;
+        damage.apply(&image, tables);
+        Reseal(&image);
+        if (Open(image))
+            std::printf("  accepted: %s\n", damage.name);
+        BGM_CHECK(!Open(image));
+    }
+
+    std::vector<uint8_t> image = fixture.image;
+    Reseal(&image);
+    BGM_CHECK(Open(image));
+}
+
+BGM_TEST_MAIN()
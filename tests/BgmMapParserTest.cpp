@@ -0,0 +1,218 @@
+// BgmMapParser against yaml-cpp: the shipped BgmMap.yaml and a set of lines
+// that exercise quoting, escapes and comments must give the same keys and
+// values, and everything outside the subset must be handed to yaml-cpp
+// (Unsupported) or rejected by both (Error).
+
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "BgmMapParser.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+struct KeyValue {
+    std::string key;
+    std::string value;
+};
+
+// What main.cpp's fallback reads: every top-level pair as strings. A
+// document that is not a mapping yields no tracks, so it counts as rejected.
+bool LoadWithYamlCpp(const std::string& source, std::vector<KeyValue>* out)
+{
+    try {
+        YAML::Node config = YAML::Load(source);
+        if (!config.IsMap())
+            return false;
+        for (const auto& node : config)
+            out->push_back({ node.first.as<std::string>(), node.second.as<std::string>() });
+        return true;
+    } catch (const YAML::Exception&) {
+        return false;
+    }
+}
+
+// The parser's entries re-joined into the "title|disc|track" value, for
+// comparison with yaml-cpp's scalar. Only valid for well-formed values.
+std::string JoinValue(const BgmMapParsedEntry& entry, const std::string& original)
+{
+    if (!entry.wellFormed)
+        return original;
+    return std::string(entry.title) + "|" + std::to_string(entry.disc) + "|" + std::to_string(entry.track);
+}
+
+// Parses `source` both ways and checks the entries agree, key and value.
+void CheckMatchesYamlCpp(const std::string& source)
+{
+    BgmMapParser parser;
+    BgmMapParseStatus status = parser.Parse(source.data(), source.size());
+    std::vector<KeyValue> expected;
+    bool yamlOk = LoadWithYamlCpp(source, &expected);
+    if (status != BgmMapParseStatus::Ok || !yamlOk) {
+        std::printf("  \"%s\": parser %d (%s), yaml-cpp %d\n", source.c_str(), (int)status, parser.GetMessage(), (int)yamlOk);
+        BGM_CHECK(false);
+        return;
+    }
+    const std::vector<BgmMapParsedEntry>& entries = parser.GetEntries();
+    BGM_REQUIRE(entries.size() == expected.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        std::string_view title;
+        uint8_t disc = 0, track = 0;
+        bool wellFormed = ParseBgmValue(std::string_view(expected[i].value), &title, &disc, &track);
+        if (entries[i].key != expected[i].key || entries[i].title != title || entries[i].disc != disc ||
+            entries[i].track != track || entries[i].wellFormed != wellFormed)
+            std::printf("  line %u: '%.*s' -> '%.*s', yaml-cpp '%s' -> '%s'\n", entries[i].line,
+                (int)entries[i].key.size(), entries[i].key.data(), (int)entries[i].title.size(), entries[i].title.data(),
+                expected[i].key.c_str(), expected[i].value.c_str());
+        BGM_CHECK(entries[i].key == expected[i].key);
+        BGM_CHECK(entries[i].title == title);
+        BGM_CHECK(entries[i].disc == disc && entries[i].track == track);
+        BGM_CHECK(entries[i].wellFormed == wellFormed);
+        if (wellFormed)
+            BGM_CHECK(JoinValue(entries[i], expected[i].value) == expected[i].value);
+    }
+}
+
+BgmMapParseStatus ParseStatus(const std::string& source)
+{
+    BgmMapParser parser;
+    return parser.Parse(source.data(), source.size());
+}
+
+} // namespace
+
+BGM_TEST(ShippedMapMatchesYamlCpp)
+{
+    std::string source = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    BGM_REQUIRE(!source.empty());
+    CheckMatchesYamlCpp(source);
+
+    BgmMapParser parser;
+    BGM_REQUIRE(parser.Parse(source.data(), source.size()) == BgmMapParseStatus::Ok);
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+        BGM_CHECK(entry.wellFormed);
+}
+
+// Unescaped keys and titles are views into the caller's buffer, not copies.
+BGM_TEST(EntriesBorrowTheInput)
+{
+    std::string source = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    BgmMapParser parser;
+    BGM_REQUIRE(parser.Parse(source.data(), source.size()) == BgmMapParseStatus::Ok);
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+    {
+        BGM_CHECK(entry.key.data() >= begin && entry.key.data() + entry.key.size() <= end);
+        BGM_CHECK(entry.title.data() >= begin && entry.title.data() + entry.title.size() <= end);
+    }
+}
+
+BGM_TEST(LinesMatchYamlCpp)
+{
+    const char* const cases[] = {
+        "bgm\\y8_b001.ogg: \"Crimson Fighter|1|19\"\n",
+        "bgm\\y8_b001.ogg: Crimson Fighter|1|19\n",
+        "bgm\\y8_b001.ogg: 'Crimson Fighter|1|19'\n",
+        "\"bgm\\\\y8_b001.ogg\": \"Crimson Fighter|1|19\"\n",
+        "'bgm\\y8_b001.ogg': \"It''s|1|2\"\n",
+        "bgm\\y8_b001.ogg: 'It''s|1|2'\n",
+        "bgm\\y8_b001.ogg: \"Tab\\tand \\\"quote\\\"|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"\\u7D05\\x41\\U0001F3B5|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"\xE7\xB4\x85\xE3\x81\x84|2|3\"\n",
+        "bgm\\y8_b001.ogg: \"A|1|2\" # trailing comment\n",
+        "bgm\\y8_b001.ogg: A|1|2 # trailing comment\n",
+        "bgm\\y8_b001.ogg: A#B|1|2\n",
+        "bgm\\y8 b001.ogg  :   A|1|2   \n",
+        "bgm\\y8_b001.ogg: \"A|1|2\"\r\nbgm\\y8_b002.ogg: \"B|3|4\"\r\n",
+        "\xEF\xBB\xBF" "bgm\\y8_b001.ogg: \"A|1|2\"\n",
+        "# comment\n\n   \n\t# indented comment\nbgm\\y8_b001.ogg: \"A|1|2\"",
+        "bgm\\y8_b001.ogg: \"Untitled\"\n",
+        "bgm\\y8_b001.ogg: \"A||7\"\n",
+        "bgm\\y8_b001.ogg: \"A|x|300\"\n",
+        "bgm\\y8_b001.ogg: \"|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"A|1|2|3\"\n",
+    };
+    for (const char* source : cases)
+        CheckMatchesYamlCpp(source);
+}
+
+// Valid YAML outside the subset: the parser must step aside, not misread it.
+BGM_TEST(OtherYamlIsUnsupported)
+{
+    const char* const cases[] = {
+        "{ bgm\\y8_b001.ogg: \"A|1|2\" }\n",
+        "bgm\\y8_b001.ogg:\n  \"A|1|2\"\n",
+        "bgm\\y8_b001.ogg: >\n  A|1|2\n",
+        "bgm\\y8_b001.ogg: \"A|1\n  |2\"\n",
+        "---\nbgm\\y8_b001.ogg: \"A|1|2\"\n",
+        "%YAML 1.2\n---\nbgm\\y8_b001.ogg: \"A|1|2\"\n",
+        "bgm\\y8_b001.ogg: &title \"A|1|2\"\nbgm\\y8_b002.ogg: *title\n",
+        "? bgm\\y8_b001.ogg\n: \"A|1|2\"\n",
+        "bgm\\y8_b001.ogg: !!str A|1|2\n",
+        "bgm\\y8_b001.ogg: a: b\n",
+        "\"bgm\\\\y8_b001.ogg\":\"A|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"\xC9t\xE9|1|2\"\n", // Latin-1
+    };
+    for (const char* source : cases)
+    {
+        std::vector<KeyValue> ignored;
+        if (!LoadWithYamlCpp(source, &ignored))
+            continue; // Invalid YAML; the fallback will report it
+        BgmMapParseStatus status = ParseStatus(source);
+        if (status != BgmMapParseStatus::Unsupported)
+            std::printf("  \"%s\": %d\n", source, (int)status);
+        BGM_CHECK(status == BgmMapParseStatus::Unsupported);
+    }
+}
+
+// Errors are only reported for text yaml-cpp rejects too.
+BGM_TEST(ErrorsAreYamlErrors)
+{
+    const char* const cases[] = {
+        "bgm\\y8_b001.ogg \"A|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"A\\q|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"A\\xZZ|1|2\"\n",
+        "bgm\\y8_b001.ogg: \"A|1|2\" trailing\n",
+        "\"bgm\\y8_b001.ogg\" \"A|1|2\"\n",
+    };
+    for (const char* source : cases)
+    {
+        BgmMapParser parser;
+        BgmMapParseStatus status = parser.Parse(source, strlen(source));
+        std::vector<KeyValue> ignored;
+        bool yamlOk = LoadWithYamlCpp(source, &ignored);
+        if (status != BgmMapParseStatus::Error || yamlOk)
+            std::printf("  \"%s\": parser %d, yaml-cpp %d\n", source, (int)status, (int)yamlOk);
+        BGM_CHECK(status == BgmMapParseStatus::Error);
+        BGM_CHECK(!yamlOk);
+        BGM_CHECK(parser.GetLine() == 1 && parser.GetColumn() >= 1);
+    }
+
+    // yaml-cpp accepts a quote left open at the end of the file; YAML does not
+    const char unterminated[] = "bgm\\y8_b001.ogg: \"A|1|2\n";
+    BgmMapParser parser;
+    BGM_CHECK(parser.Parse(unterminated, strlen(unterminated)) == BgmMapParseStatus::Error);
+    BGM_CHECK(parser.GetLine() == 1 && parser.GetColumn() == 18);
+}
+
+// A large synthetic map, in every quoting style the subset allows.
+BGM_TEST(SyntheticMapMatchesYamlCpp)
+{
+    std::vector<std::string> keys = MakeSyntheticBgmKeys(5000);
+    std::string source;
+    char line[256];
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const char* formats[] = { "%s: \"Track %zu|%zu|%zu\"\n", "%s: 'Track %zu|%zu|%zu'\n", "%s: Track %zu|%zu|%zu # note\n" };
+        snprintf(line, sizeof(line), formats[i % 3], keys[i].c_str(), i, i % 3 + 1, i % 255 + 1);
+        source += line;
+    }
+    CheckMatchesYamlCpp(source);
+}
+
+BGM_TEST_MAIN()
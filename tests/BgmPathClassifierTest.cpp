@@ -0,0 +1,184 @@
+// ClassifyPath (SSE2, or AVX2 when built with -mavx2) against the scalar
+// loop, for UTF-8 and UTF-16 paths at every alignment, including paths that
+// end right before an unreadable page.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+using BgmPathClassifierDetail::ClassifyScalar;
+
+static bool SameInfo(const BgmPathInfo& a, const BgmPathInfo& b)
+{
+    return a.length == b.length && a.basenameOffset == b.basenameOffset && a.isOgg == b.isOgg;
+}
+
+static std::u16string Widen(const std::string& text)
+{
+    return std::u16string(text.begin(), text.end());
+}
+
+template <typename CharT>
+static BgmPathInfo Classify(const std::basic_string<CharT>& path)
+{
+    return ClassifyPath(path.c_str());
+}
+
+BGM_TEST(ExtensionAndBasename)
+{
+    struct Case {
+        const char* path;
+        size_t basenameOffset;
+        bool isOgg;
+    };
+    const Case cases[] = {
+        { "bgm\\y8_b001.ogg", 4, true },
+        { "C:/Games/Ys VIII/bgm/y8_op.OGG", 21, true },
+        { "a.Ogg", 0, true },
+        { "x.ogg.bak", 0, false },
+        { "bgm\\y8_b001.og", 4, false },
+        { "bgm\\y8_b001.oggx", 4, false },
+        { "bgm\\y8_b001_ogg", 4, false },
+        { ".ogg", 0, false },       // No stem
+        { "\\.ogg", 1, false },     // Nor after a separator
+        { "/.ogg", 1, false },
+        { "bgm\\.OGG", 4, false },
+        { "bgm/..ogg", 4, true },   // "." is a stem
+        { "bgm\\ogg", 4, false },
+        { "", 0, false },
+        { "\\", 1, false },
+    };
+    for (const Case& c : cases)
+    {
+        std::string path = c.path;
+        BgmPathInfo info = Classify(path);
+        BgmPathInfo wide = Classify(Widen(path));
+        if (info.length != path.size() || info.basenameOffset != c.basenameOffset || info.isOgg != c.isOgg)
+            std::printf("  %s: length %zu, basename %zu, ogg %d\n", c.path, info.length, info.basenameOffset, (int)info.isOgg);
+        BGM_CHECK(info.length == path.size());
+        BGM_CHECK(info.basenameOffset == c.basenameOffset);
+        BGM_CHECK(info.isOgg == c.isOgg);
+        BGM_CHECK(SameInfo(wide, info));
+        BGM_CHECK(SameInfo(ClassifyScalar(path.c_str()), info));
+    }
+}
+
+BGM_TEST(NonAsciiUnitsNeverFoldOntoOgg)
+{
+    // 0x014F | 0x20 is 0x016F, not 'o'; 0x2E is only '.' in its low byte
+    std::u16string path = u"bgm\\y8.\u014F\u0147\u0147";
+    BGM_CHECK(!ClassifyPath(path.c_str()).isOgg);
+    path = u"bgm\\\u3042\u3044.ogg";
+    BgmPathInfo info = ClassifyPath(path.c_str());
+    BGM_CHECK(info.isOgg && info.basenameOffset == 4 && info.length == 10);
+
+    std::string utf8 = "bgm\\\xE3\x81\x82.ogg";
+    info = ClassifyPath(utf8.c_str());
+    BGM_CHECK(info.isOgg && info.basenameOffset == 4 && info.length == utf8.size());
+}
+
+// Random paths made mostly of separators, dots and "ogg" letters, at every
+// offset within a 64-byte window, so each block position and every way a
+// separator, the terminator or the extension can straddle a block is hit.
+template <typename CharT>
+static void CompareWithScalar(uint32_t seed)
+{
+    static const char ALPHABET[] = "\\/.oOgGa_0\\/.ogg";
+    std::mt19937 rng(seed);
+    std::vector<CharT> buffer(256 + 64);
+    size_t mismatches = 0;
+    for (int round = 0; round < 4000; ++round)
+    {
+        size_t length = rng() % 200;
+        for (size_t offset = 0; offset < 64 / sizeof(CharT); ++offset)
+        {
+            // Garbage (with separators) before the string must be ignored
+            for (size_t i = 0; i < offset; ++i)
+                buffer[i] = (CharT)'\\';
+            for (size_t i = 0; i < length; ++i)
+                buffer[offset + i] = (CharT)ALPHABET[rng() % (sizeof(ALPHABET) - 1)];
+            if (length >= 4 && rng() % 2)
+                for (size_t i = 0; i < 4; ++i)
+                    buffer[offset + length - 4 + i] = (CharT)".oGg"[i];
+            buffer[offset + length] = 0;
+            for (size_t i = offset + length + 1; i < buffer.size(); ++i)
+                buffer[i] = (CharT)'/'; // And so must anything after the terminator
+
+            const CharT* path = buffer.data() + offset;
+            if (!SameInfo(ClassifyPath(path), ClassifyScalar(path)))
+                ++mismatches;
+        }
+    }
+    BGM_CHECK(mismatches == 0);
+}
+
+BGM_TEST(Utf8MatchesScalar) { CompareWithScalar<char>(1); }
+BGM_TEST(Utf16MatchesScalar) { CompareWithScalar<char16_t>(2); }
+
+BGM_TEST(ShippedKeysMatchScalar)
+{
+    for (const BgmTestEntry& entry : LoadShippedBgmMap())
+    {
+        std::string path = BGM_TEST_GAME_DIR + entry.key;
+        BgmPathInfo info = ClassifyPath(path.c_str());
+        BGM_CHECK(info.isOgg);
+        BGM_CHECK(SameInfo(info, ClassifyScalar(path.c_str())));
+        std::u16string wide = Widen(path);
+        BGM_CHECK(SameInfo(ClassifyPath(wide.c_str()), info));
+    }
+}
+
+#if defined(__linux__)
+// The vector loop reads whole aligned blocks; one that holds the terminator
+// must never reach into the next page. Strings here end on the last bytes of
+// a page followed by an inaccessible one.
+template <typename CharT>
+static void ClassifyAtPageEnd()
+{
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    uint8_t* pages = (uint8_t*)mmap(nullptr, pageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    BGM_REQUIRE(pages != MAP_FAILED);
+    BGM_REQUIRE(mprotect(pages + pageSize, pageSize, PROT_NONE) == 0);
+
+    const std::string text = "voice\\v001_00001.ogg";
+    for (size_t length = 0; length <= text.size(); ++length)
+    {
+        CharT* path = (CharT*)(pages + pageSize) - (length + 1);
+        for (size_t i = 0; i < length; ++i)
+            path[i] = (CharT)text[text.size() - length + i];
+        path[length] = 0;
+        BGM_CHECK(SameInfo(ClassifyPath(path), ClassifyScalar(path)));
+    }
+    munmap(pages, pageSize * 2);
+}
+
+BGM_TEST(Utf8NeverReadsPastThePage) { ClassifyAtPageEnd<char>(); }
+BGM_TEST(Utf16NeverReadsPastThePage) { ClassifyAtPageEnd<char16_t>(); }
+#endif
+
+int main(int argc, char** argv)
+{
+#if defined(BGM_CLASSIFIER_AVX2)
+    std::printf("Vector path: AVX2\n");
+#if defined(__GNUC__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("This CPU has no AVX2; skipped.\n");
+        return 0;
+    }
+#endif
+#elif defined(BGM_CLASSIFIER_SSE2)
+    std::printf("Vector path: SSE2\n");
+#else
+    std::printf("Vector path: none (scalar only)\n");
+#endif
+    return RunBgmTests(argc, argv);
+}
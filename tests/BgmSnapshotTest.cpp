@@ -0,0 +1,376 @@
+// BgmSnapshot.h: RCU publication of map snapshots (also run under TSan), a
+// Linux reload loop that polls BgmMap.yaml the way the map watcher does, and
+// how toasts made against one snapshot are carried over to the next.
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BgmMapParser.h"
+#include "BgmPathClassifier.h"
+#include "BgmSnapshot.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "BgmToastQueue.h"
+
+namespace {
+
+struct TestTrack {
+    const char* key;
+    const char* title;
+};
+
+std::unique_ptr<BgmMapSnapshot> MakeSnapshot(uint32_t generation, const std::vector<TestTrack>& tracks)
+{
+    auto snapshot = std::make_unique<BgmMapSnapshot>();
+    std::vector<std::string> keys;
+    for (const TestTrack& track : tracks)
+    {
+        snapshot->store.Add(track.key, track.title, 1, 1);
+        keys.push_back(track.key);
+    }
+    snapshot->index.Build(keys);
+    snapshot->generation = generation;
+    return snapshot;
+}
+
+BgmToastState MakeToast(const BgmMapSnapshot& snapshot, uint16_t trackId, uint32_t serial)
+{
+    BgmToastState toast;
+    const char* key = snapshot.store.GetKey(trackId);
+    toast.track = MakeBgmSnapshotTrack(snapshot, trackId);
+    toast.serial = serial;
+    toast.keyHash = HashBgmKey(key, strlen(key));
+    return toast;
+}
+
+const char* GetTitle(const BgmMapSnapshot& snapshot, const BgmToastState& toast)
+{
+    uint16_t trackId = GetBgmSnapshotTrackId(&snapshot, toast.track);
+    return trackId == BGM_INVALID_TRACK_ID ? "" : snapshot.store.GetTitle(trackId);
+}
+
+} // namespace
+
+// -------------------------------------------------------------
+// Toasts across reloads
+// -------------------------------------------------------------
+
+BGM_TEST(TrackIdsOnlyReadAgainstTheirSnapshot)
+{
+    auto first = MakeSnapshot(1, { { "bgm\\a.ogg", "A" }, { "bgm\\b.ogg", "B" } });
+    auto second = MakeSnapshot(2, { { "bgm\\a.ogg", "A" } });
+    uint32_t track = MakeBgmSnapshotTrack(*first, 1);
+    BGM_CHECK(GetBgmSnapshotTrackId(first.get(), track) == 1);
+    BGM_CHECK(GetBgmSnapshotTrackId(second.get(), track) == BGM_INVALID_TRACK_ID);
+    BGM_CHECK(GetBgmSnapshotTrackId(nullptr, track) == BGM_INVALID_TRACK_ID);
+    BGM_CHECK(GetBgmSnapshotTrackId(first.get(), MakeBgmSnapshotTrack(*first, 2)) == BGM_INVALID_TRACK_ID);
+    BGM_CHECK(GetBgmSnapshotTrackId(first.get(), BgmToastState().track) == BGM_INVALID_TRACK_ID);
+}
+
+BGM_TEST(RemapFollowsKeysAcrossReloads)
+{
+    auto before = MakeSnapshot(1, { { "bgm\\a.ogg", "A" }, { "bgm\\b.ogg", "B" }, { "bgm\\c.ogg", "C" } });
+    // The edit renames B, drops C and moves A to another ID
+    auto after = MakeSnapshot(2, { { "bgm\\new.ogg", "New" }, { "bgm\\b.ogg", "B (fixed)" }, { "bgm\\a.ogg", "A" } });
+
+    BgmToastState visible = MakeToast(*before, 0, 1);
+    BgmToastState pendingB = MakeToast(*before, 1, 2);
+    BgmToastState pendingC = MakeToast(*before, 2, 3);
+    BgmToastState current = MakeToast(*after, 0, 4);
+    BgmToastState* states[] = { &visible, &pendingB, &pendingC, &current };
+
+    BGM_CHECK(RemapBgmToastStates(*after, states, 4) == 1);
+    BGM_CHECK(std::strcmp(GetTitle(*after, visible), "A") == 0);
+    BGM_CHECK(std::strcmp(GetTitle(*after, pendingB), "B (fixed)") == 0);
+    BGM_CHECK(GetBgmSnapshotTrackId(after.get(), pendingC.track) == BGM_INVALID_TRACK_ID);
+    BGM_CHECK((pendingC.track >> 16) == 2);
+    BGM_CHECK(std::strcmp(GetTitle(*after, current), "New") == 0);
+    BGM_CHECK(visible.serial == 1 && pendingB.serial == 2 && pendingC.serial == 3);
+
+    // Nothing stale: no scan, nothing changes
+    BgmToastState copy = visible;
+    BGM_CHECK(RemapBgmToastStates(*after, states, 2) == 0);
+    BGM_CHECK(visible.track == copy.track && visible.keyHash == copy.keyHash);
+}
+
+// A frame can miss reloads (the game was minimized), so toasts may be more
+// than one generation old; the key hash does not care.
+BGM_TEST(RemapSkipsMissedGenerations)
+{
+    auto first = MakeSnapshot(1, { { "bgm\\a.ogg", "A" }, { "bgm\\b.ogg", "B" } });
+    auto third = MakeSnapshot(3, { { "BGM/B.OGG", "B" }, { "bgm\\b.ogg", "B2" }, { "bgm\\a.ogg", "A" } });
+    BgmToastState a = MakeToast(*first, 0, 1);
+    BgmToastState b = MakeToast(*first, 1, 2);
+    BgmToastState never;  // Default state: no key at all
+    BgmToastState* states[] = { &a, &b, &never };
+    BGM_CHECK(RemapBgmToastStates(*third, states, 3) == 1);
+    BGM_CHECK(GetBgmSnapshotTrackId(third.get(), a.track) == 2);
+    // Keys that fold alike resolve to the first, like the index does
+    BGM_CHECK(GetBgmSnapshotTrackId(third.get(), b.track) == 0);
+    BGM_CHECK(GetBgmSnapshotTrackId(third.get(), never.track) == BGM_INVALID_TRACK_ID);
+}
+
+// What My_Present does with unresolved queued toasts
+BGM_TEST(QueueDropsPendingToastsInOrder)
+{
+    BgmToastQueue<int, 8> queue(BgmToastPolicy::Enqueue);
+    for (int i = 0; i < 6; ++i)
+        queue.Push(i, 0.0);
+    queue.ShowNext(0.0); // 0 visible, 1-5 pending
+    queue.Push(6, 0.0);
+    queue.Push(7, 0.0);  // The ring has wrapped once ShowNext moved the head
+    BGM_CHECK(queue.RemovePendingIf([](int v) { return v % 2 == 1; }) == 4);
+    BGM_REQUIRE(queue.GetPendingCount() == 3);
+    BGM_CHECK(queue.GetPending(0) == 2 && queue.GetPending(1) == 4 && queue.GetPending(2) == 6);
+    BGM_CHECK(queue.HasVisible() && queue.GetVisible() == 0);
+    BGM_CHECK(queue.GetStats().dropped == 4);
+    queue.Push(8, 0.0);
+    BGM_CHECK(queue.GetPending(3) == 8);
+    BGM_CHECK(queue.RemovePendingIf([](int) { return false; }) == 0);
+    BGM_CHECK(queue.GetPendingCount() == 4);
+}
+
+// -------------------------------------------------------------
+// RCU publication
+// -------------------------------------------------------------
+
+namespace {
+
+// Every field derives from `generation`, so a reader can tell a torn or
+// freed value from a good one.
+struct Versioned {
+    uint32_t generation;
+    std::vector<uint32_t> words;
+
+    explicit Versioned(uint32_t g) : generation(g), words(32, g * 2654435761u) {}
+    ~Versioned() { std::fill(words.begin(), words.end(), 0xDEADBEEFu); }
+
+    bool IsWhole() const
+    {
+        for (uint32_t word : words)
+            if (word != generation * 2654435761u)
+                return false;
+        return true;
+    }
+};
+
+} // namespace
+
+BGM_TEST(ReadersNeverSeeAReclaimedValue)
+{
+    BgmRcuPointer<Versioned> rcu;
+    BGM_CHECK(!BgmRcuPointer<Versioned>::ReadGuard(rcu));
+    rcu.Publish(new Versioned(1));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0}, torn{0}, backwards{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&] {
+            uint32_t lastSeen = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                BgmRcuPointer<Versioned>::ReadGuard guard(rcu);
+                if (!guard->IsWhole())
+                    torn.fetch_add(1);
+                if (guard->generation < lastSeen)
+                    backwards.fetch_add(1);
+                lastSeen = guard->generation;
+                {
+                    BgmRcuPointer<Versioned>::ReadGuard nested(rcu); // Nesting is allowed
+                    if (!nested->IsWhole())
+                        torn.fetch_add(1);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+                if (reads.load(std::memory_order_relaxed) % 64 == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    uint32_t generation = 1;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < end || generation < 200)
+        rcu.Publish(new Versioned(++generation));
+    stop = true;
+    for (std::thread& reader : readers)
+        reader.join();
+    rcu.Publish(nullptr);
+
+    std::printf("  %u publishes, %llu reads\n", generation, (unsigned long long)reads.load());
+    BGM_CHECK(torn.load() == 0);
+    BGM_CHECK(backwards.load() == 0);
+    BGM_CHECK(reads.load() > 0);
+}
+
+// -------------------------------------------------------------
+// Reloading BgmMap.yaml on Linux
+// -------------------------------------------------------------
+// BgmMapWatcherThread waits on a Win32 change notification; here a thread
+// polls the file's mtime and size instead, then does what LoadBgmMap does:
+// skip unchanged bytes, parse, build a whole snapshot, publish it and remap
+// the latest toast. Readers resolve paths the way the detours do meanwhile.
+
+namespace {
+
+std::string MakeTestMap(int edit)
+{
+    // Every edit retitles all tracks, drops track 0 on odd edits and moves
+    // the rest, so IDs change between snapshots
+    std::string yaml = "# edit " + std::to_string(edit) + "\n";
+    for (int i = (edit % 2); i < 40; ++i)
+        yaml += "bgm\\y8_t" + std::to_string(i) + ".ogg: \"Edit " + std::to_string(edit) + " track " + std::to_string(i) + "|1|" + std::to_string(i + 1) + "\"\n";
+    return yaml;
+}
+
+void WriteTestMap(const std::string& path, const std::string& yaml)
+{
+    std::string temp = path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    std::fwrite(yaml.data(), 1, yaml.size(), file);
+    std::fclose(file);
+    std::filesystem::rename(temp, path); // Like an editor's atomic save
+}
+
+std::unique_ptr<BgmMapSnapshot> ParseTestMap(const std::string& source, uint32_t generation)
+{
+    BgmMapParser parser;
+    if (parser.Parse(source.data(), source.size()) != BgmMapParseStatus::Ok)
+        return nullptr;
+    auto snapshot = std::make_unique<BgmMapSnapshot>();
+    std::vector<std::string_view> keys;
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+    {
+        snapshot->store.Add(entry.key, entry.title, entry.disc, entry.track);
+        keys.emplace_back(entry.key);
+    }
+    snapshot->index.Build(keys.data(), keys.size());
+    snapshot->sourceHash = HashBgmMapSource(source.data(), source.size());
+    snapshot->generation = generation;
+    return snapshot;
+}
+
+} // namespace
+
+BGM_TEST(PollingWatcherReloadsEveryEdit)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "BgmSnapshotTest_BgmMap.yaml").string();
+    constexpr int EDITS = 12;
+    WriteTestMap(path, MakeTestMap(0));
+
+    BgmRcuPointer<BgmMapSnapshot> rcu;
+    BgmSeqlock<BgmToastState> toastState;
+    std::atomic<bool> stop{false};
+    std::atomic<int> lastEditSeen{-1};
+    uint32_t generation = 0;
+
+    auto reload = [&] {
+        std::string source = ReadBgmTestFile(path);
+        uint64_t sourceHash = HashBgmMapSource(source.data(), source.size());
+        {
+            BgmRcuPointer<BgmMapSnapshot>::ReadGuard published(rcu);
+            if (published && published->sourceHash == sourceHash)
+                return;
+        }
+        std::unique_ptr<BgmMapSnapshot> next = ParseTestMap(source, ++generation);
+        if (!next)
+            return;
+        BgmMapSnapshot* publishedNow = next.get();
+        std::unique_ptr<BgmMapSnapshot> previous(rcu.Exchange(next.release()));
+        if (previous)
+        {
+            toastState.Update([&](BgmToastState& toast) {
+                BgmToastState* states[] = { &toast };
+                RemapBgmToastStates(*publishedNow, states, 1);
+            });
+            rcu.Synchronize();
+        }
+        lastEditSeen = std::atoi(source.c_str() + 7);
+    };
+    reload();
+
+    std::thread watcher([&] {
+        struct stat last = {};
+        while (!stop.load())
+        {
+            struct stat now;
+            if (stat(path.c_str(), &now) == 0 &&
+                (now.st_mtim.tv_sec != last.st_mtim.tv_sec || now.st_mtim.tv_nsec != last.st_mtim.tv_nsec ||
+                 now.st_size != last.st_size || now.st_ino != last.st_ino))
+            {
+                last = now;
+                reload();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    // Detour-like readers: every lookup sees one whole snapshot, whose
+    // titles all come from the same edit
+    std::atomic<uint64_t> lookups{0}, mixed{0}, missed{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+    {
+        readers.emplace_back([&, t] {
+            for (uint32_t i = (uint32_t)t; !stop.load(std::memory_order_relaxed); i += 3)
+            {
+                std::string path = "C:\\game\\bgm\\y8_t" + std::to_string(1 + i % 39) + ".ogg";
+                BgmPathInfo info = ClassifyPath(path.c_str());
+                uint64_t hash = HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset);
+                BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+                uint16_t trackId = snapshot->index.Find(hash, path.c_str(), info.length, info.basenameOffset);
+                if (trackId == BGM_INVALID_TRACK_ID) {
+                    missed.fetch_add(1);
+                    continue;
+                }
+                std::string prefix = std::string(snapshot->store.GetTitle(0)).substr(0, 8);
+                if (std::string(snapshot->store.GetTitle(trackId)).compare(0, 8, prefix) != 0)
+                    mixed.fetch_add(1);
+                lookups.fetch_add(1, std::memory_order_relaxed);
+                if (i % 32 == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // The toast on screen is track 5; it must follow its key through every edit
+    {
+        BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+        toastState.Store(MakeToast(*snapshot, 5, 1));
+    }
+    for (int edit = 1; edit <= EDITS; ++edit)
+    {
+        WriteTestMap(path, MakeTestMap(edit));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (lastEditSeen.load() != edit && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        BGM_CHECK(lastEditSeen.load() == edit);
+
+        BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+        BgmToastState toast = toastState.Load();
+        std::string expected = "Edit " + std::to_string(edit) + " track 5";
+        BGM_CHECK(expected == GetTitle(*snapshot, toast));
+    }
+
+    stop = true;
+    watcher.join();
+    for (std::thread& reader : readers)
+        reader.join();
+    rcu.Publish(nullptr);
+    std::remove(path.c_str());
+
+    std::printf("  %d edits, %u snapshots, %llu lookups\n", EDITS, generation, (unsigned long long)lookups.load());
+    BGM_CHECK(mixed.load() == 0);
+    BGM_CHECK(missed.load() == 0);
+    BGM_CHECK(generation == EDITS + 1);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// =============================================================
+// HOST TEST HARNESS
+// =============================================================
+// Just enough of a unit test framework for the platform-free Bgm*.h headers,
+// so the tests build anywhere the headers do with no extra dependency. Each
+// test file is its own executable:
+//
+//   BGM_TEST(RingKeepsPushOrder) { ...; BGM_CHECK(a == b); }
+//   BGM_TEST_MAIN()
+//
+// A failed check reports its file and line and fails the test; the remaining
+// tests still run. Benchmarks (tests/*Bench.cpp) use BgmBench below.
+
+struct BgmTestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<BgmTestCase>& GetBgmTests()
+{
+    static std::vector<BgmTestCase> tests;
+    return tests;
+}
+
+inline int& GetBgmTestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+struct BgmTestRegistrar {
+    BgmTestRegistrar(const char* name, void (*fn)()) { GetBgmTests().push_back({ name, fn }); }
+};
+
+#define BGM_TEST(name) \
+    static void name(); \
+    static BgmTestRegistrar name##_registrar(#name, name); \
+    static void name()
+
+#define BGM_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++GetBgmTestFailures(); \
+        } \
+    } while (0)
+
+// Like BGM_CHECK, but leaves the test: for checks the rest of it depends on.
+#define BGM_REQUIRE(cond) \
+    do { \
+        if (!(cond)) { \
+            std::printf("  %s:%d: requirement failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++GetBgmTestFailures(); \
+            return; \
+        } \
+    } while (0)
+
+// Runs every registered test, or only those whose name contains argv[1].
+inline int RunBgmTests(int argc, char** argv)
+{
+    int failed = 0;
+    for (const BgmTestCase& test : GetBgmTests())
+    {
+        if (argc > 1 && !std::strstr(test.name, argv[1]))
+            continue;
+        int before = GetBgmTestFailures();
+        std::printf("[ RUN  ] %s\n", test.name);
+        test.fn();
+        bool ok = GetBgmTestFailures() == before;
+        std::printf("[ %s ] %s\n", ok ? " OK " : "FAIL", test.name);
+        if (!ok) ++failed;
+    }
+    std::printf("%zu test(s), %d failed.\n", GetBgmTests().size(), failed);
+    return failed ? 1 : 0;
+}
+
+#define BGM_TEST_MAIN() \
+    int main(int argc, char** argv) { return RunBgmTests(argc, argv); }
+
+// =============================================================
+// BENCHMARK HELPERS
+// =============================================================
+// Benchmarks print one line per measurement. With --quick (what ctest runs)
+// they do a fraction of the iterations, so the run only proves they work.
+struct BgmBench {
+    bool quick = false;
+
+    BgmBench(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+            if (std::strcmp(argv[i], "--quick") == 0) quick = true;
+    }
+
+    // `full` iterations normally, a hundredth of them (at least one) with --quick.
+    size_t Iterations(size_t full) const { return quick ? (full / 100 ? full / 100 : 1) : full; }
+
+    // Nanoseconds per call of fn(i) over `iterations` calls, best of `runs`.
+    template <typename Fn>
+    double NsPerCall(size_t iterations, Fn&& fn, int runs = 5) const
+    {
+        double best = 0.0;
+        for (int run = 0; run < (quick ? 1 : runs); ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+                fn(i);
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+            if (run == 0 || ns < best) best = ns;
+        }
+        return best;
+    }
+
+    // Microseconds for one call of fn(), best of `runs`.
+    template <typename Fn>
+    double Microseconds(Fn&& fn, int runs = 5) const
+    {
+        double best = 0.0;
+        for (int run = 0; run < (quick ? 1 : runs); ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || us < best) best = us;
+        }
+        return best;
+    }
+};
+
+// Keeps the optimizer from discarding a result the benchmark never reads.
+inline void BgmBenchKeep(uint64_t value)
+{
+    static volatile uint64_t sink;
+    sink = sink + value;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "BgmMapParser.h"
+
+// =============================================================
+// TEST DATA
+// =============================================================
+// The shipped BgmMap.yaml and path corpora shaped like what Ys VIII opens,
+// shared by the tests and benchmarks. BGMTOAST_SOURCE_DIR is set by
+// tests/CMakeLists.txt.
+
+#ifndef BGMTOAST_SOURCE_DIR
+#define BGMTOAST_SOURCE_DIR "."
+#endif
+
+inline std::string GetBgmTestPath(const char* relativePath)
+{
+    return std::string(BGMTOAST_SOURCE_DIR) + "/" + relativePath;
+}
+
+inline std::string ReadBgmTestFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+struct BgmTestEntry {
+    std::string key;
+    std::string title;
+    uint8_t disc = 0;
+    uint8_t track = 0;
+};
+
+// The entries of the shipped BgmMap.yaml, in file order.
+inline std::vector<BgmTestEntry> LoadShippedBgmMap()
+{
+    std::string source = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    BgmMapParser parser;
+    std::vector<BgmTestEntry> entries;
+    if (parser.Parse(source.data(), source.size()) != BgmMapParseStatus::Ok) {
+        std::printf("Cannot parse the shipped BgmMap.yaml.\n");
+        return entries;
+    }
+    for (const BgmMapParsedEntry& parsed : parser.GetEntries())
+        entries.push_back({ std::string(parsed.key), std::string(parsed.title), parsed.disc, parsed.track });
+    return entries;
+}
+
+inline std::vector<std::string> GetBgmTestKeys(const std::vector<BgmTestEntry>& entries)
+{
+    std::vector<std::string> keys;
+    for (const BgmTestEntry& entry : entries)
+        keys.push_back(entry.key);
+    return keys;
+}
+
+// Where the game lives in the traces below.
+constexpr char BGM_TEST_GAME_DIR[] = "C:\\Program Files (x86)\\Steam\\steamapps\\common\\Ys VIII Lacrimosa of DANA\\";
+
+// Synthetic keys in the shipped map's shape ("bgm\y8_x1234.ogg"), for map sizes
+// the game never ships.
+inline std::vector<std::string> MakeSyntheticBgmKeys(size_t count)
+{
+    static const char CATEGORIES[] = "bdefmt";
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    char key[64];
+    for (size_t i = 0; i < count; ++i)
+    {
+        snprintf(key, sizeof(key), "bgm\\y8_%c%05zu.ogg", CATEGORIES[i % 6], i);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+// A path trace shaped like a play session: mostly voice lines and sound
+// effects (also .ogg), models and textures, and now and then a BGM track from
+// `keys`. Deterministic for a given size.
+struct BgmTestTrace {
+    std::vector<std::string> bgmHits;   // Full paths of mapped tracks
+    std::vector<std::string> oggMisses; // Voice and sound-effect .ogg files
+    std::vector<std::string> otherFiles; // Everything else the game opens
+};
+
+inline BgmTestTrace MakeBgmTestTrace(const std::vector<std::string>& keys, size_t missCount, size_t otherCount)
+{
+    BgmTestTrace trace;
+    for (const std::string& key : keys)
+        trace.bgmHits.push_back(BGM_TEST_GAME_DIR + key);
+
+    char path[256];
+    for (size_t i = 0; i < missCount; ++i)
+    {
+        if (i % 4 == 3)
+            snprintf(path, sizeof(path), "%sse\\se_%04zu.ogg", BGM_TEST_GAME_DIR, i);
+        else
+            snprintf(path, sizeof(path), "%svoice\\ogg\\v%03zu_%05zu.OGG", BGM_TEST_GAME_DIR, i % 97, i);
+        trace.oggMisses.push_back(path);
+    }
+
+    static const char* const EXTENSIONS[] = { ".mdl", ".dds", ".itp", ".it3", ".dat", ".tbl" };
+    for (size_t i = 0; i < otherCount; ++i)
+    {
+        snprintf(path, sizeof(path), "%smap\\mp%04zu\\mp%04zu_%02zu%s", BGM_TEST_GAME_DIR, i / 16, i / 16, i % 16, EXTENSIONS[i % 6]);
+        trace.otherFiles.push_back(path);
+    }
+    return trace;
+}
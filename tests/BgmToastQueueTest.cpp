@@ -0,0 +1,350 @@
+// BgmToastQueue: a step table per policy (push result, visible and pending
+// entries, stats after every operation), a random trace against a plain
+// std::deque model of the documented policies, and the queue driven by the
+// toast's own timing (5 s on screen, 0.3 s slide-out, 60 fps) for a battle
+// start followed by a battle end.
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BgmTest.h"
+#include "BgmToastQueue.h"
+
+namespace {
+
+using Queue = BgmToastQueue<int, 3>;
+
+// "3|1,2": 3 visible, 1 and 2 pending in show order; "-|" when empty.
+std::string Describe(const Queue& queue)
+{
+    std::string text = queue.HasVisible() ? std::to_string(queue.GetVisible()) : "-";
+    text += "|";
+    for (size_t i = 0; i < queue.GetPendingCount(); ++i)
+        text += (i ? "," : "") + std::to_string(queue.GetPending(i));
+    return text;
+}
+
+constexpr int SHOWN = 10;     // ShowNext returned true
+constexpr int NOT_SHOWN = 11; // ShowNext returned false
+constexpr int NONE = 12;      // Hide
+
+struct Step {
+    char op;            // 'P'ush value at time, 'S'howNext at time, 'H'ide
+    double time;
+    int value;
+    int expected;       // BgmToastPushResult for pushes, SHOWN / NOT_SHOWN / NONE otherwise
+    const char* state;  // Describe() afterwards
+};
+
+constexpr int Q = (int)BgmToastPushResult::Queued;
+constexpr int CP = (int)BgmToastPushResult::CoalescedPending;
+constexpr int CV = (int)BgmToastPushResult::CoalescedVisible;
+constexpr int PV = (int)BgmToastPushResult::PreemptVisible;
+
+void RunSteps(Queue& queue, const std::vector<Step>& steps)
+{
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        const Step& step = steps[i];
+        int result = NONE;
+        if (step.op == 'P')
+            result = (int)queue.Push(step.value, step.time);
+        else if (step.op == 'S')
+            result = queue.ShowNext(step.time) ? SHOWN : NOT_SHOWN;
+        else
+            queue.Hide();
+
+        std::string state = Describe(queue);
+        if (result != step.expected || state != step.state)
+            std::printf("  step %zu (%c %g %d): result %d, state \"%s\"; expected %d, \"%s\"\n", i, step.op, step.time,
+                step.value, result, state.c_str(), step.expected, step.state);
+        BGM_CHECK(result == step.expected);
+        BGM_CHECK(state == step.state);
+    }
+}
+
+bool SameStats(const BgmToastQueueStats& stats, uint64_t pushed, uint64_t coalesced, uint64_t dropped)
+{
+    return stats.pushed == pushed && stats.coalesced == coalesced && stats.dropped == dropped;
+}
+
+} // namespace
+
+BGM_TEST(ReplacePreemptsAndDropsPending)
+{
+    Queue queue(BgmToastPolicy::Replace, 2.0);
+    RunSteps(queue, {
+        { 'S', 0.0, 0, NOT_SHOWN, "-|" },
+        { 'P', 0.0, 1, Q, "-|1" },
+        { 'S', 0.0, 0, SHOWN, "1|" },
+        { 'S', 0.1, 0, NOT_SHOWN, "1|" },
+        { 'P', 1.0, 2, PV, "1|2" },
+        { 'P', 1.1, 3, PV, "1|3" },      // 2 dropped
+        { 'H', 1.5, 0, NONE, "-|3" },
+        { 'P', 1.6, 4, Q, "-|4" },       // Nothing visible to preempt; 3 dropped
+        { 'S', 2.0, 0, SHOWN, "4|" },
+        { 'H', 3.0, 0, NONE, "-|" },
+        { 'S', 3.0, 0, NOT_SHOWN, "-|" },
+    });
+    BGM_CHECK(SameStats(queue.GetStats(), 4, 0, 2));
+}
+
+BGM_TEST(EnqueueWaitsAndDropsTheOldestWhenFull)
+{
+    Queue queue(BgmToastPolicy::Enqueue, 2.0);
+    RunSteps(queue, {
+        { 'P', 0.0, 1, Q, "-|1" },
+        { 'S', 0.0, 0, SHOWN, "1|" },
+        { 'P', 0.1, 2, Q, "1|2" },
+        { 'P', 0.2, 3, Q, "1|2,3" },
+        { 'P', 0.3, 4, Q, "1|2,3,4" },
+        { 'P', 0.4, 5, Q, "1|3,4,5" },   // Full: 2 dropped
+        { 'H', 5.0, 0, NONE, "-|3,4,5" },
+        { 'S', 5.0, 0, SHOWN, "3|4,5" },
+        { 'P', 5.1, 6, Q, "3|4,5,6" },   // The ring has wrapped
+        { 'H', 6.0, 0, NONE, "-|4,5,6" },
+        { 'S', 6.0, 0, SHOWN, "4|5,6" },
+        { 'H', 7.0, 0, NONE, "-|5,6" },
+        { 'S', 7.0, 0, SHOWN, "5|6" },
+        { 'H', 8.0, 0, NONE, "-|6" },
+        { 'S', 8.0, 0, SHOWN, "6|" },
+    });
+    BGM_CHECK(SameStats(queue.GetStats(), 6, 0, 1));
+}
+
+BGM_TEST(CoalesceOverwritesTheNewestWithinTheWindow)
+{
+    Queue queue(BgmToastPolicy::Coalesce, 2.0);
+    RunSteps(queue, {
+        { 'P', 0.0, 1, Q, "-|1" },
+        { 'P', 1.0, 2, CP, "-|2" },      // Within 2 s of 1
+        { 'P', 2.5, 3, Q, "-|2,3" },     // The window counts from 1's request, not 2's
+        { 'S', 3.0, 0, SHOWN, "2|3" },
+        { 'P', 3.5, 4, CP, "2|4" },      // Newest is pending 3 (2.5)
+        { 'P', 5.0, 5, Q, "2|4,5" },
+        { 'H', 6.0, 0, NONE, "-|4,5" },
+        { 'S', 6.0, 0, SHOWN, "4|5" },
+        { 'H', 7.0, 0, NONE, "-|5" },
+        { 'S', 7.0, 0, SHOWN, "5|" },    // Visible from 7.0
+        { 'P', 8.0, 6, CV, "6|" },       // Newest is the visible toast
+        { 'P', 9.5, 7, Q, "6|7" },
+        { 'P', 12.0, 8, Q, "6|7,8" },
+        { 'P', 14.5, 9, Q, "6|7,8,9" },
+        { 'P', 17.0, 10, Q, "6|8,9,10" }, // Full: 7 dropped
+    });
+    BGM_CHECK(SameStats(queue.GetStats(), 10, 3, 1));
+}
+
+BGM_TEST(ZeroWindowNeverCoalesces)
+{
+    Queue queue(BgmToastPolicy::Coalesce, 0.0);
+    RunSteps(queue, {
+        { 'P', 1.0, 1, Q, "-|1" },
+        { 'P', 1.0, 2, Q, "-|1,2" },
+        { 'S', 1.0, 0, SHOWN, "1|2" },
+    });
+}
+
+BGM_TEST(RemovePendingIfKeepsOrderAcrossTheWrap)
+{
+    Queue queue(BgmToastPolicy::Enqueue, 0.0);
+    RunSteps(queue, {
+        { 'P', 0.0, 1, Q, "-|1" },
+        { 'P', 0.0, 2, Q, "-|1,2" },
+        { 'S', 0.0, 0, SHOWN, "1|2" },
+        { 'P', 0.0, 3, Q, "1|2,3" },
+        { 'P', 0.0, 4, Q, "1|2,3,4" },   // Head at slot 1, tail wrapped to slot 0
+    });
+    BGM_CHECK(queue.RemovePendingIf([](int value) { return value == 3; }) == 1);
+    BGM_CHECK(Describe(queue) == "1|2,4");
+    RunSteps(queue, {
+        { 'P', 0.0, 5, Q, "1|2,4,5" },
+        { 'P', 0.0, 6, Q, "1|4,5,6" },
+    });
+    BGM_CHECK(queue.RemovePendingIf([](int value) { return value % 2 == 0; }) == 2);
+    BGM_CHECK(Describe(queue) == "1|5");
+    BGM_CHECK(queue.RemovePendingIf([](int) { return false; }) == 0);
+    BGM_CHECK(SameStats(queue.GetStats(), 6, 0, 4));
+
+    queue.Clear();
+    BGM_CHECK(Describe(queue) == "-|");
+}
+
+// The documented policies written the obvious way, for the random trace.
+struct QueueModel {
+    struct Entry {
+        int value;
+        double requestedAt;
+    };
+    BgmToastPolicy policy;
+    double window;
+    size_t capacity;
+    bool hasVisible = false;
+    Entry visible{};
+    std::deque<Entry> pending;
+
+    BgmToastPushResult Push(int value, double now)
+    {
+        if (policy == BgmToastPolicy::Coalesce)
+        {
+            Entry* newest = !pending.empty() ? &pending.back() : hasVisible ? &visible : nullptr;
+            if (newest && now - newest->requestedAt < window) {
+                newest->value = value;
+                return newest == &visible ? BgmToastPushResult::CoalescedVisible : BgmToastPushResult::CoalescedPending;
+            }
+        }
+        bool preempt = false;
+        if (policy == BgmToastPolicy::Replace) {
+            pending.clear();
+            preempt = hasVisible;
+        } else if (pending.size() == capacity) {
+            pending.pop_front();
+        }
+        pending.push_back({ value, now });
+        return preempt ? BgmToastPushResult::PreemptVisible : BgmToastPushResult::Queued;
+    }
+
+    bool ShowNext(double now)
+    {
+        if (hasVisible || pending.empty()) return false;
+        visible = { pending.front().value, now };
+        pending.pop_front();
+        hasVisible = true;
+        return true;
+    }
+
+    std::string Describe() const
+    {
+        std::string text = hasVisible ? std::to_string(visible.value) : "-";
+        text += "|";
+        for (size_t i = 0; i < pending.size(); ++i)
+            text += (i ? "," : "") + std::to_string(pending[i].value);
+        return text;
+    }
+};
+
+BGM_TEST(RandomTraceMatchesModel)
+{
+    const BgmToastPolicy policies[] = { BgmToastPolicy::Replace, BgmToastPolicy::Enqueue, BgmToastPolicy::Coalesce };
+    std::mt19937 rng(15);
+    size_t mismatches = 0;
+    for (BgmToastPolicy policy : policies)
+    {
+        for (double window : { 0.0, 0.5, 2.0 })
+        {
+            Queue queue(policy, window);
+            QueueModel model{ policy, window, 3, false, {}, {} };
+            double now = 0.0;
+            for (int i = 0; i < 20000; ++i)
+            {
+                now += (double)(rng() % 100) / 100.0;
+                int op = (int)(rng() % 10);
+                if (op < 5) {
+                    int value = (int)(rng() % 1000);
+                    mismatches += queue.Push(value, now) != model.Push(value, now);
+                } else if (op < 8) {
+                    mismatches += queue.ShowNext(now) != model.ShowNext(now);
+                } else if (op < 9) {
+                    queue.Hide();
+                    model.hasVisible = false;
+                } else {
+                    int parity = (int)(rng() % 2);
+                    queue.RemovePendingIf([&](int value) { return value % 2 == parity; });
+                    for (auto it = model.pending.begin(); it != model.pending.end();)
+                        it = it->value % 2 == parity ? model.pending.erase(it) : it + 1;
+                }
+                if (Describe(queue) != model.Describe()) {
+                    if (mismatches++ == 0)
+                        std::printf("  policy %d, window %g, op %d: \"%s\" vs model \"%s\"\n", (int)policy, window, i,
+                            Describe(queue).c_str(), model.Describe().c_str());
+                    break;
+                }
+            }
+        }
+    }
+    BGM_CHECK(mismatches == 0);
+}
+
+// My_Present's pacing: a toast stays TOAST_DURATION_SECONDS, then slides out
+// for ~0.3 s (the toast's width at TOAST_ANIMATION_SPEED); the next one is
+// promoted on the frame after Hide. Records each value that appears on
+// screen (including one coalesced into the visible toast) and when.
+struct Shown {
+    int value;
+    double time;
+};
+
+std::vector<Shown> PlayFrames(BgmToastPolicy policy, double window, const std::vector<std::pair<double, int>>& requests)
+{
+    constexpr double FRAME = 1.0 / 60.0;
+    constexpr double ON_SCREEN = 5.0;
+    constexpr double SLIDE_OUT = 0.3;
+    Queue queue(policy, window);
+    std::vector<Shown> shown;
+    double timer = 0.0, slideOut = 0.0;
+    size_t next = 0;
+    for (int frame = 0; frame < 60 * 30; ++frame)
+    {
+        double now = frame * FRAME;
+        for (; next < requests.size() && requests[next].first <= now; ++next)
+            if (queue.Push(requests[next].second, now) == BgmToastPushResult::PreemptVisible)
+                timer = 0.0;
+        bool promoted = queue.ShowNext(now);
+        if (promoted) {
+            timer = ON_SCREEN;
+            slideOut = SLIDE_OUT;
+        }
+        if (!queue.HasVisible())
+            continue;
+        if (promoted || shown.back().value != queue.GetVisible())
+            shown.push_back({ queue.GetVisible(), now });
+        if (timer > 0.0) {
+            timer -= FRAME;
+        } else if ((slideOut -= FRAME) <= 0.0) {
+            queue.Hide();
+        }
+    }
+    return shown;
+}
+
+std::vector<int> Values(const std::vector<Shown>& shown)
+{
+    std::vector<int> values;
+    for (const Shown& s : shown)
+        values.push_back(s.value);
+    return values;
+}
+
+BGM_TEST(BattleStartThenEndFollowsTheAnimation)
+{
+    // The field theme's toast is up when a battle starts, and the battle is
+    // over 0.2 s later
+    const std::vector<std::pair<double, int>> requests = { { 0.0, 1 }, { 3.0, 2 }, { 3.2, 3 } };
+
+    // Battle start never shows; battle end waits for the field toast
+    std::vector<Shown> coalesce = PlayFrames(BgmToastPolicy::Coalesce, 2.0, requests);
+    BGM_CHECK((Values(coalesce) == std::vector<int>{ 1, 3 }));
+    BGM_CHECK(coalesce.size() == 2 && coalesce[1].time > 5.3 && coalesce[1].time < 5.4);
+
+    BGM_CHECK((Values(PlayFrames(BgmToastPolicy::Enqueue, 2.0, requests)) == std::vector<int>{ 1, 2, 3 }));
+
+    // The field toast is cut short; battle start is dropped before it shows
+    std::vector<Shown> replace = PlayFrames(BgmToastPolicy::Replace, 2.0, requests);
+    BGM_CHECK((Values(replace) == std::vector<int>{ 1, 3 }));
+    BGM_CHECK(replace.size() == 2 && replace[1].time > 3.3 && replace[1].time < 3.4);
+
+    // Within the window of a toast that just appeared, its text is swapped in place
+    const std::vector<std::pair<double, int>> quick = { { 0.0, 1 }, { 1.0, 2 } };
+    std::vector<Shown> swapped = PlayFrames(BgmToastPolicy::Coalesce, 2.0, quick);
+    BGM_CHECK((Values(swapped) == std::vector<int>{ 1, 2 }));
+    BGM_CHECK(swapped.size() == 2 && swapped[1].time == swapped[0].time + 60 * (1.0 / 60.0));
+
+    // Far enough apart, every policy shows every track
+    const std::vector<std::pair<double, int>> spaced = { { 0.0, 1 }, { 8.0, 2 }, { 16.0, 3 } };
+    for (BgmToastPolicy policy : { BgmToastPolicy::Replace, BgmToastPolicy::Enqueue, BgmToastPolicy::Coalesce })
+        BGM_CHECK((Values(PlayFrames(policy, 2.0, spaced)) == std::vector<int>{ 1, 2, 3 }));
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,166 @@
+// BgmSeqlock: single-threaded round trips, then writers and readers racing
+// on values whose words are all derived from one counter, so any torn read
+// (words from two different writes) is detected. Also built with TSan
+// (BgmToastStateTestTsan), where a reported race fails the test.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "BgmTest.h"
+#include "BgmToastState.h"
+
+namespace {
+
+// Spans three words, the last one partly
+struct Wide {
+    uint32_t count;
+    uint32_t doubled;
+    uint32_t inverted;
+    uint8_t tail[5];
+};
+
+Wide MakeWide(uint32_t count)
+{
+    Wide value{};
+    value.count = count;
+    value.doubled = count * 2;
+    value.inverted = ~count;
+    for (size_t i = 0; i < sizeof(value.tail); ++i)
+        value.tail[i] = (uint8_t)(count + i);
+    return value;
+}
+
+bool IsConsistent(const Wide& value)
+{
+    Wide expected = MakeWide(value.count);
+    return value.doubled == expected.doubled && value.inverted == expected.inverted &&
+        memcmp(value.tail, expected.tail, sizeof(value.tail)) == 0;
+}
+
+} // namespace
+
+BGM_TEST(LoadReturnsWhatWasStored)
+{
+    BgmSeqlock<BgmToastState> lock;
+    BgmToastState initial = lock.Load();
+    BGM_CHECK(initial.track == BGM_INVALID_TRACK_ID && initial.serial == 0 && initial.keyHash == 0);
+
+    BgmToastState state;
+    state.track = (3u << 16) | 7;
+    state.serial = 42;
+    state.keyHash = 0x0123456789ABCDEFull;
+    lock.Store(state);
+    BgmToastState loaded = lock.Load();
+    BGM_CHECK(loaded.track == state.track && loaded.serial == 42 && loaded.keyHash == state.keyHash);
+
+    lock.Update([](BgmToastState& toast) { ++toast.serial; });
+    loaded = lock.Load();
+    BGM_CHECK(loaded.serial == 43 && loaded.track == state.track);
+
+    BgmSeqlock<Wide> wide(MakeWide(9));
+    BGM_CHECK(IsConsistent(wide.Load()) && wide.Load().count == 9);
+    static_assert(sizeof(Wide) % sizeof(uint64_t) != 0, "Wide should not fill its last word");
+}
+
+// Writers increment the counter with Update (read-modify-write); readers load
+// continuously. Every load must be whole, a reader must never see the counter
+// go backwards, and no increment may be lost between writers.
+BGM_TEST(RacingWritersAndReadersNeverTear)
+{
+    constexpr int WRITERS = 2;
+    constexpr int READERS = 3;
+    constexpr uint32_t WRITES = 50000;
+    BgmSeqlock<Wide> lock(MakeWide(0));
+    std::atomic<int> writersLeft{WRITERS};
+    std::atomic<uint64_t> torn{0}, backwards{0}, loads{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < READERS; ++r)
+        threads.emplace_back([&] {
+            uint32_t last = 0;
+            uint64_t count = 0;
+            while (writersLeft.load() > 0)
+            {
+                Wide value = lock.Load();
+                if (!IsConsistent(value)) torn.fetch_add(1);
+                if (value.count < last) backwards.fetch_add(1);
+                last = value.count;
+                ++count;
+            }
+            loads.fetch_add(count);
+        });
+    for (int w = 0; w < WRITERS; ++w)
+        threads.emplace_back([&] {
+            for (uint32_t i = 0; i < WRITES; ++i)
+            {
+                lock.Update([](Wide& value) { value = MakeWide(value.count + 1); });
+                if (i % 64 == 0)
+                    std::this_thread::yield(); // Give readers a turn on small machines
+            }
+            writersLeft.fetch_sub(1);
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    BGM_CHECK(torn.load() == 0);
+    BGM_CHECK(backwards.load() == 0);
+    BGM_CHECK(loads.load() > 0);
+    Wide final = lock.Load();
+    BGM_CHECK(IsConsistent(final));
+    BGM_CHECK(final.count == WRITERS * WRITES);
+}
+
+// The toast's own traffic: a drain thread bumping serial with a matching
+// track and key hash, a reload thread rewriting track and hash in place (as
+// RemapToastQueue does), and the render thread reading every "frame".
+BGM_TEST(ToastStateStaysConsistent)
+{
+    constexpr uint32_t TRIGGERS = 50000;
+    BgmSeqlock<BgmToastState> lock;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> mismatched{0}, serialBackwards{0};
+
+    auto hashFor = [](uint32_t track) { return (uint64_t)track * 0x9E3779B97F4A7C15ull; };
+
+    std::thread render([&] {
+        uint32_t lastSerial = 0;
+        while (!done.load())
+        {
+            BgmToastState toast = lock.Load();
+            if (toast.track != BGM_INVALID_TRACK_ID && toast.keyHash != hashFor(toast.track)) mismatched.fetch_add(1);
+            if (toast.serial < lastSerial) serialBackwards.fetch_add(1);
+            lastSerial = toast.serial;
+        }
+    });
+    std::thread reload([&] {
+        for (uint32_t generation = 1; !done.load(); ++generation)
+        {
+            lock.Update([&](BgmToastState& toast) {
+                if (toast.track == BGM_INVALID_TRACK_ID) return;
+                toast.track = (generation << 16) | (toast.track & 0xFFFF);
+                toast.keyHash = hashFor(toast.track);
+            });
+            std::this_thread::yield();
+        }
+    });
+    for (uint32_t i = 0; i < TRIGGERS; ++i)
+    {
+        lock.Update([&](BgmToastState& toast) {
+            toast.track = i & 0xFFFF;
+            toast.keyHash = hashFor(toast.track);
+            ++toast.serial;
+        });
+        if (i % 64 == 0)
+            std::this_thread::yield();
+    }
+    done = true;
+    render.join();
+    reload.join();
+
+    BGM_CHECK(mismatched.load() == 0);
+    BGM_CHECK(serialBackwards.load() == 0);
+    BGM_CHECK(lock.Load().serial == TRIGGERS);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,172 @@
+// BgmTrackStore.h: the "title|disc|track" value parser, the structure-of-
+// arrays store and its string pool, and the title codepoint helpers.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BgmTest.h"
+#include "BgmTrackStore.h"
+
+BGM_TEST(ParsesWellFormedValues)
+{
+    std::string_view title;
+    uint8_t disc, track;
+    BGM_CHECK(ParseBgmValue("Crimson Fighter|1|19", &title, &disc, &track));
+    BGM_CHECK(title == "Crimson Fighter" && disc == 1 && track == 19);
+    BGM_CHECK(ParseBgmValue("A|255|255", &title, &disc, &track));
+    BGM_CHECK(title == "A" && disc == 255 && track == 255);
+    BGM_CHECK(ParseBgmValue("\xE7\xB4\x85|2|007", &title, &disc, &track));
+    BGM_CHECK(title == "\xE7\xB4\x85" && disc == 2 && track == 7);
+}
+
+// Malformed values are reported, but still shown the way the original split
+// showed them, minus the parts that are not numbers.
+BGM_TEST(KeepsThePartsOfMalformedValuesThatParse)
+{
+    struct Case {
+        const char* value;
+        const char* title;
+        uint8_t disc;
+        uint8_t track;
+    };
+    const Case cases[] = {
+        { "Title only", "Title only", 0, 0 },
+        { "Title|1", "Title|1", 0, 0 },
+        { "|1|2", "|1|2", 0, 0 },
+        { "", "", 0, 0 },
+        { "Title||", "Title", 0, 0 },
+        { "Title|A|3", "Title", 0, 3 },
+        { "Title|1|B-side", "Title", 1, 0 },
+        { "Title|1|3|4", "Title", 1, 0 },
+        { "Title| 1 |3 ", "Title", 1, 3 },
+        { "Title|0|3", "Title", 0, 3 },
+        { "Title|256|3", "Title", 0, 3 },
+        { "Title|1|99999999999", "Title", 1, 0 },
+        { "Title|-1|+2", "Title", 0, 0 },
+    };
+    for (const Case& c : cases)
+    {
+        std::string_view title;
+        uint8_t disc = 99, track = 99;
+        bool parsed = ParseBgmValue(c.value, &title, &disc, &track);
+        if (parsed || title != c.title || disc != c.disc || track != c.track)
+            std::printf("  \"%s\": %d \"%.*s\" %u %u\n", c.value, (int)parsed, (int)title.size(), title.data(), disc, track);
+        BGM_CHECK(!parsed);
+        BGM_CHECK(title == c.title);
+        BGM_CHECK(disc == c.disc && track == c.track);
+
+        std::string owned;
+        BGM_CHECK(!ParseBgmValue(std::string(c.value), &owned, &disc, &track));
+        BGM_CHECK(owned == c.title);
+    }
+}
+
+BGM_TEST(InternsTitlesAndReturnsViews)
+{
+    BgmTrackStore store;
+    BGM_CHECK(store.Add("bgm\\a.ogg", "Song", 1, 2) == 0);
+    BGM_CHECK(store.Add("bgm\\b.ogg", "Other", 0, 0) == 1);
+    BGM_CHECK(store.Add("bgm\\c.ogg", "Song", 3, 4) == 2);
+    BGM_REQUIRE(store.GetCount() == 3);
+
+    BGM_CHECK(std::strcmp(store.GetKey(2), "bgm\\c.ogg") == 0);
+    BGM_CHECK(std::strcmp(store.GetTitle(2), "Song") == 0);
+    BGM_CHECK(store.GetTitleOffset(0) == store.GetTitleOffset(2));
+    BGM_CHECK(store.GetTitleOffset(0) != store.GetTitleOffset(1));
+    BGM_CHECK(store.GetDisc(2) == 3 && store.GetTrackNumber(2) == 4);
+    BGM_CHECK(store.GetDisc(1) == 0 && store.GetTrackNumber(1) == 0);
+
+    // Three keys and two titles, each NUL-terminated, plus 10 bytes a record
+    size_t pool = 3 * 10 + 5 + 6;
+    BGM_CHECK(store.GetTables().stringPoolSize == pool);
+    BGM_CHECK(store.GetSizeInBytes() == pool + 3 * 10);
+
+    // Views stay valid for the store's contents after it grows
+    for (int i = 0; i < 1000; ++i)
+        store.Add("bgm\\x" + std::to_string(i) + ".ogg", "Song " + std::to_string(i % 10), 1, 1);
+    BGM_CHECK(std::strcmp(store.GetTitle(0), "Song") == 0);
+    BGM_CHECK(std::strcmp(store.GetTitle(1002), "Song 9") == 0);
+    BGM_CHECK(store.GetTitleOffset(3) == store.GetTitleOffset(13));
+}
+
+BGM_TEST(AttachesStaticTablesAndDetachesOnAdd)
+{
+    static const char POOL[] = "k0\0Title\0k1";
+    static const uint32_t KEYS[] = { 0, 9 };
+    static const uint32_t TITLES[] = { 3, 3 };
+    static const uint8_t DISCS[] = { 1, 1 };
+    static const uint8_t TRACKS[] = { 5, 6 };
+
+    BgmTrackStoreTables tables;
+    tables.stringPool = POOL;
+    tables.stringPoolSize = sizeof(POOL);
+    tables.keyOffsets = KEYS;
+    tables.titleOffsets = TITLES;
+    tables.discs = DISCS;
+    tables.trackNumbers = TRACKS;
+    tables.trackCount = 2;
+
+    BgmTrackStore store;
+    store.Add("old", "Old", 1, 1);
+    store.Attach(tables);
+    BGM_REQUIRE(store.GetCount() == 2);
+    BGM_CHECK(store.GetTitle(1) == POOL + 3);
+    BGM_CHECK(std::strcmp(store.GetKey(1), "k1") == 0);
+    BGM_CHECK(store.GetTrackNumber(1) == 6);
+
+    // Adding starts a runtime store from scratch
+    BGM_CHECK(store.Add("new", "New", 2, 2) == 0);
+    BGM_CHECK(store.GetCount() == 1);
+    BGM_CHECK(std::strcmp(store.GetTitle(0), "New") == 0);
+    BGM_CHECK(store.GetTables().stringPool != POOL);
+}
+
+BGM_TEST(StopsAtMaxTracks)
+{
+    BgmTrackStore store;
+    for (size_t i = 0; i < BGM_MAX_TRACKS; ++i)
+        BGM_REQUIRE(store.Add("k", "t", 0, 0) == (uint16_t)i);
+    BGM_CHECK(store.Add("k", "t", 0, 0) == BGM_INVALID_TRACK_ID);
+    BGM_CHECK(store.GetCount() == BGM_MAX_TRACKS);
+}
+
+BGM_TEST(DecodesUtf8LikeImGui)
+{
+    struct Case {
+        const char* text;
+        size_t length;
+        uint32_t codepoint;
+    };
+    const Case cases[] = {
+        { "A", 1, 'A' },
+        { "\xC3\xA9", 2, 0xE9 },
+        { "\xE7\xB4\x85", 3, 0x7D05 },
+        { "\xF0\x9F\x8E\xB5", 4, 0x1F3B5 },
+        { "\xC0\xAF", 1, 0xFFFD },          // Overlong
+        { "\xED\xA0\x80", 1, 0xFFFD },      // Surrogate
+        { "\xF4\x90\x80\x80", 1, 0xFFFD },  // Above U+10FFFF
+        { "\xE7\xB4", 1, 0xFFFD },          // Truncated by the terminator
+        { "\x80", 1, 0xFFFD },
+        { "\xFF", 1, 0xFFFD },
+    };
+    for (const Case& c : cases)
+    {
+        uint32_t codepoint;
+        BGM_CHECK(DecodeBgmUtf8(c.text, &codepoint) == c.length);
+        BGM_CHECK(codepoint == c.codepoint);
+    }
+}
+
+BGM_TEST(CollectsTitleCodepoints)
+{
+    BgmTrackStore store;
+    store.Add("a", "ba", 1, 1);
+    store.Add("b", "ba", 1, 2);
+    store.Add("c", "\xE7\xB4\x85" "c", 1, 3);
+    std::vector<uint32_t> expected = { ' ', '1', 'D', 'a', 'b', 'c', 0x7D05 };
+    BGM_CHECK(CollectBgmTitleCodepoints(store, "D1 ") == expected);
+    BGM_CHECK(CollectBgmTitleCodepoints(BgmTrackStore(), "").empty());
+}
+
+BGM_TEST_MAIN()
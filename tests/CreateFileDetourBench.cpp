@@ -0,0 +1,159 @@
+// ns per Detour_CreateFileA call, before and after the in-place fast path,
+// for .ogg BGM hits, other .ogg opens and non-.ogg paths.
+//
+// "Before" is the original detour body: a std::string copy, substr and
+// std::transform per call, and on every .ogg a synchronous Log() plus the
+// try_lock handoff. "After" is the current body: ClassifyPath, the Bloom
+// filter and perfect hash, and a ring push (the BGM event ring for hits, the
+// deferred path log for other .ogg files). Both rings are drained between
+// timed batches, as their consumer threads would.
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+
+#include "BgmEventRing.h"
+#include "BgmIndex.h"
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+// --- Before ---
+std::mutex g_bufferMutex;
+bool g_bNewBgmAvailable = false;
+char g_bgmFilenameBuffer[260];
+std::string g_logPath;
+
+void Log(const std::string& message)
+{
+    std::ofstream log_file(g_logPath, std::ios_base::app | std::ios_base::out);
+    log_file << "[Thu Jan  1 00:00:00 2026] " << message << std::endl;
+}
+
+void BaselineDetour(const char* lpFileName, bool withLog)
+{
+    if (lpFileName) {
+        std::string fname = lpFileName;
+        if (fname.length() > 4) {
+            std::string ext = fname.substr(fname.length() - 4);
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+            if (ext == ".ogg") {
+                if (withLog)
+                    Log("Detour_CreateFileA caught: " + fname);
+
+                if (g_bufferMutex.try_lock()) {
+                    if (!g_bNewBgmAvailable) {
+                        strncpy(g_bgmFilenameBuffer, lpFileName, sizeof(g_bgmFilenameBuffer) - 1);
+                        g_bNewBgmAvailable = true;
+                    }
+                    g_bufferMutex.unlock();
+                }
+            }
+        }
+    }
+}
+
+// --- After ---
+BgmTrackIndex g_index;
+BgmEventRing<64> g_eventRing;
+BgmEventRing<64, BgmPathLogEvent> g_pathLogRing;
+
+void CurrentDetour(const char* lpFileName)
+{
+    if (lpFileName) {
+        BgmPathInfo pathInfo = ClassifyPath(lpFileName);
+        if (pathInfo.isOgg) {
+            uint64_t hash;
+            uint16_t trackId = BGM_INVALID_TRACK_ID;
+            if (HashAsciiBasename(lpFileName + pathInfo.basenameOffset, pathInfo.length - pathInfo.basenameOffset, &hash) &&
+                g_index.MayContain(hash))
+                trackId = g_index.Find(hash, lpFileName, pathInfo.length, pathInfo.basenameOffset);
+
+            if (trackId == BGM_INVALID_TRACK_ID) {
+                size_t length = std::min(pathInfo.length, BGM_LOGGED_PATH_CHARS - 1);
+                g_pathLogRing.TryPush([&](BgmPathLogEvent& ev) {
+                    ev.threadId = 1;
+                    memcpy(ev.path, lpFileName, length);
+                    ev.path[length] = '\0';
+                });
+            } else {
+                g_eventRing.TryPush([&](BgmCaptureEvent& ev) {
+                    ev.timestamp = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+                    ev.threadId = 1;
+                    ev.trackId = trackId;
+                    ev.source = BgmCaptureSource::CreateFileA;
+                });
+            }
+        }
+    }
+}
+
+// Calls `detour` over `paths` round-robin in batches of 32 (half a ring),
+// timing only the calls; returns ns per call.
+template <typename Detour>
+double TimeDetour(const BgmBench& bench, const std::vector<std::string>& paths, size_t calls, Detour&& detour)
+{
+    constexpr size_t BATCH = 32;
+    double best = 0.0;
+    for (int run = 0; run < (bench.quick ? 1 : 5); ++run)
+    {
+        std::chrono::steady_clock::duration total{};
+        for (size_t done = 0; done < calls; done += BATCH)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = done; i < done + BATCH; ++i)
+                detour(paths[i % paths.size()].c_str());
+            total += std::chrono::steady_clock::now() - start;
+
+            BgmCaptureEvent events[BATCH];
+            BgmPathLogEvent logged[8];
+            while (g_eventRing.PopBatch(events, BATCH)) {}
+            while (g_pathLogRing.PopBatch(logged, 8)) {}
+            g_bNewBgmAvailable = false;
+        }
+        double ns = std::chrono::duration<double, std::nano>(total).count() / calls;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::vector<BgmTestEntry> entries = LoadShippedBgmMap();
+    if (entries.empty() || !g_index.Build(GetBgmTestKeys(entries)))
+        return 1;
+    BgmTestTrace trace = MakeBgmTestTrace(GetBgmTestKeys(entries), 1000, 1000);
+    g_logPath = (std::filesystem::temp_directory_path() / "CreateFileDetourBench.log").string();
+
+    struct Case {
+        const char* name;
+        const std::vector<std::string>* paths;
+    };
+    const Case cases[] = {
+        { ".ogg BGM hit", &trace.bgmHits },
+        { ".ogg miss (voice/SE)", &trace.oggMisses },
+        { "non-.ogg", &trace.otherFiles },
+    };
+
+    std::printf("Detour_CreateFileA, ns/call (%zu map entries)\n", entries.size());
+    std::printf("%-22s %14s %14s %10s\n", "path", "before", "before,no Log", "after");
+    size_t calls = bench.Iterations(320000);
+    for (const Case& c : cases)
+    {
+        // The logging baseline opens the log file per .ogg; a few thousand calls tell enough
+        double before = TimeDetour(bench, *c.paths, std::min<size_t>(calls, 3200), [](const char* p) { BaselineDetour(p, true); });
+        double beforeNoLog = TimeDetour(bench, *c.paths, calls, [](const char* p) { BaselineDetour(p, false); });
+        double after = TimeDetour(bench, *c.paths, calls, CurrentDetour);
+        std::printf("%-22s %14.1f %14.1f %10.1f\n", c.name, before, beforeNoLog, after);
+    }
+
+    std::remove(g_logPath.c_str());
+    return 0;
+}
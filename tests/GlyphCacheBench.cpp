@@ -0,0 +1,179 @@
+// Cold bake vs. ToastGlyphs.cache load, for the toast font's prewarm set, run
+// through the DLL's own ToastFont.cpp and ToastGlyphCache.cpp:
+//
+// - cold bake: what PrewarmToastGlyphs does on a cache miss without the
+//   rasterizer thread, every glyph through ImGui's stb_truetype loader into
+//   the ImGui atlas;
+// - cache write: WriteToastGlyphCache after that bake, the glyphs read back
+//   out of the atlas and saved (once per map that missed the cache);
+// - cache load: LoadToastGlyphCache, the file read, validated and copied
+//   into a fresh atlas.
+//
+// mod_font.otf at 28 px as bitmaps, for the shipped map's title codepoints
+// and for every codepoint the font keeps resident. Each run starts from a new
+// ImGui context; only the bake, write or load is timed. The loaded glyphs
+// are checked against the baked ones, metrics and pixels.
+
+#include <cstring>
+#include <filesystem>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "BgmTrackStore.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphCache.h"
+
+namespace {
+
+// A fresh ImGui context with the toast font added, between NewFrame and
+// Render, as Present has it when PrewarmToastGlyphs runs.
+struct ToastFrame {
+    ImFontBaked* baked = nullptr;
+
+    ToastFrame()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.IniFilename = nullptr;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        g_pToastFont = AddToastFonts(io.Fonts);
+        ImGui::NewFrame();
+        g_toastBakedSize = TOAST_FONT_SIZE;
+        if (g_pToastFont)
+            baked = GetToastBaked();
+    }
+    ~ToastFrame()
+    {
+        ImGui::EndFrame();
+        ImGui::DestroyContext();
+        g_pToastFont = nullptr;
+    }
+};
+
+std::vector<uint32_t> GetResident(const std::vector<uint32_t>& codepoints)
+{
+    std::vector<uint32_t> resident;
+    for (uint32_t codepoint : codepoints)
+        if (codepoint <= IM_UNICODE_CODEPOINT_MAX && !IsToastGlyphOnDemand(codepoint) && g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+            resident.push_back(codepoint);
+    return resident;
+}
+
+// Microseconds for work(frame) in a fresh ToastFrame, after an untimed
+// prepare(frame), best of a few runs.
+template <typename Prepare, typename Fn>
+double TimeInFreshFrame(const BgmBench& bench, Prepare&& prepare, Fn&& work)
+{
+    double best = 0.0;
+    for (int run = 0; run < (bench.quick ? 1 : 7); ++run)
+    {
+        ToastFrame frame;
+        prepare(frame);
+        auto start = std::chrono::steady_clock::now();
+        work(frame);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || us < best) best = us;
+    }
+    return best;
+}
+
+struct GlyphSnapshot {
+    std::vector<BgmCachedGlyph> glyphs;
+    std::vector<uint8_t> pixels;
+};
+
+bool SameGlyphs(const GlyphSnapshot& a, const GlyphSnapshot& b)
+{
+    if (a.glyphs.size() != b.glyphs.size() || a.pixels != b.pixels)
+        return false;
+    for (size_t i = 0; i < a.glyphs.size(); ++i)
+        if (memcmp(&a.glyphs[i], &b.glyphs[i], sizeof(BgmCachedGlyph)) != 0)
+            return false;
+    return true;
+}
+
+// Returns false if the cache did not reproduce the bake.
+bool RunSet(const BgmBench& bench, const char* name, const std::vector<uint32_t>& codepoints)
+{
+    std::filesystem::remove(GetToastGlyphCachePath());
+    BgmGlyphCacheKey key = MakeToastGlyphCacheKey(codepoints, TOAST_FONT_SIZE);
+    size_t resident = 0;
+
+    auto none = [](ToastFrame&) {};
+    auto bake = [&](ToastFrame& frame) {
+        std::vector<uint32_t> set = GetResident(codepoints);
+        resident = set.size();
+        for (uint32_t codepoint : set)
+            frame.baked->FindGlyph((ImWchar)codepoint);
+    };
+    double coldUs = TimeInFreshFrame(bench, none, bake);
+    double writeUs = TimeInFreshFrame(bench, bake, [&](ToastFrame& frame) { WriteToastGlyphCache(key, codepoints, frame.baked); });
+
+    GlyphSnapshot bakedGlyphs;
+    {
+        ToastFrame frame;
+        ReadToastGlyphs(ImGui::GetIO().Fonts, frame.baked, GetResident(codepoints), &bakedGlyphs.glyphs, &bakedGlyphs.pixels);
+    }
+    uintmax_t fileBytes = std::filesystem::file_size(GetToastGlyphCachePath());
+
+    int loaded = -1;
+    double loadUs = TimeInFreshFrame(bench, none, [&](ToastFrame& frame) { loaded = LoadToastGlyphCache(key, frame.baked); });
+
+    // Read back from an atlas that only ever saw the cache (and NewFrame's
+    // fallback glyphs); anything the cache missed would be rasterized here
+    GlyphSnapshot cachedGlyphs;
+    bool missed = false;
+    {
+        ToastFrame frame;
+        LoadToastGlyphCache(key, frame.baked);
+        int glyphsAfterLoad = frame.baked->Glyphs.Size;
+        ReadToastGlyphs(ImGui::GetIO().Fonts, frame.baked, GetResident(codepoints), &cachedGlyphs.glyphs, &cachedGlyphs.pixels);
+        missed = frame.baked->Glyphs.Size != glyphsAfterLoad;
+    }
+    bool same = loaded > 0 && !missed && SameGlyphs(bakedGlyphs, cachedGlyphs);
+
+    std::printf("%-22s %6zu %12.1f %12.1f %12.1f %9.1fx %8ju  %s\n", name, resident, coldUs, writeUs, loadUs,
+        loadUs > 0.0 ? coldUs / loadUs : 0.0, fileBytes, same ? "identical" : "MISMATCH");
+    return same;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmGlyphCacheBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    g_bToastSdf = false;
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    BgmTrackStore store;
+    for (const BgmTestEntry& entry : LoadShippedBgmMap())
+        store.Add(entry.key, entry.title, entry.disc, entry.track);
+    std::vector<uint32_t> titles = CollectBgmTitleCodepoints(store, "Disc, Track 0123456789");
+
+    std::vector<uint32_t> wholeFont;
+    {
+        ToastFrame frame;
+        for (uint32_t codepoint = 0x20; codepoint < TOAST_ON_DEMAND_CODEPOINT_MIN; ++codepoint)
+            if (g_pToastFont && g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+                wholeFont.push_back(codepoint);
+    }
+
+    std::printf("Toast glyph prewarm, us (ImGui %s, mod_font.otf at %.0f px, bitmaps)\n", IMGUI_VERSION, TOAST_FONT_SIZE);
+    std::printf("%-22s %6s %12s %12s %12s %10s %8s\n", "set", "glyphs", "cold bake", "cache write", "cache load", "speedup", "bytes");
+    bool ok = RunSet(bench, "shipped map titles", titles);
+    ok &= RunSet(bench, "whole font (resident)", wholeFont);
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return ok ? 0 : 1;
+}
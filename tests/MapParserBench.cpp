@@ -0,0 +1,110 @@
+// Cost of turning BgmMap.yaml text into a track store and index, for the
+// shipped map and a 100k-line synthetic one:
+//
+// - parse: BgmMapParser::Parse alone, and yaml-cpp's YAML::Load plus reading
+//   every pair as strings (main.cpp's fallback);
+// - build: parse, BgmTrackStore::Add straight from the parser's views and
+//   BgmTrackIndex::Build over the pooled keys (LoadBgmMap minus file I/O),
+//   against the same through yaml-cpp. Both parse every line; the store
+//   takes the first BGM_MAX_TRACKS entries and the index is built over those.
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "BgmIndex.h"
+#include "BgmMapParser.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+size_t BuildFromParser(const std::string& source)
+{
+    BgmMapParser parser;
+    if (parser.Parse(source.data(), source.size()) != BgmMapParseStatus::Ok)
+        return 0;
+    BgmTrackStore store;
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+        if (store.Add(entry.key, entry.title, entry.disc, entry.track) == BGM_INVALID_TRACK_ID)
+            break;
+    std::vector<std::string_view> keys;
+    for (uint16_t id = 0; id < store.GetCount(); ++id)
+        keys.emplace_back(store.GetKey(id));
+    BgmTrackIndex index;
+    return index.Build(keys.data(), keys.size()) ? store.GetCount() : 0;
+}
+
+size_t BuildFromYamlCpp(const std::string& source)
+{
+    YAML::Node config = YAML::Load(source);
+    std::deque<std::string> strings;
+    BgmTrackStore store;
+    for (const auto& node : config)
+    {
+        const std::string& key = strings.emplace_back(node.first.as<std::string>());
+        const std::string& value = strings.emplace_back(node.second.as<std::string>());
+        std::string_view title;
+        uint8_t disc = 0, track = 0;
+        ParseBgmValue(std::string_view(value), &title, &disc, &track);
+        if (store.Add(key, title, disc, track) == BGM_INVALID_TRACK_ID)
+            break;
+    }
+    std::vector<std::string_view> keys;
+    for (uint16_t id = 0; id < store.GetCount(); ++id)
+        keys.emplace_back(store.GetKey(id));
+    BgmTrackIndex index;
+    return index.Build(keys.data(), keys.size()) ? store.GetCount() : 0;
+}
+
+void BenchMap(const BgmBench& bench, const char* name, const std::string& source)
+{
+    BgmMapParser parser;
+    if (parser.Parse(source.data(), source.size()) != BgmMapParseStatus::Ok) {
+        std::printf("%s: not in the parser's subset\n", name);
+        return;
+    }
+    size_t entries = parser.GetEntries().size();
+
+    double parse = bench.Microseconds([&] {
+        BgmMapParser timed;
+        timed.Parse(source.data(), source.size());
+        BgmBenchKeep(timed.GetEntries().size());
+    });
+    double yamlParse = bench.Microseconds([&] {
+        YAML::Node config = YAML::Load(source);
+        size_t bytes = 0;
+        for (const auto& node : config)
+            bytes += node.first.as<std::string>().size() + node.second.as<std::string>().size();
+        BgmBenchKeep(bytes);
+    });
+    double build = bench.Microseconds([&] { BgmBenchKeep(BuildFromParser(source)); });
+    double yamlBuild = bench.Microseconds([&] { BgmBenchKeep(BuildFromYamlCpp(source)); });
+
+    std::printf("%-10s %8zu %10.1f %10.1f %8.0f %10.1f %10.1f\n", name, entries, parse, yamlParse,
+        (double)source.size() / parse, build, yamlBuild);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::string shipped = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    if (shipped.empty())
+        return 1;
+
+    std::vector<std::string> syntheticKeys = MakeSyntheticBgmKeys(bench.quick ? 1000 : 100000);
+    std::string synthetic = "# Synthetic map\n";
+    for (size_t i = 0; i < syntheticKeys.size(); ++i)
+        synthetic += syntheticKeys[i] + ": \"Synthetic Song " + std::to_string(i / 2) + "|1|" + std::to_string(i % 255 + 1) + "\"\n";
+
+    std::printf("BgmMap.yaml to store + index, us (MB/s = parser throughput)\n");
+    std::printf("%-10s %8s %10s %10s %8s %10s %10s\n", "map", "entries", "parse", "yaml-cpp", "MB/s", "build", "yaml-cpp");
+    BenchMap(bench, "shipped", shipped);
+    BenchMap(bench, "synthetic", synthetic);
+    return 0;
+}
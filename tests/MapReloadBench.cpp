@@ -0,0 +1,151 @@
+// Cost of a BgmMap.yaml hot reload and of the RCU read side it relies on:
+//
+// - reload: parse the YAML, build a whole snapshot, publish it and wait out
+//   readers of the old one (LoadBgmMap minus file I/O), for the shipped map
+//   and 50k entries, with and without reader threads doing detour lookups;
+// - ReadGuard: ns to pin and release the current snapshot, alone and while
+//   a writer publishes in a loop.
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BgmMapParser.h"
+#include "BgmPathClassifier.h"
+#include "BgmSnapshot.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+std::unique_ptr<BgmMapSnapshot> ParseSnapshot(const std::string& source, uint32_t generation)
+{
+    BgmMapParser parser;
+    parser.Parse(source.data(), source.size());
+    auto snapshot = std::make_unique<BgmMapSnapshot>();
+    std::vector<std::string_view> keys;
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+    {
+        if (snapshot->store.Add(entry.key, entry.title, entry.disc, entry.track) == BGM_INVALID_TRACK_ID)
+            break;
+        keys.emplace_back(entry.key);
+    }
+    snapshot->index.Build(keys.data(), keys.size());
+    snapshot->generation = generation;
+    return snapshot;
+}
+
+// Reader threads that resolve `paths` against the current snapshot until stopped.
+class Readers {
+public:
+    Readers(BgmRcuPointer<BgmMapSnapshot>& rcu, const std::vector<std::string>& paths, int count)
+    {
+        for (int t = 0; t < count; ++t)
+        {
+            m_threads.emplace_back([&, t] {
+                uint64_t sum = 0;
+                for (size_t i = (size_t)t; !m_stop.load(std::memory_order_relaxed); ++i)
+                {
+                    const std::string& path = paths[i % paths.size()];
+                    BgmPathInfo info = ClassifyPath(path.c_str());
+                    uint64_t hash = HashUtf8Basename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset);
+                    BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+                    sum += snapshot->index.Find(hash, path.c_str(), info.length, info.basenameOffset);
+                    if (i % 256 == 0)
+                        std::this_thread::yield(); // Leaves room for the writer on small machines
+                }
+                BgmBenchKeep(sum);
+            });
+        }
+    }
+    ~Readers()
+    {
+        m_stop = true;
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+private:
+    std::atomic<bool> m_stop{false};
+    std::vector<std::thread> m_threads;
+};
+
+void BenchReload(const BgmBench& bench, const char* name, const std::string& source, const std::vector<std::string>& keys)
+{
+    BgmRcuPointer<BgmMapSnapshot> rcu;
+    uint32_t generation = 0;
+    rcu.Publish(ParseSnapshot(source, ++generation).release());
+
+    std::vector<std::string> paths = MakeBgmTestTrace(keys, 0, 0).bgmHits;
+    double synchronizeUs = 0.0;
+    auto timeReload = [&](int readerCount) {
+        Readers readers(rcu, paths, readerCount);
+        return bench.Microseconds([&] {
+            std::unique_ptr<BgmMapSnapshot> next = ParseSnapshot(source, ++generation);
+            std::unique_ptr<BgmMapSnapshot> previous(rcu.Exchange(next.release()));
+            auto start = std::chrono::steady_clock::now();
+            rcu.Synchronize();
+            synchronizeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        });
+    };
+    double alone = timeReload(0);
+    double aloneSync = synchronizeUs;
+    double contended = timeReload(3);
+    double contendedSync = synchronizeUs;
+    rcu.Publish(nullptr);
+
+    std::printf("%-10s %8zu %12.0f %10.1f %12.0f %10.1f\n", name, keys.size(), alone, aloneSync, contended, contendedSync);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::string shipped = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    std::vector<std::string> shippedKeys = GetBgmTestKeys(LoadShippedBgmMap());
+    if (shippedKeys.empty())
+        return 1;
+
+    std::vector<std::string> syntheticKeys = MakeSyntheticBgmKeys(bench.quick ? 1000 : 50000);
+    std::string synthetic;
+    for (size_t i = 0; i < syntheticKeys.size(); ++i)
+        synthetic += syntheticKeys[i] + ": \"Synthetic Song " + std::to_string(i / 2) + "|1|" + std::to_string(i % 255 + 1) + "\"\n";
+
+    std::printf("Reload (parse, build, publish, synchronize), us; sync = the Synchronize part\n");
+    std::printf("%-10s %8s %12s %10s %12s %10s\n", "map", "entries", "no readers", "sync", "3 readers", "sync");
+    BenchReload(bench, "shipped", shipped, shippedKeys);
+    BenchReload(bench, "synthetic", synthetic, syntheticKeys);
+
+    // Read side
+    BgmRcuPointer<BgmMapSnapshot> rcu;
+    rcu.Publish(new BgmMapSnapshot());
+    size_t calls = bench.Iterations(10000000);
+    uint64_t sum = 0;
+    double quiet = bench.NsPerCall(calls, [&](size_t) {
+        BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+        sum += snapshot->generation;
+    });
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        uint32_t generation = 0;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            auto next = new BgmMapSnapshot();
+            next->generation = ++generation;
+            rcu.Publish(next);
+            std::this_thread::yield();
+        }
+    });
+    double busy = bench.NsPerCall(calls, [&](size_t) {
+        BgmRcuPointer<BgmMapSnapshot>::ReadGuard snapshot(rcu);
+        sum += snapshot->generation;
+    });
+    stop = true;
+    writer.join();
+    rcu.Publish(nullptr);
+    BgmBenchKeep(sum);
+    std::printf("ReadGuard, ns: %.1f alone, %.1f with a writer publishing in a loop\n", quiet, busy);
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Time for LoadBgmMap to get from an edited BgmMap.yaml to usable tables,
+// cold (files evicted from the page cache) and warm, for the shipped map and
+// a synthetic 50k-entry one:
+//
+// - parse: read the YAML, fingerprint it, BgmMapParser, then
+//   BgmTrackStore::Add and BgmTrackIndex::Build per entry;
+// - cache: read and fingerprint the YAML (to detect a stale cache), map
+//   BgmMap.cache, validate it with OpenBgmMapCache and attach the tables.
+//
+// The files are written to the working directory; eviction uses
+// posix_fadvise and has no effect on tmpfs.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+#include "BgmMapCache.h"
+#include "BgmMapParser.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+void WriteFile(const std::string& path, const void* data, size_t size)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return;
+    std::fwrite(data, 1, size, file);
+    std::fflush(file);
+    fdatasync(fileno(file));
+    std::fclose(file);
+}
+
+void Evict(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Returns the number of entries loaded, 0 on failure.
+size_t LoadByParsing(const std::string& yamlPath)
+{
+    std::string source = ReadBgmTestFile(yamlPath);
+    BgmBenchKeep(HashBgmMapSource(source.data(), source.size()));
+    BgmMapParser parser;
+    if (parser.Parse(source.data(), source.size()) != BgmMapParseStatus::Ok)
+        return 0;
+
+    BgmTrackStore store;
+    std::vector<std::string_view> keys;
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+    {
+        if (store.Add(entry.key, entry.title, entry.disc, entry.track) == BGM_INVALID_TRACK_ID)
+            break;
+        keys.emplace_back(entry.key);
+    }
+    BgmTrackIndex index;
+    return index.Build(keys.data(), keys.size()) ? store.GetCount() : 0;
+}
+
+size_t LoadFromCache(const std::string& yamlPath, const std::string& cachePath)
+{
+    std::string source = ReadBgmTestFile(yamlPath);
+    uint64_t sourceHash = HashBgmMapSource(source.data(), source.size());
+
+    int fd = open(cachePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat info;
+    void* view = fstat(fd, &info) == 0 ? mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (view == MAP_FAILED)
+        return 0;
+
+    BgmTrackStoreTables storeTables;
+    BgmTrackIndexTables indexTables;
+    size_t count = 0;
+    if (OpenBgmMapCache(view, (size_t)info.st_size, sourceHash, &storeTables, &indexTables))
+    {
+        BgmTrackStore store;
+        store.Attach(storeTables);
+        BgmTrackIndex index;
+        index.Attach(indexTables);
+        count = store.GetCount();
+    }
+    munmap(view, (size_t)info.st_size);
+    return count;
+}
+
+void BenchStartup(const BgmBench& bench, const char* name, const std::string& yaml)
+{
+    std::string yamlPath = std::string("MapStartupBench_") + name + ".yaml";
+    std::string cachePath = yamlPath + ".cache";
+    WriteFile(yamlPath, yaml.data(), yaml.size());
+
+    // The cache a first launch would write
+    BgmMapParser parser;
+    parser.Parse(yaml.data(), yaml.size());
+    BgmTrackStore store;
+    std::vector<std::string_view> keys;
+    for (const BgmMapParsedEntry& entry : parser.GetEntries())
+    {
+        if (store.Add(entry.key, entry.title, entry.disc, entry.track) == BGM_INVALID_TRACK_ID)
+            break;
+        keys.emplace_back(entry.key);
+    }
+    BgmTrackIndex index;
+    index.Build(keys.data(), keys.size());
+    std::vector<uint8_t> image;
+    BuildBgmMapCache(store.GetTables(), index.GetTables(), HashBgmMapSource(yaml.data(), yaml.size()), &image);
+    WriteFile(cachePath, image.data(), image.size());
+
+    size_t parsed = 0, cached = 0;
+    auto cold = [&](auto&& load) {
+        return bench.Microseconds([&] {
+            Evict(yamlPath);
+            Evict(cachePath);
+            load();
+        });
+    };
+    // Cold runs include the two fadvise calls, a few microseconds
+    double parseCold = cold([&] { parsed = LoadByParsing(yamlPath); });
+    double parseWarm = bench.Microseconds([&] { parsed = LoadByParsing(yamlPath); });
+    double cacheCold = cold([&] { cached = LoadFromCache(yamlPath, cachePath); });
+    double cacheWarm = bench.Microseconds([&] { cached = LoadFromCache(yamlPath, cachePath); });
+
+    std::printf("%-10s %8zu %10zu %10zu %10.0f %10.0f %10.0f %10.0f%s\n", name, parsed, yaml.size(), image.size(),
+        parseCold, parseWarm, cacheCold, cacheWarm, cached == parsed ? "" : "  (cache rejected!)");
+    std::remove(yamlPath.c_str());
+    std::remove(cachePath.c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::string shipped = ReadBgmTestFile(GetBgmTestPath("BgmMap.yaml"));
+    if (shipped.empty())
+        return 1;
+
+    std::string synthetic;
+    std::vector<std::string> keys = MakeSyntheticBgmKeys(bench.quick ? 1000 : 50000);
+    for (size_t i = 0; i < keys.size(); ++i)
+        synthetic += keys[i] + ": \"Synthetic Song " + std::to_string(i / 2) + "|1|" + std::to_string(i % 255 + 1) + "\"\n";
+
+    std::printf("BgmMap.yaml to usable tables, us\n");
+    std::printf("%-10s %8s %10s %10s %10s %10s %10s %10s\n",
+        "map", "entries", "yaml", "cache", "parse cold", "warm", "cache cold", "warm");
+    BenchStartup(bench, "shipped", shipped);
+    BenchStartup(bench, "synthetic", synthetic);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "ModUtilHost.h"
+
+namespace {
+
+std::string g_modDirectory = ".";
+std::vector<std::string> g_modLog;
+
+} // namespace
+
+void SetModDirectory(const std::string& directory)
+{
+    g_modDirectory = directory;
+}
+
+const std::vector<std::string>& GetModLog()
+{
+    return g_modLog;
+}
+
+std::string MakeTempModDirectory(const char* name)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "assets");
+    SetModDirectory(directory.string());
+    return (directory / "assets").string();
+}
+
+void Log(const std::string& message)
+{
+    g_modLog.push_back(message);
+}
+
+std::string GetModDirectory()
+{
+    return g_modDirectory;
+}
+
+std::string GetModAssetPath(const char* name)
+{
+    return g_modDirectory + "/assets/" + name;
+}
+
+bool ReadModFile(const std::string& path, std::vector<uint8_t>* out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    out->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !out->empty();
+}
+
+bool WriteCacheFile(const std::string& path, const std::vector<uint8_t>& image, const char* caller)
+{
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write((const char*)image.data(), (std::streamsize)image.size());
+        if (!out.good()) {
+            Log(std::string(caller) + ": Could not write " + tempPath);
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        Log(std::string(caller) + ": Could not replace " + path);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ModUtil.h"
+
+// =============================================================
+// HOST MOD FILES
+// =============================================================
+// ModUtil.h for tests of the DLL's portable modules (ModUtilHost.cpp): the mod
+// directory is whatever the test sets, and Log keeps the lines in memory.
+
+void SetModDirectory(const std::string& directory);
+
+// Everything logged so far, in order.
+const std::vector<std::string>& GetModLog();
+
+// A fresh directory with an assets/ subdirectory, under the system's temp
+// directory, made the mod directory. Returns the assets path.
+std::string MakeTempModDirectory(const char* name);
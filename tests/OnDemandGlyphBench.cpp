@@ -0,0 +1,214 @@
+// Memory and latency of on-demand glyphs for a 3,000-title multilingual map,
+// through the DLL's ToastGlyphRasterizer.cpp and its real rasterizer thread:
+//
+// - latency: from a toast's first RequestToastGlyphs to every glyph of its
+//   title being in the atlas (Present frames keep running meanwhile);
+// - render thread: IngestToastGlyphs + RequestToastGlyphs + measuring the
+//   title + TouchToastGlyphs per frame, what Present adds for them;
+// - memory: the LRU's surface and the atlas texture after every toast, vs.
+//   the atlas with every on-demand glyph of the map resident.
+//
+// Titles mix ASCII with 3-10 on-demand codepoints, drawn with a Zipf skew
+// (a few common characters, a long tail), from every codepoint at or above
+// TOAST_ON_DEMAND_CODEPOINT_MIN that the toast fonts have. mod_font.otf has
+// no CJK, so DejaVu Sans, if installed, is merged in as mod_font_cjk.otf;
+// the pool is printed, and is far smaller than a CJK font's. Toasts are shown
+// in random order; GlyphPageSize 512 (the default) and 256.
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphRasterizer.h"
+
+namespace {
+
+constexpr size_t TITLE_COUNT = 3000;
+constexpr const char* FALLBACK_FONT = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+
+void AppendUtf8(std::string* out, uint32_t codepoint)
+{
+    if (codepoint < 0x80) {
+        out->push_back((char)codepoint);
+    } else if (codepoint < 0x800) {
+        out->push_back((char)(0xC0 | (codepoint >> 6)));
+        out->push_back((char)(0x80 | (codepoint & 0x3F)));
+    } else {
+        out->push_back((char)(0xE0 | (codepoint >> 12)));
+        out->push_back((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+        out->push_back((char)(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+std::vector<std::string> MakeTitles(const std::vector<uint32_t>& pool)
+{
+    std::mt19937 rng(22);
+    std::vector<double> weights;
+    for (size_t rank = 0; rank < pool.size(); ++rank)
+        weights.push_back(1.0 / (double)(rank + 1));
+    std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+
+    std::vector<std::string> titles;
+    for (size_t i = 0; i < TITLE_COUNT; ++i)
+    {
+        std::string title = "Track " + std::to_string(i) + " ";
+        for (size_t n = 0, length = 3 + rng() % 8; n < length; ++n)
+            AppendUtf8(&title, pool[pick(rng)]);
+        titles.push_back(title);
+    }
+    return titles;
+}
+
+ImFontBaked* KeepBake(ImFontAtlas*, ImFontBaked* baked, const ToastGlyphBatch&, bool, const BgmGlyphCacheView&)
+{
+    return baked; // The scale never changes here
+}
+
+struct ToastContext {
+    ToastContext()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.IniFilename = nullptr;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        g_pToastFont = AddToastFonts(io.Fonts);
+        g_toastBakedSize = TOAST_FONT_SIZE;
+    }
+    ~ToastContext()
+    {
+        ImGui::DestroyContext();
+        g_pToastFont = nullptr;
+    }
+};
+
+// Glyph surface and atlas texture with all of `pool` baked in.
+void MeasureAllResident(const std::vector<uint32_t>& pool, uint64_t* outSurface, ImVec2* outTexture)
+{
+    ToastContext context;
+    ImGui::NewFrame();
+    ImFontBaked* baked = GetToastBaked();
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    *outSurface = 0;
+    for (uint32_t codepoint : pool)
+    {
+        ImFontGlyph* glyph = baked->FindGlyphNoFallback((ImWchar)codepoint);
+        if (glyph && glyph->PackId != ImFontAtlasRectId_Invalid) {
+            const ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph->PackId);
+            *outSurface += (uint64_t)r->w * r->h;
+        }
+    }
+    *outTexture = ImVec2((float)atlas->TexData->Width, (float)atlas->TexData->Height);
+    ImGui::EndFrame();
+}
+
+double Percentile(std::vector<double> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[std::min(values.size() - 1, (size_t)(p * (double)values.size()))];
+}
+
+void RunPage(const BgmBench& bench, const std::vector<std::string>& titles, uint32_t pageSize)
+{
+    ToastContext context;
+    SetToastGlyphPageSize(pageSize);
+    ResetToastGlyphLru(GetToastBaked(), BgmGlyphCacheView());
+
+    std::mt19937 rng(15);
+    size_t toasts = bench.Iterations(2000);
+    std::vector<double> latencies;
+    std::vector<double> frameCosts;
+    size_t frames = 0;
+    for (size_t t = 0; t < toasts; ++t)
+    {
+        const char* title = titles[rng() % titles.size()].c_str();
+        auto requested = std::chrono::steady_clock::now();
+        for (bool shown = false; !shown; ++frames)
+        {
+            auto start = std::chrono::steady_clock::now();
+            IngestToastGlyphs(KeepBake);
+            std::chrono::steady_clock::duration cost = std::chrono::steady_clock::now() - start;
+
+            ImGui::NewFrame();
+            start = std::chrono::steady_clock::now();
+            PushToastFont();
+            ImFontBaked* baked = ImGui::GetFontBaked();
+            if (!RequestToastGlyphs(baked, title)) {
+                BgmBenchKeep((uint64_t)ImGui::CalcTextSize(title).x);
+                TouchToastGlyphs(baked, title);
+                latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - requested).count());
+                shown = true;
+            }
+            ImGui::PopFont();
+            cost += std::chrono::steady_clock::now() - start;
+            frameCosts.push_back(std::chrono::duration<double, std::micro>(cost).count());
+            ImGui::Render();
+            if (!shown)
+                std::this_thread::yield(); // A real frame is ~7 ms at 144 Hz; don't starve the rasterizer
+        }
+    }
+
+    const BgmGlyphLru& lru = GetToastGlyphLru();
+    const BgmGlyphLruStats& stats = lru.GetStats();
+    ImTextureData* texture = ImGui::GetIO().Fonts->TexData;
+    double meanCost = 0.0;
+    for (double cost : frameCosts)
+        meanCost += cost / (double)frameCosts.size();
+    std::printf("%4u %6zu %7zu %9.1f %9.1f %9.1f %8.2f %8.1f %7zu %9llu %9llu %9llu %6dx%-5d\n", pageSize, toasts, frames,
+        Percentile(latencies, 0.5), Percentile(latencies, 0.99), Percentile(latencies, 1.0), meanCost,
+        Percentile(frameCosts, 1.0), lru.GetCount(), (unsigned long long)lru.GetArea(), (unsigned long long)lru.GetBudget(),
+        (unsigned long long)stats.evictions, texture->Width, texture->Height);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmOnDemandGlyphBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    bool fallback = std::filesystem::exists(FALLBACK_FONT);
+    if (fallback)
+        std::filesystem::copy_file(FALLBACK_FONT, assets + "/mod_font_cjk.otf");
+    g_bToastSdf = false;
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    std::vector<uint32_t> pool;
+    {
+        ToastContext context;
+        for (uint32_t codepoint = TOAST_ON_DEMAND_CODEPOINT_MIN; codepoint <= IM_UNICODE_CODEPOINT_MAX; ++codepoint)
+            if (IsToastGlyphOnDemand(codepoint) && g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+                pool.push_back(codepoint);
+    }
+    std::shuffle(pool.begin(), pool.end(), std::mt19937(3)); // Zipf ranks across scripts, not by codepoint
+    std::vector<std::string> titles = MakeTitles(pool);
+
+    uint64_t allSurface = 0;
+    ImVec2 allTexture;
+    MeasureAllResident(pool, &allSurface, &allTexture);
+
+    std::printf("On-demand glyphs, %zu titles over %zu codepoints (mod_font.otf%s, %.0f px bitmaps)\n", titles.size(),
+        pool.size(), fallback ? " + DejaVu Sans" : "", TOAST_FONT_SIZE);
+    std::printf("All resident: %llu px of glyphs, atlas %.0fx%.0f (%.1f MiB RGBA32)\n", (unsigned long long)allSurface,
+        allTexture.x, allTexture.y, allTexture.x * allTexture.y * 4.0 / (1024.0 * 1024.0));
+    std::printf("%4s %6s %7s %9s %9s %9s %8s %8s %7s %9s %9s %9s %12s\n", "page", "toasts", "frames", "p50 us", "p99 us",
+        "max us", "frame us", "max us", "glyphs", "area px", "budget", "evicted", "atlas");
+    RunPage(bench, titles, 512);
+    RunPage(bench, titles, 256);
+
+    StopToastGlyphRasterizer();
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Cycles per ClassifyPath call over a trace of Ys VIII asset paths, against
+// the scalar loop and the original Detour_CreateFileW test (wcslen, then
+// towlower on the last four units). Built twice: with the compiler's default
+// SSE2 and with -mavx2 (PathClassifierAvx2Bench).
+
+#include <cwctype>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+using BgmPathClassifierDetail::ClassifyScalar;
+
+static uint64_t ReadCycles()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// The original W detour's test, on 16-bit units like Windows' WCHAR.
+static bool BaselineIsOgg(const char16_t* path)
+{
+    size_t length = std::char_traits<char16_t>::length(path);
+    return length > 4 && path[length - 4] == u'.' && std::towlower(path[length - 3]) == L'o' &&
+        std::towlower(path[length - 2]) == L'g' && std::towlower(path[length - 1]) == L'g';
+}
+
+template <typename CharT, typename Classify>
+static double CyclesPerCall(const BgmBench& bench, const std::vector<std::basic_string<CharT>>& paths, Classify&& classify)
+{
+    size_t rounds = bench.Iterations(200);
+    double best = 0.0;
+    for (int run = 0; run < (bench.quick ? 1 : 5); ++run)
+    {
+        uint64_t sum = 0;
+        uint64_t start = ReadCycles();
+        for (size_t round = 0; round < rounds; ++round)
+            for (const std::basic_string<CharT>& path : paths)
+                sum += classify(path.c_str());
+        double cycles = (double)(ReadCycles() - start) / (double)(rounds * paths.size());
+        BgmBenchKeep(sum);
+        if (run == 0 || cycles < best) best = cycles;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+#if defined(BGM_CLASSIFIER_AVX2)
+    const char* vectorName = "AVX2";
+#if defined(__GNUC__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("This CPU has no AVX2; skipped.\n");
+        return 0;
+    }
+#endif
+#elif defined(BGM_CLASSIFIER_SSE2)
+    const char* vectorName = "SSE2";
+#else
+    const char* vectorName = "scalar";
+#endif
+
+    // One BGM track in ~50 opens, as in a map transition with voiced dialogue
+    BgmTestTrace trace = MakeBgmTestTrace(GetBgmTestKeys(LoadShippedBgmMap()), 1500, 1500);
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < 1500; ++i) {
+        paths.push_back(trace.oggMisses[i]);
+        paths.push_back(trace.otherFiles[i]);
+        if (i % 25 == 0)
+            paths.push_back(trace.bgmHits[i / 25 % trace.bgmHits.size()]);
+    }
+    std::vector<std::u16string> widePaths;
+    size_t totalUnits = 0;
+    for (const std::string& path : paths) {
+        widePaths.emplace_back(path.begin(), path.end());
+        totalUnits += path.size();
+    }
+
+    auto info = [](BgmPathInfo i) { return i.length + i.basenameOffset + i.isOgg; };
+    std::printf("ClassifyPath, cycles/call over %zu paths (avg %zu units)\n", paths.size(), totalUnits / paths.size());
+    std::printf("%-8s %12s %10s %10s\n", "", "wcslen+tow", "scalar", vectorName);
+    std::printf("%-8s %12s %10.1f %10.1f\n", "UTF-8", "-",
+        CyclesPerCall(bench, paths, [&](const char* p) { return info(ClassifyScalar(p)); }),
+        CyclesPerCall(bench, paths, [&](const char* p) { return info(ClassifyPath(p)); }));
+    std::printf("%-8s %12.1f %10.1f %10.1f\n", "UTF-16",
+        CyclesPerCall(bench, widePaths, [](const char16_t* p) { return (size_t)BaselineIsOgg(p); }),
+        CyclesPerCall(bench, widePaths, [&](const char16_t* p) { return info(ClassifyScalar(p)); }),
+        CyclesPerCall(bench, widePaths, [&](const char16_t* p) { return info(ClassifyPath(p)); }));
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Distance-field glyphs vs. coverage, through the DLL's ToastGlyphLoader.cpp
+// and ToastGlyphRasterizer.cpp:
+//
+// - bake time: BakeToastGlyphs on one thread, as coverage and as fields;
+//   the fields split into N slices on N threads (what the rasterizer thread
+//   and its helpers do with a large batch, one slice per spare core); and a
+//   whole rebake sent to the real rasterizer thread, from SendToastGlyphBatch
+//   until IngestToastGlyphs hands it back;
+// - atlas memory: the glyph surface and the ImGui atlas texture with every
+//   glyph baked, for fields at TOAST_FONT_SIZE (which serve draw
+//   sizes up to TOAST_SDF_MAX_MAGNIFICATION times that) and for coverage at
+//   TOAST_FONT_SIZE and at the largest size those fields serve, which bitmaps
+//   have to be rebaked at to draw there.
+//
+// Every glyph of mod_font.otf; then, for bake times, the on-demand pool of
+// DejaVu Sans merged in as mod_font_cjk.otf, if it is installed (no CJK font
+// is). Slicing only pays off with cores to spare; the core count is printed.
+
+#include <filesystem>
+#include <thread>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphLoader.h"
+#include "ToastGlyphRasterizer.h"
+
+namespace {
+
+constexpr const char* FALLBACK_FONT = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+
+struct ToastContext {
+    explicit ToastContext(bool sdf)
+    {
+        g_bToastSdf = sdf;
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.IniFilename = nullptr;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        g_pToastFont = AddToastFonts(io.Fonts);
+        g_toastBakedSize = TOAST_FONT_SIZE;
+    }
+    ~ToastContext()
+    {
+        ImGui::DestroyContext();
+        g_pToastFont = nullptr;
+    }
+};
+
+// Fields split into `slices` on as many threads, every Nth codepoint each.
+void BakeSliced(const std::vector<uint32_t>& codepoints, size_t slices)
+{
+    std::vector<std::thread> threads;
+    std::vector<size_t> counts(slices);
+    for (size_t slice = 0; slice < slices; ++slice)
+        threads.emplace_back([&, slice] {
+            std::vector<uint32_t> mine;
+            for (size_t i = slice; i < codepoints.size(); i += slices)
+                mine.push_back(codepoints[i]);
+            std::vector<BgmCachedGlyph> glyphs;
+            std::vector<uint8_t> pixels;
+            counts[slice] = BakeToastGlyphs(mine, TOAST_FONT_SIZE, true, &glyphs, &pixels);
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (size_t count : counts)
+        BgmBenchKeep(count);
+}
+
+size_t g_rebakeGlyphs = 0;
+bool g_bRebakeArrived = false;
+
+ImFontBaked* CountRebake(ImFontAtlas*, ImFontBaked* baked, const ToastGlyphBatch&, bool valid, const BgmGlyphCacheView& view)
+{
+    g_rebakeGlyphs = valid ? view.glyphCount : 0;
+    g_bRebakeArrived = true;
+    return baked; // Not swapped in: only the time to get it back is measured
+}
+
+void RunBakeTimes(const BgmBench& bench, const char* name, const std::vector<uint32_t>& codepoints)
+{
+    auto bake = [&](bool sdf) {
+        std::vector<BgmCachedGlyph> glyphs;
+        std::vector<uint8_t> pixels;
+        BgmBenchKeep(BakeToastGlyphs(codepoints, TOAST_FONT_SIZE, sdf, &glyphs, &pixels));
+    };
+    double coverageUs = bench.Microseconds([&] { bake(false); });
+    double sdfUs = bench.Microseconds([&] { bake(true); });
+
+    double rasterizerUs;
+    {
+        ToastContext context(true);
+        rasterizerUs = bench.Microseconds([&] {
+            g_bRebakeArrived = false;
+            SendToastGlyphBatch(TOAST_FONT_SIZE, codepoints, ToastGlyphBatchKind::Rebake);
+            while (!g_bRebakeArrived)
+            {
+                IngestToastGlyphs(CountRebake);
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::printf("%-22s %6zu %11.0f %11.0f %7.1fx", name, codepoints.size(), coverageUs, sdfUs, coverageUs > 0.0 ? sdfUs / coverageUs : 0.0);
+    for (size_t slices : { 2, 4, 8 })
+        std::printf(" %11.0f", bench.Microseconds([&] { BakeSliced(codepoints, slices); }));
+    std::printf(" %11.0f %s\n", rasterizerUs, g_rebakeGlyphs == codepoints.size() ? "" : "(INCOMPLETE)");
+}
+
+// Glyph surface and atlas texture with every one of `codepoints` baked at `size`.
+void RunAtlasMemory(const char* name, const std::vector<uint32_t>& codepoints, float size, bool sdf)
+{
+    ToastContext context(sdf);
+    g_pToastFont->Flags &= ~ImFontFlags_LockBakedSizes; // NewFrame bakes TOAST_FONT_SIZE; measure `size` alone
+    ImGui::NewFrame();
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFontBaked* baked = g_pToastFont->GetFontBaked(size);
+    uint64_t surface = 0;
+    for (uint32_t codepoint : codepoints)
+    {
+        ImFontGlyph* glyph = baked->FindGlyphNoFallback((ImWchar)codepoint);
+        if (glyph && glyph->PackId != ImFontAtlasRectId_Invalid) {
+            const ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph->PackId);
+            surface += (uint64_t)r->w * r->h;
+        }
+    }
+    ImTextureData* texture = atlas->TexData;
+    std::printf("%-34s %5.0f %10llu %6dx%-5d %8.2f\n", name, size, (unsigned long long)surface, texture->Width,
+        texture->Height, texture->Width * texture->Height * 4.0 / (1024.0 * 1024.0));
+    ImGui::EndFrame();
+}
+
+// Every codepoint the toast font has, or only its on-demand ones.
+std::vector<uint32_t> GetFontCodepoints(bool onDemandOnly)
+{
+    ToastContext context(true);
+    std::vector<uint32_t> codepoints;
+    for (uint32_t codepoint = 0x20; codepoint <= IM_UNICODE_CODEPOINT_MAX; ++codepoint)
+        if (g_pToastFont->IsGlyphInFont((ImWchar)codepoint) && (!onDemandOnly || IsToastGlyphOnDemand(codepoint)))
+            codepoints.push_back(codepoint);
+    return codepoints;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmSdfBakeBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+    std::vector<uint32_t> modFont = GetFontCodepoints(false);
+
+    std::printf("Toast glyph bake, us (%.0f px, %u core(s))\n", TOAST_FONT_SIZE, std::thread::hardware_concurrency());
+    std::printf("%-22s %6s %11s %11s %8s %11s %11s %11s %11s\n", "set", "glyphs", "coverage", "sdf", "cost", "sdf 2 thr",
+        "sdf 4 thr", "sdf 8 thr", "rasterizer");
+    RunBakeTimes(bench, "mod_font.otf", modFont);
+
+    // The CJK-sized case, as far as an installed font allows
+    if (std::filesystem::exists(FALLBACK_FONT)) {
+        std::filesystem::copy_file(FALLBACK_FONT, assets + "/mod_font_cjk.otf");
+        if (LoadToastFontFiles())
+            RunBakeTimes(bench, "on-demand (DejaVu)", GetFontCodepoints(true));
+    }
+    StopToastGlyphRasterizer();
+
+    float largest = TOAST_FONT_SIZE * TOAST_SDF_MAX_MAGNIFICATION;
+    std::printf("\nAtlas memory, mod_font.otf's %zu glyphs (RGBA32 texture, ImGui's default)\n", modFont.size());
+    std::printf("%-34s %5s %10s %12s %8s\n", "bake", "px", "glyph px", "atlas", "MiB");
+    RunAtlasMemory("coverage (one draw size)", modFont, TOAST_FONT_SIZE, false);
+    RunAtlasMemory("coverage (largest size sdf serves)", modFont, largest, false);
+    RunAtlasMemory("sdf (serves both)", modFont, TOAST_FONT_SIZE, true);
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return 0;
+}
@@ -0,0 +1,167 @@
+// The toast font's atlas as the DLL builds it vs. the one InitImGui used to,
+// headless, mod_font.otf at 28 px:
+//
+// - default ranges: AddFontFromMemoryTTF with ImGui's default glyph ranges
+//   and a static Build(), what ImGui 1.92 still does for a backend without
+//   RendererHasTextures and what the DLL did before the prewarm;
+// - title subset: AddToastFonts and one FindGlyph per codepoint of the
+//   shipped map's titles plus "Disc, Track 0-9", as PrewarmToastGlyphs bakes
+//   them, as bitmaps and as distance fields.
+//
+// Per set: glyphs baked, the atlas texture, the time from a new ImGui context
+// to the baked atlas, and how much the process's resident memory grew. Each
+// set runs in a child process, so its RSS is not hidden by pages an earlier
+// set already faulted in.
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "BgmTrackStore.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+
+namespace {
+
+constexpr const char* TOAST_FIXED_GLYPHS = "Disc, Track 0123456789"; // main.cpp's second toast line
+
+struct AtlasResult {
+    int glyphs = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Resident set size in KB, from /proc/self/statm.
+long GetResidentKb()
+{
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+ImGuiIO& CreateHeadlessContext(bool rendererHasTextures)
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.IniFilename = nullptr;
+    if (rendererHasTextures)
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+    return io;
+}
+
+AtlasResult ReadAtlas(ImFontAtlas* atlas, ImFontBaked* baked)
+{
+    AtlasResult result;
+    result.glyphs = baked ? baked->Glyphs.Size : 0;
+    result.width = atlas->TexData->Width;
+    result.height = atlas->TexData->Height;
+    return result;
+}
+
+AtlasResult BuildDefaultRanges()
+{
+    ImGuiIO& io = CreateHeadlessContext(false);
+    ImFontConfig config;
+    config.FontDataOwnedByAtlas = false;
+    ImFont* font = io.Fonts->AddFontFromMemoryTTF(g_toastFontData.data(), (int)g_toastFontData.size(), TOAST_FONT_SIZE,
+        &config, io.Fonts->GetGlyphRangesDefault());
+    io.Fonts->Build();
+    return ReadAtlas(io.Fonts, font ? font->GetFontBaked(TOAST_FONT_SIZE) : nullptr);
+}
+
+AtlasResult BuildTitleSubset(const std::vector<uint32_t>& codepoints, bool sdf)
+{
+    g_bToastSdf = sdf;
+    ImGuiIO& io = CreateHeadlessContext(true);
+    g_pToastFont = AddToastFonts(io.Fonts);
+    ImGui::NewFrame();
+    g_toastBakedSize = TOAST_FONT_SIZE;
+    ImFontBaked* baked = g_pToastFont ? GetToastBaked() : nullptr;
+    if (baked)
+        for (uint32_t codepoint : codepoints)
+            if (codepoint <= IM_UNICODE_CODEPOINT_MAX && !IsToastGlyphOnDemand(codepoint))
+                baked->FindGlyph((ImWchar)codepoint);
+    AtlasResult result = ReadAtlas(io.Fonts, baked);
+    ImGui::EndFrame();
+    return result;
+}
+
+void DestroyContext()
+{
+    ImGui::DestroyContext();
+    g_pToastFont = nullptr;
+}
+
+// Runs `build` once for the RSS and then for the best time, in a child
+// process that prints the row. False if the child failed.
+template <typename Build>
+bool RunSet(const BgmBench& bench, const char* name, Build&& build)
+{
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        long before = GetResidentKb();
+        AtlasResult result = build();
+        long grownKb = GetResidentKb() - before;
+        DestroyContext();
+
+        double best = 0.0;
+        for (int run = 0; run < (bench.quick ? 1 : 7); ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            build();
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            DestroyContext();
+            if (run == 0 || us < best) best = us;
+        }
+
+        size_t textureKb = (size_t)result.width * result.height * 4 / 1024;
+        std::printf("%-22s %6d %5dx%-5d %9zu %10.0f %8ld\n", name, result.glyphs, result.width, result.height,
+            textureKb, best, grownKb);
+        std::fflush(stdout);
+        _exit(result.glyphs > 0 ? 0 : 1);
+    }
+    int status = 0;
+    return child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmToastAtlasBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    BgmTrackStore store;
+    for (const BgmTestEntry& entry : LoadShippedBgmMap())
+        store.Add(entry.key, entry.title, entry.disc, entry.track);
+    std::vector<uint32_t> titles = CollectBgmTitleCodepoints(store, TOAST_FIXED_GLYPHS);
+
+    std::printf("Toast font atlas (ImGui %s, mod_font.otf at %.0f px, shipped map: %zu codepoints)\n", IMGUI_VERSION,
+        TOAST_FONT_SIZE, titles.size());
+    std::printf("%-22s %6s %11s %9s %10s %8s\n", "set", "glyphs", "atlas", "KB", "build us", "RSS KB");
+    bool ok = RunSet(bench, "default ranges", [] { return BuildDefaultRanges(); });
+    ok &= RunSet(bench, "title subset", [&] { return BuildTitleSubset(titles, false); });
+    ok &= RunSet(bench, "title subset (sdf)", [&] { return BuildTitleSubset(titles, true); });
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return ok ? 0 : 1;
+}
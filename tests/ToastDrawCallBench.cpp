@@ -0,0 +1,195 @@
+// Draw calls and state changes of a toast frame, counted in the headless
+// ImDrawData that ImGui_ImplDX11_RenderDrawData would submit, through the
+// DLL's ToastGeometry.cpp and ToastIcons.cpp:
+//
+// - separate icon: bgm_info.dds as its own texture, as it was before the
+//   icons were packed: an AddImage of another texture ahead of the retained
+//   geometry, which then has no atlas icon;
+// - packed icon: AddToastIcons puts it in the font atlas, and the retained
+//   geometry draws icon, box and text from the one texture.
+//
+// Each as bitmap and distance-field text (whose SetToastSdfShader and
+// ImDrawCallback_ResetRenderState callbacks swap the pixel shader, the second
+// also rebinding the backend's whole state). Also the frame's CPU time and the
+// atlas texture the packing grows. The icon has bgm_info.dds's size; its
+// pixels are a placeholder (DirectXTex decodes the BC7 on Windows only).
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGeometry.h"
+#include "ToastIcons.h"
+#include "ToastSdfShader.h"
+
+namespace {
+
+constexpr const char* TITLE = "Lacrimosa of Dana -Opening Ver.-";
+constexpr const char* LINE2 = "Disc 1, Track 1";
+constexpr const char* KEY = "bgm\\y8_b006.ogg";
+constexpr float DISPLAY_WIDTH = 1920.0f;
+constexpr float DISPLAY_HEIGHT = 1080.0f;
+const ImTextureRef SEPARATE_ICON_TEXTURE((ImTextureID)0x1C0); // What g_pToastTexture's view was
+
+bool g_bPackIcons = false;
+
+} // namespace
+
+// The bench never binds a pixel shader; only the callback's identity matters.
+void SetToastSdfShader(const ImDrawList*, const ImDrawCmd*) {}
+
+// The DDS header's size, with opaque white pixels.
+bool LoadToastIconImage(const std::string& path, ToastIconImage* out)
+{
+    std::ifstream file(path, std::ios::binary);
+    char header[20];
+    if (!g_bPackIcons || !file.read(header, sizeof(header)) || std::memcmp(header, "DDS ", 4) != 0)
+        return false;
+    uint32_t height, width;
+    std::memcpy(&height, header + 12, 4);
+    std::memcpy(&width, header + 16, 4);
+    out->width = (int)width;
+    out->height = (int)height;
+    out->pitch = (size_t)width * 4;
+    out->pixels.assign(out->pitch * height, 0xFF);
+    return true;
+}
+
+namespace {
+
+struct DrawStats {
+    int drawCalls = 0;
+    int textureChanges = 0; // Draw calls with another texture than the one before
+    int callbacks = 0;      // Pixel shader swaps and render state resets
+    int vertices = 0;
+};
+
+DrawStats CountDrawData(const ImDrawData* drawData)
+{
+    DrawStats stats;
+    ImTextureRef bound;
+    bool anyBound = false;
+    for (const ImDrawList* list : drawData->CmdLists)
+    {
+        stats.vertices += list->VtxBuffer.Size;
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            if (cmd.UserCallback) {
+                ++stats.callbacks;
+                continue;
+            }
+            if (cmd.ElemCount == 0)
+                continue;
+            ++stats.drawCalls;
+            if (!anyBound || cmd.TexRef._TexData != bound._TexData || cmd.TexRef._TexID != bound._TexID)
+                ++stats.textureChanges;
+            bound = cmd.TexRef;
+            anyBound = true;
+        }
+    }
+    return stats;
+}
+
+// GetToastLayout's measurements for one track, without the map snapshot.
+ToastLayout MakeLayout()
+{
+    ToastLayout layout;
+    layout.track = 1;
+    layout.screenWidth = DISPLAY_WIDTH;
+    layout.scale = 1.0f;
+    layout.bakedSize = g_toastBakedSize;
+    layout.title = TITLE;
+    std::strcpy(layout.line2, LINE2);
+    PushToastFont();
+    ImVec2 size_line1 = ImGui::CalcTextSize(layout.title);
+    ImVec2 size_line2 = ImGui::CalcTextSize(layout.line2);
+    ImGui::PopFont();
+    layout.lineHeight = size_line1.y;
+    layout.totalHeight = layout.lineHeight * 2.2f + TOAST_TEXT_PADDING_Y * 2.0f;
+    layout.noteIconWidth = layout.totalHeight;
+    layout.boxWidth = std::max(size_line1.x, size_line2.x) + TOAST_TEXT_PADDING_X * 2.0f;
+    layout.textStartOffsetY = (layout.totalHeight - layout.lineHeight * 2.0f) * 0.5f;
+    layout.icon = GetToastIcon(KEY);
+    layout.targetOnscreenX = DISPLAY_WIDTH - layout.noteIconWidth - layout.boxWidth - TOAST_SCREEN_PADDING;
+    return layout;
+}
+
+// My_Present's toast frame: the geometry, shifted on screen, then Render.
+void RunFrame(const ToastLayout& layout, bool packed)
+{
+    ImGui::NewFrame();
+    ImDrawList* drawList = ImGui::GetBackgroundDrawList();
+    float x = layout.targetOnscreenX;
+    float top = TOAST_SCREEN_PADDING * layout.scale;
+    if (!packed)
+        drawList->AddImage(SEPARATE_ICON_TEXTURE, ImVec2(x, top), ImVec2(x + layout.noteIconWidth, top + layout.totalHeight));
+    DrawToastGeometry(drawList, GetToastGeometry(layout, top), x);
+    ImGui::Render();
+}
+
+void RunCase(const BgmBench& bench, const char* name, bool sdf, bool packed)
+{
+    g_bToastSdf = sdf;
+    g_bPackIcons = packed;
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    io.IniFilename = nullptr;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+    g_pToastFont = AddToastFonts(io.Fonts);
+    g_toastBakedSize = TOAST_FONT_SIZE;
+    g_toastFontSize = TOAST_FONT_SIZE;
+    AddToastIcons(io.Fonts);
+
+    RunFrame(MakeLayout(), packed); // Bakes the glyphs
+    ToastLayout layout = MakeLayout();
+    RunFrame(layout, packed);
+    DrawStats stats = CountDrawData(ImGui::GetDrawData());
+    double us = bench.Microseconds([&] {
+        for (int i = 0; i < 100; ++i)
+            RunFrame(layout, packed);
+    }) / 100.0;
+
+    ImTextureData* texture = io.Fonts->TexData;
+    std::printf("%-10s %-14s %10d %15d %10d %9d %9.1f %6dx%-5d\n", name, packed ? "packed" : "separate", stats.drawCalls,
+        stats.textureChanges, stats.callbacks, stats.vertices, us, texture->Width, texture->Height);
+
+    ImGui::DestroyContext();
+    g_pToastFont = nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmToastDrawCallBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    std::filesystem::copy_file(GetBgmTestPath("bgm_info.dds"), assets + "/bgm_info.dds");
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    std::printf("One toast frame's ImDrawData at %.0fx%.0f (\"%s\"; a battle track, which draws the note icon)\n",
+        DISPLAY_WIDTH, DISPLAY_HEIGHT, TITLE);
+    std::printf("%-10s %-14s %10s %15s %10s %9s %9s %12s\n", "text", "icon", "draw calls", "texture changes",
+        "callbacks", "vertices", "frame us", "atlas");
+    for (bool sdf : { false, true })
+    {
+        RunCase(bench, sdf ? "sdf" : "bitmap", sdf, false);
+        RunCase(bench, sdf ? "sdf" : "bitmap", sdf, true);
+    }
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return 0;
+}
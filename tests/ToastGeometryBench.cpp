@@ -0,0 +1,202 @@
+// Per-frame vertex generation for a shown toast, through the DLL's
+// ToastGeometry.cpp, headless:
+//
+// - immediate: AddImage, AddRectFilled and both AddText lines at the slide
+//   X, every frame, as My_Present drew the toast before it was retained;
+// - retained: DrawToastGeometry appending GetToastGeometry's cached
+//   vertices and indices shifted along X, what every frame of a toast does;
+// - rebuild: GetToastGeometry re-tessellating for a new layout, then the
+//   append, what the first frame after a trigger does.
+//
+// Each frame draws into a reset ImDrawList, so only the generation is timed,
+// not NewFrame or Render. mod_font.otf at 28 px as bitmaps, with a 64x64
+// icon in the atlas. The retained output is checked against the immediate
+// one, vertex for vertex.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGeometry.h"
+#include "ToastIcons.h"
+#include "ToastSdfShader.h"
+
+namespace {
+
+constexpr const char* TITLE = "Lacrimosa of Dana -Opening Ver.-";
+constexpr const char* LINE2 = "Disc 1, Track 1";
+constexpr float DISPLAY_WIDTH = 1920.0f;
+constexpr float DISPLAY_HEIGHT = 1080.0f;
+
+} // namespace
+
+// The text is drawn as bitmaps; the shader callback never runs.
+void SetToastSdfShader(const ImDrawList*, const ImDrawCmd*) {}
+
+// A white 64x64 icon for every category.
+bool LoadToastIconImage(const std::string&, ToastIconImage* out)
+{
+    out->width = 64;
+    out->height = 64;
+    out->pitch = 64 * 4;
+    out->pixels.assign(out->pitch * 64, 0xFF);
+    return true;
+}
+
+namespace {
+
+// GetToastLayout's measurements for one track, without the map snapshot.
+ToastLayout MakeLayout()
+{
+    ToastLayout layout;
+    layout.track = 1;
+    layout.screenWidth = DISPLAY_WIDTH;
+    layout.scale = 1.0f;
+    layout.bakedSize = g_toastBakedSize;
+    layout.title = TITLE;
+    std::strcpy(layout.line2, LINE2);
+    PushToastFont();
+    ImVec2 size_line1 = ImGui::CalcTextSize(layout.title);
+    ImVec2 size_line2 = ImGui::CalcTextSize(layout.line2);
+    ImGui::PopFont();
+    layout.lineHeight = size_line1.y;
+    layout.totalHeight = layout.lineHeight * 2.2f + TOAST_TEXT_PADDING_Y * 2.0f;
+    layout.noteIconWidth = layout.totalHeight;
+    layout.boxWidth = std::max(size_line1.x, size_line2.x) + TOAST_TEXT_PADDING_X * 2.0f;
+    layout.textStartOffsetY = (layout.totalHeight - layout.lineHeight * 2.0f) * 0.5f;
+    layout.icon = ToastIcon::Battle;
+    layout.targetOnscreenX = DISPLAY_WIDTH - layout.noteIconWidth - layout.boxWidth - TOAST_SCREEN_PADDING;
+    return layout;
+}
+
+// The toast as My_Present tessellated it every frame, at x.
+void DrawImmediate(ImDrawList* drawList, const ToastLayout& layout, float top, float x)
+{
+    ImVec2 noteStart(x, top);
+    ImVec2 noteEnd(x + layout.noteIconWidth, top + layout.totalHeight);
+    ImVec2 boxStart(noteEnd.x, top);
+    ImVec2 boxEnd(boxStart.x + layout.boxWidth, top + layout.totalHeight);
+    float textY = top + layout.textStartOffsetY;
+
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFontAtlasRect icon;
+    if (GetToastIconRect(atlas, layout.icon, &icon))
+        drawList->AddImage(atlas->TexRef, noteStart, noteEnd, icon.uv0, icon.uv1);
+    drawList->AddRectFilled(boxStart, boxEnd, IM_COL32(0, 0, 0, 100), TOAST_ROUNDING * layout.scale);
+
+    PushToastFont();
+    float textX = boxStart.x + TOAST_TEXT_PADDING_X * layout.scale;
+    drawList->AddText(ImVec2(textX, textY), IM_COL32_WHITE, layout.title);
+    drawList->AddText(ImVec2(textX, textY + layout.lineHeight), IM_COL32(180, 180, 180, 255), layout.line2);
+    ImGui::PopFont();
+}
+
+// A background list as NewFrame leaves it.
+void ResetList(ImDrawList* drawList)
+{
+    drawList->_ResetForNewFrame();
+    drawList->PushTexture(ImGui::GetIO().Fonts->TexRef);
+    drawList->PushClipRect(ImVec2(0.0f, 0.0f), ImVec2(DISPLAY_WIDTH, DISPLAY_HEIGHT));
+}
+
+// Same indices, UVs and colours, positions within `epsilon`.
+bool SameVertices(const ImDrawList& a, const ImDrawList& b, float epsilon)
+{
+    if (a.VtxBuffer.Size != b.VtxBuffer.Size || a.IdxBuffer.Size != b.IdxBuffer.Size)
+        return false;
+    if (std::memcmp(a.IdxBuffer.Data, b.IdxBuffer.Data, a.IdxBuffer.size_in_bytes()) != 0)
+        return false;
+    for (int i = 0; i < a.VtxBuffer.Size; ++i)
+    {
+        const ImDrawVert& va = a.VtxBuffer[i];
+        const ImDrawVert& vb = b.VtxBuffer[i];
+        if (std::fabs(va.pos.x - vb.pos.x) > epsilon || std::fabs(va.pos.y - vb.pos.y) > epsilon ||
+            va.uv.x != vb.uv.x || va.uv.y != vb.uv.y || va.col != vb.col)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmToastGeometryBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    g_bToastSdf = false;
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    io.IniFilename = nullptr;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+    g_pToastFont = AddToastFonts(io.Fonts);
+    g_toastBakedSize = TOAST_FONT_SIZE;
+    g_toastFontSize = TOAST_FONT_SIZE;
+    AddToastIcons(io.Fonts);
+    ImGui::NewFrame();
+
+    bool same = false;
+    {
+        ToastLayout layout = MakeLayout();
+        float top = TOAST_SCREEN_PADDING;
+        float x = std::floor(layout.targetOnscreenX); // AddText snaps to whole pixels; a shifted copy keeps the fraction
+        GetToastGeometry(layout, top); // Bakes the glyphs
+
+        ImDrawList immediate(ImGui::GetDrawListSharedData()), retained(ImGui::GetDrawListSharedData());
+        ResetList(&immediate);
+        DrawImmediate(&immediate, layout, top, x);
+        ResetList(&retained);
+        DrawToastGeometry(&retained, GetToastGeometry(layout, top), x);
+        same = SameVertices(immediate, retained, 0.001f);
+
+        // Slide positions that keep the whole toast on screen, so neither
+        // path culls glyphs
+        size_t frames = bench.Iterations(200000);
+        auto slide = [&](size_t i) { return x - (float)(i % 100); };
+        ImDrawList list(ImGui::GetDrawListSharedData());
+        double immediateNs = bench.NsPerCall(frames, [&](size_t i) {
+            ResetList(&list);
+            DrawImmediate(&list, layout, top, slide(i));
+        });
+        double retainedNs = bench.NsPerCall(frames, [&](size_t i) {
+            ResetList(&list);
+            DrawToastGeometry(&list, GetToastGeometry(layout, top), slide(i));
+        });
+        ToastLayout other = layout;
+        other.track = 2;
+        double rebuildNs = bench.NsPerCall(frames / 10, [&](size_t i) {
+            ResetList(&list);
+            DrawToastGeometry(&list, GetToastGeometry(i % 2 ? other : layout, top), slide(i));
+        });
+
+        std::printf("Toast vertex generation per frame (ImGui %s core, mod_font.otf at %.0f px, \"%s\")\n",
+            IMGUI_VERSION, TOAST_FONT_SIZE, TITLE);
+        std::printf("%d vertices, %d indices, %d batch(es); retained output %s the immediate one\n",
+            retained.VtxBuffer.Size, retained.IdxBuffer.Size, GetToastGeometry(layout, top).batches.Size,
+            same ? "matches" : "DIFFERS FROM");
+        std::printf("%-24s %12.1f ns\n", "immediate", immediateNs);
+        std::printf("%-24s %12.1f ns\n", "retained", retainedNs);
+        std::printf("%-24s %12.1f ns\n", "retained, rebuild", rebuildNs);
+    }
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    g_pToastFont = nullptr;
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return same ? 0 : 1;
+}
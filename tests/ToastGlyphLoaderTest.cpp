@@ -0,0 +1,180 @@
+// ToastGlyphLoader.cpp: BakeToastGlyphs (the rasterizer thread's, no atlas)
+// bakes exactly what the toast font's ImFontLoader puts in an ImGui atlas,
+// metrics and pixels, as coverage and as distance fields; and its coverage is
+// exactly what ImGui's own stb_truetype loader renders. mod_font.otf, with
+// DejaVu Sans merged in as mod_font_cjk.otf if it is installed.
+
+#include <cstring>
+#include <filesystem>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphCache.h"
+#include "ToastGlyphLoader.h"
+
+namespace {
+
+constexpr const char* FALLBACK_FONT = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+constexpr float SIZES[] = { 14.0f, TOAST_FONT_SIZE, 44.0f }; // Oversampled twice, and not at all past 36 px
+
+bool LoadFonts()
+{
+    static bool s_loaded = [] {
+        std::string assets = MakeTempModDirectory("BgmToastGlyphLoaderTest");
+        std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+        if (std::filesystem::exists(FALLBACK_FONT))
+            std::filesystem::copy_file(FALLBACK_FONT, assets + "/mod_font_cjk.otf");
+        return LoadToastFontFiles();
+    }();
+    return s_loaded;
+}
+
+// A fresh ImGui context, mid-frame, with the toast font added as g_bToastSdf says.
+struct ToastFrame {
+    ToastFrame()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.IniFilename = nullptr;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        g_pToastFont = AddToastFonts(io.Fonts);
+        if (g_pToastFont)
+            g_pToastFont->Flags &= ~ImFontFlags_LockBakedSizes; // Bakes at every size asked
+        ImGui::NewFrame();
+    }
+    ~ToastFrame()
+    {
+        ImGui::EndFrame();
+        ImGui::DestroyContext();
+        g_pToastFont = nullptr;
+    }
+};
+
+// Latin and symbols, a CJK block (in the fallback, if at all) and a codepoint
+// neither file has; not the font's ellipsis, which ImGui may assemble out of dots.
+std::vector<uint32_t> GetCodepoints(const ImFont* font)
+{
+    std::vector<uint32_t> codepoints;
+    for (uint32_t codepoint = 0x20; codepoint < 0x2200; ++codepoint)
+        if (codepoint != font->EllipsisChar)
+            codepoints.push_back(codepoint);
+    for (uint32_t codepoint = 0x3000; codepoint < 0x3100; ++codepoint)
+        codepoints.push_back(codepoint);
+    codepoints.push_back(0xFFFF);
+    return codepoints;
+}
+
+struct GlyphSet {
+    std::vector<BgmCachedGlyph> glyphs;
+    std::vector<uint8_t> pixels;
+};
+
+// The glyphs of `font` (the toast font or another, in the current atlas).
+GlyphSet ReadAtlas(ImFont* font, float size, const std::vector<uint32_t>& codepoints)
+{
+    GlyphSet set;
+    ReadToastGlyphs(ImGui::GetIO().Fonts, font->GetFontBaked(size), codepoints, &set.glyphs, &set.pixels);
+    return set;
+}
+
+// Whether both sets have the same glyphs, bit for bit; reports the first difference.
+bool SameGlyphs(const GlyphSet& a, const GlyphSet& b)
+{
+    if (a.glyphs.size() != b.glyphs.size()) {
+        std::printf("  %zu glyphs vs %zu\n", a.glyphs.size(), b.glyphs.size());
+        return false;
+    }
+    for (size_t i = 0; i < a.glyphs.size(); ++i)
+    {
+        const BgmCachedGlyph& x = a.glyphs[i];
+        const BgmCachedGlyph& y = b.glyphs[i];
+        size_t bytes = (size_t)x.width * x.height;
+        if (std::memcmp(&x, &y, sizeof(BgmCachedGlyph)) != 0 ||
+            std::memcmp(&a.pixels[x.pixelOffset], &b.pixels[y.pixelOffset], bytes) != 0) {
+            std::printf("  U+%04X differs: %ux%u at (%g, %g), advance %g vs U+%04X %ux%u at (%g, %g), advance %g\n",
+                x.codepoint, x.width, x.height, x.x0, x.y0, x.advanceX, y.codepoint, y.width, y.height, y.x0, y.y0, y.advanceX);
+            return false;
+        }
+    }
+    return true;
+}
+
+void CheckBakeMatchesAtlas(bool sdf)
+{
+    BGM_REQUIRE(LoadFonts());
+    g_bToastSdf = sdf;
+    for (float size : SIZES)
+    {
+        ToastFrame frame;
+        BGM_REQUIRE(g_pToastFont);
+        std::vector<uint32_t> codepoints = GetCodepoints(g_pToastFont);
+        GlyphSet atlas = ReadAtlas(g_pToastFont, size, codepoints);
+
+        GlyphSet baked;
+        size_t count = BakeToastGlyphs(codepoints, size, sdf, &baked.glyphs, &baked.pixels);
+        BGM_CHECK(count == baked.glyphs.size());
+        BGM_CHECK(count > 300);
+        BGM_CHECK(SameGlyphs(atlas, baked));
+    }
+}
+
+} // namespace
+
+BGM_TEST(CoverageBakeMatchesTheAtlas)
+{
+    CheckBakeMatchesAtlas(false);
+}
+
+BGM_TEST(SdfBakeMatchesTheAtlas)
+{
+    CheckBakeMatchesAtlas(true);
+}
+
+BGM_TEST(CoverageMatchesImGuisLoader)
+{
+    BGM_REQUIRE(LoadFonts());
+    g_bToastSdf = false;
+    for (float size : SIZES)
+    {
+        ToastFrame frame;
+        BGM_REQUIRE(g_pToastFont);
+        std::vector<uint32_t> codepoints = GetCodepoints(g_pToastFont);
+
+        // The same files, through ImGui's stb_truetype loader
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false;
+        ImFont* stock = atlas->AddFontFromMemoryTTF(g_toastFontData.data(), (int)g_toastFontData.size(), TOAST_FONT_SIZE, &config);
+        BGM_REQUIRE(stock);
+        if (!g_toastFallbackFontData.empty()) {
+            config.MergeMode = true;
+            atlas->AddFontFromMemoryTTF(g_toastFallbackFontData.data(), (int)g_toastFallbackFontData.size(), TOAST_FONT_SIZE, &config);
+        }
+
+        BGM_CHECK(std::strcmp(g_pToastFont->Sources[0]->FontLoader->Name, "ToastGlyphLoader") == 0);
+        BGM_CHECK(stock->Sources[0]->FontLoader == nullptr);
+        ImFontBaked* ours = g_pToastFont->GetFontBaked(size);
+        ImFontBaked* theirs = stock->GetFontBaked(size);
+        BGM_CHECK(ours->Ascent == theirs->Ascent && ours->Descent == theirs->Descent);
+        BGM_CHECK(SameGlyphs(ReadAtlas(g_pToastFont, size, codepoints), ReadAtlas(stock, size, codepoints)));
+    }
+}
+
+BGM_TEST(LeavesOutWhatNeitherFileHas)
+{
+    BGM_REQUIRE(LoadFonts());
+    GlyphSet set;
+    BGM_CHECK(BakeToastGlyphs({ 0xFFFF, 0x110000, 'A', ' ' }, TOAST_FONT_SIZE, true, &set.glyphs, &set.pixels) == 2);
+    BGM_REQUIRE(set.glyphs.size() == 2);
+    BGM_CHECK(set.glyphs[0].codepoint == 'A' && set.glyphs[0].width > 2 * TOAST_SDF_SPREAD);
+    BGM_CHECK(set.glyphs[1].codepoint == ' ' && set.glyphs[1].width == 0 && set.glyphs[1].advanceX > 0.0f);
+    BGM_CHECK(set.pixels.size() == (size_t)set.glyphs[0].width * set.glyphs[0].height);
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,150 @@
+// ToastIcons.cpp: the category a track's file name picks; the icons packed
+// into the font atlas, pixel for pixel, across atlas growth; categories
+// without an icon of their own sharing the note's, which nothing can without
+// bgm_info.dds. The DDS decoding itself is DirectXTex's (Windows);
+// here an icon file is a width byte, a height byte and RGBA rows.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "ModUtilHost.h"
+#include "ToastIcons.h"
+
+bool LoadToastIconImage(const std::string& path, ToastIconImage* out)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 2)
+        return false;
+    out->width = bytes[0];
+    out->height = bytes[1];
+    out->pitch = (size_t)out->width * 4;
+    out->pixels.assign(bytes.begin() + 2, bytes.end());
+    return out->pixels.size() == out->pitch * out->height;
+}
+
+namespace {
+
+// An icon whose every pixel differs from the next, and between icons by `seed`.
+ToastIconImage MakeIcon(int width, int height, uint8_t seed)
+{
+    ToastIconImage image;
+    image.width = width;
+    image.height = height;
+    image.pitch = (size_t)width * 4;
+    for (int i = 0; i < width * height * 4; ++i)
+        image.pixels.push_back((uint8_t)(seed + i * 7));
+    return image;
+}
+
+void WriteIcon(const std::string& assets, const char* name, const ToastIconImage& image)
+{
+    std::ofstream file(assets + "/" + name, std::ios::binary);
+    file.put((char)image.width).put((char)image.height);
+    file.write((const char*)image.pixels.data(), (std::streamsize)image.pixels.size());
+}
+
+// Whether `atlas` holds `image` where `icon` draws from.
+bool AtlasHolds(ImFontAtlas* atlas, ToastIcon icon, const ToastIconImage& image)
+{
+    ImFontAtlasRect rect;
+    if (!GetToastIconRect(atlas, icon, &rect) || rect.w != image.width || rect.h != image.height)
+        return false;
+    for (int y = 0; y < rect.h; ++y)
+        if (std::memcmp(atlas->TexData->GetPixelsAt(rect.x, rect.y + y), image.pixels.data() + y * image.pitch, image.pitch) != 0)
+            return false;
+    return true;
+}
+
+struct AtlasContext {
+    AtlasContext()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        io.Fonts->AddFontDefault();
+        atlas = io.Fonts;
+    }
+    ~AtlasContext() { ImGui::DestroyContext(); }
+
+    ImFontAtlas* atlas;
+};
+
+} // namespace
+
+BGM_TEST(CategoryFromTheFileName)
+{
+    BGM_CHECK(GetToastIcon("bgm\\y8_b006.ogg") == ToastIcon::Battle);
+    BGM_CHECK(GetToastIcon("bgm\\y8_d101.ogg") == ToastIcon::Dungeon);
+    BGM_CHECK(GetToastIcon("y8_f010") == ToastIcon::Field);
+    BGM_CHECK(GetToastIcon("y8_e2") == ToastIcon::Event);
+    BGM_CHECK(GetToastIcon("bgm/y8_t001.ogg") == ToastIcon::Town);
+
+    // Only a category letter followed by a digit counts
+    BGM_CHECK(GetToastIcon("bgm\\y8_title.ogg") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("bgm\\y8_op.ogg") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("y8_b") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("y8_") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("y8_x001") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("bgm\\ys9_b001.ogg") == ToastIcon::Note);
+    BGM_CHECK(GetToastIcon("") == ToastIcon::Note);
+}
+
+BGM_TEST(IconsArePackedIntoTheAtlas)
+{
+    std::string assets = MakeTempModDirectory("BgmToastIconsTest");
+    ToastIconImage note = MakeIcon(24, 20, 1), battle = MakeIcon(16, 16, 99);
+    WriteIcon(assets, "bgm_info.dds", note);
+    WriteIcon(assets, "bgm_info_battle.dds", battle);
+
+    AtlasContext context;
+    AddToastIcons(context.atlas);
+    BGM_CHECK(AtlasHolds(context.atlas, ToastIcon::Note, note));
+    BGM_CHECK(AtlasHolds(context.atlas, ToastIcon::Battle, battle));
+    BGM_CHECK(GetModLog().back().find("note 24x20, 1 category icon(s)") != std::string::npos);
+
+    // The others draw the note, from the same rect
+    ImFontAtlasRect noteRect, townRect;
+    BGM_REQUIRE(GetToastIconRect(context.atlas, ToastIcon::Note, &noteRect));
+    BGM_REQUIRE(GetToastIconRect(context.atlas, ToastIcon::Town, &townRect));
+    BGM_CHECK(townRect.x == noteRect.x && townRect.y == noteRect.y && townRect.uv0.x == noteRect.uv0.x);
+
+    // The atlas grows (glyphs baked at a new size): the pixels move with the
+    // rects, and the UVs follow
+    int width = context.atlas->TexData->Width, height = context.atlas->TexData->Height;
+    ImFontAtlasTextureGrow(context.atlas);
+    BGM_CHECK(context.atlas->TexData->Width * context.atlas->TexData->Height > width * height);
+    BGM_CHECK(AtlasHolds(context.atlas, ToastIcon::Note, note));
+    BGM_CHECK(AtlasHolds(context.atlas, ToastIcon::Battle, battle));
+    ImFontAtlasRect grown;
+    BGM_REQUIRE(GetToastIconRect(context.atlas, ToastIcon::Note, &grown));
+    BGM_CHECK(grown.uv1.x < noteRect.uv1.x || grown.uv1.y < noteRect.uv1.y);
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+}
+
+BGM_TEST(MissingNoteIcon)
+{
+    std::string assets = MakeTempModDirectory("BgmToastIconsTest");
+    ToastIconImage battle = MakeIcon(16, 16, 5);
+    WriteIcon(assets, "bgm_info_battle.dds", battle);
+
+    // Nothing for the note to lend: only the category that has its own draws one
+    AtlasContext context;
+    AddToastIcons(context.atlas);
+    ImFontAtlasRect rect;
+    BGM_CHECK(!GetToastIconRect(context.atlas, ToastIcon::Note, &rect));
+    BGM_CHECK(!GetToastIconRect(context.atlas, ToastIcon::Town, &rect));
+    BGM_CHECK(AtlasHolds(context.atlas, ToastIcon::Battle, battle));
+    BGM_CHECK(GetModLog().back() == "Failed to load bgm_info.dds from file!");
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,140 @@
+// ns per BgmToastQueue operation on a deterministic trace of pushes,
+// ShowNext and Hide calls (the render thread's pattern, with bursts of track
+// changes), per policy, for the DLL's queue (BgmToastState, 4 pending).
+// The same trace through a std::deque-based queue is shown for scale.
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "BgmTest.h"
+#include "BgmToastQueue.h"
+#include "BgmToastState.h"
+
+namespace {
+
+constexpr size_t CAPACITY = 4;
+
+struct Op {
+    uint8_t kind;   // 0 push, 1 ShowNext, 2 Hide
+    double time;
+    uint32_t track;
+};
+
+// One op per frame at 144 fps: mostly ShowNext (a no-op while a toast is up),
+// a Hide every ~5 s, and bursts of 1-6 track changes.
+std::vector<Op> MakeTrace(size_t count)
+{
+    std::mt19937 rng(15);
+    std::vector<Op> trace;
+    trace.reserve(count);
+    double now = 0.0;
+    while (trace.size() < count)
+    {
+        now += 1.0 / 144.0;
+        uint32_t roll = rng() % 1000;
+        if (roll < 5) {
+            for (uint32_t i = 0, burst = 1 + rng() % 6; i < burst && trace.size() < count; ++i, now += 0.1)
+                trace.push_back({ 0, now, (uint32_t)(rng() % 60) });
+        } else if (roll < 7) {
+            trace.push_back({ 2, now, 0 });
+        } else {
+            trace.push_back({ 1, now, 0 });
+        }
+    }
+    return trace;
+}
+
+// Same policies over a std::deque, as a baseline.
+struct DequeQueue {
+    struct Entry {
+        BgmToastState value;
+        double requestedAt;
+    };
+    DequeQueue(BgmToastPolicy queuePolicy, double coalesceWindow) : policy(queuePolicy), window(coalesceWindow) {}
+
+    BgmToastPolicy policy;
+    double window;
+    bool hasVisible = false;
+    Entry visible{};
+    std::deque<Entry> pending;
+
+    void Push(const BgmToastState& value, double now)
+    {
+        if (policy == BgmToastPolicy::Coalesce)
+        {
+            Entry* newest = !pending.empty() ? &pending.back() : hasVisible ? &visible : nullptr;
+            if (newest && now - newest->requestedAt < window) {
+                newest->value = value;
+                return;
+            }
+        }
+        if (policy == BgmToastPolicy::Replace)
+            pending.clear();
+        else if (pending.size() == CAPACITY)
+            pending.pop_front();
+        pending.push_back({ value, now });
+    }
+    bool ShowNext(double now)
+    {
+        if (hasVisible || pending.empty()) return false;
+        visible = { pending.front().value, now };
+        pending.pop_front();
+        hasVisible = true;
+        return true;
+    }
+    void Hide() { hasVisible = false; }
+};
+
+template <typename QueueT>
+double Replay(const BgmBench& bench, const std::vector<Op>& trace, BgmToastPolicy policy)
+{
+    uint64_t shown = 0;
+    double ns = bench.NsPerCall(1, [&](size_t) {
+        QueueT queue(policy, 2.0);
+        BgmToastState state;
+        for (const Op& op : trace)
+        {
+            if (op.kind == 0) {
+                state.track = op.track;
+                ++state.serial;
+                queue.Push(state, op.time);
+            } else if (op.kind == 1) {
+                shown += queue.ShowNext(op.time);
+            } else {
+                queue.Hide();
+            }
+        }
+    });
+    BgmBenchKeep(shown);
+    return ns / (double)trace.size();
+}
+
+using ToastQueue = BgmToastQueue<BgmToastState, CAPACITY>;
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::vector<Op> trace = MakeTrace(bench.Iterations(2000000));
+    size_t pushes = 0;
+    for (const Op& op : trace)
+        pushes += op.kind == 0;
+
+    struct Case {
+        const char* name;
+        BgmToastPolicy policy;
+    };
+    const Case cases[] = {
+        { "replace", BgmToastPolicy::Replace },
+        { "enqueue", BgmToastPolicy::Enqueue },
+        { "coalesce", BgmToastPolicy::Coalesce },
+    };
+    std::printf("Toast queue, ns/op over %zu ops (%zu pushes)\n", trace.size(), pushes);
+    std::printf("%-10s %12s %12s\n", "policy", "BgmToastQ", "std::deque");
+    for (const Case& c : cases)
+        std::printf("%-10s %12.2f %12.2f\n", c.name, Replay<ToastQueue>(bench, trace, c.policy),
+            Replay<DequeQueue>(bench, trace, c.policy));
+    return 0;
+}
@@ -0,0 +1,185 @@
+// The render thread across display changes that need the toast font rebaked,
+// headless, through the DLL's ToastScale.cpp and ToastGlyphRasterizer.cpp:
+// My_Present's per-frame sequence (UpdateToastScale, IngestToastGlyphs with
+// ApplyToastRebake, NewFrame, the toast's text, Render) paced at 60 Hz, with
+// the back buffer switching between 1080 px and a height whose draw size the
+// bake no longer serves.
+//
+// Per frame, wall time and the render thread's own CPU time: while a rebake
+// is on the rasterizer thread ("in flight", ImGui scaling the old bake), on
+// the frame that swaps it in, and steady frames for reference. Against them,
+// what a blocking rebuild would stall one frame for: BakeToastGlyphs of the
+// same glyphs on the render thread (before any atlas copy). Every glyph of
+// mod_font.otf is resident, as after a map's prewarm; bitmaps and fields.
+//
+// Wall time on a single core includes the rasterizer thread preempting the
+// render thread; the CPU time does not, and is what Present itself spends.
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <thread>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphLoader.h"
+#include "ToastGlyphRasterizer.h"
+#include "ToastScale.h"
+
+namespace {
+
+constexpr const char* TITLE = "Lacrimosa of Dana -Opening Ver.-";
+constexpr auto FRAME_PERIOD = std::chrono::microseconds(16667);
+constexpr size_t STEADY_FRAMES = 30;
+constexpr size_t MAX_FRAMES_PER_SWITCH = 600; // 10 s: a rebake that never lands
+
+double GetThreadCpuMicroseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+struct FrameTimes {
+    std::vector<double> wall, cpu;
+
+    void Add(double wallUs, double cpuUs)
+    {
+        wall.push_back(wallUs);
+        cpu.push_back(cpuUs);
+    }
+};
+
+double Percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+double Max(const std::vector<double>& values)
+{
+    return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+// One of My_Present's active frames, then the rest of the 60 Hz period.
+void RunFrame(float displayHeight, FrameTimes* times)
+{
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = GetThreadCpuMicroseconds();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(displayHeight * 16.0f / 9.0f, displayHeight);
+    io.DeltaTime = 1.0f / 60.0f;
+    UpdateToastScale(displayHeight);
+    IngestToastGlyphs(ApplyToastRebake);
+    ImGui::NewFrame();
+    PushToastFont();
+    ImGui::GetForegroundDrawList()->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(100.0f, 100.0f), IM_COL32_WHITE, TITLE);
+    ImGui::PopFont();
+    ImGui::Render();
+
+    double cpuUs = GetThreadCpuMicroseconds() - cpuStart;
+    times->Add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count(), cpuUs);
+    std::this_thread::sleep_until(start + FRAME_PERIOD);
+}
+
+// Every codepoint mod_font.otf has.
+std::vector<uint32_t> GetFontCodepoints()
+{
+    std::vector<uint32_t> codepoints;
+    for (uint32_t codepoint = 0x20; codepoint <= IM_UNICODE_CODEPOINT_MAX; ++codepoint)
+        if (g_pToastFont->IsGlyphInFont((ImWchar)codepoint))
+            codepoints.push_back(codepoint);
+    return codepoints;
+}
+
+void RunMode(const BgmBench& bench, const char* name, bool sdf, float highHeight)
+{
+    g_bToastSdf = sdf;
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+    g_pToastFont = AddToastFonts(io.Fonts);
+    g_toastBakedSize = 0.0f;
+
+    FrameTimes steady, inFlight, swap;
+    RunFrame(TOAST_REFERENCE_HEIGHT, &steady);
+    std::vector<uint32_t> codepoints = GetFontCodepoints();
+    ImFontBaked* baked = GetToastBaked();
+    for (uint32_t codepoint : codepoints)
+        baked->FindGlyph((ImWchar)codepoint);
+    size_t glyphCount = (size_t)baked->Glyphs.Size;
+    steady = FrameTimes();
+    for (size_t i = 0; i < STEADY_FRAMES; ++i)
+        RunFrame(TOAST_REFERENCE_HEIGHT, &steady);
+
+    // Alternate heights; each switch runs frames until its rebake is swapped in
+    std::vector<double> rebakeMs;
+    size_t switches = bench.quick ? 2 : 10;
+    bool landed = true;
+    for (size_t n = 0; n < switches && landed; ++n)
+    {
+        float height = n % 2 == 0 ? highHeight : TOAST_REFERENCE_HEIGHT;
+        auto start = std::chrono::steady_clock::now();
+        landed = false;
+        for (size_t frame = 0; frame < MAX_FRAMES_PER_SWITCH && !landed; ++frame)
+        {
+            float bakedBefore = g_toastBakedSize;
+            FrameTimes times;
+            RunFrame(height, &times);
+            landed = g_toastBakedSize != bakedBefore;
+            (landed ? swap : inFlight).Add(times.wall[0], times.cpu[0]);
+        }
+        rebakeMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    float highBake = GetToastBakeSize(IM_ROUND(TOAST_FONT_SIZE * std::min(highHeight / TOAST_REFERENCE_HEIGHT, TOAST_SCALE_MAX)));
+    double blockingUs = bench.Microseconds([&] {
+        std::vector<BgmCachedGlyph> glyphs;
+        std::vector<uint8_t> pixels;
+        BgmBenchKeep(BakeToastGlyphs(codepoints, highBake, sdf, &glyphs, &pixels));
+    }, 3);
+
+    std::printf("%-8s %4.0f->%-4.0f %6zu %9.1f | %8.0f | %6zu %8.0f %8.0f %8.0f | %8.0f %8.0f | %7.1f %7.1f%s\n", name,
+        TOAST_REFERENCE_HEIGHT, highHeight, glyphCount, blockingUs / 1000.0, Max(steady.cpu), inFlight.cpu.size(),
+        Percentile(inFlight.cpu, 0.5), Max(inFlight.cpu), Max(inFlight.wall), Percentile(swap.cpu, 0.5), Max(swap.cpu),
+        Percentile(rebakeMs, 0.5), Max(rebakeMs), landed ? "" : " (A REBAKE NEVER LANDED)");
+
+    ImGui::DestroyContext();
+    g_pToastFont = nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+
+    std::string assets = MakeTempModDirectory("BgmToastRebakeBench");
+    std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+    if (!LoadToastFontFiles()) {
+        std::printf("Cannot read mod_font.otf.\n");
+        return 1;
+    }
+
+    std::printf("Render thread across toast font rebakes, 60 Hz (%u core(s)); frame times in us, the render thread's CPU unless noted\n",
+        std::thread::hardware_concurrency());
+    std::printf("%-26s %9s | %8s | %-33s | %-17s | %s\n", "", "blocking", "steady", "frames with the rebake in flight",
+        "swap frame", "send->swap, ms");
+    std::printf("%-8s %-10s %6s %9s | %8s | %6s %8s %8s %8s | %8s %8s | %7s %7s\n", "bake", "height", "glyphs", "bake, ms",
+        "max", "count", "p50", "max", "max wall", "p50", "max", "p50", "max");
+    RunMode(bench, "bitmap", false, 1440.0f); // 28 -> 37 px text: baked at 36
+    RunMode(bench, "sdf", true, 2880.0f);     // 28 -> 75 px text: past what 28 px fields serve, baked at 56
+    StopToastGlyphRasterizer();
+
+    std::filesystem::remove_all(std::filesystem::path(assets).parent_path());
+    return 0;
+}
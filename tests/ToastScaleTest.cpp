@@ -0,0 +1,161 @@
+// ToastScale.cpp: the scale follows the back buffer's height; the first frame
+// bakes the font in place; a draw size the bake no longer serves sends one
+// rebake to the rasterizer thread, frames keep drawing the old bake until it
+// lands, and a rebake the display has moved past is dropped. mod_font.otf,
+// as distance fields.
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include <imgui.h>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "ModUtilHost.h"
+#include "ToastFont.h"
+#include "ToastGlyphRasterizer.h"
+#include "ToastScale.h"
+
+namespace {
+
+bool LoadFonts()
+{
+    static bool s_loaded = [] {
+        std::string assets = MakeTempModDirectory("BgmToastScaleTest");
+        std::filesystem::copy_file(GetBgmTestPath("mod_font.otf"), assets + "/mod_font.otf");
+        return LoadToastFontFiles();
+    }();
+    return s_loaded;
+}
+
+// A fresh ImGui context with the toast font, not baked yet.
+struct ToastContext {
+    ToastContext()
+    {
+        g_bToastSdf = true;
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures; // Texture updates are left unprocessed
+        g_pToastFont = AddToastFonts(io.Fonts);
+        g_toastBakedSize = 0.0f;
+    }
+    ~ToastContext()
+    {
+        ImGui::DestroyContext();
+        g_pToastFont = nullptr;
+    }
+};
+
+// My_Present's order: scale, ingest, then the frame.
+void RunFrame(float displayHeight)
+{
+    ImGui::GetIO().DisplaySize = ImVec2(displayHeight * 16.0f / 9.0f, displayHeight);
+    UpdateToastScale(displayHeight);
+    IngestToastGlyphs(ApplyToastRebake);
+    ImGui::NewFrame();
+    PushToastFont();
+    ImGui::CalcTextSize("Lacrimosa of Dana");
+    ImGui::PopFont();
+    ImGui::EndFrame();
+}
+
+// Frames at `displayHeight` until no rebake is in flight. False after 10 s.
+bool RunFramesUntilLanded(float displayHeight)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (IsToastRebakeInFlight()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        RunFrame(displayHeight);
+    }
+    return true;
+}
+
+} // namespace
+
+BGM_TEST(ScaleFollowsTheBackBuffer)
+{
+    ImFont* font = g_pToastFont;
+    g_pToastFont = nullptr; // Scale only, nothing to bake
+    UpdateToastScale(TOAST_REFERENCE_HEIGHT);
+    BGM_CHECK(g_toastScale == 1.0f && g_toastFontSize == TOAST_FONT_SIZE);
+    UpdateToastScale(2160.0f);
+    BGM_CHECK(g_toastScale == 2.0f && g_toastFontSize == 2.0f * TOAST_FONT_SIZE);
+    UpdateToastScale(1440.0f);
+    BGM_CHECK(g_toastFontSize == 37.0f); // 28 * 4/3, rounded
+    UpdateToastScale(0.0f);              // No back buffer: keeps the last scale
+    BGM_CHECK(g_toastFontSize == 37.0f);
+    UpdateToastScale(100.0f);
+    BGM_CHECK(g_toastScale == TOAST_SCALE_MIN);
+    UpdateToastScale(100000.0f);
+    BGM_CHECK(g_toastScale == TOAST_SCALE_MAX);
+    g_pToastFont = font;
+}
+
+BGM_TEST(FirstFrameBakesInPlace)
+{
+    BGM_REQUIRE(LoadFonts());
+    ToastContext context;
+    RunFrame(2160.0f);
+    BGM_CHECK(g_toastBakedSize == TOAST_FONT_SIZE); // 56 px text: fields baked at 28 still serve it
+    BGM_CHECK(!IsToastRebakeInFlight());
+    RunFrame(2880.0f); // 75 px text: past them, rebaked at 56
+    BGM_CHECK(IsToastRebakeInFlight());
+    BGM_CHECK(RunFramesUntilLanded(2880.0f));
+    BGM_CHECK(g_toastBakedSize == 2.0f * TOAST_FONT_SIZE);
+}
+
+BGM_TEST(RebakeLandsBetweenFrames)
+{
+    BGM_REQUIRE(LoadFonts());
+    ToastContext context;
+    RunFrame(TOAST_REFERENCE_HEIGHT);
+    BGM_REQUIRE(g_toastBakedSize == TOAST_FONT_SIZE);
+    int glyphCount = GetToastBaked()->Glyphs.Size;
+    BGM_CHECK(glyphCount > 10);
+
+    // Frames go on with the old bake, scaled, while the rasterizer thread works
+    RunFrame(2880.0f);
+    BGM_CHECK(IsToastRebakeInFlight());
+    BGM_CHECK(g_toastBakedSize == TOAST_FONT_SIZE);
+    BGM_CHECK(g_toastFontSize == 75.0f);
+    BGM_CHECK(RunFramesUntilLanded(2880.0f));
+
+    // Swapped in with every glyph the old bake had
+    ImFontBaked* baked = GetToastBaked();
+    BGM_CHECK(g_toastBakedSize == 2.0f * TOAST_FONT_SIZE);
+    BGM_CHECK(baked->Size == 2.0f * TOAST_FONT_SIZE);
+    BGM_CHECK(baked->Glyphs.Size >= glyphCount);
+    for (const char* p = "Lacrimosa of Dana"; *p; ++p)
+        BGM_CHECK(baked->IsGlyphLoaded((ImWchar)*p));
+    BGM_CHECK(GetModLog().back().find("Toast font rebaked at 56 px for 75 px text") != std::string::npos);
+
+    // Back down: rebaked at 28 again
+    RunFrame(TOAST_REFERENCE_HEIGHT);
+    BGM_CHECK(IsToastRebakeInFlight());
+    BGM_CHECK(RunFramesUntilLanded(TOAST_REFERENCE_HEIGHT));
+    BGM_CHECK(g_toastBakedSize == TOAST_FONT_SIZE);
+}
+
+BGM_TEST(OutdatedRebakeIsDropped)
+{
+    BGM_REQUIRE(LoadFonts());
+    ToastContext context;
+    RunFrame(TOAST_REFERENCE_HEIGHT);
+    UpdateToastScale(2880.0f); // Sent; then the display goes back before it lands
+    BGM_REQUIRE(IsToastRebakeInFlight());
+    size_t logLines = GetModLog().size();
+    BGM_CHECK(RunFramesUntilLanded(TOAST_REFERENCE_HEIGHT));
+    BGM_CHECK(g_toastBakedSize == TOAST_FONT_SIZE);
+    BGM_CHECK(GetToastBaked()->Size == TOAST_FONT_SIZE);
+    for (size_t i = logLines; i < GetModLog().size(); ++i)
+        BGM_CHECK(GetModLog()[i].find("rebaked") == std::string::npos);
+    RunFrame(TOAST_REFERENCE_HEIGHT); // The bake serves the size: nothing sent
+    BGM_CHECK(!IsToastRebakeInFlight());
+    StopToastGlyphRasterizer();
+}
+
+BGM_TEST_MAIN()
@@ -0,0 +1,90 @@
+// ns to resolve a captured BGM path to its track, at the shipped map's size
+// and at 50k synthetic keys: the std::map scan ProcessBgmTrigger used to run
+// (copy and std::replace per key, then a suffix compare), a std::unordered_map
+// keyed by basename for reference, and BgmTrackIndex (hash the basename,
+// perfect hash, verify, trie walk).
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+#include "BgmIndex.h"
+#include "BgmPathClassifier.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+
+namespace {
+
+uint16_t ScanMap(const std::map<std::string, uint16_t>& map, const std::string& filename)
+{
+    std::string normalizedInput = filename;
+    std::replace(normalizedInput.begin(), normalizedInput.end(), '/', '\\');
+    for (auto& entry : map)
+    {
+        std::string key = entry.first;
+        std::replace(key.begin(), key.end(), '/', '\\');
+        if (normalizedInput.length() >= key.length() &&
+            normalizedInput.compare(normalizedInput.length() - key.length(), key.length(), key) == 0)
+            return entry.second;
+    }
+    return BGM_INVALID_TRACK_ID;
+}
+
+void BenchLookups(const BgmBench& bench, const char* name, const std::vector<std::string>& keys)
+{
+    std::map<std::string, uint16_t> map;
+    std::unordered_map<std::string, uint16_t> byBasename;
+    for (size_t id = 0; id < keys.size(); ++id)
+    {
+        map.emplace(keys[id], (uint16_t)id);
+        byBasename.emplace(keys[id].substr(keys[id].find_last_of("\\/") + 1), (uint16_t)id);
+    }
+    BgmTrackIndex index;
+    if (!index.Build(keys))
+        return;
+
+    // Hits spread over the whole map, in a fixed shuffled order
+    std::vector<std::string> paths = MakeBgmTestTrace(keys, 0, 0).bgmHits;
+    std::vector<std::string> probes;
+    for (size_t i = 0; i < 1024; ++i)
+        probes.push_back(paths[(i * 2654435761u) % paths.size()]);
+
+    uint64_t sum = 0;
+    // The scan is O(N) with N allocations; at 50k keys a few hundred calls are plenty
+    size_t scanCalls = std::max<size_t>(1, bench.Iterations(keys.size() > 1000 ? 200 : 200000));
+    double scan = bench.NsPerCall(scanCalls, [&](size_t i) {
+        sum += ScanMap(map, probes[i % probes.size()]);
+    });
+    size_t calls = bench.Iterations(1000000);
+    double hashed = bench.NsPerCall(calls, [&](size_t i) {
+        const std::string& path = probes[i % probes.size()];
+        auto found = byBasename.find(path.substr(path.find_last_of('\\') + 1));
+        sum += found == byBasename.end() ? BGM_INVALID_TRACK_ID : found->second;
+    });
+    double indexed = bench.NsPerCall(calls, [&](size_t i) {
+        const std::string& path = probes[i % probes.size()];
+        BgmPathInfo info = ClassifyPath(path.c_str());
+        uint64_t hash;
+        if (HashAsciiBasename(path.c_str() + info.basenameOffset, info.length - info.basenameOffset, &hash))
+            sum += index.Find(hash, path.c_str(), info.length, info.basenameOffset);
+    });
+    BgmBenchKeep(sum);
+
+    std::printf("%-10s %8zu %14.1f %14.1f %14.1f %10zu\n", name, keys.size(), scan, hashed, indexed, index.GetSizeInBytes());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::vector<std::string> shipped = GetBgmTestKeys(LoadShippedBgmMap());
+    if (shipped.empty())
+        return 1;
+
+    std::printf("Track lookup for a BGM hit, ns/lookup\n");
+    std::printf("%-10s %8s %14s %14s %14s %10s\n", "map", "keys", "std::map scan", "unordered_map", "BgmTrackIndex", "bytes");
+    BenchLookups(bench, "shipped", shipped);
+    BenchLookups(bench, "synthetic", MakeSyntheticBgmKeys(50000));
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Memory footprint and load time of the BGM map's records: the original
+// std::map<std::string, BgmInfo> (four std::string members per record)
+// against BgmTrackStore, for the shipped map and a synthetic 100k-entry one.
+// "Heap" counts every byte requested from operator new while loading.
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <new>
+
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "BgmTrackStore.h"
+
+static size_t g_allocatedBytes = 0;
+
+void* operator new(size_t size)
+{
+    g_allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct BgmInfo {
+    std::string songName;
+    std::string disc;
+    std::string track;
+    std::string rawFileName;
+};
+
+void BenchLoad(const BgmBench& bench, const char* name, const std::vector<BgmTestEntry>& entries)
+{
+    size_t mapBytes = 0, storeBytes = 0, storeRecords = 0, storeSize = 0;
+    double mapUs = bench.Microseconds([&] {
+        size_t before = g_allocatedBytes;
+        std::map<std::string, BgmInfo> map;
+        for (const BgmTestEntry& entry : entries)
+        {
+            BgmInfo info;
+            info.songName = entry.title;
+            info.disc = std::to_string(entry.disc);
+            info.track = std::to_string(entry.track);
+            info.rawFileName = entry.key;
+            map[entry.key] = info;
+        }
+        mapBytes = g_allocatedBytes - before;
+    });
+    double storeUs = bench.Microseconds([&] {
+        size_t before = g_allocatedBytes;
+        BgmTrackStore store;
+        for (const BgmTestEntry& entry : entries)
+        {
+            if (store.Add(entry.key, entry.title, entry.disc, entry.track) == BGM_INVALID_TRACK_ID)
+                break;
+        }
+        storeBytes = g_allocatedBytes - before;
+        storeRecords = store.GetCount();
+        storeSize = store.GetSizeInBytes();
+    });
+    std::printf("%-10s %8zu %12zu %10.0f %8zu %12zu %12zu %10.0f\n",
+        name, entries.size(), mapBytes, mapUs, storeRecords, storeSize, storeBytes, storeUs);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    std::vector<BgmTestEntry> shipped = LoadShippedBgmMap();
+    if (shipped.empty())
+        return 1;
+
+    // Two keys per title, like tracks that loop through an intro file
+    std::vector<BgmTestEntry> synthetic;
+    std::vector<std::string> keys = MakeSyntheticBgmKeys(bench.quick ? 1000 : 100000);
+    for (size_t i = 0; i < keys.size(); ++i)
+        synthetic.push_back({ keys[i], "Synthetic Song Title Number " + std::to_string(i / 2), 1, (uint8_t)(i % 255 + 1) });
+
+    std::printf("Loading the BGM records (the store holds at most %zu)\n", BGM_MAX_TRACKS);
+    std::printf("%-10s %8s %12s %10s %8s %12s %12s %10s\n",
+        "map", "entries", "std::map heap", "us", "records", "store bytes", "store heap", "us");
+    BenchLoad(bench, "shipped", shipped);
+    BenchLoad(bench, "synthetic", synthetic);
+    return 0;
+}
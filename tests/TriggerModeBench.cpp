@@ -0,0 +1,200 @@
+// Frame time under both trigger modes, headless: a render thread runs
+// fixed 1 ms frames while a game thread pushes bursts of BGM events (a map
+// transition opening a dozen tracks) every ~45 frames.
+//
+// - worker: BgmWorkerThread's loop on its own thread (drain, BgmWakeup::Wait),
+//   producers calling Notify after each push;
+// - inline: ProcessBgmEventsInline's drain at the top of each frame
+//   (BgmEventRing::DrainUntil, batches of 4, 200 us budget), the keys pushed
+//   to a log ring that a watcher thread writes out every 250 ms;
+// - inline+log: the same drain writing the log lines inside the frame, as
+//   the inline mode did before its logging was deferred.
+//
+// The trigger stands in for ProcessBgmTrigger: a store lookup, a title copy
+// and a "MATCH FOUND" line appended to a log file, as the DLL's Log() does.
+// On a machine with spare cores the worker's cost lands elsewhere; run
+// under `taskset -c 0` to see the single-core case.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "BgmEventRing.h"
+#include "BgmTest.h"
+#include "BgmTestData.h"
+#include "BgmTrackStore.h"
+#include "BgmWakeup.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t BURST_EVENTS = 12;
+constexpr size_t BURST_FRAMES = 45;
+constexpr auto FRAME_WORK = std::chrono::microseconds(1000);
+constexpr auto INLINE_BUDGET = std::chrono::microseconds(200);
+
+BgmTrackStore g_store;
+std::string g_logPath;
+BgmEventRing<256> g_ring;
+BgmEventRing<32, BgmPathLogEvent> g_logRing; // Inline mode's deferred keys
+
+void WriteLog(const char* key)
+{
+    std::ofstream log(g_logPath, std::ios_base::app | std::ios_base::out);
+    log << "[Thu Jan  1 00:00:00 2026] MATCH FOUND for: " << key << std::endl;
+}
+
+void Trigger(const BgmCaptureEvent& ev)
+{
+    char title[256];
+    snprintf(title, sizeof(title), "%s", g_store.GetTitle(ev.trackId));
+    BgmBenchKeep(title[0]);
+    WriteLog(g_store.GetKey(ev.trackId));
+}
+
+void TriggerBatch(const BgmCaptureEvent* batch, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        Trigger(batch[i]);
+}
+
+// The inline mode's trigger: the key goes to g_logRing, not the log file.
+void TriggerBatchDeferred(const BgmCaptureEvent* batch, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        char title[256];
+        snprintf(title, sizeof(title), "%s", g_store.GetTitle(batch[i].trackId));
+        BgmBenchKeep(title[0]);
+        const char* key = g_store.GetKey(batch[i].trackId);
+        size_t length = std::min(strlen(key), BGM_LOGGED_PATH_CHARS - 1);
+        g_logRing.TryPush([&](BgmPathLogEvent& ev) {
+            memcpy(ev.path, key, length);
+            ev.path[length] = '\0';
+        });
+    }
+}
+
+struct FrameResult {
+    std::vector<double> frames; // us
+    size_t carriedOver = 0;
+};
+
+// Runs `frameCount` frames; `beginFrame` is what Present does before the
+// game's own work (nothing in worker mode, the budgeted drain inline).
+template <typename BeginFrame>
+FrameResult RunFrames(size_t frameCount, std::atomic<bool>& producing, BeginFrame&& beginFrame, void (*notify)())
+{
+    FrameResult result;
+    result.frames.reserve(frameCount);
+    std::thread producer([&] {
+        uint16_t next = 0;
+        while (producing.load())
+        {
+            for (size_t i = 0; i < BURST_EVENTS; ++i)
+            {
+                g_ring.TryPush([&](BgmCaptureEvent& ev) {
+                    ev.timestamp = (uint64_t)Clock::now().time_since_epoch().count();
+                    ev.trackId = (uint16_t)(next++ % g_store.GetCount());
+                });
+                notify();
+            }
+            std::this_thread::sleep_for(FRAME_WORK * BURST_FRAMES);
+        }
+    });
+
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        Clock::time_point start = Clock::now();
+        result.carriedOver += beginFrame();
+        Clock::time_point workEnd = Clock::now() + FRAME_WORK;
+        while (Clock::now() < workEnd) {}
+        result.frames.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    producing = false;
+    producer.join();
+    return result;
+}
+
+void PrintResult(const char* name, FrameResult result)
+{
+    std::vector<double>& f = result.frames;
+    double total = 0.0;
+    for (double us : f) total += us;
+    std::sort(f.begin(), f.end());
+    std::printf("%-10s %8zu %10.1f %10.1f %10.1f %10.1f %10zu\n", name, f.size(), total / (double)f.size(),
+        f[f.size() / 2], f[std::min(f.size() - 1, f.size() * 99 / 100)], f.back(), result.carriedOver);
+}
+
+BgmWakeup<BgmAutoResetEvent> g_wakeup;
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    for (const BgmTestEntry& entry : LoadShippedBgmMap())
+        g_store.Add(entry.key, entry.title, entry.disc, entry.track);
+    if (g_store.GetCount() == 0)
+        return 1;
+    g_logPath = (std::filesystem::temp_directory_path() / "TriggerModeBench.log").string();
+    size_t frameCount = bench.Iterations(5000);
+
+    std::printf("Frame time, us (1000 us of frame work, %zu events every %zu frames)\n", BURST_EVENTS, BURST_FRAMES);
+    std::printf("%-10s %8s %10s %10s %10s %10s %10s\n", "mode", "frames", "avg", "p50", "p99", "max", "carried");
+
+    {
+        std::atomic<bool> active{true}, producing{true};
+        std::thread worker([&] {
+            BgmCaptureEvent batch[16];
+            while (active.load())
+            {
+                while (size_t count = g_ring.PopBatch(batch, 16))
+                    TriggerBatch(batch, count);
+                g_wakeup.Wait([&] { return g_ring.IsEmpty() && active.load(); });
+            }
+        });
+        PrintResult("worker", RunFrames(frameCount, producing, [] { return 0; }, [] { g_wakeup.Notify(); }));
+        active = false;
+        g_wakeup.GetEvent().Set();
+        worker.join();
+    }
+    {
+        // LogDeferredPaths on BgmMapWatcherThread's 250 ms poll
+        std::atomic<bool> producing{true}, watching{true};
+        std::thread watcher([&] {
+            BgmPathLogEvent batch[8];
+            while (watching.load())
+            {
+                while (size_t count = g_logRing.PopBatch(batch, 8))
+                    for (size_t i = 0; i < count; ++i)
+                        WriteLog(batch[i].path);
+                std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            }
+        });
+        auto drain = [] {
+            if (g_ring.IsEmpty()) return 0;
+            return (int)g_ring.DrainUntil<4>(Clock::now() + INLINE_BUDGET, TriggerBatchDeferred);
+        };
+        PrintResult("inline", RunFrames(frameCount, producing, drain, [] {}));
+        watching = false;
+        watcher.join();
+    }
+    {
+        std::atomic<bool> producing{true};
+        auto drain = [] {
+            if (g_ring.IsEmpty()) return 0;
+            return (int)g_ring.DrainUntil<4>(Clock::now() + INLINE_BUDGET, TriggerBatch);
+        };
+        PrintResult("inline+log", RunFrames(frameCount, producing, drain, [] {}));
+    }
+
+    std::remove(g_logPath.c_str());
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Push-to-trigger latency of the BGM worker: the time from a detour's push
+// (the event's timestamp) to the consumer handing the event to
+// ProcessBgmTrigger, and how often an idle consumer wakes up.
+//
+// "event wait" is BgmWorkerThread's loop: drain, then BgmWakeup::Wait, with
+// producers calling Notify after each push. It runs on BgmAutoResetEvent
+// here; the DLL uses a Win32 event behind the same protocol. "100 ms poll" is
+// the original loop: drain, then sleep 100 ms. Events arrive one at a time,
+// a few milliseconds apart, so the consumer is asleep for each of them.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "BgmEventRing.h"
+#include "BgmTest.h"
+#include "BgmWakeup.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct LatencyResult {
+    std::vector<double> latencies; // us, one per event
+    double idleWakeupsPerSecond = 0.0;
+};
+
+// Runs a consumer with `sleep` (the part of the loop after a drain) against
+// one producer that pushes `eventCount` events `gap` apart on average, then
+// leaves the consumer idle for `idleTime` and counts its loop iterations.
+template <typename Sleep, typename Notify>
+LatencyResult RunConsumer(size_t eventCount, Clock::duration gap, Clock::duration idleTime,
+    std::atomic<bool>& active, Sleep&& sleep, Notify&& notify)
+{
+    static BgmEventRing<64> ring;
+    LatencyResult result;
+    result.latencies.reserve(eventCount);
+    std::atomic<uint64_t> iterations{0};
+    std::atomic<size_t> received{0};
+
+    std::thread consumer([&] {
+        BgmCaptureEvent batch[16];
+        while (active.load())
+        {
+            while (size_t count = ring.PopBatch(batch, 16))
+            {
+                Clock::time_point now = Clock::now();
+                for (size_t i = 0; i < count; ++i)
+                    result.latencies.push_back(std::chrono::duration<double, std::micro>(
+                        now.time_since_epoch() - Clock::duration(batch[i].timestamp)).count());
+                received.fetch_add(count);
+            }
+            iterations.fetch_add(1, std::memory_order_relaxed);
+            sleep(ring);
+        }
+    });
+
+    std::mt19937 rng(12);
+    std::uniform_int_distribution<int> jitter(50, 150);
+    for (size_t i = 0; i < eventCount; ++i)
+    {
+        std::this_thread::sleep_for(gap * jitter(rng) / 100);
+        ring.TryPush([](BgmCaptureEvent& ev) { ev.timestamp = (uint64_t)Clock::now().time_since_epoch().count(); });
+        notify();
+    }
+    // Let the last event through, then count wakeups with nothing to do
+    while (received.load() < eventCount)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    uint64_t before = iterations.load();
+    std::this_thread::sleep_for(idleTime);
+    result.idleWakeupsPerSecond = (double)(iterations.load() - before) / std::chrono::duration<double>(idleTime).count();
+
+    active = false;
+    notify();
+    consumer.join();
+    return result;
+}
+
+void PrintResult(const char* name, LatencyResult result)
+{
+    std::vector<double>& l = result.latencies;
+    std::sort(l.begin(), l.end());
+    auto percentile = [&](double p) { return l[std::min(l.size() - 1, (size_t)(p * (double)l.size()))]; };
+    std::printf("%-13s %7zu %12.1f %10.1f %10.1f %10.1f %12.1f\n", name, l.size(), result.idleWakeupsPerSecond,
+        percentile(0.5), percentile(0.99), l.back(), l.front());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BgmBench bench(argc, argv);
+    Clock::duration idleTime = bench.quick ? std::chrono::milliseconds(250) : std::chrono::seconds(2);
+
+    std::printf("Push to ProcessBgmTrigger, us; idle = consumer wakeups/s with an empty ring\n");
+    std::printf("%-13s %7s %12s %10s %10s %10s %12s\n", "consumer", "events", "idle", "p50", "p99", "max", "min");
+
+    {
+        BgmWakeup<BgmAutoResetEvent> wakeup;
+        std::atomic<bool> active{true};
+        auto sleep = [&](BgmEventRing<64>& ring) { wakeup.Wait([&] { return ring.IsEmpty() && active.load(); }); };
+        PrintResult("event wait", RunConsumer(bench.Iterations(2000), std::chrono::milliseconds(2), idleTime,
+            active, sleep, [&] { wakeup.Notify(); }));
+    }
+    {
+        std::atomic<bool> active{true};
+        auto sleep = [](BgmEventRing<64>&) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); };
+        PrintResult("100 ms poll", RunConsumer(bench.quick ? 3 : 40, std::chrono::milliseconds(37), idleTime,
+            active, sleep, [] {}));
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+// =============================================================
+// BgmMapGen: compiles BgmMap.yaml into a C++ header at build time
+// =============================================================
+// Usage: BgmMapGen <BgmMap.yaml> <output header>
+//
+// Emits every BgmTrackStore and BgmTrackIndex table as constexpr arrays, so
+// the DLL can resolve the shipped soundtrack with no YAML parsing and no heap
+// allocation. Fails (non-zero exit) on duplicate keys or values that are not
+// "title|disc|track", which fails the build.
+
+#include "BgmIndex.h"
+#include "BgmTrackStore.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Entry {
+    std::string key;
+    std::string title;
+    uint8_t disc;
+    uint8_t track;
+};
+
+// Octal escapes never swallow the character that follows them, unlike \x.
+std::string ToCppString(const char* data, size_t size)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < size; ++i)
+    {
+        unsigned char c = (unsigned char)data[i];
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += (char)c;
+        } else if (c >= 0x20 && c < 0x7F && c != '?') {
+            out += (char)c;
+        } else {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            out += escaped;
+        }
+    }
+    return out + "\"";
+}
+
+template <typename T, typename Format>
+void WriteArray(std::ostream& out, const char* type, const char* name, const T* data, size_t count, Format format)
+{
+    out << "constexpr " << type << " " << name << "[] = {";
+    for (size_t i = 0; i < count; ++i)
+    {
+        out << (i % 8 == 0 ? "\n    " : " ") << format(data[i]) << ",";
+    }
+    out << "\n};\n\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: BgmMapGen <BgmMap.yaml> <output header>\n";
+        return 2;
+    }
+    const char* yamlPath = argv[1];
+    const char* outputPath = argv[2];
+
+    std::ifstream file(yamlPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << yamlPath << ": cannot open file\n";
+        return 1;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string source = contents.str();
+
+    std::vector<Entry> entries;
+    try
+    {
+        YAML::Node config = YAML::Load(source);
+        if (!config.IsMap())
+        {
+            std::cerr << yamlPath << ": expected a map of \"path: title|disc|track\" entries\n";
+            return 1;
+        }
+
+        std::set<std::string> seenKeys;
+        bool failed = false;
+        for (const auto& node : config)
+        {
+            int line = node.first.Mark().line + 1;
+            std::string key = node.first.as<std::string>();
+            if (!node.second.IsScalar())
+            {
+                std::cerr << yamlPath << ":" << line << ": value for '" << key << "' must be a string\n";
+                failed = true;
+                continue;
+            }
+            if (!seenKeys.insert(key).second)
+            {
+                std::cerr << yamlPath << ":" << line << ": duplicate key '" << key << "'\n";
+                failed = true;
+                continue;
+            }
+
+            Entry entry;
+            entry.key = key;
+            if (!ParseBgmValue(node.second.as<std::string>(), &entry.title, &entry.disc, &entry.track))
+            {
+                std::cerr << yamlPath << ":" << line << ": value for '" << key
+                          << "' is not \"title|disc|track\" (disc and track must be 1-255)\n";
+                failed = true;
+                continue;
+            }
+            entries.push_back(entry);
+        }
+        if (failed)
+            return 1;
+    }
+    catch (const YAML::Exception& e)
+    {
+        std::cerr << yamlPath << ": YAML parsing error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (entries.empty() || entries.size() > BGM_MAX_TRACKS)
+    {
+        std::cerr << yamlPath << ": expected between 1 and " << BGM_MAX_TRACKS << " entries\n";
+        return 1;
+    }
+
+    std::vector<std::string> keys;
+    BgmTrackStore store;
+    for (const Entry& entry : entries)
+    {
+        keys.push_back(entry.key);
+        store.Add(entry.key, entry.title, entry.disc, entry.track);
+    }
+
+    BgmTrackIndex index;
+    if (!index.Build(keys))
+    {
+        std::cerr << yamlPath << ": could not build the perfect hash\n";
+        return 1;
+    }
+    if (!index.GetShadowedKeys().empty())
+    {
+        for (uint16_t id : index.GetShadowedKeys())
+            std::cerr << yamlPath << ": key '" << keys[id] << "' differs from another key only by case or separators\n";
+        return 1;
+    }
+    const BgmTrackIndexTables& tables = index.GetTables();
+    const BgmTrackStoreTables& records = store.GetTables();
+
+    std::ostringstream out;
+    out << "// Generated by tools/BgmMapGen from BgmMap.yaml. Do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include \"BgmIndex.h\"\n"
+        << "#include \"BgmTrackStore.h\"\n\n";
+
+    char hashText[32];
+    snprintf(hashText, sizeof(hashText), "0x%016llXull", (unsigned long long)HashBgmMapSource(source.data(), source.size()));
+    out << "constexpr uint64_t BGM_BUILTIN_SOURCE_HASH = " << hashText << ";\n\n";
+
+    auto hex64 = [](uint64_t v) { char text[32]; snprintf(text, sizeof(text), "0x%016llXull", (unsigned long long)v); return std::string(text); };
+    auto number = [](uint32_t v) { return std::to_string(v); };
+    auto node = [](const BgmTrieNode& n) {
+        return "{ " + std::to_string(n.firstChild) + "u, " + std::to_string(n.nextSibling) + "u, " +
+            std::to_string(n.trackId) + ", " + std::to_string(n.unit) + " }";
+    };
+
+    out << "constexpr char BGM_BUILTIN_STRING_POOL[] = " << ToCppString(records.stringPool, records.stringPoolSize) << ";\n\n";
+    WriteArray(out, "uint32_t", "BGM_BUILTIN_KEY_OFFSETS", records.keyOffsets, records.trackCount, number);
+    WriteArray(out, "uint32_t", "BGM_BUILTIN_TITLE_OFFSETS", records.titleOffsets, records.trackCount, number);
+    WriteArray(out, "uint8_t", "BGM_BUILTIN_DISCS", records.discs, records.trackCount, number);
+    WriteArray(out, "uint8_t", "BGM_BUILTIN_TRACK_NUMBERS", records.trackNumbers, records.trackCount, number);
+
+    WriteArray(out, "uint64_t", "BGM_BUILTIN_FILTER_WORDS", tables.filterWords, tables.filterWordCount, hex64);
+    WriteArray(out, "uint32_t", "BGM_BUILTIN_HASH_SEEDS", tables.hashSeeds, tables.hashSeedCount, number);
+    WriteArray(out, "uint16_t", "BGM_BUILTIN_HASH_SLOTS", tables.hashSlots, tables.hashSlotCount,
+        [](uint16_t v) { return std::to_string(v); });
+    out << "constexpr char BGM_BUILTIN_NAME_POOL[] = " << ToCppString(tables.namePool, tables.nameOffsets[tables.groupCount]) << ";\n\n";
+    WriteArray(out, "uint32_t", "BGM_BUILTIN_NAME_OFFSETS", tables.nameOffsets, tables.groupCount + 1, number);
+    WriteArray(out, "uint32_t", "BGM_BUILTIN_GROUP_ROOTS", tables.groupRoots, tables.groupCount, number);
+    WriteArray(out, "BgmTrieNode", "BGM_BUILTIN_TRIE_NODES", tables.nodes, tables.nodeCount, node);
+
+    out << "inline BgmTrackStoreTables GetBuiltinBgmTrackTables()\n"
+        << "{\n"
+        << "    BgmTrackStoreTables tables;\n"
+        << "    tables.stringPool = BGM_BUILTIN_STRING_POOL;\n"
+        << "    tables.stringPoolSize = " << records.stringPoolSize << ";\n"
+        << "    tables.keyOffsets = BGM_BUILTIN_KEY_OFFSETS;\n"
+        << "    tables.titleOffsets = BGM_BUILTIN_TITLE_OFFSETS;\n"
+        << "    tables.discs = BGM_BUILTIN_DISCS;\n"
+        << "    tables.trackNumbers = BGM_BUILTIN_TRACK_NUMBERS;\n"
+        << "    tables.trackCount = " << records.trackCount << ";\n"
+        << "    return tables;\n"
+        << "}\n\n";
+
+    out << "inline BgmTrackIndexTables GetBuiltinBgmIndexTables()\n"
+        << "{\n"
+        << "    BgmTrackIndexTables tables;\n"
+        << "    tables.filterWords = BGM_BUILTIN_FILTER_WORDS;\n"
+        << "    tables.filterWordCount = " << tables.filterWordCount << ";\n"
+        << "    tables.hashSeeds = BGM_BUILTIN_HASH_SEEDS;\n"
+        << "    tables.hashSeedCount = " << tables.hashSeedCount << ";\n"
+        << "    tables.hashSlots = BGM_BUILTIN_HASH_SLOTS;\n"
+        << "    tables.hashSlotCount = " << tables.hashSlotCount << ";\n"
+        << "    tables.namePool = BGM_BUILTIN_NAME_POOL;\n"
+        << "    tables.nameOffsets = BGM_BUILTIN_NAME_OFFSETS;\n"
+        << "    tables.groupRoots = BGM_BUILTIN_GROUP_ROOTS;\n"
+        << "    tables.groupCount = " << tables.groupCount << ";\n"
+        << "    tables.nodes = BGM_BUILTIN_TRIE_NODES;\n"
+        << "    tables.nodeCount = " << tables.nodeCount << ";\n"
+        << "    return tables;\n"
+        << "}\n";
+
+    std::string generated = out.str();
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+    {
+        std::cerr << outputPath << ": cannot write file\n";
+        return 1;
+    }
+    output << generated;
+    return output.good() ? 0 : 1;
+}